@@ -17,6 +17,7 @@ BuildRequires: cmake >= 2.8.11
 BuildRequires: gcc-c++ >= 4.7.0
 BuildRequires: libbpp-core4 = %{version}
 BuildRequires: libbpp-core-devel = %{version}
+BuildRequires: zlib-devel
 AutoReq: yes
 AutoProv: yes
 
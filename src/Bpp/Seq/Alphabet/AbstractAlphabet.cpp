@@ -14,6 +14,9 @@ using namespace bpp;
 #include <ctype.h>
 #include <map>
 #include <iostream>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
 
 using namespace std;
 
@@ -33,8 +36,119 @@ void AbstractAlphabet::updateMaps_(size_t pos, const AlphabetState& st)
 
 /******************************************************************************/
 
+const AbstractAlphabet::CodingTables_& AbstractAlphabet::buildCodingTables_() const
+{
+  std::lock_guard<std::mutex> lock(tablesMutex_);
+  // Tables might have been built by another thread in the meantime:
+  const CodingTables_* built = tablesPtr_.load(std::memory_order_acquire);
+  if (built)
+    return *built;
+
+  // Beyond this number of entries, maps are used instead of dense tables:
+  static const size_t MAX_TABLE_SIZE = 1 << 20;
+
+  auto tables = make_unique<CodingTables_>();
+
+  // Char descriptions:
+  size_t maxLength = 0;
+  size_t minLength = numeric_limits<size_t>::max();
+  for (const auto* st : alphabet_)
+  {
+    if (st)
+    {
+      maxLength = max(maxLength, st->getLetter().size());
+      minLength = min(minLength, st->getLetter().size());
+    }
+  }
+  if (minLength == maxLength)
+    tables->codingSize = maxLength;
+  tables->ranks.resize(maxLength);
+  tables->strides.resize(maxLength);
+  for (auto& ranks : tables->ranks)
+  {
+    ranks.fill(0);
+  }
+  vector<uint32_t> nbRanks(maxLength, 0);
+  for (const auto* st : alphabet_)
+  {
+    if (!st)
+      continue;
+    const string& letter = st->getLetter();
+    for (size_t i = 0; i < letter.size(); ++i)
+    {
+      uint32_t& rank = tables->ranks[i][static_cast<unsigned char>(letter[i])];
+      if (rank == 0)
+        rank = ++nbRanks[i];
+    }
+  }
+  size_t tableSize = 1;
+  tables->denseChars = true;
+  for (size_t i = 0; i < maxLength && tables->denseChars; ++i)
+  {
+    tables->strides[i] = tableSize;
+    tableSize *= nbRanks[i] + 1;
+    if (tableSize > MAX_TABLE_SIZE)
+      tables->denseChars = false;
+  }
+  if (tables->denseChars)
+  {
+    tables->keyToIndex.assign(tableSize, CodingTables_::NO_STATE);
+    for (const auto& it : letters_)
+    {
+      size_t key = 0;
+      for (size_t i = 0; i < it.first.size(); ++i)
+      {
+        key += tables->ranks[i][static_cast<unsigned char>(it.first[i])] * tables->strides[i];
+      }
+      tables->keyToIndex[key] = static_cast<uint32_t>(it.second);
+    }
+  }
+  else
+  {
+    tables->ranks.clear();
+    tables->strides.clear();
+  }
+
+  // Int descriptions:
+  if (!nums_.empty())
+  {
+    int64_t minNum = nums_.begin()->first;
+    int64_t maxNum = nums_.rbegin()->first;
+    if (maxNum - minNum < static_cast<int64_t>(MAX_TABLE_SIZE))
+    {
+      tables->denseNums = true;
+      tables->minNum = static_cast<int>(minNum);
+      tables->numToIndex.assign(static_cast<size_t>(maxNum - minNum + 1), CodingTables_::NO_STATE);
+      for (const auto& it : nums_)
+      {
+        tables->numToIndex[static_cast<size_t>(it.first - minNum)] = static_cast<uint32_t>(it.second);
+      }
+      if (tables->codingSize == 1)
+      {
+        tables->numToChar.assign(tables->numToIndex.size(), 0);
+        for (size_t i = 0; i < tables->numToIndex.size(); ++i)
+        {
+          if (tables->numToIndex[i] != CodingTables_::NO_STATE)
+            tables->numToChar[i] = alphabet_[tables->numToIndex[i]]->getLetter()[0];
+        }
+      }
+    }
+  }
+  else
+  {
+    tables->denseNums = true;
+  }
+
+  tables_ = std::move(tables);
+  tablesPtr_.store(tables_.get(), std::memory_order_release);
+  return *tables_;
+}
+
+/******************************************************************************/
+
 void AbstractAlphabet::registerState(AlphabetState* st)
 {
+  resetCodingTables_();
   // Add the state to the vector
   alphabet_.push_back(st);
   // Update the maps
@@ -47,6 +161,7 @@ void AbstractAlphabet::setState(size_t pos, AlphabetState* st)
 {
   if (pos > alphabet_.size())
     throw IndexOutOfBoundsException("AbstractAlphabet::setState: incorrect position", pos, 0, alphabet_.size());
+  resetCodingTables_();
   // Delete the state if not empty
   if (alphabet_[pos] != 0)
     delete alphabet_[pos];
@@ -60,60 +175,60 @@ void AbstractAlphabet::setState(size_t pos, AlphabetState* st)
 
 const AlphabetState& AbstractAlphabet::getState(const std::string& letter) const
 {
-  map<string, size_t>::const_iterator it = letters_.find(letter);
-  if (it == letters_.end())
+  size_t index;
+  if (!findStateIndex(letter, index))
     throw BadCharException(letter, "AbstractAlphabet::getState(string): Specified base unknown", this);
-  return *(alphabet_[it->second]);
+  return *(alphabet_[index]);
 }
 
 /******************************************************************************/
 
 size_t AbstractAlphabet::getStateIndex(const std::string& letter) const
 {
-  map<string, size_t>::const_iterator it = letters_.find(letter);
-  if (it == letters_.end())
+  size_t index;
+  if (!findStateIndex(letter, index))
     throw BadCharException(letter, "AbstractAlphabet::getStateIndex(string): Specified base unknown", this);
-  return it->second;
+  return index;
 }
 
 /******************************************************************************/
 
 const AlphabetState& AbstractAlphabet::getState(int num) const
 {
-  map<int, size_t>::const_iterator it = nums_.find(num);
-  if (it == nums_.end())
+  size_t index;
+  if (!findStateIndex(num, index))
     throw BadIntException(num, "AbstractAlphabet::getState(int): Specified base unknown", this);
-  return *(alphabet_[it->second]);
+  return *(alphabet_[index]);
 }
 
 /******************************************************************************/
 
 size_t AbstractAlphabet::getStateIndex(int num) const
 {
-  map<int, size_t>::const_iterator it = nums_.find(num);
-  if (it == nums_.end())
+  size_t index;
+  if (!findStateIndex(num, index))
     throw BadIntException(num, "AbstractAlphabet::getStateIndex(int): Specified base unknown", this);
-  return it->second;
+  return index;
 }
 
 /******************************************************************************/
 
 AlphabetState& AbstractAlphabet::getState(const std::string& letter)
 {
-  map<string, size_t>::iterator it = letters_.find(letter);
-  if (it == letters_.end())
+  size_t index;
+  if (!findStateIndex(letter, index))
     throw BadCharException(letter, "AbstractAlphabet::getState(string): Specified base unknown", this);
-  return *(alphabet_[it->second]);
+  return *(alphabet_[index]);
 }
 
 /******************************************************************************/
 
 AlphabetState& AbstractAlphabet::getState(int num)
 {
-  map<int, size_t>::iterator it = nums_.find(num);
-  if (it == nums_.end())
+  size_t index;
+  if (!findStateIndex(num, index))
     throw BadIntException(num, "AbstractAlphabet::getState(int): Specified base unknown", this);
-  return *(alphabet_[it->second]);
+  return *(alphabet_[index]);
 }
 
 /******************************************************************************/
@@ -150,36 +265,98 @@ std::string AbstractAlphabet::getName(int state) const
 
 /******************************************************************************/
 
-int AbstractAlphabet::charToInt(const std::string& state) const
+int AbstractAlphabet::encodeState(std::string_view state) const
 {
-  return getState(state).getNum();
+  size_t index;
+  if (!findStateIndex(state, index))
+    throw BadCharException(string(state), "AbstractAlphabet::encodeState: Specified base unknown", this);
+  return alphabet_[index]->getNum();
 }
 
 /******************************************************************************/
 
-std::string AbstractAlphabet::intToChar(int state) const
+std::string_view AbstractAlphabet::decodeState(int state) const
 {
-  return (getState(state)).getLetter();
+  size_t index;
+  if (!findStateIndex(state, index))
+    throw BadIntException(state, "AbstractAlphabet::decodeState: Specified base unknown", this);
+  return alphabet_[index]->getLetter();
+}
+
+/******************************************************************************/
+
+void AbstractAlphabet::encode(const char* chars, size_t length, int* codes) const
+{
+  size_t size = getStateCodingSize();
+  if (getCodingTables_().codingSize != size)
+    throw AlphabetException("AbstractAlphabet::encode: states are not described by strings of the same size.", this);
+  if (length % size != 0)
+    throw BadCharException(string(chars + length - length % size, length % size), "AbstractAlphabet::encode: incomplete state", this);
+  for (size_t i = 0; i < length; i += size)
+  {
+    *codes++ = encodeState(string_view(chars + i, size));
+  }
+}
+
+/******************************************************************************/
+
+void AbstractAlphabet::decode(const int* codes, size_t nbCodes, char* chars) const
+{
+  size_t size = getStateCodingSize();
+  if (getCodingTables_().codingSize != size)
+    throw AlphabetException("AbstractAlphabet::decode: states are not described by strings of the same size.", this);
+  for (size_t i = 0; i < nbCodes; ++i)
+  {
+    string_view state = decodeState(codes[i]);
+    if (state.size() != size)
+      throw BadIntException(codes[i], "AbstractAlphabet::decode: state description has an unexpected size", this);
+    memcpy(chars, state.data(), size);
+    chars += size;
+  }
+}
+
+/******************************************************************************/
+
+void AbstractAlphabet::decodeLetters(const int* codes, size_t nbCodes, char* chars) const
+{
+  const CodingTables_& tables = getCodingTables_();
+  if (tables.numToChar.empty())
+  {
+    if (tables.codingSize != 1)
+      throw AlphabetException("AbstractAlphabet::decodeLetters: states are not described by a single character.", this);
+    // No dense table available:
+    for (size_t i = 0; i < nbCodes; ++i)
+    {
+      chars[i] = decodeState(codes[i])[0];
+    }
+    return;
+  }
+  const char* table = tables.numToChar.data();
+  size_t tableSize = tables.numToChar.size();
+  for (size_t i = 0; i < nbCodes; ++i)
+  {
+    size_t offset = static_cast<size_t>(static_cast<int64_t>(codes[i]) - tables.minNum);
+    char c = offset < tableSize ? table[offset] : 0;
+    if (c == 0)
+      throw BadIntException(codes[i], "AbstractAlphabet::decodeLetters: Specified base unknown", this);
+    chars[i] = c;
+  }
 }
 
 /******************************************************************************/
 
 bool AbstractAlphabet::isIntInAlphabet(int state) const
 {
-  map<int, size_t>::const_iterator it = nums_.find(state);
-  if (it != nums_.end())
-    return true;
-  return false;
+  size_t index;
+  return findStateIndex(state, index);
 }
 
 /******************************************************************************/
 
 bool AbstractAlphabet::isCharInAlphabet(const std::string& state) const
 {
-  map<string, size_t>::const_iterator it = letters_.find(state);
-  if (it != letters_.end())
-    return true;
-  return false;
+  size_t index;
+  return findStateIndex(state, index);
 }
 
 /******************************************************************************/
@@ -336,3 +513,24 @@ const std::vector<std::string>& AbstractAlphabet::getResolvedChars() const
 
   return charList_;
 }
+
+/******************************************************************************/
+
+size_t Alphabet::getAlphabetTypeId(const string& type)
+{
+  // Registry of all alphabet types met so far, shared by all alphabets:
+  static std::mutex registryMutex;
+  static std::unordered_map<string, size_t> registry;
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+  return registry.emplace(type, registry.size() + 1).first->second;
+}
+
+/******************************************************************************/
+
+size_t AbstractAlphabet::computeAlphabetId_() const
+{
+  size_t id = getAlphabetTypeId(getAlphabetType());
+  alphabetId_.store(id, std::memory_order_relaxed);
+  return id;
+}
@@ -12,8 +12,14 @@
 
 // From the STL:
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
 #include <map>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <cstdint>
 
 namespace bpp
 {
@@ -25,6 +31,12 @@ namespace bpp
  * but do not provide any method to initialize it.
  * This is up to each constructor of the derived classes.
  *
+ * Conversions between int and char descriptions are table-driven: on first
+ * use, dense lookup tables are computed from the registered states, so that
+ * encoding and decoding a state takes constant time, including for
+ * multi-character states (words, codons, etc.). The tables are discarded
+ * whenever states are registered or modified.
+ *
  * @see Alphabet
  */
 class AbstractAlphabet :
@@ -40,10 +52,49 @@ private:
    * @name maps used to quick search for letter and num.
    * @{
    */
-  std::map<std::string, size_t> letters_;
+  std::map<std::string, size_t, std::less<>> letters_;
   std::map<int, size_t> nums_;
   /** @} */
 
+  /**
+   * @brief Dense lookup tables for state conversions.
+   *
+   * Char descriptions are encoded position by position: each character found
+   * at a given position in a state description gets a rank (starting at 1,
+   * 0 standing for the end of the description), and the ranks are combined
+   * into a key indexing keyToIndex. Int descriptions directly index
+   * numToIndex, after subtraction of minNum.
+   *
+   * When tables would be too large, the corresponding dense flag is false and
+   * the maps are used instead.
+   *
+   * codingSize is the common size of all char descriptions, or 0 if they
+   * differ. When it is 1, numToChar gives the char description of each int
+   * description (0 if none), with the same offset as numToIndex.
+   */
+  struct CodingTables_
+  {
+    static constexpr uint32_t NO_STATE = UINT32_MAX;
+    bool denseChars = false;
+    std::vector<std::array<uint32_t, 256>> ranks{};
+    std::vector<size_t> strides{};
+    std::vector<uint32_t> keyToIndex{};
+    bool denseNums = false;
+    int minNum = 0;
+    std::vector<uint32_t> numToIndex{};
+    size_t codingSize = 0;
+    std::vector<char> numToChar{};
+  };
+
+  mutable std::unique_ptr<CodingTables_> tables_;
+  mutable std::atomic<const CodingTables_*> tablesPtr_;
+  mutable std::mutex tablesMutex_;
+
+  /**
+   * @brief The interned identity of the alphabet type, 0 if not computed yet.
+   */
+  mutable std::atomic<size_t> alphabetId_;
+
   /**
    * @brief Update the private maps letters_ and nums_ when adding a state.
    *
@@ -52,6 +103,29 @@ private:
    */
   void updateMaps_(size_t pos, const AlphabetState& st);
 
+  /**
+   * @return The lookup tables, computed if needed.
+   */
+  const CodingTables_& getCodingTables_() const
+  {
+    const CodingTables_* tables = tablesPtr_.load(std::memory_order_acquire);
+    return tables ? *tables : buildCodingTables_();
+  }
+
+  const CodingTables_& buildCodingTables_() const;
+
+  size_t computeAlphabetId_() const;
+
+  /**
+   * @brief Discard the lookup tables, which will be recomputed on next use.
+   */
+  void resetCodingTables_()
+  {
+    std::lock_guard<std::mutex> lock(tablesMutex_);
+    tablesPtr_.store(nullptr, std::memory_order_release);
+    tables_.reset();
+  }
+
 protected:
   /**
    * @name Available codes
@@ -65,10 +139,10 @@ protected:
   /** @} */
 
 public:
-  AbstractAlphabet() : alphabet_(), letters_(), nums_(), charList_(), intList_()
+  AbstractAlphabet() : alphabet_(), letters_(), nums_(), tables_(), tablesPtr_(nullptr), tablesMutex_(), alphabetId_(0), charList_(), intList_()
   {}
 
-  AbstractAlphabet(const AbstractAlphabet& alph) : alphabet_(), letters_(alph.letters_), nums_(alph.nums_), charList_(alph.charList_), intList_(alph.intList_)
+  AbstractAlphabet(const AbstractAlphabet& alph) : alphabet_(), letters_(alph.letters_), nums_(alph.nums_), tables_(), tablesPtr_(nullptr), tablesMutex_(), alphabetId_(0), charList_(alph.charList_), intList_(alph.intList_)
   {
     for (size_t i = 0; i < alph.alphabet_.size(); ++i)
     {
@@ -82,6 +156,7 @@ public:
     {
       delete alphabet_[i];
     }
+    alphabet_.clear();
 
     for (size_t i = 0; i < alph.alphabet_.size(); ++i)
     {
@@ -92,6 +167,8 @@ public:
     nums_     = alph.nums_;
     charList_ = alph.charList_;
     intList_  = alph.intList_;
+    resetCodingTables_();
+    alphabetId_ = 0;
 
     return *this;
   }
@@ -122,8 +199,18 @@ public:
   }
   std::string getName(const std::string& state) const;
   std::string getName(int state) const;
-  int charToInt(const std::string& state) const;
-  std::string intToChar(int state) const;
+  int charToInt(const std::string& state) const
+  {
+    return encodeState(state);
+  }
+  std::string intToChar(int state) const
+  {
+    return std::string(decodeState(state));
+  }
+  int encodeState(std::string_view state) const;
+  std::string_view decodeState(int state) const;
+  void encode(const char* chars, size_t length, int* codes) const;
+  void decode(const int* codes, size_t nbCodes, char* chars) const;
   bool isIntInAlphabet(int state) const;
   bool isCharInAlphabet(const std::string& state) const;
   bool isResolvedIn(int state1, int state2) const;
@@ -146,6 +233,15 @@ public:
   {
     return charToInt(state) == -1;
   }
+  size_t getAlphabetId() const override
+  {
+    size_t id = alphabetId_.load(std::memory_order_relaxed);
+    return id ? id : computeAlphabetId_();
+  }
+  bool isCompatibleWith(const Alphabet& alphabet) const override
+  {
+    return this == &alphabet || getAlphabetId() == alphabet.getAlphabetId();
+  }
   /** @} */
 
   /**
@@ -215,6 +311,84 @@ public:
   size_t getStateIndex(const std::string& state) const;
   /** @} */
 
+protected:
+  /**
+   * @brief Look for a state by its char description, without throwing any exception.
+   *
+   * @param state The char description of the state.
+   * @param stateIndex [out] The index of the state in the alphabet_ vector, if found.
+   * @return Whether the state was found.
+   */
+  bool findStateIndex(std::string_view state, size_t& stateIndex) const
+  {
+    const CodingTables_& tables = getCodingTables_();
+    if (!tables.denseChars)
+    {
+      auto it = letters_.find(state);
+      if (it == letters_.end())
+        return false;
+      stateIndex = it->second;
+      return true;
+    }
+    if (state.size() > tables.ranks.size())
+      return false;
+    size_t key = 0;
+    for (size_t i = 0; i < state.size(); ++i)
+    {
+      uint32_t rank = tables.ranks[i][static_cast<unsigned char>(state[i])];
+      if (rank == 0)
+        return false;
+      key += rank * tables.strides[i];
+    }
+    uint32_t index = tables.keyToIndex[key];
+    if (index == CodingTables_::NO_STATE)
+      return false;
+    stateIndex = index;
+    return true;
+  }
+
+  /**
+   * @brief Look for a state by its int description, without throwing any exception.
+   *
+   * @param state The int description of the state.
+   * @param stateIndex [out] The index of the state in the alphabet_ vector, if found.
+   * @return Whether the state was found.
+   */
+  bool findStateIndex(int state, size_t& stateIndex) const
+  {
+    const CodingTables_& tables = getCodingTables_();
+    if (!tables.denseNums)
+    {
+      auto it = nums_.find(state);
+      if (it == nums_.end())
+        return false;
+      stateIndex = it->second;
+      return true;
+    }
+    int64_t offset = static_cast<int64_t>(state) - tables.minNum;
+    if (offset < 0 || offset >= static_cast<int64_t>(tables.numToIndex.size()))
+      return false;
+    uint32_t index = tables.numToIndex[static_cast<size_t>(offset)];
+    if (index == CodingTables_::NO_STATE)
+      return false;
+    stateIndex = index;
+    return true;
+  }
+
+  /**
+   * @brief Decode states described by a single character, directly from the lookup tables.
+   *
+   * This is the fast path of decode() for alphabets whose states are all described by one
+   * character, and which do not redefine decodeState().
+   *
+   * @param codes A pointer toward the first int description to decode.
+   * @param nbCodes The number of states to decode.
+   * @param chars A pointer toward the output buffer.
+   * @throw BadIntException When a state is not a valid integer.
+   * @throw AlphabetException When states are not all described by one character.
+   */
+  void decodeLetters(const int* codes, size_t nbCodes, char* chars) const;
+
 protected:
   /**
    * @brief Add a state to the Alphabet.
@@ -241,6 +415,7 @@ protected:
    */
   void resize(size_t size)
   {
+    resetCodingTables_();
     alphabet_.resize(size);
   }
 
@@ -249,6 +424,7 @@ protected:
    */
   void remap()
   {
+    resetCodingTables_();
     letters_.clear();
     nums_.clear();
     for (size_t i = 0; i < alphabet_.size(); ++i)
@@ -257,14 +433,18 @@ protected:
     }
   }
 
+  /**
+   * @return The common size of all char descriptions, or 1 if they do not all have the same size.
+   */
   unsigned int getStateCodingSize() const
   {
-    return 1;
+    size_t size = getCodingTables_().codingSize;
+    return size > 0 ? static_cast<unsigned int>(size) : 1;
   }
 
   bool equals(const Alphabet& alphabet) const
   {
-    return getAlphabetType() == alphabet.getAlphabetType();
+    return isCompatibleWith(alphabet);
   }
 };
 } // end of namespace bpp.
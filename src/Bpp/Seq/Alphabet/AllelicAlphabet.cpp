@@ -132,7 +132,7 @@ std::unique_ptr<ProbabilisticSequence> AllelicAlphabet::convertFromStateAlphabet
 
   auto alphabet = seq ? seq->getAlphabet() : probseq->getAlphabet();
 
-  if (alphabet->getAlphabetType() != getStateAlphabet()->getAlphabetType())
+  if (!alphabet->isCompatibleWith(*getStateAlphabet()))
     throw AlphabetMismatchException("AllelicAlphabet::convertFromStateAlphabet", getStateAlphabet().get(), alphabet.get());
 
   auto alphaPtr = shared_from_this();
@@ -90,12 +90,12 @@ public:
    *
    * @{
    */
-  int charToInt(const std::string& state) const override
+  int encodeState(std::string_view state) const override
   {
     if (state.size() != getStateCodingSize())
-      throw BadCharException(state, "AllelicAlphabet::charToInt", this);
+      throw BadCharException(std::string(state), "AllelicAlphabet::charToInt", this);
     else
-      return AbstractAlphabet::charToInt(state);
+      return AbstractAlphabet::encodeState(state);
   }
 
   unsigned int getSize() const override
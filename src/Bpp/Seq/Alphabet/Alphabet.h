@@ -7,6 +7,7 @@
 
 #include <Bpp/Clonable.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
@@ -246,6 +247,58 @@ public:
    * @throw BadCharException When state is not a valid char description.
    */
   virtual int charToInt(const std::string& state) const = 0;
+
+  /**
+   * @brief Give the int description of a state given its string description.
+   *
+   * Same as charToInt, but without requiring the state to be stored in a std::string.
+   * This allows to encode states directly from a character buffer.
+   *
+   * @param state The string description.
+   * @return The int description.
+   * @throw BadCharException When state is not a valid char description.
+   */
+  virtual int encodeState(std::string_view state) const = 0;
+
+  /**
+   * @brief Give the string description of a state given its int description.
+   *
+   * Same as intToChar, but no string is allocated: the returned view points to
+   * the description stored in the alphabet, and remains valid as long as the
+   * alphabet itself.
+   *
+   * @param state The int description.
+   * @return A view on the string description.
+   * @throw BadIntException When state is not a valid integer.
+   */
+  virtual std::string_view decodeState(int state) const = 0;
+
+  /**
+   * @brief Encode a whole buffer of char descriptions.
+   *
+   * The buffer is made of successive state descriptions, all of size
+   * getStateCodingSize(), without any separator.
+   *
+   * @param chars A pointer toward the first character to encode.
+   * @param length The number of characters to encode, which must be a multiple of getStateCodingSize().
+   * @param codes A pointer toward a preallocated buffer of at least length / getStateCodingSize() elements,
+   * where the int descriptions will be written.
+   * @throw BadCharException When a state is not a valid char description.
+   * @throw AlphabetException When states do not all have a description of the same size.
+   */
+  virtual void encode(const char* chars, size_t length, int* codes) const = 0;
+
+  /**
+   * @brief Decode a whole buffer of int descriptions.
+   *
+   * @param codes A pointer toward the first int description to decode.
+   * @param nbCodes The number of states to decode.
+   * @param chars A pointer toward a preallocated buffer of at least nbCodes * getStateCodingSize() characters,
+   * where the char descriptions will be written (no terminal null character is added).
+   * @throw BadIntException When a state is not a valid integer.
+   * @throw AlphabetException When states do not all have a description of the same size.
+   */
+  virtual void decode(const int* codes, size_t nbCodes, char* chars) const = 0;
   /** @} */
 
   /**
@@ -427,6 +480,38 @@ public:
    */
   virtual std::string getAlphabetType() const = 0;
 
+  /**
+   * @brief Interned identity of the alphabet type.
+   *
+   * All alphabets with the same type (see getAlphabetType()) share the same
+   * identifier. It is computed the first time it is requested and then
+   * cached, so that comparing identifiers does not involve any string
+   * construction, even for alphabets built from other alphabets.
+   *
+   * The default implementation looks the type up at each call; implementations
+   * should cache it.
+   *
+   * @return A non-null identifier, unique to the alphabet type during the execution of the program.
+   */
+  virtual size_t getAlphabetId() const
+  {
+    return getAlphabetTypeId(getAlphabetType());
+  }
+
+  /**
+   * @brief Tell if sequences from two alphabets can be mixed.
+   *
+   * This is equivalent to comparing the results of getAlphabetType(),
+   * but is done in constant time using getAlphabetId().
+   *
+   * @param alphabet The alphabet to compare with.
+   * @return true If the two alphabets have the same type.
+   */
+  virtual bool isCompatibleWith(const Alphabet& alphabet) const
+  {
+    return this == &alphabet || getAlphabetId() == alphabet.getAlphabetId();
+  }
+
   /**
    * @brief Get the size of the string coding a state.
    * @return The size of the string coding each states in the Alphabet.
@@ -440,6 +525,14 @@ public:
    * @return true If the two instances are of the same class.
    */
   virtual bool equals(const Alphabet& alphabet) const = 0;
+
+protected:
+  /**
+   * @return The identifier of an alphabet type, see getAlphabetId().
+   * Types are registered the first time they are met, by all alphabets.
+   * @param type The type of an alphabet, as returned by getAlphabetType().
+   */
+  static size_t getAlphabetTypeId(const std::string& type);
 };
 } // end of namespace bpp.
 #endif // BPP_SEQ_ALPHABET_ALPHABET_H
@@ -50,11 +50,11 @@ bool AlphabetTools::checkAlphabetCodingSize(const Alphabet& alphabet)
 {
   if (alphabet.getNumberOfChars() == 0)
     return true; // Will this really happen?
-  size_t size = alphabet.intToChar(0).size();
+  size_t size = alphabet.decodeState(0).size();
 
   for (size_t i = 1; i < alphabet.getNumberOfTypes(); ++i)
   {
-    if (alphabet.intToChar(alphabet.getStateAt(i).getNum()).size() != size)
+    if (alphabet.decodeState(alphabet.getStateAt(i).getNum()).size() != size)
       return false;
   }
   return true;
@@ -73,7 +73,7 @@ unsigned int AlphabetTools::getAlphabetCodingSize(const Alphabet& alphabet)
 {
   if (!checkAlphabetCodingSize(alphabet))
     throw AlphabetException("Bad alphabet in function Alphabet::getAlphabetCodingSize().", &alphabet);
-  return static_cast<unsigned int>(alphabet.intToChar(0).size());
+  return static_cast<unsigned int>(alphabet.decodeState(0).size());
 }
 
 /**********************************************************************************************/
@@ -125,15 +125,18 @@ public:
     return states[0];
   }
 
-  int charToInt(const std::string& state) const override
+  int encodeState(std::string_view state) const override
   {
+    size_t stateIndex;
+    if (findStateIndex(state, stateIndex))
+      return getIntCodeAt(stateIndex);
     if (state.size() != 3)
-      throw BadCharException(state, "CodonAlphabet::charToInt", this);
-    if (containsUnresolved(state))
+      throw BadCharException(std::string(state), "CodonAlphabet::charToInt", this);
+    if (containsUnresolved(std::string(state)))
       return static_cast<int>(getSize());
-    if (containsGap(state))
+    if (containsGap(std::string(state)))
       return -1;
-    else return AbstractAlphabet::charToInt(state);
+    throw BadCharException(std::string(state), "CodonAlphabet::charToInt", this);
   }
 
   /**
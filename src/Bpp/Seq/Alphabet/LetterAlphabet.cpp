@@ -4,6 +4,302 @@
 
 #include "LetterAlphabet.h"
 
+// From the STL:
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
 using namespace bpp;
+using namespace std;
 
 const int LetterAlphabet::LETTER_UNDEF_VALUE = -99;
+const size_t LetterAlphabet::SIMD_BLOCK_SIZE = 16;
+
+namespace
+{
+// Below this number of states, building the SIMD lookup tables costs more than it saves.
+const size_t SIMD_MIN_LENGTH = 64;
+// Marks letters and codes without a compact equivalent in the SIMD lookup tables.
+const int8_t SIMD_NO_CODE = -128;
+
+#if defined(__SSE2__)
+/**
+ * @brief Sign-extend 16 8-bits codes and store them as int.
+ */
+inline void storeCodes(__m128i v, int* codes)
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i w0 = _mm_unpacklo_epi8(v, _mm_cmpgt_epi8(zero, v));
+  __m128i w1 = _mm_unpackhi_epi8(v, _mm_cmpgt_epi8(zero, v));
+  __m128i s0 = _mm_cmpgt_epi16(zero, w0);
+  __m128i s1 = _mm_cmpgt_epi16(zero, w1);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(codes), _mm_unpacklo_epi16(w0, s0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + 4), _mm_unpackhi_epi16(w0, s0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + 8), _mm_unpacklo_epi16(w1, s1));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + 12), _mm_unpackhi_epi16(w1, s1));
+}
+
+/**
+ * @brief Load 16 int codes as 8-bits integers, with saturation.
+ */
+inline __m128i loadCodes(const int* codes)
+{
+  __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes));
+  __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + 4));
+  __m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + 8));
+  __m128i c3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + 12));
+  return _mm_packs_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3));
+}
+#endif
+}
+
+/******************************************************************************/
+
+void LetterAlphabet::encode(const char* chars, size_t length, int* codes) const
+{
+  size_t done = 0;
+  if (length >= SIMD_MIN_LENGTH)
+    done = encodeBlocks_(chars, length, codes);
+  encodeLetters_(chars + done, length - done, codes + done);
+}
+
+/******************************************************************************/
+
+void LetterAlphabet::decode(const int* codes, size_t nbCodes, char* chars) const
+{
+  size_t done = 0;
+  if (nbCodes >= SIMD_MIN_LENGTH)
+    done = decodeBlocks_(codes, nbCodes, chars);
+  decodeLetters(codes + done, nbCodes - done, chars + done);
+}
+
+/******************************************************************************/
+
+#if defined(__SSSE3__)
+
+// Any letter alphabet: letters 'A' to 'Z' are looked up in two 16-entries
+// shuffle tables, after case folding.
+
+size_t LetterAlphabet::encodeBlocks_(const char* chars, size_t length, int* codes) const
+{
+  alignas(16) int8_t table[32];
+  for (int k = 0; k < 32; ++k)
+  {
+    table[k] = SIMD_NO_CODE;
+    if (k >= 26)
+      continue;
+    int upper = letters_[static_cast<unsigned char>('A' + k)];
+    int lower = letters_[static_cast<unsigned char>('a' + k)];
+    // Case folding is only valid if both cases code for the same state:
+    if (upper != LETTER_UNDEF_VALUE && upper == lower && upper > SIMD_NO_CODE && upper <= INT8_MAX)
+      table[k] = static_cast<int8_t>(upper);
+  }
+  int gap = letters_[static_cast<unsigned char>('-')];
+  bool hasGap = gap != LETTER_UNDEF_VALUE && gap > SIMD_NO_CODE && gap <= INT8_MAX;
+
+  const __m128i tableLo = _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+  const __m128i tableHi = _mm_load_si128(reinterpret_cast<const __m128i*>(table + 16));
+  const __m128i caseMask = _mm_set1_epi8(static_cast<char>(0xDF));
+  const __m128i letterA = _mm_set1_epi8('A');
+  const __m128i gapChar = _mm_set1_epi8('-');
+  const __m128i gapCode = _mm_set1_epi8(static_cast<char>(hasGap ? gap : 0));
+  const __m128i noCode = _mm_set1_epi8(SIMD_NO_CODE);
+  const __m128i minusOne = _mm_set1_epi8(-1);
+  const __m128i sixteen = _mm_set1_epi8(16);
+  const __m128i twentySix = _mm_set1_epi8(26);
+
+  size_t i = 0;
+  for ( ; i + SIMD_BLOCK_SIZE <= length; i += SIMD_BLOCK_SIZE)
+  {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+    __m128i index = _mm_sub_epi8(_mm_and_si128(x, caseMask), letterA);
+    __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(index, minusOne), _mm_cmplt_epi8(index, twentySix));
+    __m128i isLow = _mm_cmplt_epi8(index, sixteen);
+    __m128i v = _mm_or_si128(
+        _mm_and_si128(isLow, _mm_shuffle_epi8(tableLo, index)),
+        _mm_andnot_si128(isLow, _mm_shuffle_epi8(tableHi, _mm_sub_epi8(index, sixteen))));
+    isLetter = _mm_andnot_si128(_mm_cmpeq_epi8(v, noCode), isLetter);
+    __m128i isGap = hasGap ? _mm_cmpeq_epi8(x, gapChar) : _mm_setzero_si128();
+    if (_mm_movemask_epi8(_mm_or_si128(isLetter, isGap)) != 0xFFFF)
+    {
+      // Other characters in this block:
+      encodeLetters_(chars + i, SIMD_BLOCK_SIZE, codes + i);
+      continue;
+    }
+    v = _mm_or_si128(_mm_and_si128(isLetter, v), _mm_and_si128(isGap, gapCode));
+    storeCodes(v, codes + i);
+  }
+  return i;
+}
+
+/******************************************************************************/
+
+size_t LetterAlphabet::decodeBlocks_(const int* codes, size_t nbCodes, char* chars) const
+{
+  alignas(16) char table[32];
+  for (int k = 0; k < 32; ++k)
+  {
+    table[k] = isIntInAlphabet(k) ? decodeState(k)[0] : 0;
+  }
+  char gap = isIntInAlphabet(-1) ? decodeState(-1)[0] : 0;
+
+  const __m128i tableLo = _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+  const __m128i tableHi = _mm_load_si128(reinterpret_cast<const __m128i*>(table + 16));
+  const __m128i gapChar = _mm_set1_epi8(gap);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i minusOne = _mm_set1_epi8(-1);
+  const __m128i sixteen = _mm_set1_epi8(16);
+
+  size_t i = 0;
+  for ( ; i + SIMD_BLOCK_SIZE <= nbCodes; i += SIMD_BLOCK_SIZE)
+  {
+    __m128i v = loadCodes(codes + i);
+    // Negative codes give 0 with both shuffles:
+    __m128i isLow = _mm_cmplt_epi8(v, sixteen);
+    __m128i c = _mm_or_si128(
+        _mm_and_si128(isLow, _mm_shuffle_epi8(tableLo, v)),
+        _mm_andnot_si128(isLow, _mm_shuffle_epi8(tableHi, _mm_sub_epi8(v, sixteen))));
+    // Codes above 31 would be looked up modulo 16:
+    __m128i isValid = _mm_andnot_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(31)), _mm_cmpgt_epi8(v, minusOne));
+    isValid = _mm_andnot_si128(_mm_cmpeq_epi8(c, zero), isValid);
+    __m128i isGap = gap ? _mm_cmpeq_epi8(v, minusOne) : zero;
+    if (_mm_movemask_epi8(_mm_or_si128(isValid, isGap)) != 0xFFFF)
+    {
+      decodeLetters(codes + i, SIMD_BLOCK_SIZE, chars + i);
+      continue;
+    }
+    c = _mm_or_si128(_mm_and_si128(isValid, c), _mm_and_si128(isGap, gapChar));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chars + i), c);
+  }
+  return i;
+}
+
+#elif defined(__SSE2__)
+
+// Without byte shuffles, only alphabets with at most 4 resolved letters
+// (i.e. nucleotides) are vectorized, by comparing each block to all of them.
+
+size_t LetterAlphabet::encodeBlocks_(const char* chars, size_t length, int* codes) const
+{
+  char letters[4];
+  int8_t letterCodes[4];
+  int nbLetters = 0;
+  if (getSize() > 4)
+    return 0;
+  for (int k = 0; k < 26; ++k)
+  {
+    int upper = letters_[static_cast<unsigned char>('A' + k)];
+    int lower = letters_[static_cast<unsigned char>('a' + k)];
+    if (upper >= 0 && upper < static_cast<int>(getSize()))
+    {
+      if (upper != lower || nbLetters == 4)
+        return 0;
+      letters[nbLetters] = static_cast<char>('a' + k);
+      letterCodes[nbLetters] = static_cast<int8_t>(upper);
+      nbLetters++;
+    }
+  }
+  int gap = letters_[static_cast<unsigned char>('-')];
+  bool hasGap = gap != LETTER_UNDEF_VALUE && gap > SIMD_NO_CODE && gap <= INT8_MAX;
+
+  __m128i letterChars[4], letterValues[4];
+  for (int k = 0; k < nbLetters; ++k)
+  {
+    letterChars[k] = _mm_set1_epi8(letters[k]);
+    letterValues[k] = _mm_set1_epi8(letterCodes[k]);
+  }
+  const __m128i lowerCase = _mm_set1_epi8(0x20);
+  const __m128i gapChar = _mm_set1_epi8('-');
+  const __m128i gapCode = _mm_set1_epi8(static_cast<char>(hasGap ? gap : 0));
+
+  size_t i = 0;
+  for ( ; i + SIMD_BLOCK_SIZE <= length; i += SIMD_BLOCK_SIZE)
+  {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+    __m128i folded = _mm_or_si128(x, lowerCase);
+    __m128i v = _mm_setzero_si128();
+    __m128i found = _mm_setzero_si128();
+    for (int k = 0; k < nbLetters; ++k)
+    {
+      __m128i m = _mm_cmpeq_epi8(folded, letterChars[k]);
+      v = _mm_or_si128(v, _mm_and_si128(m, letterValues[k]));
+      found = _mm_or_si128(found, m);
+    }
+    if (hasGap)
+    {
+      __m128i m = _mm_cmpeq_epi8(x, gapChar);
+      v = _mm_or_si128(v, _mm_and_si128(m, gapCode));
+      found = _mm_or_si128(found, m);
+    }
+    if (_mm_movemask_epi8(found) != 0xFFFF)
+    {
+      encodeLetters_(chars + i, SIMD_BLOCK_SIZE, codes + i);
+      continue;
+    }
+    storeCodes(v, codes + i);
+  }
+  return i;
+}
+
+/******************************************************************************/
+
+size_t LetterAlphabet::decodeBlocks_(const int* codes, size_t nbCodes, char* chars) const
+{
+  if (getSize() > 4)
+    return 0;
+  // Codes -1 (gap) to 3:
+  __m128i values[5], letters[5];
+  bool defined[5];
+  for (int k = -1; k < 4; ++k)
+  {
+    defined[k + 1] = isIntInAlphabet(k);
+    values[k + 1] = _mm_set1_epi8(static_cast<char>(k));
+    letters[k + 1] = _mm_set1_epi8(defined[k + 1] ? decodeState(k)[0] : 0);
+  }
+
+  size_t i = 0;
+  for ( ; i + SIMD_BLOCK_SIZE <= nbCodes; i += SIMD_BLOCK_SIZE)
+  {
+    __m128i v = loadCodes(codes + i);
+    __m128i c = _mm_setzero_si128();
+    __m128i found = _mm_setzero_si128();
+    for (int k = 0; k < 5; ++k)
+    {
+      if (!defined[k])
+        continue;
+      __m128i m = _mm_cmpeq_epi8(v, values[k]);
+      c = _mm_or_si128(c, _mm_and_si128(m, letters[k]));
+      found = _mm_or_si128(found, m);
+    }
+    if (_mm_movemask_epi8(found) != 0xFFFF)
+    {
+      decodeLetters(codes + i, SIMD_BLOCK_SIZE, chars + i);
+      continue;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chars + i), c);
+  }
+  return i;
+}
+
+#else
+
+size_t LetterAlphabet::encodeBlocks_(const char* chars, size_t length, int* codes) const
+{
+  return 0;
+}
+
+/******************************************************************************/
+
+size_t LetterAlphabet::decodeBlocks_(const int* codes, size_t nbCodes, char* chars) const
+{
+  return 0;
+}
+
+#endif
+
+/******************************************************************************/
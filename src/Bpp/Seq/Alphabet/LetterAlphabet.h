@@ -27,6 +27,7 @@ class LetterAlphabet :
 {
 private:
   static const int LETTER_UNDEF_VALUE;
+  static const size_t SIMD_BLOCK_SIZE;
   std::vector<int> letters_;
   bool caseSensitive_;
 
@@ -54,7 +55,7 @@ public:
 public:
   bool isCharInAlphabet(char state) const
   {
-    return letters_[static_cast<size_t>(state)] != LETTER_UNDEF_VALUE;
+    return letters_[static_cast<unsigned char>(state)] != LETTER_UNDEF_VALUE;
   }
   bool isCharInAlphabet(const std::string& state) const
   {
@@ -64,7 +65,77 @@ public:
   {
     if (!isCharInAlphabet(state))
       throw BadCharException(state, "LetterAlphabet::charToInt: Unknown state", this);
-    return letters_[static_cast<unsigned int>(state[0])];
+    return letters_[static_cast<unsigned char>(state[0])];
+  }
+
+  /**
+   * @brief Give the int description of a state given its character.
+   *
+   * @param state The character.
+   * @return The int description.
+   * @throw BadCharException When state is not a valid character.
+   */
+  int charToInt(char state) const
+  {
+    int code = letters_[static_cast<unsigned char>(state)];
+    if (code == LETTER_UNDEF_VALUE)
+      throw BadCharException(std::string(1, state), "LetterAlphabet::charToInt: Unknown state", this);
+    return code;
+  }
+
+  int encodeState(std::string_view state) const override
+  {
+    if (state.size() != 1)
+      throw BadCharException(std::string(state), "LetterAlphabet::encodeState: Unknown state", this);
+    return charToInt(state[0]);
+  }
+
+  /**
+   * @brief Encode a whole buffer of characters.
+   *
+   * Characters are converted using the letter table, so that the case is ignored
+   * if the alphabet is not case-sensitive. When the processor supports it, blocks
+   * of characters made only of letters and gaps are converted with SIMD instructions.
+   *
+   * @see Alphabet::encode
+   */
+  void encode(const char* chars, size_t length, int* codes) const;
+
+  /**
+   * @brief Decode a whole buffer of int descriptions.
+   *
+   * When the processor supports it, blocks of small codes are converted with SIMD instructions.
+   *
+   * @see Alphabet::decode
+   */
+  void decode(const int* codes, size_t nbCodes, char* chars) const;
+
+private:
+  /**
+   * @brief Vectorized part of encode() and decode().
+   *
+   * Only whole blocks of SIMD_BLOCK_SIZE states are processed.
+   *
+   * @return The number of states processed, 0 if SIMD instructions are not available.
+   */
+  size_t encodeBlocks_(const char* chars, size_t length, int* codes) const;
+  size_t decodeBlocks_(const int* codes, size_t nbCodes, char* chars) const;
+
+  /**
+   * @brief Encode characters one by one with the letter table.
+   *
+   * @throw BadCharException When a character is not in the alphabet.
+   */
+  void encodeLetters_(const char* chars, size_t length, int* codes) const
+  {
+    const int* table = letters_.data();
+    for (size_t i = 0; i < length; ++i)
+    {
+      int code = table[static_cast<unsigned char>(chars[i])];
+      if (code == LETTER_UNDEF_VALUE)
+        throw BadCharException(std::string(1, chars[i]), "LetterAlphabet::encode: Unknown state", this);
+      codes[i] = code;
+    }
   }
 
 protected:
@@ -73,12 +144,12 @@ protected:
     AbstractAlphabet::registerState(st);
     if (caseSensitive_)
     {
-      letters_[static_cast<size_t>(st->getLetter()[0])] = st->getNum();
+      letters_[static_cast<unsigned char>(st->getLetter()[0])] = st->getNum();
     }
     else
     {
-      letters_[static_cast<size_t>(tolower(st->getLetter()[0]))] = st->getNum();
-      letters_[static_cast<size_t>(toupper(st->getLetter()[0]))] = st->getNum();
+      letters_[static_cast<unsigned char>(tolower(st->getLetter()[0]))] = st->getNum();
+      letters_[static_cast<unsigned char>(toupper(st->getLetter()[0]))] = st->getNum();
     }
   }
 
@@ -87,12 +158,12 @@ protected:
     AbstractAlphabet::setState(pos, st);
     if (caseSensitive_)
     {
-      letters_[static_cast<size_t>(st->getLetter()[0])] = st->getNum();
+      letters_[static_cast<unsigned char>(st->getLetter()[0])] = st->getNum();
     }
     else
     {
-      letters_[static_cast<size_t>(tolower(st->getLetter()[0]))] = st->getNum();
-      letters_[static_cast<size_t>(toupper(st->getLetter()[0]))] = st->getNum();
+      letters_[static_cast<unsigned char>(tolower(st->getLetter()[0]))] = st->getNum();
+      letters_[static_cast<unsigned char>(toupper(st->getLetter()[0]))] = st->getNum();
     }
   }
 };
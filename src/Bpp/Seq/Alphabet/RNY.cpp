@@ -289,7 +289,7 @@ vector<string> RNY::getAlias(const string& state) const
 
   for (size_t i = 0; i < size; i++)
   {
-    s[i] = AbstractAlphabet::intToChar(v[i]);
+    s[i] = string(AbstractAlphabet::decodeState(v[i]));
   }
   return s;
 }
@@ -427,103 +427,23 @@ bool RNY::isUnresolved(int state) const
 
 /****************************************************************************************/
 
-int RNY::charToInt(const string& state) const
+int RNY::encodeState(std::string_view state) const
 {
   if (state.size() != 3)
-    throw BadCharException(state, "RNY::charToInt", this);
+    throw BadCharException(string(state), "RNY::charToInt", this);
   else
-    return AbstractAlphabet::charToInt(state);
+    return AbstractAlphabet::encodeState(state);
 }
 
 
 /************************************************************/
 
-string RNY::intToChar(int state) const
+std::string_view RNY::decodeState(int state) const
 {
   // ---
 
   if (state == -1 || state == 350)
     return "---";
 
-  int i, j, k, l;
-  for (i = 0; i < 3; ++i)
-  {
-    for (j = 0; j < 4; ++j)
-    {
-      for (k = 0; k < 3; ++k)
-      {
-        l = i * 12 + j * 3 + k;
-        if (getState(l).getNum() == state)
-          return getState(l).getLetter();
-      }
-    }
-  }
-
-  // NN- (50->83)
-
-  for (i = 0; i < 3; ++i)
-  {
-    for (j = 0; j < 4; ++j)
-    {
-      l = 50 + 12 * i + j * 3;
-      if (getState(l).getNum() == state)
-        return getState(l).getLetter();
-    }
-  }
-
-  // N-N (100->126)
-
-  for (i = 0; i < 3; ++i)
-  {
-    for (k = 0; k < 3; ++k)
-    {
-      l = 100 + 12 * i + k;
-      if (getState(l).getNum() == state)
-        return getState(l).getLetter();
-    }
-  }
-
-  // N-- (150->152)
-
-  for (i = 0; i < 3; ++i)
-  {
-    l = 150 + 12 * i;
-    if (getState(l).getNum() == state)
-      return getState(l).getLetter();
-  }
-
-  // -NN (200->211)
-
-  for (j = 0; j < 4; ++j)
-  {
-    for (k = 0; k < 3; ++k)
-    {
-      l = 200 + j * 3 + k;
-      if (getState(l).getNum() == state)
-        return getState(l).getLetter();
-    }
-  }
-
-
-  // -N- (250->253)
-
-  for (j = 0; j < 4; ++j)
-  {
-    l = 250 + 3 * j;
-    if (getState(l).getNum() == state)
-      return getState(l).getLetter();
-  }
-
-  // --N (300->302)
-
-  for (k = 0; k < 3; ++k)
-  {
-    l = 300 + k;
-    if (getState(l).getNum() == state)
-      return getState(l).getLetter();
-  }
-
-
-  throw BadIntException(state, "RNY::intToChar: Specified base unknown", this);
-  return "XXX";
+  return AbstractAlphabet::decodeState(state);
 }
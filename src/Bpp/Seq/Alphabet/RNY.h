@@ -52,8 +52,8 @@ public:
   {}
 
 public:
-  int charToInt(const std::string& state) const;
-  std::string intToChar(int state) const;
+  int encodeState(std::string_view state) const;
+  std::string_view decodeState(int state) const;
 
   bool containsGap(const std::string& state) const;
 
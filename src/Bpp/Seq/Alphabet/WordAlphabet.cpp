@@ -114,10 +114,9 @@ std::string WordAlphabet::getAlphabetType() const
 
 bool WordAlphabet::hasUniqueAlphabet() const
 {
-  string s = vAbsAlph_[0]->getAlphabetType();
   for (unsigned int i = 1; i < vAbsAlph_.size(); i++)
   {
-    if (vAbsAlph_[i]->getAlphabetType() != s)
+    if (!vAbsAlph_[i]->isCompatibleWith(*vAbsAlph_[0]))
       return false;
   }
   return true;
@@ -311,7 +310,7 @@ std::string WordAlphabet::getWord(const std::vector<string>& vpos, size_t pos) c
 unique_ptr<SequenceInterface> WordAlphabet::translate(const SequenceInterface& sequence, size_t pos) const
 {
   if ((!hasUniqueAlphabet()) or
-      (sequence.getAlphabet()->getAlphabetType() != vAbsAlph_[0]->getAlphabetType()))
+      !sequence.getAlphabet()->isCompatibleWith(*vAbsAlph_[0]))
     throw AlphabetMismatchException("No matching alphabets", sequence.getAlphabet().get(), vAbsAlph_[0].get());
 
   vector<int> content;
@@ -335,7 +334,7 @@ unique_ptr<SequenceInterface> WordAlphabet::translate(const SequenceInterface& s
 unique_ptr<SequenceInterface> WordAlphabet::reverse(const SequenceInterface& sequence) const
 {
   if ((!hasUniqueAlphabet()) or
-      (sequence.getAlphabet()->getAlphabetType() != getAlphabetType()))
+      !sequence.getAlphabet()->isCompatibleWith(*this))
     throw AlphabetMismatchException("No matching alphabets", sequence.getAlphabet().get(), this);
 
   auto alphaPtr = getNAlphabet(0);
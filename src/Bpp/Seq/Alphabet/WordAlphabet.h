@@ -211,15 +211,18 @@ public:
    */
   std::string getName(const std::string& state) const override;
 
-  int charToInt(const std::string& state) const override
+  int encodeState(std::string_view state) const override
   {
+    size_t stateIndex;
+    if (findStateIndex(state, stateIndex))
+      return getIntCodeAt(stateIndex);
     if (state.size() != vAbsAlph_.size())
-      throw BadCharException(state, "WordAlphabet::charToInt", this);
-    if (containsUnresolved(state))
+      throw BadCharException(std::string(state), "WordAlphabet::charToInt", this);
+    if (containsUnresolved(std::string(state)))
       return static_cast<int>(getSize());
-    if (containsGap(state))
+    if (containsGap(std::string(state)))
       return -1;
-    else return AbstractAlphabet::charToInt(state);
+    throw BadCharException(std::string(state), "WordAlphabet::charToInt", this);
   }
 
   unsigned int getSize() const override
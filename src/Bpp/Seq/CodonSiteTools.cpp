@@ -21,6 +21,27 @@ using namespace bpp;
 
 using namespace std;
 
+namespace
+{
+/**
+ * @brief Get the frequencies of the states observed in a site, by increasing state.
+ */
+void getObservedFrequencies(const Site& site, vector<int>& states, vector<double>& freqs)
+{
+  vector<double> dense;
+  SymbolListTools::getDenseFrequencies(site, dense);
+  int offset = SymbolListTools::getDenseCountsOffset(site.alphabet());
+  for (size_t k = 0; k < dense.size(); ++k)
+  {
+    if (dense[k] != 0)
+    {
+      states.push_back(static_cast<int>(k) + offset);
+      freqs.push_back(dense[k]);
+    }
+  }
+}
+}
+
 /******************************************************************************/
 
 bool CodonSiteTools::hasGapOrStop(const Site& site, const GeneticCode& gCode)
@@ -107,16 +128,18 @@ bool CodonSiteTools::isSynonymousPolymorphic(const Site& site, const GeneticCode
     return false;
 
   // Synonymous polymorphism checking
-  map<int, size_t> counts;
-  SymbolListTools::getCounts(site, counts);
+  vector<size_t> counts;
+  SymbolListTools::getDenseCounts(site, counts);
+  int offset = SymbolListTools::getDenseCountsOffset(site.alphabet());
   map<int, size_t> aas;
   size_t cdat = 0;
-  for (auto it = counts.begin(); it != counts.end(); ++it)
+  for (size_t k = 0; k < counts.size(); ++k)
   {
-    if (!site.getAlphabet()->isUnresolved(it->first))
+    int state = static_cast<int>(k) + offset;
+    if (counts[k] != 0 && !site.getAlphabet()->isUnresolved(state))
     {
-      cdat += it->second;
-      aas[gCode.translate(it->first)]++;
+      cdat += counts[k];
+      aas[gCode.translate(state)]++;
       if (aas.size() > 1)
         return false;
     }
@@ -143,16 +166,18 @@ unique_ptr<Site> CodonSiteTools::generateCodonSiteWithoutRareVariant(const Site&
   else
   {
     // Computation
-    map<int, double> freqcodon;
-    SymbolListTools::getFrequencies(site, freqcodon);
+    vector<double> freqcodon;
+    SymbolListTools::getDenseFrequencies(site, freqcodon);
+    int offset = SymbolListTools::getDenseCountsOffset(site.alphabet());
     auto ca = dynamic_pointer_cast<const CodonAlphabet>(site.getAlphabet());
     shared_ptr<const Alphabet> na = ca->getNucleicAlphabet();
     int newcodon = -1;
-    for (map<int, double>::iterator it = freqcodon.begin(); it != freqcodon.end(); it++)
+    for (size_t k = 0; k < freqcodon.size(); ++k)
     {
-      if (it->second > freqmin && !gCode.isStop(it->first))
+      int state = static_cast<int>(k) + offset;
+      if (freqcodon[k] > freqmin && !gCode.isStop(state))
       {
-        newcodon = it->first;
+        newcodon = state;
         break;
       }
     }
@@ -164,16 +189,19 @@ unique_ptr<Site> CodonSiteTools::generateCodonSiteWithoutRareVariant(const Site&
       pos3.push_back(ca->getThirdPosition(site[i]));
     }
     Site s1(pos1, na), s2(pos2, na), s3(pos3, na);
-    map<int, double> freq1;
-    SymbolListTools::getFrequencies(s1, freq1);
-    map<int, double> freq2;
-    SymbolListTools::getFrequencies(s2, freq2);
-    map<int, double> freq3;
-    SymbolListTools::getFrequencies(s3, freq3);
+    vector<double> freq1;
+    SymbolListTools::getDenseFrequencies(s1, freq1);
+    vector<double> freq2;
+    SymbolListTools::getDenseFrequencies(s2, freq2);
+    vector<double> freq3;
+    SymbolListTools::getDenseFrequencies(s3, freq3);
+    int nucleicOffset = SymbolListTools::getDenseCountsOffset(*na);
     vector<int> codon;
     for (size_t i = 0; i < site.size(); i++)
     {
-      if (freq1[s1.getValue(i)] > freqmin && freq2[s2.getValue(i)] > freqmin && freq3[s3.getValue(i)] > freqmin)
+      if (freq1[static_cast<size_t>(s1.getValue(i) - nucleicOffset)] > freqmin
+          && freq2[static_cast<size_t>(s2.getValue(i) - nucleicOffset)] > freqmin
+          && freq3[static_cast<size_t>(s3.getValue(i) - nucleicOffset)] > freqmin)
       {
         codon.push_back(site.getValue(i));
       }
@@ -440,14 +468,15 @@ double CodonSiteTools::piSynonymous(const Site& site, const GeneticCode& gCode,
     return 0;
 
   // Computation
-  map<int, double> freq;
-  SymbolListTools::getFrequencies(site, freq);
+  vector<int> states;
+  vector<double> freqs;
+  getObservedFrequencies(site, states, freqs);
   double pi = 0;
-  for (map<int, double>::iterator it1 = freq.begin(); it1 != freq.end(); it1++)
+  for (size_t k1 = 0; k1 < states.size(); ++k1)
   {
-    for (map<int, double>::iterator it2 = freq.begin(); it2 != freq.end(); it2++)
+    for (size_t k2 = 0; k2 < states.size(); ++k2)
     {
-      pi += (it1->second) * (it2->second) * (numberOfSynonymousDifferences(it1->first, it2->first, gCode, minchange));
+      pi += freqs[k1] * freqs[k2] * (numberOfSynonymousDifferences(states[k1], states[k2], gCode, minchange));
     }
   }
   double n = static_cast<double>(site.size());
@@ -473,17 +502,18 @@ double CodonSiteTools::piNonSynonymous(const Site& site, const GeneticCode& gCod
   if (isSynonymousPolymorphic(site, gCode))
     return 0;
   // Computation
-  map<int, double> freq;
-  SymbolListTools::getFrequencies(site, freq);
+  vector<int> states;
+  vector<double> freqs;
+  getObservedFrequencies(site, states, freqs);
   auto ca = dynamic_pointer_cast<const CodonAlphabet>(site.getAlphabet());
   double pi = 0;
-  for (map<int, double>::iterator it1 = freq.begin(); it1 != freq.end(); it1++)
+  for (size_t k1 = 0; k1 < states.size(); ++k1)
   {
-    for (map<int, double>::iterator it2 = freq.begin(); it2 != freq.end(); it2++)
+    for (size_t k2 = 0; k2 < states.size(); ++k2)
     {
-      double nbtot = static_cast<double>(numberOfDifferences(it1->first, it2->first, *ca));
-      double nbsyn = numberOfSynonymousDifferences(it1->first, it2->first, gCode, minchange);
-      pi += (it1->second) * (it2->second) * (nbtot - nbsyn);
+      double nbtot = static_cast<double>(numberOfDifferences(states[k1], states[k2], *ca));
+      double nbsyn = numberOfSynonymousDifferences(states[k1], states[k2], gCode, minchange);
+      pi += freqs[k1] * freqs[k2] * (nbtot - nbsyn);
     }
   }
 
@@ -549,16 +579,17 @@ double CodonSiteTools::meanNumberOfSynonymousPositions(const Site& site, const G
   // Computation
 
   double nbSyn = 0;
-  map<int, double> freqs;
-  SymbolListTools::getFrequencies(site, freqs);
+  vector<int> states;
+  vector<double> freqs;
+  getObservedFrequencies(site, states, freqs);
   double total = 0;
-  for (const auto& it : freqs)
+  for (size_t k = 0; k < states.size(); ++k)
   {
-    int state = it.first;
+    int state = states[k];
     if (!alphabet->isUnresolved(state) &&
         !alphabet->isGap(state))
     {
-      double freq = it.second;
+      double freq = freqs[k];
       total += freq;
       nbSyn += freq * numberOfSynonymousPositions(state, gCode, ratio);
     }
@@ -632,21 +663,22 @@ size_t CodonSiteTools::numberOfNonSynonymousSubstitutions(const Site& site, cons
   if (SymbolListTools::hasGap(*newsite))
     return 0;
   // computation
-  map<int, size_t> count;
-  SymbolListTools::getCounts(*newsite, count);
+  vector<int> states;
+  vector<double> freqs;
+  getObservedFrequencies(*newsite, states, freqs);
   size_t NaSup = 0;
   size_t Nminmin = 10;
 
   auto ca = dynamic_pointer_cast<const CodonAlphabet>(site.getAlphabet());
 
-  for (map<int, size_t>::iterator it1 = count.begin(); it1 != count.end(); it1++)
+  for (int state1 : states)
   {
     size_t Nmin = 10;
-    for (map<int, size_t>::iterator it2 = count.begin(); it2 != count.end(); it2++)
+    for (int state2 : states)
     {
-      size_t Ntot = numberOfDifferences(it1->first, it2->first, *ca);
-      size_t Ns = (size_t)numberOfSynonymousDifferences(it1->first, it2->first, gCode, true);
-      if (Nmin > Ntot - Ns && it1->first != it2->first)
+      size_t Ntot = numberOfDifferences(state1, state2, *ca);
+      size_t Ns = (size_t)numberOfSynonymousDifferences(state1, state2, gCode, true);
+      if (Nmin > Ntot - Ns && state1 != state2)
         Nmin = Ntot - Ns;
     }
     NaSup += Nmin;
@@ -13,6 +13,7 @@
 #include "../Sequence.h"
 #include "../ProbabilisticSequence.h"
 #include "SiteContainer.h"
+#include "SiteCoordinateIndex.h"
 #include "VectorPositionedContainer.h"
 #include "VectorSequenceContainer.h"
 
@@ -46,6 +47,9 @@ private:
   // std::vector that contains the site coordinates
   std::vector<int> coordinates_;
 
+  // Hash index of the coordinates, used to check for duplicates
+  SiteCoordinateIndex coordinateIndex_;
+
   size_t length_;   // Number of sites for verifications before sequence's insertion in sequence container
 
 public:
@@ -63,6 +67,7 @@ public:
     TemplateVectorSequenceContainer<SequenceType>(alphabet, vs),
     VectorPositionedContainer<SiteType>(),
     coordinates_(),
+    coordinateIndex_(),
     length_(0)
   {
     if (vs.size() == 0)
@@ -90,6 +95,7 @@ public:
     TemplateVectorSequenceContainer<SequenceType>(alphabet),
     siteVector_(),
     coordinates_(),
+    coordinateIndex_(),
     length_(0)
   {
     reindexSites();
@@ -104,6 +110,7 @@ public:
     TemplateVectorSequenceContainer<SequenceType>(asc),
     siteVector_(asc.getNumberOfSites()), // Cache is not copied
     coordinates_(asc.getSiteCoordinates()),
+    coordinateIndex_(),
     length_(asc.getNumberOfSites())
   {}
 
@@ -116,6 +123,7 @@ public:
     TemplateVectorSequenceContainer<SequenceType>(sc),
     siteVector_(sc.getNumberOfSites()), // Cache is not copied
     coordinates_(sc.getSiteCoordinates()),
+    coordinateIndex_(),
     length_(sc.getNumberOfSites())
   {}
 
@@ -131,6 +139,7 @@ public:
     TemplateVectorSequenceContainer<SequenceType>(sc.getAlphabet()),
     siteVector_(),
     coordinates_(),
+    coordinateIndex_(),
     length_()
   {
     // Initializing
@@ -158,6 +167,7 @@ public:
     // Initializing
     length_      = asc.getNumberOfSites();
     coordinates_ = asc.getSiteCoordinates();
+    coordinateIndex_.invalidate();
     siteVector_.setSize(length_); // Reset the cache
     siteVector_.nullify();
 
@@ -171,6 +181,7 @@ public:
     // Initializing
     length_      = sc.getNumberOfSites();
     coordinates_ = sc.getSiteCoordinates();
+    coordinateIndex_.invalidate();
     siteVector_.setSize(length_); // Reset the cache
     siteVector_.nullify();
 
@@ -241,7 +252,7 @@ public:
     // New site's alphabet and site container's alphabet matching verification
     if (sitePosition >= getNumberOfSites())
       throw IndexOutOfBoundsException("AlignedSequenceContainer::setSite", sitePosition, 0, getNumberOfSites());
-    if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("AlignedSequenceContainer::setSite", getAlphabet(), site->getAlphabet());
 
     // Check size:
@@ -252,12 +263,12 @@ public:
     if (checkCoordinate)
     {
       int coordinate = site->getCoordinate();
-      // For all coordinates in vector: throw exception if position already exists
-      for (size_t i = 0; i < getNumberOfSites(); ++i)
-      {
-        if (i != sitePosition && coordinates_[i] == coordinate)
-          throw SiteException("AlignedSequenceContainer::setSite: Site position already exists in container", site.get());
-      }
+      // Throw exception if position already exists, the replaced site excepted
+      size_t n = getCoordinateIndex_().count(coordinate);
+      if (coordinates_[sitePosition] == coordinate)
+        n--;
+      if (n > 0)
+        throw SiteException("AlignedSequenceContainer::setSite: Site position already exists in container", site.get());
     }
 
     // For all sequences
@@ -269,7 +280,9 @@ public:
     // Reset site buffer for this position:
     siteVector_.addObject(nullptr, sitePosition);
 
+    coordinateIndex_.remove(coordinates_[sitePosition]);
     coordinates_[sitePosition] = site->getCoordinate();
+    coordinateIndex_.add(coordinates_[sitePosition]);
   }
 
 
@@ -288,6 +301,7 @@ public:
     }
 
     // Delete site's position
+    coordinateIndex_.remove(coordinates_[sitePosition]);
     coordinates_.erase(coordinates_.begin() + static_cast<ptrdiff_t>(sitePosition));
     length_--;
 
@@ -310,6 +324,7 @@ public:
     }
 
     // Delete site's position
+    coordinateIndex_.remove(coordinates_[sitePosition]);
     coordinates_.erase(coordinates_.begin() + static_cast<ptrdiff_t>(sitePosition));
     length_--;
 
@@ -330,6 +345,10 @@ public:
     }
 
     // Delete site's sitePositionition
+    for (size_t i = sitePosition; coordinateIndex_.isValid() && i < sitePosition + length; ++i)
+    {
+      coordinateIndex_.remove(coordinates_[i]);
+    }
     coordinates_.erase(coordinates_.begin() + static_cast<ptrdiff_t>(sitePosition),
         coordinates_.begin() + static_cast<ptrdiff_t>(sitePosition + length));
     length_ -= length;
@@ -342,7 +361,7 @@ public:
   void addSite(std::unique_ptr<SiteType>& site, bool checkCoordinate = true) override
   {
     // New site's alphabet and site container's alphabet matching verification
-    if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("AlignedSequenceContainer::addSite", site->getAlphabet(), getAlphabet());
 
     // Check size:
@@ -353,12 +372,9 @@ public:
     int coordinate = site->getCoordinate();
     if (checkCoordinate)
     {
-      // For all positions in vector : throw exception if position already exists
-      for (size_t i = 0; i < coordinates_.size(); ++i)
-      {
-        if (coordinates_[i] == coordinate)
-          throw SiteException("AlignedSequenceContainer::addSite: Site coordinate already exists in container", site.get());
-      }
+      // Throw exception if position already exists
+      if (getCoordinateIndex_().count(coordinate) > 0)
+        throw SiteException("AlignedSequenceContainer::addSite: Site coordinate already exists in container", site.get());
     }
 
     // For all sequences
@@ -369,6 +385,7 @@ public:
 
     length_++;
     coordinates_.push_back(coordinate);
+    coordinateIndex_.add(coordinate);
 
     // Actualizes the 'sites' vector:
     siteVector_.appendObject(nullptr);
@@ -380,7 +397,7 @@ public:
       throw IndexOutOfBoundsException("AlignedSequenceContainer::addSite", sitePosition, 0, getNumberOfSites());
 
     // New site's alphabet and site container's alphabet matching verification
-    if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("AlignedSequenceContainer::addSite", getAlphabet(), site->getAlphabet());
 
     // Check size:
@@ -391,12 +408,9 @@ public:
     int coordinate = site->getCoordinate();
     if (checkCoordinate)
     {
-      // For all positions in vector : throw exception if position already exists
-      for (size_t i = 0; i < coordinates_.size(); ++i)
-      {
-        if (coordinates_[i] == coordinate)
-          throw SiteException("AlignedSequenceContainer::addSite: Site coordinate already exists in container", site.get());
-      }
+      // Throw exception if position already exists
+      if (getCoordinateIndex_().count(coordinate) > 0)
+        throw SiteException("AlignedSequenceContainer::addSite: Site coordinate already exists in container", site.get());
     }
 
     // For all sequences
@@ -407,6 +421,7 @@ public:
 
     length_++;
     coordinates_.insert(coordinates_.begin() + static_cast<ptrdiff_t>(sitePosition), coordinate);
+    coordinateIndex_.add(coordinate);
 
     // Actualizes the 'sites' vector:
     siteVector_.insertObject(nullptr, sitePosition);
@@ -415,6 +430,8 @@ public:
   void clear() override
   {
     length_ = 0;
+    coordinates_.clear();
+    coordinateIndex_.invalidate();
     TemplateVectorSequenceContainer<SequenceType>::clear();
     siteVector_.clear();
   }
@@ -448,6 +465,7 @@ public:
     {
       coordinates_[i] = vCoordinates[i];
     }
+    coordinateIndex_.invalidate();
   }
 
 
@@ -458,6 +476,7 @@ public:
     {
       coordinates_[i] = static_cast<int>(i + 1); // starts with 1.
     }
+    coordinateIndex_.invalidate();
   }
 
   /** @} */
@@ -581,6 +600,16 @@ protected:
   {
     return sequenceRef.size() == length_;
   }
+
+  /**
+   * @return The coordinate index, built first if needed.
+   */
+  const SiteCoordinateIndex& getCoordinateIndex_()
+  {
+    if (!coordinateIndex_.isValid())
+      coordinateIndex_.build(coordinates_);
+    return coordinateIndex_;
+  }
 };
 
 // Aliases:
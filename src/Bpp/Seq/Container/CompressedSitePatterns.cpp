@@ -0,0 +1,272 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+#include "../SiteTools.h"
+#include "CompressedSitePatterns.h"
+#include "CompressedVectorSiteContainer.h"
+
+// From the STL:
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+namespace
+{
+/**
+ * @brief Run a worker function on nbThreads threads, including the current one.
+ */
+template<class Worker>
+void runThreads(Worker& worker, unsigned int nbThreads)
+{
+  vector<thread> threads;
+  for (unsigned int k = 1; k < nbThreads; ++k)
+  {
+    threads.push_back(thread(std::ref(worker)));
+  }
+  worker();
+  for (auto& th : threads)
+  {
+    th.join();
+  }
+}
+
+/**
+ * @brief Find the unique sites of a container.
+ *
+ * @param sites The container.
+ * @param indices [out] The index of the pattern of each site.
+ * @param nbThreads The number of threads to use.
+ * @return The first site of each pattern.
+ */
+template<class SiteType, class SequenceType>
+vector<const SiteType*> findPatterns(
+    const TemplateSiteContainerInterface<SiteType, SequenceType, string>& sites,
+    vector<size_t>& indices,
+    unsigned int nbThreads)
+{
+  // Sites are retrieved first, as containers may build them on the fly:
+  size_t n = sites.getNumberOfSites();
+  vector<const SiteType*> allSites(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    allSites[i] = &sites.site(i);
+  }
+
+  // Sites are hashed and compared by blocks in parallel. For each site, we
+  // keep the first identical site in its block:
+  vector<size_t> hashes(n), firstInBlock(n);
+  size_t nbBlocks = min(static_cast<size_t>(nbThreads), max<size_t>(n, 1));
+  atomic<size_t> next(0);
+  auto worker = [&]()
+  {
+    size_t b;
+    while ((b = next++) < nbBlocks)
+    {
+      unordered_multimap<size_t, size_t> seen;
+      for (size_t i = b * n / nbBlocks; i < (b + 1) * n / nbBlocks; ++i)
+      {
+        size_t hash = SiteTools::getContentHash(*allSites[i]);
+        hashes[i] = hash;
+        firstInBlock[i] = i;
+        auto range = seen.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+          if (allSites[it->second]->getContent() == allSites[i]->getContent())
+          {
+            firstInBlock[i] = it->second;
+            break;
+          }
+        }
+        if (firstInBlock[i] == i)
+          seen.emplace(hash, i);
+      }
+    }
+  };
+  runThreads(worker, static_cast<unsigned int>(nbBlocks));
+
+  // Blocks are merged in site order, so that patterns are numbered by first occurrence:
+  vector<const SiteType*> patterns;
+  unordered_multimap<size_t, size_t> patternsByHash;
+  indices.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (firstInBlock[i] != i)
+    {
+      indices[i] = indices[firstInBlock[i]];
+      continue;
+    }
+    size_t p = patterns.size();
+    auto range = patternsByHash.equal_range(hashes[i]);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (patterns[it->second]->getContent() == allSites[i]->getContent())
+      {
+        p = it->second;
+        break;
+      }
+    }
+    if (p == patterns.size())
+    {
+      patterns.push_back(allSites[i]);
+      patternsByHash.emplace(hashes[i], p);
+    }
+    indices[i] = p;
+  }
+  return patterns;
+}
+
+unsigned int getNumberOfThreads(unsigned int nbThreads, size_t nbTasks)
+{
+  if (nbThreads == 0)
+    nbThreads = max(thread::hardware_concurrency(), 1u);
+  return static_cast<unsigned int>(min(static_cast<size_t>(nbThreads), max<size_t>(nbTasks, 1)));
+}
+} // end of anonymous namespace.
+
+/******************************************************************************/
+
+CompressedSitePatterns::CompressedSitePatterns(const SiteContainerInterface& sites, unsigned int nbThreads) :
+  alphabet_(sites.getAlphabet()),
+  sequenceNames_(sites.getSequenceNames()),
+  nbStates_(1),
+  probabilistic_(false),
+  states_(),
+  probabilities_(),
+  weights_(),
+  indices_(),
+  siteOffsets_(),
+  sites_()
+{
+  size_t n = sites.getNumberOfSites();
+  nbThreads = getNumberOfThreads(nbThreads, n);
+  vector<const Site*> patterns;
+  auto compressed = dynamic_cast<const CompressedVectorSiteContainer*>(&sites);
+  if (compressed)
+  {
+    // Unique sites are already known, they only need to be renumbered:
+    vector<size_t> renumbering(compressed->getNumberOfUniqueSites(), n);
+    indices_.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+      size_t& p = renumbering[compressed->getUniqueSiteIndex(i)];
+      if (p == n)
+      {
+        p = patterns.size();
+        patterns.push_back(&compressed->site(i));
+      }
+      indices_[i] = p;
+    }
+  }
+  else
+  {
+    patterns = findPatterns(sites, indices_, nbThreads);
+  }
+
+  size_t nbSequences = getNumberOfSequences();
+  states_.resize(patterns.size() * nbSequences);
+  atomic<size_t> next(0);
+  auto worker = [&]()
+  {
+    size_t p;
+    while ((p = next++) < patterns.size())
+    {
+      const vector<int>& content = patterns[p]->getContent();
+      copy(content.begin(), content.end(), states_.begin() + static_cast<ptrdiff_t>(p * nbSequences));
+    }
+  };
+  runThreads(worker, nbThreads);
+
+  computeSiteLists_();
+}
+
+/******************************************************************************/
+
+CompressedSitePatterns::CompressedSitePatterns(const ProbabilisticSiteContainerInterface& sites, unsigned int nbThreads) :
+  alphabet_(sites.getAlphabet()),
+  sequenceNames_(sites.getSequenceNames()),
+  nbStates_(0),
+  probabilistic_(true),
+  states_(),
+  probabilities_(),
+  weights_(),
+  indices_(),
+  siteOffsets_(),
+  sites_()
+{
+  size_t n = sites.getNumberOfSites();
+  nbThreads = getNumberOfThreads(nbThreads, n);
+  vector<const ProbabilisticSite*> patterns = findPatterns(sites, indices_, nbThreads);
+
+  size_t nbSequences = getNumberOfSequences();
+  if (!patterns.empty() && nbSequences > 0)
+    nbStates_ = (*patterns[0])[0].size();
+  for (size_t p = 0; p < patterns.size(); ++p)
+  {
+    for (size_t i = 0; i < nbSequences; ++i)
+    {
+      if ((*patterns[p])[i].size() != nbStates_)
+        throw Exception("CompressedSitePatterns: sites do not have the same number of states, found " + TextTools::toString((*patterns[p])[i].size()) + " instead of " + TextTools::toString(nbStates_) + ".");
+    }
+  }
+
+  probabilities_.resize(patterns.size() * nbSequences * nbStates_);
+  atomic<size_t> next(0);
+  auto worker = [&]()
+  {
+    size_t p;
+    while ((p = next++) < patterns.size())
+    {
+      auto out = probabilities_.begin() + static_cast<ptrdiff_t>(p * nbSequences * nbStates_);
+      for (size_t i = 0; i < nbSequences; ++i)
+      {
+        const vector<double>& values = (*patterns[p])[i];
+        out = copy(values.begin(), values.end(), out);
+      }
+    }
+  };
+  runThreads(worker, nbThreads);
+
+  computeSiteLists_();
+}
+
+/******************************************************************************/
+
+void CompressedSitePatterns::computeSiteLists_()
+{
+  size_t nbPatterns = 0;
+  for (size_t p : indices_)
+  {
+    nbPatterns = max(nbPatterns, p + 1);
+  }
+
+  // Counting sort of the sites according to their pattern:
+  siteOffsets_.assign(nbPatterns + 1, 0);
+  for (size_t p : indices_)
+  {
+    siteOffsets_[p + 1]++;
+  }
+  weights_.resize(nbPatterns);
+  for (size_t p = 0; p < nbPatterns; ++p)
+  {
+    weights_[p] = static_cast<double>(siteOffsets_[p + 1]);
+    siteOffsets_[p + 1] += siteOffsets_[p];
+  }
+  sites_.resize(indices_.size());
+  vector<size_t> positions(siteOffsets_.begin(), siteOffsets_.end() - 1);
+  for (size_t i = 0; i < indices_.size(); ++i)
+  {
+    sites_[positions[indices_[i]]++] = i;
+  }
+}
+
+/******************************************************************************/
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_CONTAINER_COMPRESSEDSITEPATTERNS_H
+#define BPP_SEQ_CONTAINER_COMPRESSEDSITEPATTERNS_H
+
+#include "../Alphabet/Alphabet.h"
+#include "SiteContainer.h"
+
+// From the STL:
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief The unique site patterns of an alignment, with their weights.
+ *
+ * This class computes in one shot all what is needed to compute likelihoods
+ * on the distinct columns of an alignment only:
+ * - the pattern matrix, stored contiguously pattern after pattern,
+ * - the weight of each pattern, that is the number of sites sharing it,
+ * - the index of the pattern of each site,
+ * - the list of the sites of each pattern, in compressed sparse row format:
+ *   the sites of pattern \f$p\f$ are `getSites()[k]` for \f$k\f$ in
+ *   [`getSiteOffsets()[p]`, `getSiteOffsets()[p + 1]`[, in increasing order.
+ *
+ * Patterns are numbered in the order of their first occurrence in the alignment.
+ *
+ * For sites made of states, the pattern matrix has one integer state per
+ * sequence and pattern (see getStates()). For probabilistic sites, it has
+ * one value per state, sequence and pattern (see getProbabilities()).
+ *
+ * Site hashing and the filling of the pattern matrix are done in parallel,
+ * and patterns found in each block of sites are then merged in site order.
+ * If the container is a CompressedVectorSiteContainer, its own index of
+ * unique sites is used instead.
+ */
+class CompressedSitePatterns
+{
+private:
+  std::shared_ptr<const Alphabet> alphabet_;
+  std::vector<std::string> sequenceNames_;
+  size_t nbStates_;
+  bool probabilistic_;
+  std::vector<int> states_;
+  std::vector<double> probabilities_;
+  std::vector<double> weights_;
+  std::vector<size_t> indices_;
+  std::vector<size_t> siteOffsets_;
+  std::vector<size_t> sites_;
+
+public:
+  /**
+   * @brief Compute the patterns of a site container.
+   *
+   * @param sites The container to compress.
+   * @param nbThreads The number of threads to use, 0 for the number of hardware threads.
+   */
+  CompressedSitePatterns(const SiteContainerInterface& sites, unsigned int nbThreads = 0);
+
+  /**
+   * @brief Compute the patterns of a probabilistic site container.
+   *
+   * Two sites are considered as identical if all their values are equal.
+   *
+   * @param sites The container to compress.
+   * @param nbThreads The number of threads to use, 0 for the number of hardware threads.
+   * @throw Exception If the sites do not have the same number of states for all sequences.
+   */
+  CompressedSitePatterns(const ProbabilisticSiteContainerInterface& sites, unsigned int nbThreads = 0);
+
+public:
+  std::shared_ptr<const Alphabet> getAlphabet() const { return alphabet_; }
+
+  const std::vector<std::string>& getSequenceNames() const { return sequenceNames_; }
+
+  size_t getNumberOfSequences() const { return sequenceNames_.size(); }
+
+  size_t getNumberOfSites() const { return indices_.size(); }
+
+  size_t getNumberOfPatterns() const { return weights_.size(); }
+
+  /**
+   * @return True if the patterns were computed from probabilistic sites.
+   */
+  bool isProbabilistic() const { return probabilistic_; }
+
+  /**
+   * @return The number of values per sequence in probabilistic patterns, 1 otherwise.
+   */
+  size_t getNumberOfStates() const { return nbStates_; }
+
+  /**
+   * @return The states of all patterns: the state of sequence \f$i\f$ in
+   * pattern \f$p\f$ is at position \f$p \times n + i\f$, where \f$n\f$ is the
+   * number of sequences. Empty for probabilistic patterns.
+   */
+  const std::vector<int>& getStates() const { return states_; }
+
+  /**
+   * @return A pointer to the states of pattern p, one per sequence.
+   */
+  const int* getPatternStates(size_t p) const
+  {
+    return states_.data() + p * getNumberOfSequences();
+  }
+
+  /**
+   * @return The values of all probabilistic patterns: the value of state
+   * \f$s\f$ for sequence \f$i\f$ in pattern \f$p\f$ is at position
+   * \f$(p \times n + i) \times k + s\f$, where \f$n\f$ is the number of
+   * sequences and \f$k\f$ the number of states. Empty for patterns of states.
+   */
+  const std::vector<double>& getProbabilities() const { return probabilities_; }
+
+  /**
+   * @return A pointer to the values of pattern p, sequence after sequence.
+   */
+  const double* getPatternProbabilities(size_t p) const
+  {
+    return probabilities_.data() + p * getNumberOfSequences() * nbStates_;
+  }
+
+  /**
+   * @return The weight of each pattern, that is the number of sites sharing it.
+   */
+  const std::vector<double>& getWeights() const { return weights_; }
+
+  /**
+   * @return For each site, the index of its pattern.
+   */
+  const std::vector<size_t>& getIndices() const { return indices_; }
+
+  /**
+   * @return The offsets of the sites of each pattern in getSites(), plus the total number of sites.
+   */
+  const std::vector<size_t>& getSiteOffsets() const { return siteOffsets_; }
+
+  /**
+   * @return The positions of the sites, grouped by pattern.
+   */
+  const std::vector<size_t>& getSites() const { return sites_; }
+
+private:
+  /**
+   * @brief Fill the weights and the lists of sites of each pattern from the indices.
+   */
+  void computeSiteLists_();
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_CONTAINER_COMPRESSEDSITEPATTERNS_H
@@ -5,6 +5,7 @@
 #include <Bpp/Text/TextTools.h>
 #include <iostream>
 
+#include "../SiteTools.h"
 #include "CompressedVectorSiteContainer.h"
 
 using namespace std;
@@ -21,7 +22,10 @@ CompressedVectorSiteContainer::CompressedVectorSiteContainer(
   sequenceContainer_(),
   sequenceNames_(),
   sequenceComments_(),
-  index_(0)
+  index_(0),
+  counts_(),
+  hashes_(),
+  patterns_()
 {
   if (vs.size() == 0)
     throw Exception("CompressedVectorSiteContainer::CompressedVectorSiteContainer. Empty site set.");
@@ -50,7 +54,10 @@ CompressedVectorSiteContainer::CompressedVectorSiteContainer(
   sequenceContainer_(),
   sequenceNames_(),
   sequenceComments_(),
-  index_(0)
+  index_(0),
+  counts_(),
+  hashes_(),
+  patterns_()
 {
   // Seq names and comments:
   for (size_t i = 0; i < size; ++i)
@@ -70,7 +77,10 @@ CompressedVectorSiteContainer::CompressedVectorSiteContainer(
   sequenceContainer_(),
   sequenceNames_(),
   sequenceComments_(),
-  index_(0)
+  index_(0),
+  counts_(),
+  hashes_(),
+  patterns_()
 {
   unsigned int i = 0;
   for (auto key : sequenceKeys)
@@ -89,7 +99,10 @@ CompressedVectorSiteContainer::CompressedVectorSiteContainer(std::shared_ptr<con
   sequenceContainer_(),
   sequenceNames_(),
   sequenceComments_(),
-  index_(0)
+  index_(0),
+  counts_(),
+  hashes_(),
+  patterns_()
 {}
 
 /******************************************************************************/
@@ -100,7 +113,10 @@ CompressedVectorSiteContainer::CompressedVectorSiteContainer(const CompressedVec
   sequenceContainer_(),
   sequenceNames_(vsc.sequenceNames_),
   sequenceComments_(vsc.sequenceComments_),
-  index_(vsc.index_)
+  index_(vsc.index_),
+  counts_(vsc.counts_),
+  hashes_(vsc.hashes_),
+  patterns_(vsc.patterns_)
 {
   for (const auto& name: vsc.sequenceNames_)
   {
@@ -110,7 +126,7 @@ CompressedVectorSiteContainer::CompressedVectorSiteContainer(const CompressedVec
   // Copy the compressed data:
   for (size_t i = 0; i < vsc.siteContainer_.getSize(); ++i)
   {
-    auto sitePtr = std::shared_ptr<Site>(vsc.siteContainer_.getObject(i)->clone());
+    auto sitePtr = std::shared_ptr<Site>(vsc.siteContainer_.getObject(i)->clone(), SwitchDeleter<Site>());
     siteContainer_.appendObject(sitePtr);
   }
 }
@@ -123,7 +139,10 @@ CompressedVectorSiteContainer::CompressedVectorSiteContainer(const SiteContainer
   sequenceContainer_(),
   sequenceNames_(sc.getSequenceNames()),
   sequenceComments_(sc.getSequenceComments()),
-  index_(0)
+  index_(0),
+  counts_(),
+  hashes_(),
+  patterns_()
 {
   for (const auto& name: sc.getSequenceNames())
   {
@@ -152,9 +171,12 @@ CompressedVectorSiteContainer& CompressedVectorSiteContainer::operator=(const Co
 
   // Copy the compressed data:
   index_ = vsc.index_;
+  counts_ = vsc.counts_;
+  hashes_ = vsc.hashes_;
+  patterns_ = vsc.patterns_;
   for (size_t i = 0; i < vsc.siteContainer_.getSize(); ++i)
   {
-    auto sitePtr = std::shared_ptr<Site>(vsc.siteContainer_.getObject(i)->clone());
+    auto sitePtr = std::shared_ptr<Site>(vsc.siteContainer_.getObject(i)->clone(), SwitchDeleter<Site>());
     siteContainer_.appendObject(sitePtr);
   }
 
@@ -196,11 +218,12 @@ void CompressedVectorSiteContainer::setSite(size_t sitePosition, unique_ptr<Site
     throw SiteException("AlignedSequenceContainer::setSite. Site does not have the appropriate length", site.get());
 
   // New site's alphabet and site container's alphabet matching verification
-  if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+  if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
     throw AlphabetMismatchException("CompressedVectorSiteContainer::setSite", getAlphabet(), site->getAlphabet());
 
   size_t current = index_[sitePosition];
-  size_t siteIndex = getSiteIndex_(*site);
+  size_t hash = SiteTools::getContentHash(*site);
+  size_t siteIndex = getSiteIndex_(*site, hash);
   if (siteIndex == current)
   {
     // Nothing to do here, this is the same site.
@@ -209,58 +232,40 @@ void CompressedVectorSiteContainer::setSite(size_t sitePosition, unique_ptr<Site
   {
     // The new site is already in the list, si we just update the index:
     index_[sitePosition] = siteIndex;
+    counts_[siteIndex]++;
 
-    // We have to check if the previous pattern was unique, and if so, remove it and update indices:
-    bool test = true;
-    for (size_t i = 0; test && i < index_.size(); ++i)
-    {
-      if (index_[i] == current)
-      {
-        // There is another site, so nothing to do...
-        test = false;
-      }
-    }
-    if (test)
+    // If the previous pattern was unique, we remove it and update indices:
+    if (--counts_[current] == 0)
+      removeUnusedUniqueSites_();
+  }
+  else if (counts_[current] == 1)
+  {
+    // This is a new pattern, and the previous pattern was unique: we replace it.
+    auto range = patterns_.equal_range(hashes_[current]);
+    for (auto it = range.first; it != range.second; ++it)
     {
-      // There was no other site pointing toward this pattern, so we remove it.
-      siteContainer_.deleteObject(current);
-      // Now we have to correct all indices:
-      for (size_t i = 0; i < index_.size(); ++i)
+      if (it->second == current)
       {
-        if (index_[i] > current)
-          index_[i]--;
+        patterns_.erase(it);
+        break;
       }
     }
+    std::shared_ptr<Site> sitePtr(site.release(), SwitchDeleter<Site>());
+    siteContainer_.addObject(sitePtr, current, false);
+    hashes_[current] = hash;
+    patterns_.insert(make_pair(hash, current));
   }
   else
   {
-    // This is a new pattern, and we have to add it to the list.
-    // Now we have to check if the previous pattern was unique, and if so,
-    // replace it with the new one. Otherwise, add the new site at the end of the list.
-    bool test = true;
-    for (size_t i = 0; test && i < index_.size(); ++i)
-    {
-      if (i != sitePosition && index_[i] == current)
-      {
-        // There is another site
-        test = false;
-      }
-    }
-    if (test)
-    {
-      // we relace the site
-      siteContainer_.addObject(std::move(site), current, false);
-    }
-    else
-    {
-      // We add the site at the end:
-      siteContainer_.appendObject(std::move(site));
-      index_[sitePosition] = siteIndex;
-    }
+    // This is a new pattern, we add the site at the end:
+    counts_[current]--;
+    siteIndex = appendUniqueSite_(site, hash);
+    counts_[siteIndex]++;
+    index_[sitePosition] = siteIndex;
   }
 
   // Clean Sequence Container cache
-  sequenceContainer_.clear();
+  sequenceContainer_.nullify();
 }
 
 /******************************************************************************/
@@ -269,61 +274,58 @@ std::unique_ptr<Site> CompressedVectorSiteContainer::removeSite(size_t siteIndex
 {
   if (siteIndex >= getNumberOfSites())
     throw IndexOutOfBoundsException("CompressedVectorSiteContainer::removeSite.", siteIndex, 0, getNumberOfSites() - 1);
-  // Here we need to check whether the pattern corresponding to this site is unique:
-
-  auto sitePtr = siteContainer_.getObject(index_[siteIndex]);
-  std::get_deleter<SwitchDeleter<Site>>(sitePtr)->off();
 
   size_t current = index_[siteIndex];
-  bool test = true;
-  for (size_t j = 0; test && j < index_.size(); ++j)
+  index_.erase(index_.begin() + static_cast<ptrdiff_t>(siteIndex));
+  std::unique_ptr<Site> site;
+  if (--counts_[current] == 0)
   {
-    if (j != siteIndex && index_[j] == current)
-    {
-      // There is another site, so nothing to erase
-      test = false;
-    }
+    // There was no other site pointing toward this pattern, so we remove it and return it.
+    auto sitePtr = siteContainer_.getObject(current);
+    std::get_deleter<SwitchDeleter<Site>>(sitePtr)->off();
+    site.reset(sitePtr.get());
+    removeUnusedUniqueSites_();
   }
-  if (test)
+  else
   {
-    // There was no other site pointing toward this pattern, so we remove it.
-    siteContainer_.removeObject(index_[siteIndex]);
-
-    // Now we have to correct all indices:
-    for (size_t j = 0; j < index_.size(); ++j)
-    {
-      if (index_[j] > current)
-        index_[j]--;
-    }
+    // The pattern is still used, we return a copy.
+    site.reset(siteContainer_.getObject(current)->clone());
   }
-  index_.erase(index_.begin() + static_cast<ptrdiff_t>(siteIndex));
 
   // Clean Sequence Container cache
-  sequenceContainer_.clear();
+  sequenceContainer_.nullify();
 
-  return std::unique_ptr<Site>(sitePtr.get());
+  return site;
 }
 
 /******************************************************************************/
 
 void CompressedVectorSiteContainer::deleteSite(size_t siteIndex)
 {
-  if (siteIndex >= getNumberOfSites())
-    throw IndexOutOfBoundsException("CompressedVectorSiteContainer::deleteSite.", siteIndex, 0, getNumberOfSites() - 1);
-  // Here we need to check whether the pattern corresponding to this site is unique:
-
-  removeSite(siteIndex); // This effectively delete the object as the unique_ptr is not forwarded and will be destroyed.
+  deleteSites(siteIndex, 1);
 }
 
 /******************************************************************************/
 
 void CompressedVectorSiteContainer::deleteSites(size_t siteIndex, size_t length)
 {
-  // This may be optimized later:
-  for (size_t i = 0; i < length; ++i)
+  if (siteIndex + length > getNumberOfSites())
+    throw IndexOutOfBoundsException("CompressedVectorSiteContainer::deleteSites.", siteIndex + length, 0, getNumberOfSites());
+
+  bool unused = false;
+  for (size_t i = siteIndex; i < siteIndex + length; ++i)
   {
-    deleteSite(siteIndex + i);
+    if (--counts_[index_[i]] == 0)
+      unused = true;
   }
+  index_.erase(index_.begin() + static_cast<ptrdiff_t>(siteIndex), index_.begin() + static_cast<ptrdiff_t>(siteIndex + length));
+
+  // Unused patterns are removed all at once:
+  if (unused)
+    removeUnusedUniqueSites_();
+
+  // Clean Sequence Container cache
+  sequenceContainer_.nullify();
 }
 
 /***************************************************************************/
@@ -335,20 +337,21 @@ void CompressedVectorSiteContainer::addSite(std::unique_ptr<Site>& site, bool ch
     throw SiteException("CompressedVectorSiteContainer::addSite. Site does not have the appropriate length", site.get());
 
   // New site's alphabet and site container's alphabet matching verification
-  if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+  if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
   {
     throw AlphabetMismatchException("CompressedVectorSiteContainer::addSite", getAlphabet(), site->getAlphabet());
   }
 
   size_t n = site->size();
 
-  size_t siteIndex = getSiteIndex_(*site);
+  size_t hash = SiteTools::getContentHash(*site);
+  size_t siteIndex = getSiteIndex_(*site, hash);
   if (siteIndex == getNumberOfUniqueSites())
   {
     // This is a new pattern:
-    std::shared_ptr<Site> sitePtr(site.release(), SwitchDeleter<Site>());
-    siteContainer_.appendObject(sitePtr);
+    appendUniqueSite_(site, hash);
   }
+  counts_[siteIndex]++;
 
   index_.push_back(siteIndex);
 
@@ -381,20 +384,21 @@ void CompressedVectorSiteContainer::addSite(std::unique_ptr<Site>& site, size_t
     throw SiteException("CompressedVectorSiteContainer::addSite. Site does not have the appropriate length", site.get());
 
   // New site's alphabet and site container's alphabet matching verification
-  if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+  if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
   {
     throw AlphabetMismatchException("CompressedVectorSiteContainer::addSite", getAlphabet(), site->getAlphabet());
   }
 
   size_t n = site->size();
 
-  size_t index = getSiteIndex_(*site);
+  size_t hash = SiteTools::getContentHash(*site);
+  size_t index = getSiteIndex_(*site, hash);
   if (index == getNumberOfUniqueSites())
   {
     // This is a new pattern:
-    std::shared_ptr<Site> sitePtr(site.release(), SwitchDeleter<Site>());
-    siteContainer_.appendObject(sitePtr);
+    appendUniqueSite_(site, hash);
   }
+  counts_[index]++;
 
   index_.insert(index_.begin() + static_cast<ptrdiff_t>(siteIndex), index);
 
@@ -485,28 +489,67 @@ const Sequence& CompressedVectorSiteContainer::sequence(size_t sequencePosition)
 
 /******************************************************************************/
 
-size_t CompressedVectorSiteContainer::getSiteIndex_(const Site& site)
+size_t CompressedVectorSiteContainer::getSiteIndex_(const Site& site, size_t hash) const
 {
-  size_t pos = getNumberOfUniqueSites();
-  bool test;
-  for (size_t i = 0; i < getNumberOfUniqueSites(); ++i)
+  // Sites with the same hash are compared, in case of collision:
+  auto range = patterns_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it)
   {
-    test = true;
-    const Site& siteI = *siteContainer_.getObject(i);
+    if (siteContainer_.getObject(it->second)->getContent() == site.getContent())
+      return it->second;
+  }
+  return getNumberOfUniqueSites();
+}
 
-    for (size_t j = 0; test && j < site.size(); ++j) // site is supposed to have the correct size, that is the same as all the ones in the container.
-    {
-      if (site[j] != siteI[j])
-        test = false;
-    }
+/******************************************************************************/
+
+size_t CompressedVectorSiteContainer::appendUniqueSite_(std::unique_ptr<Site>& site, size_t hash)
+{
+  size_t pos = getNumberOfUniqueSites();
+  std::shared_ptr<Site> sitePtr(site.release(), SwitchDeleter<Site>());
+  siteContainer_.appendObject(sitePtr);
+  counts_.push_back(0);
+  hashes_.push_back(hash);
+  patterns_.insert(make_pair(hash, pos));
+  return pos;
+}
 
-    if (test)
+/******************************************************************************/
+
+void CompressedVectorSiteContainer::removeUnusedUniqueSites_()
+{
+  size_t n = getNumberOfUniqueSites();
+  vector<size_t> newPositions(n);
+  size_t k = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    newPositions[i] = k;
+    if (counts_[i] > 0)
     {
-      pos = i;
-      break;
+      if (k != i)
+      {
+        siteContainer_.addObject(siteContainer_.getObject(i), k, false);
+        counts_[k] = counts_[i];
+        hashes_[k] = hashes_[i];
+      }
+      ++k;
     }
   }
-  return pos;
+  if (k == n)
+    return;
+  siteContainer_.deleteObjects(k, n - k);
+  counts_.resize(k);
+  hashes_.resize(k);
+
+  patterns_.clear();
+  for (size_t i = 0; i < k; ++i)
+  {
+    patterns_.insert(make_pair(hashes_[i], i));
+  }
+  for (auto& i : index_)
+  {
+    i = newPositions[i];
+  }
 }
 
 /******************************************************************************/
@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <unordered_map>
 
 namespace bpp
 {
@@ -27,6 +28,9 @@ namespace bpp
  * containers where the number of sites is large compared to the number of sequences.
  * site access is as fast as in the standard VectorSiteContainer class, but site
  * addition takes more time, as the new site must be first compared to the existing set.
+ * Unique sites are indexed in a hash table on their content, so that this comparison
+ * takes a constant time on average, and the number of sites sharing each unique site
+ * is recorded, so that unused unique sites are detected without scanning the container.
  * A major restriction of this container is that you can't add or remove sequences.
  * The number of sequences is fixed after the first site has been added.
  *
@@ -48,6 +52,9 @@ protected:
   std::vector<std::string> sequenceNames_;
   std::vector<Comments> sequenceComments_;
   std::vector<size_t> index_;   // For all sites, give the actual position in the set.
+  std::vector<size_t> counts_;  // For all unique sites, the number of sites pointing to it.
+  std::vector<size_t> hashes_;  // For all unique sites, the hash of their content.
+  std::unordered_multimap<size_t, size_t> patterns_; // Positions of the unique sites for each hash.
 
 public:
   /**
@@ -156,6 +163,16 @@ public:
     return siteContainer_.getSize();
   }
 
+  /**
+   * @return The position of the unique site instance of a given site.
+   *
+   * @param sitePosition The position of the site in the alignment.
+   */
+  size_t getUniqueSiteIndex(size_t sitePosition) const
+  {
+    return index_[sitePosition];
+  }
+
 
   // These methods are implemented for this class:
 
@@ -258,6 +275,9 @@ public:
     sequenceNames_.clear();
     sequenceComments_.clear();
     index_.clear();
+    counts_.clear();
+    hashes_.clear();
+    patterns_.clear();
   }
 
   CompressedVectorSiteContainer* createEmptyContainer() const override
@@ -365,8 +385,25 @@ protected:
   /**
    * @return The position of the site in the compressed set. If the site is not found,
    * this will return the number of sites in the compressed set.
+   *
+   * @param site The site to look for.
+   * @param hash The hash of the site content, see SiteTools::getContentHash.
+   */
+  size_t getSiteIndex_(const Site& site, size_t hash) const;
+
+  /**
+   * @brief Append a new unique site, used by no site yet.
+   *
+   * @param site The new unique site. The container takes its ownership.
+   * @param hash The hash of the site content.
+   * @return The position of the new unique site.
+   */
+  size_t appendUniqueSite_(std::unique_ptr<Site>& site, size_t hash);
+
+  /**
+   * @brief Remove all unique sites which are not used anymore, and update the indices.
    */
-  size_t getSiteIndex_(const Site& site);
+  void removeUnusedUniqueSites_();
 };
 } // end of namespace bpp.
 #endif // BPP_SEQ_CONTAINER_COMPRESSEDVECTORSITECONTAINER_H
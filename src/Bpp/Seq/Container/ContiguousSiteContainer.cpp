@@ -0,0 +1,586 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include <Bpp/Text/TextTools.h>
+
+#include "../StringSequenceTools.h"
+#include "ContiguousSiteContainer.h"
+
+using namespace std;
+
+using namespace bpp;
+
+// Size of the blocks used when transposing the matrix:
+static const size_t TRANSPOSE_BLOCK_SIZE = 64;
+
+/** Views: ********************************************************************/
+
+Site* ContiguousSiteContainer::SiteView::clone() const
+{
+  vector<int> content(size());
+  for (size_t i = 0; i < content.size(); ++i)
+  {
+    content[i] = (*this)[i];
+  }
+  return new Site(content, getAlphabet(), getCoordinate());
+}
+
+/******************************************************************************/
+
+string ContiguousSiteContainer::SiteView::toString() const
+{
+  vector<int> content(size());
+  for (size_t i = 0; i < content.size(); ++i)
+  {
+    content[i] = (*this)[i];
+  }
+  auto alphaPtr = getAlphabet();
+  return StringSequenceTools::decodeSequence(content, alphaPtr);
+}
+
+/******************************************************************************/
+
+Sequence* ContiguousSiteContainer::SequenceView::clone() const
+{
+  vector<int> content(size());
+  for (size_t i = 0; i < content.size(); ++i)
+  {
+    content[i] = (*this)[i];
+  }
+  auto alphaPtr = getAlphabet();
+  return new Sequence(getName(), content, getComments(), alphaPtr);
+}
+
+/******************************************************************************/
+
+string ContiguousSiteContainer::SequenceView::toString() const
+{
+  vector<int> content(size());
+  for (size_t i = 0; i < content.size(); ++i)
+  {
+    content[i] = (*this)[i];
+  }
+  auto alphaPtr = getAlphabet();
+  return StringSequenceTools::decodeSequence(content, alphaPtr);
+}
+
+/** Class constructors: *******************************************************/
+
+ContiguousSiteContainer::ContiguousSiteContainer(std::shared_ptr<const Alphabet> alphabet, Layout layout) :
+  SimpleCommentable(),
+  alphabet_(alphabet),
+  layout_(layout),
+  nbSequences_(0),
+  nbSites_(0),
+  sequenceStride_(0),
+  siteStride_(0),
+  data_(),
+  coordinates_(),
+  coordinateIndex_(),
+  sequenceKeys_(),
+  sequenceIndex_(),
+  sequenceViews_(),
+  siteViews_()
+{
+  updateStrides_();
+}
+
+/******************************************************************************/
+
+ContiguousSiteContainer::ContiguousSiteContainer(const SiteContainerInterface& sc, Layout layout) :
+  SimpleCommentable(sc.getComments()),
+  alphabet_(sc.getAlphabet()),
+  layout_(layout),
+  nbSequences_(sc.getNumberOfSequences()),
+  nbSites_(sc.getNumberOfSites()),
+  sequenceStride_(0),
+  siteStride_(0),
+  data_(sc.getNumberOfSequences() * sc.getNumberOfSites()),
+  coordinates_(sc.getNumberOfSites()),
+  coordinateIndex_(),
+  sequenceKeys_(sc.getSequenceKeys()),
+  sequenceIndex_(),
+  sequenceViews_(),
+  siteViews_()
+{
+  updateStrides_();
+  for (size_t j = 0; j < nbSites_; ++j)
+  {
+    const Site& site = sc.site(j);
+    coordinates_[j] = site.getCoordinate();
+    for (size_t i = 0; i < nbSequences_; ++i)
+    {
+      valueAt(i, j) = site[i];
+    }
+  }
+
+  vector<string> names = sc.getSequenceNames();
+  vector<Comments> comments = sc.getSequenceComments();
+  for (size_t i = 0; i < nbSequences_; ++i)
+  {
+    sequenceIndex_[sequenceKeys_[i]] = i;
+    sequenceViews_.push_back(SequenceView(this, i, names[i], i < comments.size() ? comments[i] : Comments()));
+  }
+  updateViews_();
+}
+
+/******************************************************************************/
+
+ContiguousSiteContainer::ContiguousSiteContainer(const SequenceContainerInterface& sc, Layout layout) :
+  SimpleCommentable(sc.getComments()),
+  alphabet_(sc.getAlphabet()),
+  layout_(layout),
+  nbSequences_(0),
+  nbSites_(0),
+  sequenceStride_(0),
+  siteStride_(0),
+  data_(),
+  coordinates_(),
+  coordinateIndex_(),
+  sequenceKeys_(),
+  sequenceIndex_(),
+  sequenceViews_(),
+  siteViews_()
+{
+  updateStrides_();
+  vector<string> keys = sc.getSequenceKeys();
+  if (keys.empty())
+    return;
+
+  // All sequences are copied at once:
+  size_t nbSites = sc.sequence(0).size();
+  for (size_t i = 0; i < keys.size(); ++i)
+  {
+    if (sc.sequence(i).size() != nbSites)
+      throw SequenceNotAlignedException("ContiguousSiteContainer: sequences do not have the same length.", &sc.sequence(i));
+  }
+  reshape_(keys.size(), nbSites);
+  reindexSites();
+  for (size_t i = 0; i < nbSequences_; ++i)
+  {
+    const Sequence& seq = sc.sequence(i);
+    const vector<int>& content = seq.getContent();
+    for (size_t j = 0; j < nbSites_; ++j)
+    {
+      valueAt(i, j) = content[j];
+    }
+    sequenceKeys_.push_back(keys[i]);
+    sequenceIndex_[keys[i]] = i;
+    sequenceViews_.push_back(SequenceView(this, i, seq.getName(), seq.getComments()));
+  }
+  updateViews_();
+}
+
+/******************************************************************************/
+
+ContiguousSiteContainer::ContiguousSiteContainer(const ContiguousSiteContainer& csc) :
+  SimpleCommentable(csc),
+  alphabet_(csc.alphabet_),
+  layout_(csc.layout_),
+  nbSequences_(csc.nbSequences_),
+  nbSites_(csc.nbSites_),
+  sequenceStride_(csc.sequenceStride_),
+  siteStride_(csc.siteStride_),
+  data_(csc.data_),
+  coordinates_(csc.coordinates_),
+  coordinateIndex_(),
+  sequenceKeys_(csc.sequenceKeys_),
+  sequenceIndex_(csc.sequenceIndex_),
+  sequenceViews_(csc.sequenceViews_),
+  siteViews_()
+{
+  updateViews_();
+}
+
+/******************************************************************************/
+
+ContiguousSiteContainer& ContiguousSiteContainer::operator=(const ContiguousSiteContainer& csc)
+{
+  SimpleCommentable::operator=(csc);
+  alphabet_ = csc.alphabet_;
+  layout_ = csc.layout_;
+  nbSequences_ = csc.nbSequences_;
+  nbSites_ = csc.nbSites_;
+  sequenceStride_ = csc.sequenceStride_;
+  siteStride_ = csc.siteStride_;
+  data_ = csc.data_;
+  coordinates_ = csc.coordinates_;
+  coordinateIndex_.invalidate();
+  sequenceKeys_ = csc.sequenceKeys_;
+  sequenceIndex_ = csc.sequenceIndex_;
+  sequenceViews_ = csc.sequenceViews_;
+  updateViews_();
+  return *this;
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::setLayout(Layout layout)
+{
+  if (layout == layout_)
+    return;
+
+  // Blocked transposition of the matrix:
+  size_t nbRows = layout_ == Layout::ROW_MAJOR ? nbSequences_ : nbSites_;
+  size_t nbCols = layout_ == Layout::ROW_MAJOR ? nbSites_ : nbSequences_;
+  vector<int> transposed(data_.size());
+  for (size_t ib = 0; ib < nbRows; ib += TRANSPOSE_BLOCK_SIZE)
+  {
+    size_t ie = min(ib + TRANSPOSE_BLOCK_SIZE, nbRows);
+    for (size_t jb = 0; jb < nbCols; jb += TRANSPOSE_BLOCK_SIZE)
+    {
+      size_t je = min(jb + TRANSPOSE_BLOCK_SIZE, nbCols);
+      for (size_t i = ib; i < ie; ++i)
+      {
+        for (size_t j = jb; j < je; ++j)
+        {
+          transposed[j * nbRows + i] = data_[i * nbCols + j];
+        }
+      }
+    }
+  }
+  data_.swap(transposed);
+  layout_ = layout;
+  updateStrides_();
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::addSequence(const std::string& sequenceKey, const SequenceInterface& sequence)
+{
+  // New sequence's alphabet and site container's alphabet matching verification
+  if (!sequence.getAlphabet()->isCompatibleWith(*alphabet_))
+    throw AlphabetMismatchException("ContiguousSiteContainer::addSequence", alphabet_, sequence.getAlphabet());
+
+  if (hasSequence(sequenceKey))
+    throw Exception("ContiguousSiteContainer::addSequence. A sequence with key '" + sequenceKey + "' already exists.");
+
+  // If the container has no sequence, we set the size to the size of this sequence:
+  if (nbSequences_ == 0)
+  {
+    reshape_(0, sequence.size());
+    reindexSites();
+  }
+  else if (sequence.size() != nbSites_)
+    throw SequenceNotAlignedException("ContiguousSiteContainer::addSequence", &sequence);
+
+  size_t i = nbSequences_;
+  reshape_(nbSequences_ + 1, nbSites_);
+  const vector<int>& content = sequence.getContent();
+  for (size_t j = 0; j < nbSites_; ++j)
+  {
+    valueAt(i, j) = content[j];
+  }
+  sequenceKeys_.push_back(sequenceKey);
+  sequenceIndex_[sequenceKey] = i;
+  sequenceViews_.push_back(SequenceView(this, i, sequence.getName(), sequence.getComments()));
+  updateViews_();
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::addSite(const SiteInterface& site, bool checkCoordinate)
+{
+  // New site's alphabet and site container's alphabet matching verification
+  if (!site.getAlphabet()->isCompatibleWith(*alphabet_))
+    throw AlphabetMismatchException("ContiguousSiteContainer::addSite", alphabet_, site.getAlphabet());
+
+  if (nbSequences_ == 0)
+  {
+    // Sequences are created with default names:
+    for (size_t i = 0; i < site.size(); ++i)
+    {
+      string name = "Seq_" + TextTools::toString(i);
+      sequenceKeys_.push_back(name);
+      sequenceIndex_[name] = i;
+      sequenceViews_.push_back(SequenceView(this, i, name, Comments()));
+    }
+    nbSites_ = 0;
+    coordinates_.clear();
+    coordinateIndex_.invalidate();
+    data_.clear();
+    reshape_(site.size(), 0);
+  }
+  else if (site.size() != nbSequences_)
+    throw SiteException("ContiguousSiteContainer::addSite. Site does not have the appropriate length", &site);
+
+  // Check coordinate:
+  if (checkCoordinate)
+  {
+    if (!coordinateIndex_.isValid())
+      coordinateIndex_.build(coordinates_);
+    // Throw exception if position already exists
+    if (coordinateIndex_.count(site.getCoordinate()) > 0)
+      throw SiteException("ContiguousSiteContainer::addSite: Site position already exists in container", &site);
+  }
+
+  size_t j = nbSites_;
+  reshape_(nbSequences_, nbSites_ + 1);
+  for (size_t i = 0; i < nbSequences_; ++i)
+  {
+    valueAt(i, j) = site[i];
+  }
+  coordinates_.push_back(site.getCoordinate());
+  coordinateIndex_.add(site.getCoordinate());
+  updateViews_();
+}
+
+/******************************************************************************/
+
+unique_ptr<VectorSiteContainer> ContiguousSiteContainer::toSiteContainer() const
+{
+  auto vsc = make_unique<VectorSiteContainer>(alphabet_);
+  for (size_t i = 0; i < nbSequences_; ++i)
+  {
+    auto seqPtr = unique_ptr<Sequence>(sequenceViews_[i].clone());
+    vsc->addSequence(sequenceKeys_[i], seqPtr);
+  }
+  if (nbSequences_ > 0)
+    vsc->setSiteCoordinates(coordinates_);
+  vsc->setComments(getComments());
+  return vsc;
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::deleteSites(size_t sitePosition, size_t length)
+{
+  if (sitePosition + length > nbSites_)
+    throw IndexOutOfBoundsException("ContiguousSiteContainer::deleteSites.", sitePosition + length, 0, nbSites_);
+  if (length == 0)
+    return;
+
+  if (layout_ == Layout::ROW_MAJOR)
+    eraseMinor_(sitePosition, length);
+  else
+    eraseMajor_(sitePosition, length);
+  for (size_t j = sitePosition; coordinateIndex_.isValid() && j < sitePosition + length; ++j)
+  {
+    coordinateIndex_.remove(coordinates_[j]);
+  }
+  coordinates_.erase(coordinates_.begin() + static_cast<ptrdiff_t>(sitePosition),
+      coordinates_.begin() + static_cast<ptrdiff_t>(sitePosition + length));
+  nbSites_ -= length;
+  updateStrides_();
+  updateViews_();
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::reindexSites()
+{
+  coordinates_.resize(nbSites_);
+  for (size_t i = 0; i < nbSites_; ++i)
+  {
+    coordinates_[i] = static_cast<int>(i) + 1;
+  }
+  coordinateIndex_.invalidate();
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::setSiteCoordinates(const Vint& coordinates)
+{
+  if (coordinates.size() != nbSites_)
+    throw BadSizeException("ContiguousSiteContainer::setSiteCoordinates bad size of coordinates vector", coordinates.size(), nbSites_);
+  coordinates_ = coordinates;
+  coordinateIndex_.invalidate();
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::setSequenceKeys(const std::vector<std::string>& sequenceKeys)
+{
+  if (sequenceKeys.size() != nbSequences_)
+    throw BadSizeException("ContiguousSiteContainer::setSequenceKeys: bad number of new keys", nbSequences_, sequenceKeys.size());
+  map<string, size_t> index;
+  for (size_t i = 0; i < sequenceKeys.size(); ++i)
+  {
+    if (!index.insert(make_pair(sequenceKeys[i], i)).second)
+      throw Exception("ContiguousSiteContainer::setSequenceKeys: duplicated key '" + sequenceKeys[i] + "'.");
+  }
+  sequenceKeys_ = sequenceKeys;
+  sequenceIndex_.swap(index);
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::clear()
+{
+  nbSequences_ = 0;
+  nbSites_ = 0;
+  data_.clear();
+  coordinates_.clear();
+  coordinateIndex_.invalidate();
+  sequenceKeys_.clear();
+  sequenceIndex_.clear();
+  sequenceViews_.clear();
+  siteViews_.clear();
+  updateStrides_();
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::deleteSequence(size_t sequencePosition)
+{
+  if (sequencePosition >= nbSequences_)
+    throw IndexOutOfBoundsException("ContiguousSiteContainer::deleteSequence.", sequencePosition, 0, nbSequences_ - 1);
+
+  if (layout_ == Layout::ROW_MAJOR)
+    eraseMajor_(sequencePosition, 1);
+  else
+    eraseMinor_(sequencePosition, 1);
+  nbSequences_--;
+  updateStrides_();
+
+  sequenceIndex_.erase(sequenceKeys_[sequencePosition]);
+  for (auto& entry : sequenceIndex_)
+  {
+    if (entry.second > sequencePosition)
+      entry.second--;
+  }
+  sequenceKeys_.erase(sequenceKeys_.begin() + static_cast<ptrdiff_t>(sequencePosition));
+  sequenceViews_.erase(sequenceViews_.begin() + static_cast<ptrdiff_t>(sequencePosition));
+  updateViews_();
+}
+
+/******************************************************************************/
+
+vector<string> ContiguousSiteContainer::getSequenceNames() const
+{
+  vector<string> names;
+  names.reserve(nbSequences_);
+  for (const auto& view : sequenceViews_)
+  {
+    names.push_back(view.getName());
+  }
+  return names;
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::setSequenceNames(const std::vector<std::string>& names, bool updateKeys)
+{
+  if (names.size() != nbSequences_)
+    throw DimensionException("ContiguousSiteContainer::setSequenceNames : bad number of names", names.size(), nbSequences_);
+  if (updateKeys)
+    setSequenceKeys(names);
+  for (size_t i = 0; i < nbSequences_; ++i)
+  {
+    sequenceViews_[i].setName(names[i]);
+  }
+}
+
+/******************************************************************************/
+
+vector<Comments> ContiguousSiteContainer::getSequenceComments() const
+{
+  vector<Comments> comments;
+  comments.reserve(nbSequences_);
+  for (const auto& view : sequenceViews_)
+  {
+    comments.push_back(view.getComments());
+  }
+  return comments;
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::updateStrides_()
+{
+  if (layout_ == Layout::ROW_MAJOR)
+  {
+    sequenceStride_ = nbSites_;
+    siteStride_ = 1;
+  }
+  else
+  {
+    sequenceStride_ = 1;
+    siteStride_ = nbSequences_;
+  }
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::updateViews_()
+{
+  for (size_t i = 0; i < sequenceViews_.size(); ++i)
+  {
+    sequenceViews_[i].container_ = this;
+    sequenceViews_[i].index_ = i;
+  }
+  if (siteViews_.size() > nbSites_)
+    siteViews_.erase(siteViews_.begin() + static_cast<ptrdiff_t>(nbSites_), siteViews_.end());
+  for (auto& view : siteViews_)
+  {
+    view.container_ = this;
+  }
+  siteViews_.reserve(nbSites_);
+  for (size_t j = siteViews_.size(); j < nbSites_; ++j)
+  {
+    siteViews_.push_back(SiteView(this, j));
+  }
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::reshape_(size_t nbSequences, size_t nbSites)
+{
+  int gap = alphabet_->getGapCharacterCode();
+  bool appendMajor = layout_ == Layout::ROW_MAJOR ? nbSites == nbSites_ : nbSequences == nbSequences_;
+  if (appendMajor)
+  {
+    // Rows (resp. columns) are added or removed at the end of the matrix:
+    data_.resize(nbSequences * nbSites, gap);
+  }
+  else
+  {
+    vector<int> reshaped(nbSequences * nbSites, gap);
+    size_t sequenceStride = layout_ == Layout::ROW_MAJOR ? nbSites : 1;
+    size_t siteStride = layout_ == Layout::ROW_MAJOR ? 1 : nbSequences;
+    size_t nbSeqCopy = min(nbSequences, nbSequences_);
+    size_t nbSitesCopy = min(nbSites, nbSites_);
+    for (size_t i = 0; i < nbSeqCopy; ++i)
+    {
+      for (size_t j = 0; j < nbSitesCopy; ++j)
+      {
+        reshaped[i * sequenceStride + j * siteStride] = valueAt(i, j);
+      }
+    }
+    data_.swap(reshaped);
+  }
+  nbSequences_ = nbSequences;
+  nbSites_ = nbSites;
+  updateStrides_();
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::eraseMajor_(size_t pos, size_t length)
+{
+  size_t minor = layout_ == Layout::ROW_MAJOR ? nbSites_ : nbSequences_;
+  data_.erase(data_.begin() + static_cast<ptrdiff_t>(pos * minor),
+      data_.begin() + static_cast<ptrdiff_t>((pos + length) * minor));
+}
+
+/******************************************************************************/
+
+void ContiguousSiteContainer::eraseMinor_(size_t pos, size_t length)
+{
+  size_t major = layout_ == Layout::ROW_MAJOR ? nbSequences_ : nbSites_;
+  size_t minor = layout_ == Layout::ROW_MAJOR ? nbSites_ : nbSequences_;
+  // In-place compaction, the destination is never after the source:
+  size_t k = 0;
+  for (size_t m = 0; m < major; ++m)
+  {
+    for (size_t n = 0; n < minor; ++n)
+    {
+      if (n < pos || n >= pos + length)
+        data_[k++] = data_[m * minor + n];
+    }
+  }
+  data_.resize(k);
+}
+
+/******************************************************************************/
@@ -0,0 +1,645 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_CONTAINER_CONTIGUOUSSITECONTAINER_H
+#define BPP_SEQ_CONTAINER_CONTIGUOUSSITECONTAINER_H
+
+#include <Bpp/Exceptions.h>
+
+#include "../Sequence.h"
+#include "../Site.h"
+#include "AlignmentData.h"
+#include "SiteContainer.h"
+#include "SiteCoordinateIndex.h"
+#include "VectorSiteContainer.h"
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+namespace bpp
+{
+/**
+ * @brief An alignment stored as a single contiguous matrix of states.
+ *
+ * Whereas VectorSiteContainer stores each site as a separate object, this container
+ * stores all states in one array of size (number of sequences) x (number of sites),
+ * either sequence by sequence (row-major layout) or site by site (column-major layout).
+ * The layout can be changed at any time with setLayout(), for instance to switch from
+ * a sequence-wise construction to site-wise computations.
+ *
+ * Sites and sequences are accessed through light-weight views, which read directly
+ * in the matrix: no Site or Sequence object is created, and a view never copies data.
+ * Views give access to the underlying memory via data() and getStride(): states
+ * of a site are contiguous in column-major layout, states of a sequence are contiguous
+ * in row-major layout.
+ * Views are read-only: edition methods throw a NotImplementedException, and the clone()
+ * method returns a regular Site or Sequence object.
+ * References to views are invalidated when sites or sequences are added or removed,
+ * and pointers returned by data() are also invalidated when the layout changes.
+ *
+ * Sequences can be added at the end of the container (efficient in row-major layout),
+ * and sites can be added at the end of the container (efficient in column-major layout).
+ *
+ * @see VectorSiteContainer
+ */
+class ContiguousSiteContainer :
+  public virtual AlignmentDataInterface,
+  public SimpleCommentable
+{
+public:
+  /**
+   * @brief Storage order of the states in the matrix.
+   */
+  enum class Layout
+  {
+    ROW_MAJOR,   ///< States of each sequence are contiguous.
+    COLUMN_MAJOR ///< States of each site are contiguous.
+  };
+
+  /**
+   * @brief A read-only view on a site of the container.
+   */
+  class SiteView :
+    public virtual CoreSiteInterface
+  {
+  private:
+    ContiguousSiteContainer* container_;
+    size_t index_;
+
+  public:
+    SiteView(ContiguousSiteContainer* container, size_t index) :
+      container_(container),
+      index_(index)
+    {}
+
+    SiteView(const SiteView& view) :
+      container_(view.container_),
+      index_(view.index_)
+    {}
+
+    SiteView& operator=(const SiteView& view)
+    {
+      container_ = view.container_;
+      index_ = view.index_;
+      return *this;
+    }
+
+    virtual ~SiteView()
+    {}
+
+  public:
+    /**
+     * @return A copy of this site, as a Site object.
+     */
+    Site* clone() const override;
+
+    std::shared_ptr<const Alphabet> getAlphabet() const override
+    {
+      return container_->getAlphabet();
+    }
+
+    const Alphabet& alphabet() const override
+    {
+      return container_->alphabet();
+    }
+
+    size_t size() const override
+    {
+      return container_->getNumberOfSequences();
+    }
+
+    std::string toString() const override;
+
+    void deleteElement(size_t pos) override
+    {
+      throw NotImplementedException("ContiguousSiteContainer::SiteView::deleteElement. Views are read-only.");
+    }
+
+    void deleteElements(size_t pos, size_t len) override
+    {
+      throw NotImplementedException("ContiguousSiteContainer::SiteView::deleteElements. Views are read-only.");
+    }
+
+    void shuffle() override
+    {
+      throw NotImplementedException("ContiguousSiteContainer::SiteView::shuffle. Views are read-only.");
+    }
+
+    double getStateValueAt(size_t sequencePosition, int state) const override
+    {
+      if (sequencePosition >= size())
+        throw IndexOutOfBoundsException("ContiguousSiteContainer::SiteView::getStateValueAt.", sequencePosition, 0, size() - 1);
+      return container_->alphabet().isResolvedIn((*this)[sequencePosition], state) ? 1. : 0.;
+    }
+
+    double operator()(size_t sequencePosition, int state) const override
+    {
+      return container_->alphabet().isResolvedIn((*this)[sequencePosition], state) ? 1. : 0.;
+    }
+
+    int getCoordinate() const override
+    {
+      return container_->coordinates_[index_];
+    }
+
+    void setCoordinate(int coordinate) override
+    {
+      container_->coordinates_[index_] = coordinate;
+      container_->coordinateIndex_.invalidate();
+    }
+
+    /**
+     * @return The state of the given sequence at this site.
+     */
+    int operator[](size_t sequencePosition) const
+    {
+      return container_->data_[index_ * container_->siteStride_ + sequencePosition * container_->sequenceStride_];
+    }
+
+    /**
+     * @return A pointer toward the state of the first sequence at this site.
+     */
+    const int* data() const
+    {
+      return container_->data_.data() + index_ * container_->siteStride_;
+    }
+
+    /**
+     * @return The distance in memory between the states of two successive sequences.
+     */
+    size_t getStride() const
+    {
+      return container_->sequenceStride_;
+    }
+
+    friend class ContiguousSiteContainer;
+  };
+
+  /**
+   * @brief A read-only view on a sequence of the container.
+   *
+   * The view stores the name and comments of the sequence.
+   */
+  class SequenceView :
+    public virtual CoreSequenceInterface,
+    public AbstractCoreSequence
+  {
+  private:
+    ContiguousSiteContainer* container_;
+    size_t index_;
+
+  public:
+    SequenceView(ContiguousSiteContainer* container, size_t index, const std::string& name, const Comments& comments) :
+      AbstractCoreSequence(name, comments),
+      container_(container),
+      index_(index)
+    {}
+
+    SequenceView(const SequenceView& view) :
+      AbstractCoreSequence(view.getName(), view.getComments()),
+      container_(view.container_),
+      index_(view.index_)
+    {}
+
+    SequenceView& operator=(const SequenceView& view)
+    {
+      AbstractCoreSequence::operator=(view);
+      container_ = view.container_;
+      index_ = view.index_;
+      return *this;
+    }
+
+    virtual ~SequenceView()
+    {}
+
+  public:
+    /**
+     * @return A copy of this sequence, as a Sequence object.
+     */
+    Sequence* clone() const override;
+
+    std::shared_ptr<const Alphabet> getAlphabet() const override
+    {
+      return container_->getAlphabet();
+    }
+
+    const Alphabet& alphabet() const override
+    {
+      return container_->alphabet();
+    }
+
+    size_t size() const override
+    {
+      return container_->getNumberOfSites();
+    }
+
+    std::string toString() const override;
+
+    void deleteElement(size_t pos) override
+    {
+      throw NotImplementedException("ContiguousSiteContainer::SequenceView::deleteElement. Views are read-only.");
+    }
+
+    void deleteElements(size_t pos, size_t len) override
+    {
+      throw NotImplementedException("ContiguousSiteContainer::SequenceView::deleteElements. Views are read-only.");
+    }
+
+    void shuffle() override
+    {
+      throw NotImplementedException("ContiguousSiteContainer::SequenceView::shuffle. Views are read-only.");
+    }
+
+    void setToSizeR(size_t newSize) override
+    {
+      throw NotImplementedException("ContiguousSiteContainer::SequenceView::setToSizeR. Views are read-only.");
+    }
+
+    void setToSizeL(size_t newSize) override
+    {
+      throw NotImplementedException("ContiguousSiteContainer::SequenceView::setToSizeL. Views are read-only.");
+    }
+
+    double getStateValueAt(size_t sitePosition, int state) const override
+    {
+      if (sitePosition >= size())
+        throw IndexOutOfBoundsException("ContiguousSiteContainer::SequenceView::getStateValueAt.", sitePosition, 0, size() - 1);
+      return container_->alphabet().isResolvedIn((*this)[sitePosition], state) ? 1. : 0.;
+    }
+
+    double operator()(size_t sitePosition, int state) const override
+    {
+      return container_->alphabet().isResolvedIn((*this)[sitePosition], state) ? 1. : 0.;
+    }
+
+    /**
+     * @return The state of this sequence at the given site.
+     */
+    int operator[](size_t sitePosition) const
+    {
+      return container_->data_[index_ * container_->sequenceStride_ + sitePosition * container_->siteStride_];
+    }
+
+    /**
+     * @return A pointer toward the state of this sequence at the first site.
+     */
+    const int* data() const
+    {
+      return container_->data_.data() + index_ * container_->sequenceStride_;
+    }
+
+    /**
+     * @return The distance in memory between the states of two successive sites.
+     */
+    size_t getStride() const
+    {
+      return container_->siteStride_;
+    }
+
+    friend class ContiguousSiteContainer;
+  };
+
+private:
+  std::shared_ptr<const Alphabet> alphabet_;
+  Layout layout_;
+  size_t nbSequences_;
+  size_t nbSites_;
+
+  /**
+   * @brief Offsets between two successive sequences and two successive sites in the matrix.
+   */
+  size_t sequenceStride_;
+  size_t siteStride_;
+
+  std::vector<int> data_;
+  std::vector<int> coordinates_;
+  SiteCoordinateIndex coordinateIndex_;
+  std::vector<std::string> sequenceKeys_;
+  std::map<std::string, size_t> sequenceIndex_;
+  std::vector<SequenceView> sequenceViews_;
+  std::vector<SiteView> siteViews_;
+
+public:
+  /**
+   * @brief Build a new empty container.
+   *
+   * @param alphabet The alphabet of the container.
+   * @param layout The storage order of the states.
+   */
+  ContiguousSiteContainer(std::shared_ptr<const Alphabet> alphabet, Layout layout = Layout::COLUMN_MAJOR);
+
+  /**
+   * @brief Copy the content of a site container.
+   *
+   * Sequence keys, names and comments, as well as site coordinates, are copied.
+   *
+   * @param sc The container to copy.
+   * @param layout The storage order of the states.
+   */
+  ContiguousSiteContainer(const SiteContainerInterface& sc, Layout layout = Layout::COLUMN_MAJOR);
+
+  /**
+   * @brief Copy the content of a sequence container. All sequences must have the same length.
+   *
+   * Sites are numbered from 1.
+   *
+   * @param sc The container to copy.
+   * @param layout The storage order of the states.
+   * @throw SequenceNotAlignedException If sequences do not have the same length.
+   */
+  ContiguousSiteContainer(const SequenceContainerInterface& sc, Layout layout = Layout::ROW_MAJOR);
+
+  ContiguousSiteContainer(const ContiguousSiteContainer& csc);
+
+  ContiguousSiteContainer& operator=(const ContiguousSiteContainer& csc);
+
+  virtual ~ContiguousSiteContainer()
+  {}
+
+public:
+  /**
+   * @name The Clonable interface.
+   *
+   * @{
+   */
+  ContiguousSiteContainer* clone() const override
+  {
+    return new ContiguousSiteContainer(*this);
+  }
+  /** @} */
+
+  /**
+   * @name Storage.
+   *
+   * @{
+   */
+
+  /**
+   * @return The storage order of the states.
+   */
+  Layout getLayout() const
+  {
+    return layout_;
+  }
+
+  /**
+   * @brief Change the storage order of the states.
+   *
+   * The matrix is transposed if needed. Views remain valid, but pointers returned by their data() method do not.
+   *
+   * @param layout The new storage order.
+   */
+  void setLayout(Layout layout);
+
+  /**
+   * @return A pointer toward the whole matrix of states.
+   */
+  const int* data() const
+  {
+    return data_.data();
+  }
+
+  /**
+   * @return The distance in memory between the states of two successive sequences at a given site.
+   */
+  size_t getSequenceStride() const
+  {
+    return sequenceStride_;
+  }
+
+  /**
+   * @return The distance in memory between the states of two successive sites in a given sequence.
+   */
+  size_t getSiteStride() const
+  {
+    return siteStride_;
+  }
+  /** @} */
+
+  /**
+   * @name Access to the states.
+   *
+   * @{
+   */
+  const int& valueAt(size_t sequencePosition, size_t sitePosition) const
+  {
+    return data_[sequencePosition * sequenceStride_ + sitePosition * siteStride_];
+  }
+
+  int& valueAt(size_t sequencePosition, size_t sitePosition)
+  {
+    return data_[sequencePosition * sequenceStride_ + sitePosition * siteStride_];
+  }
+
+  const int& valueAt(const std::string& sequenceKey, size_t sitePosition) const
+  {
+    return valueAt(getSequencePosition(sequenceKey), sitePosition);
+  }
+
+  int& valueAt(const std::string& sequenceKey, size_t sitePosition)
+  {
+    return valueAt(getSequencePosition(sequenceKey), sitePosition);
+  }
+  /** @} */
+
+  /**
+   * @name Adding data.
+   *
+   * @{
+   */
+
+  /**
+   * @brief Add a sequence at the end of the container.
+   *
+   * @param sequenceKey The key of the new sequence.
+   * @param sequence The sequence to add. Its content is copied.
+   * @throw AlphabetMismatchException If the sequence does not have the same alphabet as the container.
+   * @throw SequenceNotAlignedException If the sequence does not have the same length as the others.
+   * @throw Exception If the key is already used.
+   */
+  void addSequence(const std::string& sequenceKey, const SequenceInterface& sequence);
+
+  /**
+   * @brief Add a site at the end of the container.
+   *
+   * @param site The site to add. Its content is copied.
+   * @param checkCoordinate Check that the coordinate of the site is not already used in the container.
+   * @throw AlphabetMismatchException If the site does not have the same alphabet as the container.
+   * @throw SiteException If the site does not have the appropriate length, or if its coordinate is already used.
+   */
+  void addSite(const SiteInterface& site, bool checkCoordinate = true);
+  /** @} */
+
+  /**
+   * @brief Convert to a regular site container.
+   *
+   * @return A new VectorSiteContainer with the same content.
+   */
+  std::unique_ptr<VectorSiteContainer> toSiteContainer() const;
+
+  /**
+   * @name The AlignmentData interface.
+   *
+   * @{
+   */
+  const SiteView& site(size_t sitePosition) const override
+  {
+    if (sitePosition >= nbSites_)
+      throw IndexOutOfBoundsException("ContiguousSiteContainer::site.", sitePosition, 0, nbSites_ - 1);
+    return siteViews_[sitePosition];
+  }
+
+  void deleteSites(size_t sitePosition, size_t length) override;
+
+  size_t getNumberOfSites() const override
+  {
+    return nbSites_;
+  }
+
+  void reindexSites() override;
+
+  Vint getSiteCoordinates() const override
+  {
+    return coordinates_;
+  }
+
+  void setSiteCoordinates(const Vint& coordinates) override;
+  /** @} */
+
+  /**
+   * @name The SequenceData interface.
+   *
+   * @{
+   */
+  const Alphabet& alphabet() const override
+  {
+    return *alphabet_;
+  }
+
+  std::shared_ptr<const Alphabet> getAlphabet() const override
+  {
+    return alphabet_;
+  }
+
+  size_t getNumberOfSequences() const override
+  {
+    return nbSequences_;
+  }
+
+  std::vector<std::string> getSequenceKeys() const override
+  {
+    return sequenceKeys_;
+  }
+
+  void setSequenceKeys(const std::vector<std::string>& sequenceKeys) override;
+
+  double getStateValueAt(size_t sitePosition, const std::string& sequenceKey, int state) const override
+  {
+    return getStateValueAt(sitePosition, getSequencePosition(sequenceKey), state);
+  }
+
+  double operator()(size_t sitePosition, const std::string& sequenceKey, int state) const override
+  {
+    return getStateValueAt(sitePosition, getSequencePosition(sequenceKey), state);
+  }
+
+  double getStateValueAt(size_t sitePosition, size_t sequencePosition, int state) const override
+  {
+    if (sitePosition >= nbSites_)
+      throw IndexOutOfBoundsException("ContiguousSiteContainer::getStateValueAt.", sitePosition, 0, nbSites_ - 1);
+    if (sequencePosition >= nbSequences_)
+      throw IndexOutOfBoundsException("ContiguousSiteContainer::getStateValueAt.", sequencePosition, 0, nbSequences_ - 1);
+    return alphabet_->isResolvedIn(valueAt(sequencePosition, sitePosition), state) ? 1. : 0.;
+  }
+
+  double operator()(size_t sitePosition, size_t sequencePosition, int state) const override
+  {
+    return alphabet_->isResolvedIn(valueAt(sequencePosition, sitePosition), state) ? 1. : 0.;
+  }
+
+  void clear() override;
+
+  ContiguousSiteContainer* createEmptyContainer() const override
+  {
+    ContiguousSiteContainer* csc = new ContiguousSiteContainer(alphabet_, layout_);
+    csc->setComments(getComments());
+    return csc;
+  }
+
+  bool hasSequence(const std::string& sequenceKey) const override
+  {
+    return sequenceIndex_.find(sequenceKey) != sequenceIndex_.end();
+  }
+
+  const SequenceView& sequence(const std::string& sequenceKey) const override
+  {
+    return sequenceViews_[getSequencePosition(sequenceKey)];
+  }
+
+  void deleteSequence(const std::string& sequenceKey) override
+  {
+    deleteSequence(getSequencePosition(sequenceKey));
+  }
+
+  const SequenceView& sequence(size_t sequencePosition) const override
+  {
+    if (sequencePosition >= nbSequences_)
+      throw IndexOutOfBoundsException("ContiguousSiteContainer::sequence.", sequencePosition, 0, nbSequences_ - 1);
+    return sequenceViews_[sequencePosition];
+  }
+
+  void deleteSequence(size_t sequencePosition) override;
+
+  const std::string& sequenceKey(size_t sequencePosition) const override
+  {
+    if (sequencePosition >= nbSequences_)
+      throw IndexOutOfBoundsException("ContiguousSiteContainer::sequenceKey.", sequencePosition, 0, nbSequences_ - 1);
+    return sequenceKeys_[sequencePosition];
+  }
+
+  size_t getSequencePosition(const std::string& sequenceKey) const override
+  {
+    auto it = sequenceIndex_.find(sequenceKey);
+    if (it == sequenceIndex_.end())
+      throw SequenceNotFoundException("ContiguousSiteContainer::getSequencePosition.", sequenceKey);
+    return it->second;
+  }
+
+  std::vector<std::string> getSequenceNames() const override;
+
+  void setSequenceNames(const std::vector<std::string>& names, bool updateKeys = true) override;
+
+  std::vector<Comments> getSequenceComments() const override;
+  /** @} */
+
+private:
+  void updateStrides_();
+
+  /**
+   * @brief Rebuild all views, after a copy or a change of dimensions.
+   */
+  void updateViews_();
+
+  /**
+   * @brief Reorganize the matrix for new dimensions.
+   *
+   * Existing states keep their sequence and site indices. New states are set to the gap code.
+   */
+  void reshape_(size_t nbSequences, size_t nbSites);
+
+  /**
+   * @brief Remove a range of rows (row-major) or columns (column-major).
+   */
+  void eraseMajor_(size_t pos, size_t length);
+
+  /**
+   * @brief Remove a range of columns (row-major) or rows (column-major).
+   */
+  void eraseMinor_(size_t pos, size_t length);
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_CONTAINER_CONTIGUOUSSITECONTAINER_H
@@ -0,0 +1,513 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include <Bpp/Text/TextTools.h>
+
+#include "../Alphabet/AlphabetExceptions.h"
+#include "../SiteExceptions.h"
+#include "OutOfCoreSiteContainer.h"
+#include "SequenceContainerExceptions.h"
+
+// From the STL:
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BPP_SEQ_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+OutOfCoreSiteContainer::OutOfCoreSiteContainer(
+    const vector<string>& sequenceKeys,
+    shared_ptr<const Alphabet> alphabet,
+    const string& directory,
+    size_t blockSize,
+    size_t maxLoadedBlocks) :
+  AbstractTemplateSequenceContainer<Sequence, string>(alphabet),
+  directory_(directory),
+  prefix_(),
+  blockSize_(blockSize),
+  maxLoadedBlocks_(max<size_t>(maxLoadedBlocks, 1)),
+  offset_(0),
+  sequenceKeys_(),
+  sequenceNames_(),
+  sequenceComments_(),
+  positions_(),
+  coordinates_(),
+  chunks_(),
+  recentlyUsed_(),
+  usePositions_(),
+  coordinateIndex_(),
+  sites_(),
+  sequences_()
+{
+  init_(sequenceKeys);
+}
+
+OutOfCoreSiteContainer::OutOfCoreSiteContainer(
+    const SiteContainerInterface& sc,
+    const string& directory,
+    size_t blockSize,
+    size_t maxLoadedBlocks) :
+  AbstractTemplateSequenceContainer<Sequence, string>(sc.getAlphabet(), sc.getComments()),
+  directory_(directory),
+  prefix_(),
+  blockSize_(blockSize),
+  maxLoadedBlocks_(max<size_t>(maxLoadedBlocks, 1)),
+  offset_(0),
+  sequenceKeys_(),
+  sequenceNames_(),
+  sequenceComments_(),
+  positions_(),
+  coordinates_(),
+  chunks_(),
+  recentlyUsed_(),
+  usePositions_(),
+  coordinateIndex_(),
+  sites_(),
+  sequences_()
+{
+  init_(sc.getSequenceKeys());
+  sequenceNames_ = sc.getSequenceNames();
+  sequenceComments_ = sc.getSequenceComments();
+  appendSites_(sc);
+}
+
+OutOfCoreSiteContainer::OutOfCoreSiteContainer(const OutOfCoreSiteContainer& sc) :
+  AbstractTemplateSequenceContainer<Sequence, string>(sc),
+  directory_(sc.directory_),
+  prefix_(),
+  blockSize_(sc.blockSize_),
+  maxLoadedBlocks_(sc.maxLoadedBlocks_),
+  offset_(0),
+  sequenceKeys_(),
+  sequenceNames_(),
+  sequenceComments_(),
+  positions_(),
+  coordinates_(),
+  chunks_(),
+  recentlyUsed_(),
+  usePositions_(),
+  coordinateIndex_(),
+  sites_(),
+  sequences_()
+{
+  init_(sc.sequenceKeys_);
+  sequenceNames_ = sc.sequenceNames_;
+  sequenceComments_ = sc.sequenceComments_;
+  appendSites_(sc);
+}
+
+OutOfCoreSiteContainer& OutOfCoreSiteContainer::operator=(const OutOfCoreSiteContainer& sc)
+{
+  if (this == &sc)
+    return *this;
+  clear();
+  AbstractTemplateSequenceContainer<Sequence, string>::operator=(sc);
+  directory_ = sc.directory_;
+  blockSize_ = sc.blockSize_;
+  maxLoadedBlocks_ = sc.maxLoadedBlocks_;
+  init_(sc.sequenceKeys_);
+  sequenceNames_ = sc.sequenceNames_;
+  sequenceComments_ = sc.sequenceComments_;
+  appendSites_(sc);
+  return *this;
+}
+
+OutOfCoreSiteContainer::~OutOfCoreSiteContainer()
+{
+  removeChunks_();
+}
+
+/******************************************************************************/
+
+void OutOfCoreSiteContainer::init_(const vector<string>& sequenceKeys)
+{
+  // States are stored on one byte, starting from the smallest one:
+  int maxState = 0;
+  offset_ = 0;
+  for (int state : alphabet_->getSupportedInts())
+  {
+    offset_ = min(offset_, state);
+    maxState = max(maxState, state);
+  }
+  if (maxState - offset_ >= 256)
+    throw AlphabetException("OutOfCoreSiteContainer: states can not be stored on one byte.", alphabet_);
+
+  if (directory_.empty())
+    directory_ = filesystem::temp_directory_path().string();
+  random_device random;
+  prefix_ = (filesystem::path(directory_) / ("bpp_sites_" + TextTools::toString(random()) + "_" + TextTools::toString(random()))).string();
+
+  sequenceKeys_ = sequenceKeys;
+  sequenceNames_ = sequenceKeys;
+  sequenceComments_.assign(sequenceKeys.size(), Comments());
+  positions_.clear();
+  for (size_t i = 0; i < sequenceKeys_.size(); ++i)
+  {
+    positions_[sequenceKeys_[i]] = i;
+  }
+  if (blockSize_ == 0 && !sequenceKeys_.empty())
+    blockSize_ = max<size_t>((1 << 24) / sequenceKeys_.size(), 1);
+}
+
+/******************************************************************************/
+
+void OutOfCoreSiteContainer::addSite(unique_ptr<Site>& site, bool checkCoordinate)
+{
+  // The first site sets the number of sequences:
+  if (getNumberOfSequences() == 0 && getNumberOfSites() == 0)
+  {
+    vector<string> keys(site->size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+      keys[i] = "Seq_" + TextTools::toString(i);
+    }
+    removeChunks_();
+    init_(keys);
+  }
+  if (site->size() != getNumberOfSequences())
+    throw SiteException("OutOfCoreSiteContainer::addSite. Site does not have the appropriate length", site.get());
+  if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
+    throw AlphabetMismatchException("OutOfCoreSiteContainer::addSite", getAlphabet(), site->getAlphabet());
+  if (checkCoordinate)
+  {
+    if (!coordinateIndex_.isValid())
+      coordinateIndex_.build(coordinates_);
+    if (coordinateIndex_.count(site->getCoordinate()) > 0)
+      throw SiteException("OutOfCoreSiteContainer::addSite(site, bool): Site position already exists in container", site.get());
+  }
+
+  if (chunks_.empty() || chunks_.back().nbSites == blockSize_)
+  {
+    chunks_.push_back(Chunk_());
+    usePositions_.push_back(recentlyUsed_.end());
+    chunks_.back().buffer.reserve(blockSize_ * getNumberOfSequences());
+  }
+  Chunk_& chunk = chunks_.back();
+  for (size_t i = 0; i < site->size(); ++i)
+  {
+    chunk.buffer.push_back(static_cast<uint8_t>((*site)[i] - offset_));
+  }
+  chunk.data = chunk.buffer.data();
+  chunk.nbSites++;
+  coordinates_.push_back(site->getCoordinate());
+  coordinateIndex_.add(site->getCoordinate());
+  // Sites already built are unchanged, but sequences are longer:
+  sequences_.clear();
+  if (chunk.nbSites == blockSize_)
+    writeChunk_(chunks_.size() - 1);
+}
+
+/******************************************************************************/
+
+void OutOfCoreSiteContainer::appendSites_(const SiteContainerInterface& sc)
+{
+  for (size_t i = 0; i < sc.getNumberOfSites(); ++i)
+  {
+    auto site = unique_ptr<Site>(sc.site(i).clone());
+    addSite(site, false);
+  }
+}
+
+/******************************************************************************/
+
+void OutOfCoreSiteContainer::writeChunk_(size_t blockIndex)
+{
+  Chunk_& chunk = chunks_[blockIndex];
+  chunk.path = prefix_ + "_" + TextTools::toString(blockIndex) + ".chunk";
+  ofstream output(chunk.path.c_str(), ios::out | ios::binary | ios::trunc);
+  output.write(reinterpret_cast<const char*>(chunk.buffer.data()), static_cast<streamsize>(chunk.buffer.size()));
+  output.close();
+  if (!output)
+    throw IOException("OutOfCoreSiteContainer: can't write chunk file " + chunk.path);
+  vector<uint8_t>().swap(chunk.buffer);
+  chunk.data = nullptr;
+}
+
+/******************************************************************************/
+
+void OutOfCoreSiteContainer::loadChunk_(size_t blockIndex) const
+{
+  Chunk_& chunk = chunks_[blockIndex];
+  if (chunk.path.empty())
+    return; // The block being filled is always in memory.
+  if (chunk.data)
+  {
+    recentlyUsed_.splice(recentlyUsed_.begin(), recentlyUsed_, usePositions_[blockIndex]);
+    return;
+  }
+  shrinkLoadedChunks_(maxLoadedBlocks_ - 1);
+  size_t size = chunk.nbSites * getNumberOfSequences();
+#ifdef BPP_SEQ_HAVE_MMAP
+  int fd = ::open(chunk.path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw IOException("OutOfCoreSiteContainer: can't open chunk file " + chunk.path);
+  void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    throw IOException("OutOfCoreSiteContainer: can't map chunk file " + chunk.path);
+  chunk.data = static_cast<const uint8_t*>(addr);
+  chunk.mapped = true;
+#else
+  ifstream input(chunk.path.c_str(), ios::in | ios::binary);
+  chunk.buffer.resize(size);
+  input.read(reinterpret_cast<char*>(chunk.buffer.data()), static_cast<streamsize>(size));
+  if (!input)
+    throw IOException("OutOfCoreSiteContainer: can't read chunk file " + chunk.path);
+  chunk.data = chunk.buffer.data();
+#endif
+  recentlyUsed_.push_front(blockIndex);
+  usePositions_[blockIndex] = recentlyUsed_.begin();
+}
+
+void OutOfCoreSiteContainer::unloadChunk_(size_t blockIndex) const
+{
+  Chunk_& chunk = chunks_[blockIndex];
+  if (chunk.path.empty() || !chunk.data)
+    return;
+#ifdef BPP_SEQ_HAVE_MMAP
+  if (chunk.mapped)
+    ::munmap(const_cast<uint8_t*>(chunk.data), chunk.nbSites * getNumberOfSequences());
+#endif
+  chunk.mapped = false;
+  chunk.data = nullptr;
+  vector<uint8_t>().swap(chunk.buffer);
+  recentlyUsed_.erase(usePositions_[blockIndex]);
+  usePositions_[blockIndex] = recentlyUsed_.end();
+}
+
+void OutOfCoreSiteContainer::shrinkLoadedChunks_(size_t maxSize) const
+{
+  while (recentlyUsed_.size() > maxSize)
+  {
+    unloadChunk_(recentlyUsed_.back());
+  }
+}
+
+void OutOfCoreSiteContainer::maxLoadedBlocks(size_t maxLoadedBlocks)
+{
+  maxLoadedBlocks_ = max<size_t>(maxLoadedBlocks, 1);
+  shrinkLoadedChunks_(maxLoadedBlocks_);
+}
+
+void OutOfCoreSiteContainer::removeChunks_()
+{
+  shrinkLoadedChunks_(0);
+  for (const auto& chunk : chunks_)
+  {
+    if (!chunk.path.empty())
+      std::remove(chunk.path.c_str());
+  }
+  chunks_.clear();
+  usePositions_.clear();
+}
+
+/******************************************************************************/
+
+const uint8_t* OutOfCoreSiteContainer::getBlockData(size_t blockIndex) const
+{
+  if (blockIndex >= chunks_.size())
+    throw IndexOutOfBoundsException("OutOfCoreSiteContainer::getBlockData.", blockIndex, 0, chunks_.size() - 1);
+  loadChunk_(blockIndex);
+  return chunks_[blockIndex].data;
+}
+
+/******************************************************************************/
+
+const Site& OutOfCoreSiteContainer::site(size_t sitePosition) const
+{
+  if (sitePosition >= getNumberOfSites())
+    throw IndexOutOfBoundsException("OutOfCoreSiteContainer::site.", sitePosition, 0, getNumberOfSites() - 1);
+  auto& site = sites_[sitePosition];
+  if (!site)
+  {
+    const uint8_t* data = getBlockData(sitePosition / blockSize_) + (sitePosition % blockSize_) * getNumberOfSequences();
+    site = createSite_(data, sitePosition);
+  }
+  return *site;
+}
+
+/******************************************************************************/
+
+unique_ptr<Site> OutOfCoreSiteContainer::createSite_(const uint8_t* data, size_t sitePosition) const
+{
+  size_t n = getNumberOfSequences();
+  vector<int> states(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    states[i] = static_cast<int>(data[i]) + offset_;
+  }
+  auto alphaPtr = getAlphabet();
+  return make_unique<Site>(states, alphaPtr, coordinates_[sitePosition]);
+}
+
+/******************************************************************************/
+
+vector<unique_ptr<Site>> OutOfCoreSiteContainer::getSites(const vector<size_t>& selection) const
+{
+  // The selection is grouped by block, with a counting sort:
+  vector<size_t> starts(chunks_.size() + 1, 0);
+  for (size_t pos : selection)
+  {
+    if (pos >= getNumberOfSites())
+      throw IndexOutOfBoundsException("OutOfCoreSiteContainer::getSites.", pos, 0, getNumberOfSites() - 1);
+    starts[pos / blockSize_ + 1]++;
+  }
+  for (size_t k = 0; k < chunks_.size(); ++k)
+  {
+    starts[k + 1] += starts[k];
+  }
+  vector<size_t> order(selection.size());
+  vector<size_t> next(starts.begin(), starts.end() - 1);
+  for (size_t i = 0; i < selection.size(); ++i)
+  {
+    order[next[selection[i] / blockSize_]++] = i;
+  }
+
+  size_t n = getNumberOfSequences();
+  vector<unique_ptr<Site>> sites(selection.size());
+  for (size_t k = 0; k < chunks_.size(); ++k)
+  {
+    if (starts[k] == starts[k + 1])
+      continue;
+    const uint8_t* data = getBlockData(k);
+    for (size_t j = starts[k]; j < starts[k + 1]; ++j)
+    {
+      size_t pos = selection[order[j]];
+      sites[order[j]] = createSite_(data + (pos % blockSize_) * n, pos);
+    }
+  }
+  return sites;
+}
+
+/******************************************************************************/
+
+const Sequence& OutOfCoreSiteContainer::sequence(size_t sequencePosition) const
+{
+  if (sequencePosition >= getNumberOfSequences())
+    throw IndexOutOfBoundsException("OutOfCoreSiteContainer::sequence.", sequencePosition, 0, getNumberOfSequences() - 1);
+  auto& seq = sequences_[sequencePosition];
+  if (seq)
+    return *seq;
+
+  // The sequence is gathered block by block:
+  size_t n = getNumberOfSequences();
+  vector<int> states(getNumberOfSites());
+  size_t pos = 0;
+  for (size_t k = 0; k < chunks_.size(); ++k)
+  {
+    const uint8_t* data = getBlockData(k) + sequencePosition;
+    for (size_t j = 0; j < chunks_[k].nbSites; ++j)
+    {
+      states[pos++] = static_cast<int>(data[j * n]) + offset_;
+    }
+  }
+  auto alphaPtr = getAlphabet();
+  seq.reset(new Sequence(sequenceNames_[sequencePosition], states, sequenceComments_[sequencePosition], alphaPtr));
+  return *seq;
+}
+
+/******************************************************************************/
+
+unique_ptr<VectorSiteContainer> OutOfCoreSiteContainer::getBlock(size_t blockIndex) const
+{
+  const uint8_t* data = getBlockData(blockIndex);
+  size_t n = getNumberOfSequences();
+  auto alphaPtr = getAlphabet();
+  auto block = make_unique<VectorSiteContainer>(sequenceKeys_, alphaPtr);
+  block->setSequenceNames(sequenceNames_, false);
+  for (size_t j = 0; j < chunks_[blockIndex].nbSites; ++j)
+  {
+    auto site = createSite_(data + j * n, blockIndex * blockSize_ + j);
+    block->addSite(site, false);
+  }
+  return block;
+}
+
+/******************************************************************************/
+
+void OutOfCoreSiteContainer::reindexSites()
+{
+  for (size_t i = 0; i < coordinates_.size(); ++i)
+  {
+    coordinates_[i] = static_cast<int>(i) + 1;
+  }
+  coordinateIndex_.invalidate();
+  sites_.clear();
+}
+
+void OutOfCoreSiteContainer::setSiteCoordinates(const Vint& coordinates)
+{
+  if (coordinates.size() != getNumberOfSites())
+    throw BadSizeException("OutOfCoreSiteContainer::setSiteCoordinates bad size of coordinates vector", coordinates.size(), getNumberOfSites());
+  coordinates_ = coordinates;
+  coordinateIndex_.invalidate();
+  sites_.clear();
+}
+
+/******************************************************************************/
+
+size_t OutOfCoreSiteContainer::getSequencePosition(const string& sequenceKey) const
+{
+  auto it = positions_.find(sequenceKey);
+  if (it == positions_.end())
+    throw SequenceNotFoundException("OutOfCoreSiteContainer::getSequencePosition.", sequenceKey);
+  return it->second;
+}
+
+const string& OutOfCoreSiteContainer::sequenceKey(size_t sequencePosition) const
+{
+  if (sequencePosition >= getNumberOfSequences())
+    throw IndexOutOfBoundsException("OutOfCoreSiteContainer::sequenceKey.", sequencePosition, 0, getNumberOfSequences() - 1);
+  return sequenceKeys_[sequencePosition];
+}
+
+void OutOfCoreSiteContainer::setSequenceKeys(const vector<string>& sequenceKeys)
+{
+  if (sequenceKeys.size() != getNumberOfSequences())
+    throw DimensionException("OutOfCoreSiteContainer::setSequenceKeys : bad number of keys", sequenceKeys.size(), getNumberOfSequences());
+  sequenceKeys_ = sequenceKeys;
+  positions_.clear();
+  for (size_t i = 0; i < sequenceKeys_.size(); ++i)
+  {
+    positions_[sequenceKeys_[i]] = i;
+  }
+}
+
+void OutOfCoreSiteContainer::setSequenceNames(const vector<string>& names, bool updateKeys)
+{
+  if (names.size() != getNumberOfSequences())
+    throw DimensionException("OutOfCoreSiteContainer::setSequenceNames : bad number of names", names.size(), getNumberOfSequences());
+  sequenceNames_ = names;
+  sequences_.clear();
+  if (updateKeys)
+    setSequenceKeys(names);
+}
+
+/******************************************************************************/
+
+void OutOfCoreSiteContainer::clear()
+{
+  removeChunks_();
+  sequenceKeys_.clear();
+  sequenceNames_.clear();
+  sequenceComments_.clear();
+  positions_.clear();
+  coordinates_.clear();
+  coordinateIndex_.invalidate();
+  clearCache();
+}
+
+/******************************************************************************/
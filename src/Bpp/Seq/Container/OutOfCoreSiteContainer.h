@@ -0,0 +1,537 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_CONTAINER_OUTOFCORESITECONTAINER_H
+#define BPP_SEQ_CONTAINER_OUTOFCORESITECONTAINER_H
+
+#include <Bpp/Numeric/VectorTools.h>
+
+#include "../Site.h"
+#include "AbstractSequenceContainer.h"
+#include "SiteContainer.h"
+#include "SiteCoordinateIndex.h"
+#include "VectorSiteContainer.h"
+
+// From the STL:
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief A site container storing its sites on disk, for alignments larger than memory.
+ *
+ * Sites are stored in blocks of consecutive sites. The block being filled is
+ * kept in memory, and written to a file of its own (a chunk file) when it is
+ * full. Sites of complete blocks are read by memory-mapping their chunk file,
+ * and at most a given number of blocks are mapped at the same time: when
+ * this number is reached, the least recently used block is released. Only
+ * the sequence names and comments and the site coordinates are stored in
+ * memory.
+ *
+ * States are packed on one byte, site by site, so that only alphabets with
+ * less than 256 states (gaps and unknown characters included) can be used.
+ *
+ * Sites can only be added at the end of the container, and the number of
+ * sequences is fixed by the first site or by the constructor. Other edition
+ * methods throw a NotImplementedException. Chunk files are created in a
+ * given directory, the system temporary directory by default, and are
+ * removed when the container is destroyed or cleared.
+ *
+ * The Site and Sequence objects returned by site() and sequence() are built
+ * on demand, and kept in memory so that references remain valid until the
+ * container is modified (new sites, coordinates or names) or clearCache() is
+ * called. Sequences are read from all blocks, which is expensive. Algorithms
+ * working site by site, like most functions of SiteContainerTools, can be
+ * used directly, but all sites they access stay in memory, unpacked: with
+ * alignments larger than memory, clearCache() should be called regularly, or
+ * algorithms should work block by block, each block being loaded as a
+ * VectorSiteContainer (see getBlock() and BlockIterator).
+ *
+ * This container is not thread-safe, even for read-only methods.
+ *
+ * @see VectorSiteContainer
+ */
+class OutOfCoreSiteContainer :
+  public AbstractTemplateSequenceContainer<Sequence, std::string>,
+  public virtual TemplateSiteContainerInterface<Site, Sequence, std::string>
+{
+public:
+  /**
+   * @brief Iterate over the blocks of a container, each loaded as a VectorSiteContainer.
+   */
+  class BlockIterator
+  {
+  private:
+    const OutOfCoreSiteContainer* sites_;
+    size_t currentBlock_;
+
+  public:
+    BlockIterator(const OutOfCoreSiteContainer& sites) :
+      sites_(&sites),
+      currentBlock_(0)
+    {}
+
+    BlockIterator(const BlockIterator& it) :
+      sites_(it.sites_),
+      currentBlock_(it.currentBlock_)
+    {}
+
+    BlockIterator& operator=(const BlockIterator& it)
+    {
+      sites_ = it.sites_;
+      currentBlock_ = it.currentBlock_;
+      return *this;
+    }
+
+    virtual ~BlockIterator()
+    {}
+
+  public:
+    bool hasMoreBlocks() const
+    {
+      return currentBlock_ < sites_->getNumberOfBlocks();
+    }
+
+    std::unique_ptr<VectorSiteContainer> nextBlock()
+    {
+      return sites_->getBlock(currentBlock_++);
+    }
+  };
+
+private:
+  /**
+   * @brief A block of sites, in memory or in a chunk file.
+   */
+  struct Chunk_
+  {
+    std::string path = "";            // The chunk file, empty while the block is filled.
+    size_t nbSites = 0;
+    const uint8_t* data = nullptr;
+    bool mapped = false;
+    std::vector<uint8_t> buffer = {}; // The states of the block being filled, or of a loaded file without mmap.
+  };
+
+  std::string directory_;
+  std::string prefix_;
+  size_t blockSize_;
+  size_t maxLoadedBlocks_;
+  int offset_; // The state stored as 0.
+  std::vector<std::string> sequenceKeys_;
+  std::vector<std::string> sequenceNames_;
+  std::vector<Comments> sequenceComments_;
+  std::unordered_map<std::string, size_t> positions_;
+  Vint coordinates_;
+  mutable std::vector<Chunk_> chunks_;
+  mutable std::list<size_t> recentlyUsed_; // Loaded chunk files, the most recently used first.
+  mutable std::vector<std::list<size_t>::iterator> usePositions_;
+  mutable SiteCoordinateIndex coordinateIndex_;
+  mutable std::unordered_map<size_t, std::unique_ptr<Site>> sites_;         // Sites built on demand, by position.
+  mutable std::unordered_map<size_t, std::unique_ptr<Sequence>> sequences_; // Sequences built on demand, by position.
+
+public:
+  /**
+   * @brief Build a new empty container with specified sequence keys.
+   *
+   * @param sequenceKeys Sequence keys, also used as sequence names. This sets the number of
+   * sequences. If empty, it is set by the first site added, and sequences are named Seq_0, Seq_1, etc.
+   * @param alphabet The alphabet of the container.
+   * @param directory The directory where chunk files are written, the system temporary directory if empty.
+   * @param blockSize The number of sites per block, 0 to use blocks of about 16 MB.
+   * @param maxLoadedBlocks The maximum number of blocks mapped in memory at the same time, at least 1.
+   * @throw AlphabetException If the states of the alphabet can not be stored on one byte.
+   */
+  OutOfCoreSiteContainer(
+      const std::vector<std::string>& sequenceKeys,
+      std::shared_ptr<const Alphabet> alphabet,
+      const std::string& directory = "",
+      size_t blockSize = 0,
+      size_t maxLoadedBlocks = 4);
+
+  /**
+   * @brief Copy all sites of another container.
+   *
+   * @param sc The container to copy.
+   * @param directory The directory where chunk files are written, the system temporary directory if empty.
+   * @param blockSize The number of sites per block, 0 to use blocks of about 16 MB.
+   * @param maxLoadedBlocks The maximum number of blocks mapped in memory at the same time, at least 1.
+   */
+  OutOfCoreSiteContainer(
+      const SiteContainerInterface& sc,
+      const std::string& directory = "",
+      size_t blockSize = 0,
+      size_t maxLoadedBlocks = 4);
+
+  /**
+   * @brief Copy constructor. Sites are copied to new chunk files, in the same directory.
+   */
+  OutOfCoreSiteContainer(const OutOfCoreSiteContainer& sc);
+
+  OutOfCoreSiteContainer& operator=(const OutOfCoreSiteContainer& sc);
+
+  virtual ~OutOfCoreSiteContainer();
+
+public:
+  /**
+   * @name The Clonable interface.
+   *
+   * @{
+   */
+  OutOfCoreSiteContainer* clone() const override
+  {
+    return new OutOfCoreSiteContainer(*this);
+  }
+  /** @} */
+
+  /**
+   * @name The SiteContainer interface implementation:
+   *
+   * @{
+   */
+  const Site& site(size_t sitePosition) const override;
+
+  void setSite(size_t sitePosition, std::unique_ptr<Site>& site, bool checkCoordinate = true) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::setSite.");
+  }
+
+  std::unique_ptr<Site> removeSite(size_t sitePosition) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::removeSite.");
+  }
+
+  void deleteSite(size_t sitePosition) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::deleteSite.");
+  }
+
+  void addSite(std::unique_ptr<Site>& site, bool checkCoordinate = true) override;
+
+  void addSite(std::unique_ptr<Site>& site, size_t sitePosition, bool checkCoordinate = true) override
+  {
+    if (sitePosition != getNumberOfSites())
+      throw NotImplementedException("OutOfCoreSiteContainer::addSite. Sites can only be added at the end of the container.");
+    addSite(site, checkCoordinate);
+  }
+
+  void deleteSites(size_t sitePosition, size_t length) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::deleteSites.");
+  }
+
+  size_t getNumberOfSites() const override
+  {
+    return coordinates_.size();
+  }
+
+  void reindexSites() override;
+
+  Vint getSiteCoordinates() const override
+  {
+    return coordinates_;
+  }
+
+  void setSiteCoordinates(const Vint& coordinates) override;
+  /** @} */
+
+  /**
+   * @name The SequenceContainer interface.
+   *
+   * @{
+   */
+  const Sequence& sequence(size_t sequencePosition) const override;
+
+  const Sequence& sequence(const std::string& sequenceKey) const override
+  {
+    return sequence(getSequencePosition(sequenceKey));
+  }
+
+  bool hasSequence(const std::string& sequenceKey) const override
+  {
+    return positions_.find(sequenceKey) != positions_.end();
+  }
+
+  size_t getSequencePosition(const std::string& sequenceKey) const override;
+
+  std::unique_ptr<Sequence> removeSequence(size_t sequencePosition) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::removeSequence.");
+  }
+
+  std::unique_ptr<Sequence> removeSequence(const std::string& sequenceKey) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::removeSequence.");
+  }
+
+  void deleteSequence(size_t sequencePosition) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::deleteSequence.");
+  }
+
+  void deleteSequence(const std::string& sequenceKey) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::deleteSequence.");
+  }
+
+  size_t getNumberOfSequences() const override
+  {
+    return sequenceKeys_.size();
+  }
+
+  std::vector<std::string> getSequenceKeys() const override
+  {
+    return sequenceKeys_;
+  }
+
+  void setSequenceKeys(const std::vector<std::string>& sequenceKeys) override;
+
+  const std::string& sequenceKey(size_t sequencePosition) const override;
+
+  std::vector<std::string> getSequenceNames() const override
+  {
+    return sequenceNames_;
+  }
+
+  void setSequenceNames(const std::vector<std::string>& names, bool updateKeys) override;
+
+  std::vector<Comments> getSequenceComments() const override
+  {
+    return sequenceComments_;
+  }
+
+  /**
+   * @brief Remove all sites and sequences, and the chunk files.
+   */
+  void clear() override;
+
+  /**
+   * @return A new, empty, VectorSiteContainer.
+   */
+  VectorSiteContainer* createEmptyContainer() const override
+  {
+    auto vsc = new VectorSiteContainer(getAlphabet());
+    vsc->setComments(getComments());
+    return vsc;
+  }
+
+  void setSequence(size_t sequencePosition, std::unique_ptr<Sequence>& sequence, const std::string& sequenceKey) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::setSequence.");
+  }
+
+  void setSequence(size_t sequencePosition, std::unique_ptr<Sequence>& sequence) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::setSequence.");
+  }
+
+  void setSequence(const std::string& sequenceKey, std::unique_ptr<Sequence>& sequence) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::setSequence.");
+  }
+
+  void addSequence(const std::string& sequenceKey, std::unique_ptr<Sequence>& sequence) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::addSequence.");
+  }
+
+  void insertSequence(size_t sequencePosition, std::unique_ptr<Sequence>& sequence, const std::string& sequenceKey) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::insertSequence.");
+  }
+
+  const int& valueAt(const std::string& sequenceKey, size_t sitePosition) const override
+  {
+    return site(sitePosition)[getSequencePosition(sequenceKey)];
+  }
+
+  int& valueAt(const std::string& sequenceKey, size_t sitePosition) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::valueAt (non const).");
+  }
+
+  const int& valueAt(size_t sequencePosition, size_t sitePosition) const override
+  {
+    return site(sitePosition)[sequencePosition];
+  }
+
+  int& valueAt(size_t sequencePosition, size_t sitePosition) override
+  {
+    throw NotImplementedException("OutOfCoreSiteContainer::valueAt (non const).");
+  }
+  /** @} */
+
+  /**
+   * @name SequenceData methods.
+   *
+   * @{
+   */
+  double getStateValueAt(size_t sitePosition, const std::string& sequenceKey, int state) const override
+  {
+    return site(sitePosition).getStateValueAt(getSequencePosition(sequenceKey), state);
+  }
+
+  double operator()(size_t sitePosition, const std::string& sequenceKey, int state) const override
+  {
+    return site(sitePosition).getStateValueAt(getSequencePosition(sequenceKey), state);
+  }
+
+  double getStateValueAt(size_t sitePosition, size_t sequencePosition, int state) const override
+  {
+    return site(sitePosition).getStateValueAt(sequencePosition, state);
+  }
+
+  double operator()(size_t sitePosition, size_t sequencePosition, int state) const override
+  {
+    return site(sitePosition).getStateValueAt(sequencePosition, state);
+  }
+  /** @} */
+
+  /**
+   * @name Block access.
+   *
+   * @{
+   */
+
+  /**
+   * @return The number of sites per block.
+   */
+  size_t getBlockSize() const
+  {
+    return blockSize_;
+  }
+
+  /**
+   * @return The number of blocks, the last one being possibly incomplete.
+   */
+  size_t getNumberOfBlocks() const
+  {
+    return chunks_.size();
+  }
+
+  /**
+   * @brief Load a block of sites in memory.
+   *
+   * @param blockIndex The index of the block.
+   * @return A VectorSiteContainer with the sites of the block, and the sequence keys and names of this container.
+   */
+  std::unique_ptr<VectorSiteContainer> getBlock(size_t blockIndex) const;
+
+  /**
+   * @brief Copy a set of sites, loading each block only once.
+   *
+   * @param selection The positions of the sites, in any order, possibly repeated.
+   * @return The sites, in the order of the selection.
+   * @throw IndexOutOfBoundsException If a position is not a site of the container.
+   */
+  std::vector<std::unique_ptr<Site>> getSites(const std::vector<size_t>& selection) const;
+
+  /**
+   * @brief Get the packed states of a block.
+   *
+   * States are stored site by site, each state being stored minus getStateOffset().
+   * The pointer is valid until another block is loaded.
+   *
+   * @param blockIndex The index of the block.
+   * @return A pointer toward the states of the first site of the block.
+   */
+  const uint8_t* getBlockData(size_t blockIndex) const;
+
+  /**
+   * @return The state stored as 0 in packed blocks.
+   */
+  int getStateOffset() const
+  {
+    return offset_;
+  }
+
+  /**
+   * @return The maximum number of blocks mapped in memory at the same time.
+   */
+  size_t maxLoadedBlocks() const
+  {
+    return maxLoadedBlocks_;
+  }
+
+  /**
+   * @brief Set the maximum number of blocks mapped in memory at the same time.
+   *
+   * @param maxLoadedBlocks The number of blocks, at least 1.
+   */
+  void maxLoadedBlocks(size_t maxLoadedBlocks);
+
+  /**
+   * @return The number of chunk files currently mapped in memory.
+   */
+  size_t getNumberOfLoadedBlocks() const
+  {
+    return recentlyUsed_.size();
+  }
+
+  /**
+   * @return The number of Site and Sequence objects built by site() and sequence() and kept in memory.
+   */
+  size_t getNumberOfCachedObjects() const
+  {
+    return sites_.size() + sequences_.size();
+  }
+
+  /**
+   * @brief Free the Site and Sequence objects built by site() and sequence().
+   *
+   * All references previously returned by these methods become invalid.
+   */
+  void clearCache() const
+  {
+    sites_.clear();
+    sequences_.clear();
+  }
+  /** @} */
+
+private:
+  /**
+   * @brief Initialize the sequences and the packing of states.
+   */
+  void init_(const std::vector<std::string>& sequenceKeys);
+
+  /**
+   * @brief Build a site from its packed states.
+   */
+  std::unique_ptr<Site> createSite_(const uint8_t* data, size_t sitePosition) const;
+
+  /**
+   * @brief Write a full block to its chunk file, and release its memory.
+   */
+  void writeChunk_(size_t blockIndex);
+
+  /**
+   * @brief Map or release chunk files so that the given block is available.
+   */
+  void loadChunk_(size_t blockIndex) const;
+
+  /**
+   * @brief Release a chunk file from memory.
+   */
+  void unloadChunk_(size_t blockIndex) const;
+
+  /**
+   * @brief Release the least recently used chunk files until at most maxSize are loaded.
+   */
+  void shrinkLoadedChunks_(size_t maxSize) const;
+
+  /**
+   * @brief Remove all chunk files.
+   */
+  void removeChunks_();
+
+  /**
+   * @brief Append all sites of another container.
+   */
+  void appendSites_(const SiteContainerInterface& sc);
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_CONTAINER_OUTOFCORESITECONTAINER_H
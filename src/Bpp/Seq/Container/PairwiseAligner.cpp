@@ -0,0 +1,695 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include "../Alphabet/AlphabetExceptions.h"
+#include "PairwiseAligner.h"
+
+// From the STL:
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+using namespace bpp;
+using namespace std;
+
+const size_t PairwiseAligner::NO_BAND = numeric_limits<size_t>::max();
+
+namespace
+{
+// Larger scores and penalties are not converted to integers, to prevent overflows.
+const double MAX_INTEGER_SCORE = 1 << 20;
+
+template<class T>
+T infiniteCost()
+{
+  return numeric_limits<T>::infinity();
+}
+
+// Infinite costs are still summed with a few other costs, they must not overflow:
+template<>
+int32_t infiniteCost<int32_t>()
+{
+  return numeric_limits<int32_t>::max() / 4;
+}
+
+/**
+ * @brief Myers and Miller's linear space alignment, with costs of type T.
+ *
+ * The algorithm is written as a minimization of costs, which are the opposite of scores.
+ * Edit operations are 'M' for (mis)matches, 'D' for positions of the first sequence
+ * aligned with a gap, 'I' for positions of the second sequence aligned with a gap.
+ */
+template<class T>
+class LinearSpaceAligner
+{
+private:
+  const vector<size_t>& a_;
+  const vector<size_t>& b_;
+  size_t nbCodes_;
+  vector<T> costs_;
+  T g_;
+  T h_;
+
+  // Allowed values of j - i, where i and j are positions in the two sequences:
+  ptrdiff_t lo_;
+  ptrdiff_t hi_;
+
+  // Working memory:
+  vector<T> cc_, dd_, rr_, ss_, tmp_;
+  vector<size_t> sa_, sb_;
+  vector<char> ops_;
+
+public:
+  LinearSpaceAligner(
+      const vector<size_t>& a,
+      const vector<size_t>& b,
+      const vector<double>& scores,
+      double opening,
+      double extending,
+      size_t bandWidth) :
+    a_(a),
+    b_(b),
+    nbCodes_(static_cast<size_t>(sqrt(static_cast<double>(scores.size())) + 0.5)),
+    costs_(scores.size()),
+    g_(toCost_(opening)),
+    h_(toCost_(extending)),
+    lo_(),
+    hi_(),
+    cc_(), dd_(), rr_(), ss_(), tmp_(),
+    sa_(), sb_(),
+    ops_()
+  {
+    for (size_t k = 0; k < scores.size(); ++k)
+    {
+      costs_[k] = toCost_(scores[k]);
+    }
+    ptrdiff_t n1 = static_cast<ptrdiff_t>(a.size());
+    ptrdiff_t n2 = static_cast<ptrdiff_t>(b.size());
+    ptrdiff_t w = static_cast<ptrdiff_t>(min(bandWidth, a.size() + b.size()));
+    lo_ = min<ptrdiff_t>(0, n2 - n1) - w;
+    hi_ = max<ptrdiff_t>(0, n2 - n1) + w;
+  }
+
+public:
+  T getCost()
+  {
+    pass_(0, a_.size(), 0, b_.size(), g_, false, cc_, dd_);
+    return cc_[b_.size()];
+  }
+
+  /**
+   * @brief Compute the edit operations of the optimal global alignment of a[ai, ai + m[ with b[bj, bj + n[.
+   */
+  const vector<char>& getOperations(size_t ai, size_t m, size_t bj, size_t n)
+  {
+    ops_.clear();
+    ops_.reserve(m + n);
+    diff_(ai, m, bj, n, g_, g_);
+    return ops_;
+  }
+
+  /**
+   * @brief Compute the cost of the last edit operations computed, for an alignment starting at a[ai] and b[bj].
+   */
+  T getOperationsCost(size_t ai, size_t bj) const
+  {
+    T cost = 0;
+    char previous = 'M';
+    for (char op : ops_)
+    {
+      if (op == 'M')
+        cost += costs_[a_[ai++] * nbCodes_ + b_[bj++]];
+      else
+      {
+        cost += (op == previous ? 0 : g_) + h_;
+        if (op == 'D')
+          ++ai;
+        else
+          ++bj;
+      }
+      previous = op;
+    }
+    return cost;
+  }
+
+  /**
+   * @brief Find the best local alignment, or the best alignment of the whole sequence a
+   * with a subsequence of b if glocal is true.
+   *
+   * The end of the alignment is found with a forward pass, and its start with a reverse pass
+   * anchored at this end. The band is not used.
+   *
+   * @param begin1, end1, begin2, end2 [out] The aligned subsequences are a[begin1, end1[ and b[begin2, end2[.
+   * @return The cost of the alignment.
+   */
+  T getBestSubsequences(bool glocal, size_t& begin1, size_t& end1, size_t& begin2, size_t& end2)
+  {
+    size_t p, q;
+    T best = scan_(a_.size(), b_.size(), false, !glocal, true, glocal, p, q);
+    end1 = p;
+    end2 = q;
+    scan_(end1, end2, true, false, false, glocal, p, q);
+    begin1 = end1 - p;
+    begin2 = end2 - q;
+    return best;
+  }
+
+private:
+  static T toCost_(double score)
+  {
+    // Integer costs are rounded:
+    return is_integral<T>::value ? static_cast<T>(-llround(score)) : static_cast<T>(-score);
+  }
+
+  T gap_(size_t k) const
+  {
+    return k == 0 ? 0 : g_ + static_cast<T>(k) * h_;
+  }
+
+  /**
+   * @return True if position i of subsequence a can be aligned with position j of subsequence b,
+   * where d = j - i, and ai and bj are the starts of the subsequences.
+   */
+  bool isInBand_(size_t ai, size_t bj, ptrdiff_t d) const
+  {
+    ptrdiff_t diag = static_cast<ptrdiff_t>(bj) - static_cast<ptrdiff_t>(ai) + d;
+    return diag >= lo_ && diag <= hi_;
+  }
+
+  /**
+   * @brief Compute the last row of the cost matrices, for the alignment of a[ai, ai + m[ with b[bj, bj + n[,
+   * or of their reverses.
+   *
+   * @param tb Cost of opening a gap in b at the start of the alignment.
+   * @param cc [out] Costs of the optimal alignments of a with all prefixes of b.
+   * @param dd [out] Costs of the optimal alignments of a with all prefixes of b, ending with a gap in b.
+   */
+  void pass_(size_t ai, size_t m, size_t bj, size_t n, T tb, bool reverse, vector<T>& cc, vector<T>& dd)
+  {
+    const T inf = infiniteCost<T>();
+    sa_.resize(m);
+    for (size_t i = 0; i < m; ++i)
+    {
+      sa_[i] = reverse ? a_[ai + m - 1 - i] : a_[ai + i];
+    }
+    sb_.resize(n);
+    for (size_t j = 0; j < n; ++j)
+    {
+      sb_[j] = reverse ? b_[bj + n - 1 - j] : b_[bj + j];
+    }
+
+    // Band, in the coordinates of the subproblem:
+    ptrdiff_t offset = reverse ?
+        static_cast<ptrdiff_t>(bj + n) - static_cast<ptrdiff_t>(ai + m) :
+        static_cast<ptrdiff_t>(bj) - static_cast<ptrdiff_t>(ai);
+    ptrdiff_t lo = reverse ? offset - hi_ : lo_ - offset;
+    ptrdiff_t hi = reverse ? offset - lo_ : hi_ - offset;
+
+    // First row:
+    cc.resize(n + 1);
+    dd.resize(n + 1);
+    tmp_.resize(n + 1);
+    cc[0] = 0;
+    T t = g_;
+    for (size_t j = 1; j <= n; ++j)
+    {
+      t += h_;
+      cc[j] = t;
+      dd[j] = t + g_;
+    }
+    for (size_t j = 1; j <= n; ++j)
+    {
+      if (static_cast<ptrdiff_t>(j) > hi)
+        cc[j] = dd[j] = inf;
+    }
+
+    t = tb;
+    for (size_t i = 1; i <= m; ++i)
+    {
+      t += h_;
+      ptrdiff_t jlo = max<ptrdiff_t>(0, lo + static_cast<ptrdiff_t>(i));
+      size_t j0 = static_cast<size_t>(max<ptrdiff_t>(1, jlo));
+      size_t j1 = static_cast<size_t>(min<ptrdiff_t>(static_cast<ptrdiff_t>(n), hi + static_cast<ptrdiff_t>(i)));
+      const T* row = &costs_[sa_[i - 1] * nbCodes_];
+
+      // Diagonal and vertical moves only depend on the previous row:
+      for (size_t j = j0; j <= j1; ++j)
+      {
+        T d = min(dd[j], cc[j] + g_) + h_;
+        T s = cc[j - 1] + row[sb_[j - 1]];
+        dd[j] = d;
+        tmp_[j] = min(d, s);
+      }
+
+      // The cell at the left of the band is not reachable anymore:
+      if (jlo > 0)
+        cc[static_cast<size_t>(jlo - 1)] = dd[static_cast<size_t>(jlo - 1)] = inf;
+      if (jlo == 0)
+        cc[0] = t;
+
+      // Horizontal moves:
+      T c = cc[j0 - 1];
+      T e = inf;
+      for (size_t j = j0; j <= j1; ++j)
+      {
+        e = min(e, c + g_) + h_;
+        c = min(tmp_[j], e);
+        cc[j] = c;
+      }
+    }
+    dd[0] = cc[0];
+  }
+
+  /**
+   * @brief Find the best cell of the cost matrix, for the alignment of a[0, m[ with b[0, n[, or of their reverses.
+   *
+   * Costs are not banded, and all computed in linear memory.
+   *
+   * @param clip If true, costs are local alignment costs: they are never positive.
+   * @param freeLeading If true, leading gaps in b are free.
+   * @param lastRowOnly If true, the best cell is searched only in the last row, so that the whole subsequence a is aligned.
+   * @param bestI, bestJ [out] The position of the first best cell.
+   * @return The cost of the best cell.
+   */
+  T scan_(size_t m, size_t n, bool reverse, bool clip, bool freeLeading, bool lastRowOnly, size_t& bestI, size_t& bestJ)
+  {
+    const T inf = infiniteCost<T>();
+    sa_.resize(m);
+    for (size_t i = 0; i < m; ++i)
+    {
+      sa_[i] = reverse ? a_[m - 1 - i] : a_[i];
+    }
+    sb_.resize(n);
+    for (size_t j = 0; j < n; ++j)
+    {
+      sb_[j] = reverse ? b_[n - 1 - j] : b_[j];
+    }
+
+    // First row:
+    cc_.resize(n + 1);
+    dd_.resize(n + 1);
+    tmp_.resize(n + 1);
+    for (size_t j = 0; j <= n; ++j)
+    {
+      cc_[j] = freeLeading ? 0 : gap_(j);
+      dd_[j] = inf;
+    }
+    T best = 0;
+    bestI = bestJ = 0;
+    if (lastRowOnly && m == 0)
+      best = *min_element(cc_.begin(), cc_.end());
+
+    for (size_t i = 1; i <= m; ++i)
+    {
+      const T* row = &costs_[sa_[i - 1] * nbCodes_];
+
+      // Diagonal and vertical moves only depend on the previous row:
+      for (size_t j = 1; j <= n; ++j)
+      {
+        T d = min(dd_[j], cc_[j] + g_) + h_;
+        T s = cc_[j - 1] + row[sb_[j - 1]];
+        dd_[j] = d;
+        tmp_[j] = min(d, s);
+      }
+      cc_[0] = clip ? 0 : gap_(i);
+
+      // Horizontal moves:
+      T c = cc_[0];
+      T e = inf;
+      for (size_t j = 1; j <= n; ++j)
+      {
+        e = min(e, c + g_) + h_;
+        c = min(tmp_[j], e);
+        if (clip)
+          c = min<T>(c, 0);
+        cc_[j] = c;
+      }
+
+      if (!lastRowOnly || i == m)
+      {
+        for (size_t j = (lastRowOnly ? 0 : 1); j <= n; ++j)
+        {
+          if (cc_[j] < best || (lastRowOnly && j == 0))
+          {
+            best = cc_[j];
+            bestI = i;
+            bestJ = j;
+          }
+        }
+      }
+    }
+    return best;
+  }
+
+  /**
+   * @brief Recursively align a[ai, ai + m[ with b[bj, bj + n[.
+   *
+   * @param tb Cost of opening a gap in b at the start of the alignment (0 if it extends a previous gap).
+   * @param te Cost of opening a gap in b at the end of the alignment (0 if it is extended by a next gap).
+   */
+  void diff_(size_t ai, size_t m, size_t bj, size_t n, T tb, T te)
+  {
+    if (n == 0)
+    {
+      ops_.insert(ops_.end(), m, 'D');
+      return;
+    }
+    if (m == 0)
+    {
+      ops_.insert(ops_.end(), n, 'I');
+      return;
+    }
+    if (m == 1)
+    {
+      // Align a[ai] with one position of b, or with a gap:
+      const T* row = &costs_[a_[ai] * nbCodes_];
+      T best = infiniteCost<T>();
+      size_t midj = 0;
+      for (size_t j = 1; j <= n; ++j)
+      {
+        if (!isInBand_(ai, bj, static_cast<ptrdiff_t>(j) - 1))
+          continue;
+        T c = gap_(j - 1) + row[b_[bj + j - 1]] + gap_(n - j);
+        if (c < best)
+        {
+          best = c;
+          midj = j;
+        }
+      }
+      bool deletionFirst = false;
+      bool insertionFirst = false;
+      if (isInBand_(ai, bj, -1) && tb + h_ + gap_(n) < best)
+      {
+        best = tb + h_ + gap_(n);
+        deletionFirst = true;
+      }
+      if (isInBand_(ai, bj, static_cast<ptrdiff_t>(n)) && te + h_ + gap_(n) < best)
+      {
+        deletionFirst = false;
+        insertionFirst = true;
+      }
+
+      if (deletionFirst)
+      {
+        ops_.push_back('D');
+        ops_.insert(ops_.end(), n, 'I');
+      }
+      else if (insertionFirst)
+      {
+        ops_.insert(ops_.end(), n, 'I');
+        ops_.push_back('D');
+      }
+      else
+      {
+        ops_.insert(ops_.end(), midj - 1, 'I');
+        ops_.push_back('M');
+        ops_.insert(ops_.end(), n - midj, 'I');
+      }
+      return;
+    }
+
+    // Find where the optimal alignment crosses the middle row:
+    size_t midi = m / 2;
+    pass_(ai, midi, bj, n, tb, false, cc_, dd_);
+    pass_(ai + midi, m - midi, bj, n, te, true, rr_, ss_);
+    T best = infiniteCost<T>();
+    size_t midj = 0;
+    bool joinedGaps = false;
+    for (size_t j = 0; j <= n; ++j)
+    {
+      T c = cc_[j] + rr_[n - j];
+      if (j == 0 || c < best)
+      {
+        best = c;
+        midj = j;
+      }
+    }
+    for (size_t j = 0; j <= n; ++j)
+    {
+      T c = dd_[j] + ss_[n - j] - g_;
+      if (c < best)
+      {
+        best = c;
+        midj = j;
+        joinedGaps = true;
+      }
+    }
+
+    if (joinedGaps)
+    {
+      // a[ai + midi - 1] and a[ai + midi] are both in a gap:
+      diff_(ai, midi - 1, bj, midj, tb, 0);
+      ops_.push_back('D');
+      ops_.push_back('D');
+      diff_(ai + midi + 1, m - midi - 1, bj + midj, n - midj, 0, te);
+    }
+    else
+    {
+      diff_(ai, midi, bj, midj, tb, g_);
+      diff_(ai + midi, m - midi, bj + midj, n - midj, g_, te);
+    }
+  }
+};
+
+bool isIntegerScore(double score)
+{
+  return std::floor(score) == score && std::abs(score) <= MAX_INTEGER_SCORE;
+}
+
+/**
+ * @brief Compute the score and positions of an alignment with costs of type T.
+ *
+ * @return The edit operations of the alignment, if traceback is true.
+ */
+template<class T>
+vector<char> alignCodes(
+    const vector<size_t>& codes1,
+    const vector<size_t>& codes2,
+    const vector<double>& scores,
+    double opening,
+    double extending,
+    size_t bandWidth,
+    PairwiseAligner::Mode mode,
+    bool traceback,
+    PairwiseAligner::Result& result)
+{
+  bool global = (mode == PairwiseAligner::Mode::GLOBAL);
+  LinearSpaceAligner<T> aligner(codes1, codes2, scores, opening, extending, global ? bandWidth : PairwiseAligner::NO_BAND);
+  T cost = 0;
+  if (global)
+  {
+    result.begin1 = result.begin2 = 0;
+    result.end1 = codes1.size();
+    result.end2 = codes2.size();
+    if (!traceback)
+      cost = aligner.getCost();
+  }
+  else
+  {
+    cost = aligner.getBestSubsequences(mode == PairwiseAligner::Mode::GLOCAL, result.begin1, result.end1, result.begin2, result.end2);
+  }
+  vector<char> ops;
+  if (traceback)
+  {
+    ops = aligner.getOperations(result.begin1, result.end1 - result.begin1, result.begin2, result.end2 - result.begin2);
+    // The cost of a global alignment is computed from its operations, which saves a pass:
+    if (global)
+      cost = aligner.getOperationsCost(result.begin1, result.begin2);
+  }
+  result.score = -static_cast<double>(cost);
+  return ops;
+}
+}
+
+/******************************************************************************/
+
+void PairwiseAligner::checkAlphabets_(
+    const Sequence& seq1,
+    const Sequence& seq2) const
+{
+  if (!seq1.getAlphabet()->isCompatibleWith(*seq2.getAlphabet()))
+    throw AlphabetMismatchException("PairwiseAligner::align", seq1.getAlphabet(), seq2.getAlphabet());
+  if (!seq1.getAlphabet()->isCompatibleWith(*score_->getAlphabet()))
+    throw AlphabetMismatchException("PairwiseAligner::align", seq1.getAlphabet(), score_->getAlphabet());
+}
+
+/******************************************************************************/
+
+bool PairwiseAligner::encode_(
+    const Sequence& seq1,
+    const Sequence& seq2,
+    vector<size_t>& codes1,
+    vector<size_t>& codes2,
+    vector<int>& states,
+    vector<double>& scores) const
+{
+  checkAlphabets_(seq1, seq2);
+
+  const Alphabet& alpha = seq1.alphabet();
+  map<int, size_t> index;
+  states.clear();
+  const Sequence* seqs[2] = { &seq1, &seq2 };
+  vector<size_t>* codes[2] = { &codes1, &codes2 };
+  for (size_t k = 0; k < 2; ++k)
+  {
+    codes[k]->clear();
+    codes[k]->reserve(seqs[k]->size());
+    for (int state : seqs[k]->getContent())
+    {
+      if (alpha.isGap(state))
+        continue;
+      auto it = index.find(state);
+      if (it == index.end())
+      {
+        it = index.insert(make_pair(state, states.size())).first;
+        states.push_back(state);
+      }
+      codes[k]->push_back(it->second);
+    }
+  }
+
+  // Scores of all pairs of states:
+  size_t nbCodes = states.size();
+  scores.resize(nbCodes * nbCodes);
+  bool integerScores = isIntegerScore(opening_) && isIntegerScore(extending_);
+  double maxScore = max(abs(opening_), abs(extending_));
+  for (size_t x = 0; x < nbCodes; ++x)
+  {
+    for (size_t y = 0; y < nbCodes; ++y)
+    {
+      scores[x * nbCodes + y] = score_->getIndex(states[x], states[y]);
+      integerScores = integerScores && isIntegerScore(scores[x * nbCodes + y]);
+      maxScore = max(maxScore, abs(scores[x * nbCodes + y]));
+    }
+  }
+
+  // Costs of all alignments must fit in 32 bits integers:
+  double nbSteps = static_cast<double>(codes1.size() + codes2.size() + 2);
+  return integerScores && 2 * maxScore * nbSteps <= static_cast<double>(infiniteCost<int32_t>());
+}
+
+/******************************************************************************/
+
+PairwiseAligner::Result PairwiseAligner::compute(
+    const Sequence& seq1,
+    const Sequence& seq2,
+    bool traceback) const
+{
+  vector<size_t> codes1, codes2;
+  vector<int> states;
+  vector<double> scores;
+  Result result;
+  vector<char> ops;
+  if (encode_(seq1, seq2, codes1, codes2, states, scores))
+    ops = alignCodes<int32_t>(codes1, codes2, scores, opening_, extending_, bandWidth_, mode_, traceback, result);
+  else
+    ops = alignCodes<double>(codes1, codes2, scores, opening_, extending_, bandWidth_, mode_, traceback, result);
+  if (!traceback)
+    return result;
+
+  // Build the aligned sequences:
+  int gapCode = seq1.getAlphabet()->getGapCharacterCode();
+  vector<int> content1, content2;
+  content1.reserve(ops.size());
+  content2.reserve(ops.size());
+  size_t i = result.begin1, j = result.begin2;
+  for (char op : ops)
+  {
+    content1.push_back(op == 'I' ? gapCode : states[codes1[i++]]);
+    content2.push_back(op == 'D' ? gapCode : states[codes2[j++]]);
+  }
+  unique_ptr<Sequence> s1(seq1.clone());
+  s1->setContent(content1);
+  unique_ptr<Sequence> s2(seq2.clone());
+  s2->setContent(content2);
+  auto alphaPtr = s1->getAlphabet();
+  result.alignment = make_unique<AlignedSequenceContainer>(alphaPtr);
+  result.alignment->addSequence(s1->getName(), s1);
+  result.alignment->addSequence(s2->getName(), s2);
+  return result;
+}
+
+/******************************************************************************/
+
+unique_ptr<AlignedSequenceContainer> PairwiseAligner::align(
+    const Sequence& seq1,
+    const Sequence& seq2) const
+{
+  return std::move(compute(seq1, seq2, true).alignment);
+}
+
+/******************************************************************************/
+
+double PairwiseAligner::getAlignmentScore(
+    const Sequence& seq1,
+    const Sequence& seq2) const
+{
+  return compute(seq1, seq2, false).score;
+}
+
+/******************************************************************************/
+
+vector<PairwiseAligner::Result> PairwiseAligner::computeAll(
+    const Sequence& query,
+    const SequenceContainerInterface& targets,
+    bool traceback,
+    unsigned int nbThreads) const
+{
+  // Sequences are retrieved first, as containers may build them on the fly:
+  size_t n = targets.getNumberOfSequences();
+  vector<const Sequence*> seqs(n);
+  for (size_t k = 0; k < n; ++k)
+  {
+    seqs[k] = &targets.sequence(k);
+    checkAlphabets_(query, *seqs[k]);
+  }
+
+  vector<Result> results(n);
+  atomic<size_t> next(0);
+  exception_ptr error;
+  mutex errorMutex;
+  auto worker = [&]()
+  {
+    try
+    {
+      size_t k;
+      while ((k = next++) < n)
+      {
+        results[k] = compute(query, *seqs[k], traceback);
+      }
+    }
+    catch (...)
+    {
+      // Keep the first error, and stop the other workers:
+      lock_guard<mutex> lock(errorMutex);
+      if (!error)
+        error = current_exception();
+      next = n;
+    }
+  };
+
+  if (nbThreads == 0)
+    nbThreads = max(thread::hardware_concurrency(), 1u);
+  nbThreads = static_cast<unsigned int>(min(static_cast<size_t>(nbThreads), max<size_t>(n, 1)));
+  vector<thread> threads;
+  for (unsigned int k = 1; k < nbThreads; ++k)
+  {
+    threads.push_back(thread(worker));
+  }
+  worker();
+  for (auto& th : threads)
+  {
+    th.join();
+  }
+  if (error)
+    rethrow_exception(error);
+  return results;
+}
@@ -0,0 +1,248 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_CONTAINER_PAIRWISEALIGNER_H
+#define BPP_SEQ_CONTAINER_PAIRWISEALIGNER_H
+
+#include "../AlphabetIndex/AlphabetIndex2.h"
+#include "../Sequence.h"
+#include "AlignedSequenceContainer.h"
+#include "SequenceContainer.h"
+
+// From the STL:
+#include <memory>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief Pairwise alignment of sequences in linear memory.
+ *
+ * This class computes optimal alignments with affine gap penalties: a gap of
+ * length \f$k\f$ scores \f$o + k \times e\f$, where \f$o\f$ is the gap
+ * opening penalty and \f$e\f$ the gap extension penalty. Linear gap
+ * penalties are obtained with \f$o = 0\f$.
+ *
+ * Three modes are available:
+ * - Mode::GLOBAL (the default) aligns the complete sequences (Needleman and Wunsch),
+ * - Mode::LOCAL finds the best alignment between any subsequences of the two sequences (Smith and Waterman),
+ *   an empty alignment being returned if no pair of positions has a positive score,
+ * - Mode::GLOCAL aligns the complete first sequence with a subsequence of the second one,
+ *   that is, gaps at the ends of the second sequence are free. This is typically used to
+ *   map a read or a motif on a longer reference.
+ *
+ * In local modes, the end of the best alignment is found with a first pass
+ * over the matrices, and its start with a second, reverse pass. The subsequences
+ * are then globally aligned.
+ *
+ * The alignment is recovered with the divide and conquer algorithm of
+ * Hirschberg, extended to affine gaps by Myers and Miller (1988): only
+ * two rows of the dynamic programming matrices are stored, so that the
+ * memory used is linear in the length of the sequences, for about twice
+ * the computation time of a full matrix.
+ *
+ * Scores of all pairs of states found in the sequences are computed once
+ * before the alignment. When all scores and penalties are integers, the
+ * dynamic programming is done with 32 bits integers, otherwise with
+ * doubles. Each row of the matrices is computed in two passes: cells
+ * depending only on the previous row are computed first in a loop without
+ * dependency between iterations, that the compiler can vectorize, the
+ * horizontal gaps are then propagated in a second pass.
+ *
+ * Optionally, the alignment can be restricted to a band around the main
+ * diagonal of the matrix. With a band width \f$w\f$, position \f$i\f$ of
+ * the first sequence can only be aligned with positions \f$j\f$ of the
+ * second sequence such that
+ * \f$\min(0, n_2 - n_1) - w \leq j - i \leq \max(0, n_2 - n_1) + w\f$,
+ * where \f$n_1\f$ and \f$n_2\f$ are the lengths of the sequences. The
+ * computation time is then linear in the length of the sequences.
+ * The band is only used in global mode.
+ *
+ * If the input sequences contain gaps, they are ignored.
+ *
+ * Many sequences can be aligned with the same query in parallel, see
+ * computeAll.
+ *
+ * References:
+ * - Myers E. W. and Miller W. (1988) Optimal alignments in linear space.
+ *   Computer Applications in the Biosciences 4(1):11-17.
+ * - Huang X. and Miller W. (1991) A time-efficient, linear-space local similarity algorithm.
+ *   Advances in Applied Mathematics 12(3):337-357.
+ *
+ * @see SiteContainerTools::alignNW, SiteContainerTools::alignSW
+ */
+class PairwiseAligner
+{
+public:
+  /**
+   * @brief Value of the band width when the alignment is not banded.
+   */
+  static const size_t NO_BAND;
+
+  /**
+   * @brief Alignment modes.
+   */
+  enum class Mode
+  {
+    GLOBAL,
+    LOCAL,
+    GLOCAL
+  };
+
+  /**
+   * @brief Result of the alignment of two sequences.
+   *
+   * Positions refer to the sequences without their gaps, if any.
+   * The aligned subsequences are seq1[begin1, end1[ and seq2[begin2, end2[.
+   */
+  struct Result
+  {
+    double score = 0;
+    size_t begin1 = 0;
+    size_t end1 = 0;
+    size_t begin2 = 0;
+    size_t end2 = 0;
+
+    /**
+     * @brief The aligned subsequences, if the traceback was requested.
+     */
+    std::unique_ptr<AlignedSequenceContainer> alignment = nullptr;
+  };
+
+private:
+  std::shared_ptr<const AlphabetIndex2> score_;
+  double opening_;
+  double extending_;
+  size_t bandWidth_;
+  Mode mode_;
+
+public:
+  /**
+   * @brief Build a new aligner.
+   *
+   * @param score The score matrix to use (it is copied).
+   * @param opening Gap opening penalty.
+   * @param extending Gap extension penalty.
+   * @param bandWidth The width of the band, or NO_BAND for a full alignment.
+   * @param mode The alignment mode.
+   */
+  PairwiseAligner(
+      const AlphabetIndex2& score,
+      double opening,
+      double extending,
+      size_t bandWidth = NO_BAND,
+      Mode mode = Mode::GLOBAL) :
+    score_(score.clone()),
+    opening_(opening),
+    extending_(extending),
+    bandWidth_(bandWidth),
+    mode_(mode)
+  {}
+
+  virtual ~PairwiseAligner() {}
+
+public:
+  const AlphabetIndex2& getScore() const { return *score_; }
+
+  double getGapOpeningPenalty() const { return opening_; }
+
+  double getGapExtensionPenalty() const { return extending_; }
+
+  size_t getBandWidth() const { return bandWidth_; }
+
+  void setBandWidth(size_t bandWidth) { bandWidth_ = bandWidth; }
+
+  Mode getMode() const { return mode_; }
+
+  void setMode(Mode mode) { mode_ = mode; }
+
+  /**
+   * @brief Align two sequences.
+   *
+   * In local modes, only the aligned subsequences are returned.
+   *
+   * @param seq1 The first sequence.
+   * @param seq2 The second sequence.
+   * @return A new container with the two aligned sequences.
+   * @throw AlphabetMismatchException If the sequences and the score matrix do not share the same alphabet.
+   */
+  std::unique_ptr<AlignedSequenceContainer> align(
+      const Sequence& seq1,
+      const Sequence& seq2) const;
+
+  /**
+   * @brief Compute the score of the optimal alignment of two sequences, without the alignment itself.
+   *
+   * @param seq1 The first sequence.
+   * @param seq2 The second sequence.
+   * @return The score of the optimal alignment.
+   * @throw AlphabetMismatchException If the sequences and the score matrix do not share the same alphabet.
+   */
+  double getAlignmentScore(
+      const Sequence& seq1,
+      const Sequence& seq2) const;
+
+  /**
+   * @brief Align two sequences, and get the score and positions of the alignment.
+   *
+   * @param seq1 The first sequence.
+   * @param seq2 The second sequence.
+   * @param traceback If false, the alignment itself is not computed, which is faster.
+   * @return The result of the alignment.
+   * @throw AlphabetMismatchException If the sequences and the score matrix do not share the same alphabet.
+   */
+  Result compute(
+      const Sequence& seq1,
+      const Sequence& seq2,
+      bool traceback = true) const;
+
+  /**
+   * @brief Align a query with all sequences of a container, in parallel.
+   *
+   * The query is the first sequence of each alignment.
+   *
+   * @param query The query sequence.
+   * @param targets The sequences to align with the query.
+   * @param traceback If false, only scores and positions are computed.
+   * @param nbThreads The number of threads to use, or 0 to use all the cores of the machine.
+   * @return The results of the alignments, in the order of the container.
+   * @throw AlphabetMismatchException If the sequences and the score matrix do not share the same alphabet.
+   * @throw Exception Any error raised by an alignment, once all threads are stopped.
+   */
+  std::vector<Result> computeAll(
+      const Sequence& query,
+      const SequenceContainerInterface& targets,
+      bool traceback = false,
+      unsigned int nbThreads = 0) const;
+
+private:
+  /**
+   * @throw AlphabetMismatchException If the sequences and the score matrix do not share the same alphabet.
+   */
+  void checkAlphabets_(
+      const Sequence& seq1,
+      const Sequence& seq2) const;
+
+  /**
+   * @brief Check the alphabets, convert the states of the sequences into dense codes,
+   * and compute the scores of all pairs of codes.
+   *
+   * @param seq1 The first sequence.
+   * @param seq2 The second sequence.
+   * @param codes1 [out] The codes of the non-gap states of the first sequence.
+   * @param codes2 [out] The codes of the non-gap states of the second sequence.
+   * @param states [out] The state corresponding to each code.
+   * @param scores [out] The score of each pair of codes, as a square matrix stored by rows.
+   * @return True if all scores and penalties are integers.
+   */
+  bool encode_(
+      const Sequence& seq1,
+      const Sequence& seq2,
+      std::vector<size_t>& codes1,
+      std::vector<size_t>& codes2,
+      std::vector<int>& states,
+      std::vector<double>& scores) const;
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_CONTAINER_PAIRWISEALIGNER_H
@@ -272,13 +272,16 @@ public:
    */
   static void getCounts(const SequenceContainerInterface& sc, std::map<int, unsigned int>& f)
   {
+    std::vector<unsigned int> counts;
     for (size_t i = 0; i < sc.getNumberOfSequences(); ++i)
     {
-      const Sequence& seq = sc.sequence(i);
-      for (size_t j = 0; j < seq.size(); ++j)
-      {
-        f[seq[j]]++;
-      }
+      SymbolListTools::getDenseCounts(sc.sequence(i), counts);
+    }
+    int offset = SymbolListTools::getDenseCountsOffset(*sc.getAlphabet());
+    for (size_t k = 0; k < counts.size(); ++k)
+    {
+      if (counts[k] != 0)
+        f[static_cast<int>(k) + offset] += counts[k];
     }
   }
 
@@ -301,12 +304,19 @@ public:
       double pseudoCount = 0)
   {
     double n = 0;
+    std::vector<double> counts;
     for (size_t i = 0; i < sc.getNumberOfSequences(); ++i)
     {
       const Sequence& seq = sc.sequence(i);
-      SymbolListTools::getCounts(seq, f, true);
+      SymbolListTools::getDenseCountsResolveUnknowns(seq, counts);
       n += static_cast<double>(seq.size());
     }
+    int offset = SymbolListTools::getDenseCountsOffset(*sc.getAlphabet());
+    for (size_t k = 0; k < counts.size(); ++k)
+    {
+      if (counts[k] != 0)
+        f[static_cast<int>(k) + offset] += counts[k];
+    }
 
     if (pseudoCount != 0)
     {
@@ -343,12 +353,22 @@ public:
       double pseudoCount = 0)
   {
     double n = 0;
+    std::vector<double> counts;
     for (size_t i = 0; i < sc.getNumberOfSequences(); ++i)
     {
       const ProbabilisticSequence& seq = sc.sequence(i);
-      SymbolListTools::getCounts(seq, f, true);
+      SymbolListTools::getDenseCountsResolveUnknowns(seq, counts);
       n += static_cast<double>(seq.size());
     }
+    // All resolved states are reported, as in the probability vectors:
+    int offset = SymbolListTools::getDenseCountsOffset(*sc.getAlphabet());
+    int size = static_cast<int>(sc.getAlphabet()->getSize());
+    for (size_t k = 0; k < counts.size(); ++k)
+    {
+      int state = static_cast<int>(k) + offset;
+      if (counts[k] != 0 || (state >= 0 && state < size))
+        f[state] += counts[k];
+    }
 
     if (pseudoCount != 0)
     {
@@ -432,7 +452,7 @@ public:
       const TemplateSequenceContainerInterface<SequenceType, HashType>& seqCont2,
       TemplateSequenceContainerInterface<SequenceType, HashType>& outputCont)
   {
-    if (seqCont1.getAlphabet()->getAlphabetType() != seqCont2.getAlphabet()->getAlphabetType())
+    if (!seqCont1.getAlphabet()->isCompatibleWith(*seqCont2.getAlphabet()))
       throw AlphabetMismatchException("SequenceContainerTools::mergeByKey.", seqCont1.getAlphabet(), seqCont2.getAlphabet());
 
     for (const auto& key: seqCont1.getSequenceKeys())
@@ -11,6 +11,7 @@
 #include "../SymbolListTools.h"
 #include "SequenceContainerTools.h"
 #include "SiteContainerIterator.h"
+#include "PairwiseAligner.h"
 #include "SiteContainerTools.h"
 #include "VectorSiteContainer.h"
 
@@ -20,6 +21,10 @@ using namespace bpp;
 #include <vector>
 #include <deque>
 #include <string>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
 
 using namespace std;
 
@@ -34,33 +39,21 @@ unique_ptr<Sequence> SiteContainerTools::getConsensus(
   Vint consensus;
   SimpleSiteContainerIterator ssi(sc);
   const Site* site;
+  int offset = SiteTools::getDenseCountsOffset(*sc.getAlphabet());
+  vector<double> freq;
   while (ssi.hasMoreSites())
   {
     site = &ssi.nextSite();
-    map<int, double> freq;
-    SiteTools::getFrequencies(*site, freq, resolveUnknown);
+    SiteTools::getDenseFrequencies(*site, freq, resolveUnknown);
     double max = 0;
     int cons = -1; // default result
-    if (ignoreGap)
+    for (size_t k = 0; k < freq.size(); ++k)
     {
-      for (auto& it : freq)
+      int state = static_cast<int>(k) + offset;
+      if (freq[k] > max && (!ignoreGap || state != -1))
       {
-        if (it.second > max && it.first != -1)
-        {
-          max = it.second;
-          cons = it.first;
-        }
-      }
-    }
-    else
-    {
-      for (auto& it : freq)
-      {
-        if (it.second > max)
-        {
-          max = it.second;
-          cons = it.first;
-        }
+        max = freq[k];
+        cons = state;
       }
     }
     consensus.push_back(cons);
@@ -81,32 +74,38 @@ unique_ptr<Sequence> SiteContainerTools::sampleSequence(
   Vint consensus;
   SimpleSiteContainerIterator ssi(sc);
   const Site* site;
+  int offset = SiteTools::getDenseCountsOffset(*sc.getAlphabet());
+  vector<double> freq;
   while (ssi.hasMoreSites())
   {
     site = &ssi.nextSite();
-    map<int, double> freq;
-    SiteTools::getFrequencies(*site, freq, resolveUnknown);
-    if (ignoreGap) // Mgmt of gaps, if requested
+    SiteTools::getDenseFrequencies(*site, freq, resolveUnknown);
+    if (ignoreGap && offset <= -1) // Mgmt of gaps, if requested
     {
-      const auto& it = freq.find(-1);
-      if (it != freq.end())
+      size_t gap = static_cast<size_t>(-1 - offset);
+      double v = 1 - freq[gap];
+      if (v == 0)
       {
-        double v = 1 - it->second;
-        freq.erase(-1);
-        for (auto& itm : freq)
-        {
-          itm.second /= v;
-        }
+        // Gap-only site:
+        consensus.push_back(-1);
+        continue;
+      }
+      freq[gap] = 0;
+      for (auto& f : freq)
+      {
+        f /= v;
       }
     }
 
     int cons = -1; // default result
     double max = RandomTools::giveRandomNumberBetweenZeroAndEntry(1.);
-    for (auto& it : freq)
+    for (size_t k = 0; k < freq.size(); ++k)
     {
-      max -= it.second;
-      if (!ignoreGap || it.first != -1)
-        cons = it.first;
+      // Only observed states can be sampled:
+      if (freq[k] == 0)
+        continue;
+      max -= freq[k];
+      cons = static_cast<int>(k) + offset;
       if (max <= 0)
         break;
     }
@@ -288,7 +287,7 @@ std::map<size_t, size_t> SiteContainerTools::getAlignmentPositions(const Sequenc
 
 std::map<size_t, size_t> SiteContainerTools::translateAlignment(const Sequence& seq1, const Sequence& seq2)
 {
-  if (seq1.getAlphabet()->getAlphabetType() != seq2.getAlphabet()->getAlphabetType())
+  if (!seq1.getAlphabet()->isCompatibleWith(*seq2.getAlphabet()))
     throw AlphabetMismatchException("SiteContainerTools::translateAlignment", seq1.getAlphabet(), seq2.getAlphabet());
   map<size_t, size_t> tln;
   if (seq1.size() == 0)
@@ -386,96 +385,12 @@ std::unique_ptr<AlignedSequenceContainer> SiteContainerTools::alignNW(
     const AlphabetIndex2& s,
     double gap)
 {
-  if (seq1.getAlphabet()->getAlphabetType() != seq2.getAlphabet()->getAlphabetType())
+  if (!seq1.getAlphabet()->isCompatibleWith(*seq2.getAlphabet()))
     throw AlphabetMismatchException("SiteContainerTools::alignNW", seq1.getAlphabet(), seq2.getAlphabet());
-  if (seq1.getAlphabet()->getAlphabetType() != s.getAlphabet()->getAlphabetType())
+  if (!seq1.getAlphabet()->isCompatibleWith(*s.getAlphabet()))
     throw AlphabetMismatchException("SiteContainerTools::alignNW", seq1.getAlphabet(), s.getAlphabet());
-  // Check that sequences have no gap!
-  unique_ptr<Sequence> s1(seq1.clone());
-  SequenceTools::removeGaps(*s1);
-  unique_ptr<Sequence> s2(seq2.clone());
-  SequenceTools::removeGaps(*s2);
-
-  // 1) Initialize matrix:
-  RowMatrix<double> m(s1->size() + 1, s2->size() + 1);
-  RowMatrix<char>   p(s1->size(), s2->size());
-  double choice1, choice2, choice3, mx;
-  char px;
-  for (size_t i = 0; i <= s1->size(); i++)
-  {
-    m(i, 0) = static_cast<double>(i) * gap;
-  }
-  for (size_t j = 0; j <= s2->size(); j++)
-  {
-    m(0, j) = static_cast<double>(j) * gap;
-  }
-  for (size_t i = 1; i <= s1->size(); i++)
-  {
-    for (size_t j = 1; j <= s2->size(); j++)
-    {
-      choice1 = m(i - 1, j - 1) + static_cast<double>(s.getIndex((*s1)[i - 1], (*s2)[j - 1]));
-      choice2 = m(i - 1, j) + gap;
-      choice3 = m(i, j - 1) + gap;
-      mx = choice1; px = 'd'; // Default in case of equality of scores.
-      if (choice2 > mx)
-      {
-        mx = choice2; px = 'u';
-      }
-      if (choice3 > mx)
-      {
-        mx = choice3; px = 'l';
-      }
-      m(i, j) = mx;
-      p(i - 1, j - 1) = px;
-    }
-  }
-
-  // 2) Get alignment:
-  deque<int> a1, a2;
-  size_t i = s1->size(), j = s2->size();
-  char c;
-  while (i > 0 && j > 0)
-  {
-    c = p(i - 1, j - 1);
-    if (c == 'd')
-    {
-      a1.push_front((*s1)[i - 1]);
-      a2.push_front((*s2)[j - 1]);
-      i--;
-      j--;
-    }
-    else if (c == 'u')
-    {
-      a1.push_front((*s1)[i - 1]);
-      a2.push_front(-1);
-      i--;
-    }
-    else
-    {
-      a1.push_front(-1);
-      a2.push_front((*s2)[j - 1]);
-      j--;
-    }
-  }
-  while (i > 0)
-  {
-    a1.push_front((*s1)[i - 1]);
-    a2.push_front(-1);
-    i--;
-  }
-  while (j > 0)
-  {
-    a1.push_front(-1);
-    a2.push_front((*s2)[j - 1]);
-    j--;
-  }
-  s1->setContent(vector<int>(a1.begin(), a1.end()));
-  s2->setContent(vector<int>(a2.begin(), a2.end()));
-  auto alphaPtr = s1->getAlphabet();
-  auto asc = make_unique<AlignedSequenceContainer>(alphaPtr);
-  asc->addSequence(s1->getName(), s1);
-  asc->addSequence(s2->getName(), s2);
-  return asc;
+  PairwiseAligner aligner(s, 0., gap);
+  return aligner.align(seq1, seq2);
 }
 
 /******************************************************************************/
@@ -487,141 +402,201 @@ unique_ptr<AlignedSequenceContainer> SiteContainerTools::alignNW(
     double opening,
     double extending)
 {
-  if (seq1.getAlphabet()->getAlphabetType() != seq2.getAlphabet()->getAlphabetType())
+  if (!seq1.getAlphabet()->isCompatibleWith(*seq2.getAlphabet()))
     throw AlphabetMismatchException("SiteContainerTools::alignNW", seq1.getAlphabet(), seq2.getAlphabet());
-  if (seq1.getAlphabet()->getAlphabetType() != s.getAlphabet()->getAlphabetType())
+  if (!seq1.getAlphabet()->isCompatibleWith(*s.getAlphabet()))
     throw AlphabetMismatchException("SiteContainerTools::alignNW", seq1.getAlphabet(), s.getAlphabet());
-  // Check that sequences have no gap!
-  unique_ptr<Sequence> s1(seq1.clone());
-  SequenceTools::removeGaps(*s1);
-  unique_ptr<Sequence> s2(seq2.clone());
-  SequenceTools::removeGaps(*s2);
-
-  // 1) Initialize matrix:
-  RowMatrix<double> m(s1->size() + 1, s2->size() + 1);
-  RowMatrix<double> v(s1->size() + 1, s2->size() + 1);
-  RowMatrix<double> h(s1->size() + 1, s2->size() + 1);
-  RowMatrix<char>   p(s1->size(), s2->size());
-
-  double choice1, choice2, choice3, mx;
-  char px;
-  m(0, 0) = 0.;
-  for (size_t i = 0; i <= s1->size(); i++)
-  {
-    v(i, 0) = log(0.);
-  }
-  for (size_t j = 0; j <= s2->size(); j++)
+  PairwiseAligner aligner(s, opening, extending);
+  return aligner.align(seq1, seq2);
+}
+
+/******************************************************************************/
+
+unique_ptr<AlignedSequenceContainer> SiteContainerTools::alignSW(
+    const Sequence& seq1,
+    const Sequence& seq2,
+    const AlphabetIndex2& s,
+    double opening,
+    double extending)
+{
+  if (!seq1.getAlphabet()->isCompatibleWith(*seq2.getAlphabet()))
+    throw AlphabetMismatchException("SiteContainerTools::alignSW", seq1.getAlphabet(), seq2.getAlphabet());
+  if (!seq1.getAlphabet()->isCompatibleWith(*s.getAlphabet()))
+    throw AlphabetMismatchException("SiteContainerTools::alignSW", seq1.getAlphabet(), s.getAlphabet());
+  PairwiseAligner aligner(s, opening, extending, PairwiseAligner::NO_BAND, PairwiseAligner::Mode::LOCAL);
+  return aligner.align(seq1, seq2);
+}
+
+/******************************************************************************/
+
+const string SiteContainerTools::SIMILARITY_ALL         = "all sites";
+const string SiteContainerTools::SIMILARITY_NOFULLGAP   = "no full gap";
+const string SiteContainerTools::SIMILARITY_NODOUBLEGAP = "no double gap";
+const string SiteContainerTools::SIMILARITY_NOGAP       = "no gap";
+
+/******************************************************************************/
+
+namespace
+{
+// Number of sequences in a tile of the pair matrix.
+const size_t SIMILARITY_TILE_SIZE = 32;
+// Number of words of 64 sites processed at once for a tile of pairs.
+const size_t SIMILARITY_BLOCK_SIZE = 64;
+
+/**
+ * @return The number of bits set in a word.
+ */
+inline unsigned int popCount(uint64_t x)
+{
+#if defined(__GNUC__)
+  return static_cast<unsigned int>(__builtin_popcountll(x));
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<unsigned int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/**
+ * @brief Bit-sliced representation of an alignment.
+ *
+ * Each non-gap state is given a code of nbPlanes bits. For each word of 64 sites,
+ * a sequence is stored as nbPlanes + 1 consecutive words: the mask of gap positions,
+ * followed by one mask per bit of the codes. Sites beyond the end of the alignment
+ * are stored as gaps.
+ */
+struct BitSlicedAlignment
+{
+  size_t nbSequences = 0;
+  size_t nbSites = 0;
+  size_t nbWords = 0;
+  size_t nbPlanes = 0;
+  std::vector<uint64_t> data{};
+
+  const uint64_t* words(size_t sequence, size_t word) const
   {
-    h(0, j) = log(0.);
+    return &data[(sequence * nbWords + word) * (nbPlanes + 1)];
   }
-  for (size_t i = 1; i <= s1->size(); i++)
-  {
-    m(i, 0) = h(i, 0) = opening + static_cast<double>(i) * extending;
+};
+
+BitSlicedAlignment sliceAlignment(const SiteContainerInterface& sites, bool unresolvedAsGap)
+{
+  const Alphabet& alpha = sites.alphabet();
+  const std::vector<int>& states = alpha.getSupportedInts();
+  int minState = *std::min_element(states.begin(), states.end());
+  int maxState = *std::max_element(states.begin(), states.end());
+
+  // Code of each state, -1 for gaps:
+  std::vector<int> codes(static_cast<size_t>(maxState - minState) + 1, -2);
+  int nbCodes = 0;
+  for (int state : states)
+  {
+    int& code = codes[static_cast<size_t>(state - minState)];
+    if (code != -2)
+      continue;
+    if (alpha.isGap(state) || (unresolvedAsGap && alpha.isUnresolved(state)))
+      code = -1;
+    else
+      code = nbCodes++;
   }
-  for (size_t j = 1; j <= s2->size(); j++)
+
+  BitSlicedAlignment bsa;
+  bsa.nbSequences = sites.getNumberOfSequences();
+  bsa.nbSites = sites.getNumberOfSites();
+  bsa.nbWords = (bsa.nbSites + 63) / 64;
+  bsa.nbPlanes = 1;
+  while ((1 << bsa.nbPlanes) < nbCodes)
   {
-    m(0, j) = v(0, j) = opening + static_cast<double>(j) * extending;
+    bsa.nbPlanes++;
   }
+  bsa.data.assign(bsa.nbSequences * bsa.nbWords * (bsa.nbPlanes + 1), 0);
 
-  for (size_t i = 1; i <= s1->size(); i++)
+  for (size_t i = 0; i < bsa.nbSequences; ++i)
   {
-    for (size_t j = 1; j <= s2->size(); j++)
+    const SequenceInterface& seq = sites.sequence(i);
+    for (size_t k = 0; k < bsa.nbWords * 64; ++k)
     {
-      choice1 = m(i - 1, j - 1) + s.getIndex((*s1)[i - 1], (*s2)[j - 1]);
-      choice2 = h(i - 1, j - 1) + opening + extending;
-      choice3 = v(i - 1, j - 1) + opening + extending;
-      mx = choice1; // Default in case of equality of scores.
-      if (choice2 > mx)
+      uint64_t* w = &bsa.data[(i * bsa.nbWords + k / 64) * (bsa.nbPlanes + 1)];
+      uint64_t bit = uint64_t(1) << (k % 64);
+      int code = -1;
+      if (k < bsa.nbSites)
       {
-        mx = choice2;
+        int state = seq[k];
+        if (state < minState || state > maxState || codes[static_cast<size_t>(state - minState)] == -2)
+          throw BadIntException(state, "SiteContainerTools::computeSimilarityMatrix. Unsupported state.", &alpha);
+        code = codes[static_cast<size_t>(state - minState)];
       }
-      if (choice3 > mx)
+      if (code < 0)
       {
-        mx = choice3;
+        w[0] |= bit;
       }
-      m(i, j) = mx;
-
-      choice1 = m(i, j - 1) + opening + extending;
-      choice2 = h(i, j - 1) + extending;
-      mx = choice1; // Default in case of equality of scores.
-      if (choice2 > mx)
-      {
-        mx = choice2;
-      }
-      h(i, j) = mx;
-
-      choice1 = m(i - 1, j) + opening + extending;
-      choice2 = v(i - 1, j) + extending;
-      mx = choice1; // Default in case of equality of scores.
-      if (choice2 > mx)
+      else
       {
-        mx = choice2;
+        for (size_t p = 0; p < bsa.nbPlanes; ++p)
+        {
+          if ((code >> p) & 1)
+            w[p + 1] |= bit;
+        }
       }
-      v(i, j) = mx;
-
-      px = 'd';
-      if (v(i, j) > m(i, j))
-        px = 'u';
-      if (h(i, j) > m(i, j))
-        px = 'l';
-      p(i - 1, j - 1) = px;
     }
   }
+  return bsa;
+}
+
+/**
+ * @brief Counts for a pair of sequences, including sites beyond the end of the alignment.
+ */
+struct PairCounts
+{
+  unsigned int matches = 0;
+  unsigned int doubleGaps = 0;
+  unsigned int anyGaps = 0;
+};
+
+/**
+ * @brief Count identities and gaps for all pairs (i, j) with i in tile ti, j in tile tj and i < j.
+ *
+ * @param counts Output counts, of size SIMILARITY_TILE_SIZE², indexed by (i - i0) * SIMILARITY_TILE_SIZE + (j - j0).
+ */
+void countTile(const BitSlicedAlignment& bsa, size_t ti, size_t tj, std::vector<PairCounts>& counts)
+{
+  size_t i0 = ti * SIMILARITY_TILE_SIZE;
+  size_t i1 = std::min(i0 + SIMILARITY_TILE_SIZE, bsa.nbSequences);
+  size_t j0 = tj * SIMILARITY_TILE_SIZE;
+  size_t j1 = std::min(j0 + SIMILARITY_TILE_SIZE, bsa.nbSequences);
+  size_t nbPlanes = bsa.nbPlanes;
+  counts.assign(SIMILARITY_TILE_SIZE * SIMILARITY_TILE_SIZE, PairCounts());
 
-  // 2) Get alignment:
-  deque<int> a1, a2;
-  size_t i = s1->size(), j = s2->size();
-  char c;
-  while (i > 0 && j > 0)
+  for (size_t w0 = 0; w0 < bsa.nbWords; w0 += SIMILARITY_BLOCK_SIZE)
   {
-    c = p(i - 1, j - 1);
-    if (c == 'd')
-    {
-      a1.push_front((*s1)[i - 1]);
-      a2.push_front((*s2)[j - 1]);
-      i--;
-      j--;
-    }
-    else if (c == 'u')
+    size_t w1 = std::min(w0 + SIMILARITY_BLOCK_SIZE, bsa.nbWords);
+    for (size_t i = i0; i < i1; ++i)
     {
-      a1.push_front((*s1)[i - 1]);
-      a2.push_front(-1);
-      i--;
-    }
-    else
-    {
-      a1.push_front(-1);
-      a2.push_front((*s2)[j - 1]);
-      j--;
+      for (size_t j = std::max(j0, i + 1); j < j1; ++j)
+      {
+        PairCounts& c = counts[(i - i0) * SIMILARITY_TILE_SIZE + (j - j0)];
+        const uint64_t* a = bsa.words(i, w0);
+        const uint64_t* b = bsa.words(j, w0);
+        for (size_t w = w0; w < w1; ++w)
+        {
+          uint64_t diff = 0;
+          for (size_t p = 1; p <= nbPlanes; ++p)
+          {
+            diff |= a[p] ^ b[p];
+          }
+          uint64_t anyGap = a[0] | b[0];
+          c.matches += popCount(~(diff | anyGap));
+          c.doubleGaps += popCount(a[0] & b[0]);
+          c.anyGaps += popCount(anyGap);
+          a += nbPlanes + 1;
+          b += nbPlanes + 1;
+        }
+      }
     }
   }
-  while (i > 0)
-  {
-    a1.push_front((*s1)[i - 1]);
-    a2.push_front(-1);
-    i--;
-  }
-  while (j > 0)
-  {
-    a1.push_front(-1);
-    a2.push_front((*s2)[j - 1]);
-    j--;
-  }
-  s1->setContent(vector<int>(a1.begin(), a1.end()));
-  s2->setContent(vector<int>(a2.begin(), a2.end()));
-  auto alphaPtr = s1->getAlphabet();
-  auto asc = make_unique<AlignedSequenceContainer>(alphaPtr);
-  asc->addSequence(s1->getName(), s1);
-  asc->addSequence(s2->getName(), s2);
-  return asc;
 }
-
-/******************************************************************************/
-
-const string SiteContainerTools::SIMILARITY_ALL         = "all sites";
-const string SiteContainerTools::SIMILARITY_NOFULLGAP   = "no full gap";
-const string SiteContainerTools::SIMILARITY_NODOUBLEGAP = "no double gap";
-const string SiteContainerTools::SIMILARITY_NOGAP       = "no gap";
+}
 
 /******************************************************************************/
 
@@ -634,17 +609,23 @@ double SiteContainerTools::computeSimilarity(
 {
   if (seq1.size() != seq2.size())
     throw SequenceNotAlignedException("SiteContainerTools::computeSimilarity.", &seq2);
-  if (seq1.getAlphabet()->getAlphabetType() != seq2.getAlphabet()->getAlphabetType())
+  if (!seq1.getAlphabet()->isCompatibleWith(*seq2.getAlphabet()))
     throw AlphabetMismatchException("SiteContainerTools::computeSimilarity.", seq1.getAlphabet(), seq2.getAlphabet());
 
+  bool all = (gapOption == SIMILARITY_ALL);
+  bool noDoubleGap = (gapOption == SIMILARITY_NODOUBLEGAP);
+  bool noGap = (gapOption == SIMILARITY_NOGAP);
+  if (!all && !noDoubleGap && !noGap)
+    throw Exception("SiteContainerTools::computeSimilarity. Invalid gap option: " + gapOption);
+
   std::shared_ptr<const Alphabet> alpha = seq1.getAlphabet();
+  int gapCode = alpha->getGapCharacterCode();
   unsigned int s = 0;
   unsigned int t = 0;
   for (size_t i = 0; i < seq1.size(); i++)
   {
     int x = seq1[i];
     int y = seq2[i];
-    int gapCode = alpha->getGapCharacterCode();
     if (unresolvedAsGap)
     {
       if (alpha->isUnresolved(x))
@@ -652,32 +633,32 @@ double SiteContainerTools::computeSimilarity(
       if (alpha->isUnresolved(y))
         y = gapCode;
     }
-    if (gapOption == SIMILARITY_ALL)
+    bool gapX = alpha->isGap(x);
+    bool gapY = alpha->isGap(y);
+    if (all)
     {
       t++;
-      if (x == y && !alpha->isGap(x) && !alpha->isGap(y))
+      if (x == y && !gapX && !gapY)
         s++;
     }
-    else if (gapOption == SIMILARITY_NODOUBLEGAP)
+    else if (noDoubleGap)
     {
-      if (!alpha->isGap(x) || !alpha->isGap(y))
+      if (!gapX || !gapY)
       {
         t++;
         if (x == y)
           s++;
       }
     }
-    else if (gapOption == SIMILARITY_NOGAP)
+    else
     {
-      if (!alpha->isGap(x) && !alpha->isGap(y))
+      if (!gapX && !gapY)
       {
         t++;
         if (x == y)
           s++;
       }
     }
-    else
-      throw Exception("SiteContainerTools::computeSimilarity. Invalid gap option: " + gapOption);
   }
   double r = (t == 0 ? 0. : static_cast<double>(s) / static_cast<double>(t));
   return dist ? 1 - r : r;
@@ -689,40 +670,94 @@ std::unique_ptr<DistanceMatrix> SiteContainerTools::computeSimilarityMatrix(
     const SiteContainerInterface& sites,
     bool dist,
     const std::string& gapOption,
-    bool unresolvedAsGap)
+    bool unresolvedAsGap,
+    unsigned int nbThreads)
 {
+  if (gapOption != SIMILARITY_ALL && gapOption != SIMILARITY_NOFULLGAP
+      && gapOption != SIMILARITY_NODOUBLEGAP && gapOption != SIMILARITY_NOGAP)
+    throw Exception("SiteContainerTools::computeSimilarityMatrix. Invalid gap option: " + gapOption);
+
   size_t n = sites.getNumberOfSequences();
   auto mat = make_unique<DistanceMatrix>(sites.getSequenceNames());
-  string pairwiseGapOption = gapOption;
-  unique_ptr<SiteContainerInterface> sites2;
+  if (n == 0)
+    return mat;
+
+  BitSlicedAlignment bsa = sliceAlignment(sites, unresolvedAsGap);
+  unsigned int nbPaddedSites = static_cast<unsigned int>(bsa.nbWords * 64);
+
+  // With SIMILARITY_NOFULLGAP, sites with only gaps are ignored, and all other sites are used:
+  unsigned int nbUsedSites = static_cast<unsigned int>(bsa.nbSites);
   if (gapOption == SIMILARITY_NOFULLGAP)
   {
-    if (unresolvedAsGap)
+    for (size_t w = 0; w < bsa.nbWords; ++w)
     {
-      auto tmp = removeGapOrUnresolvedOnlySites(sites);
-      sites2 = make_unique<AlignedSequenceContainer>(*tmp);
+      uint64_t fullGap = ~uint64_t(0);
+      for (size_t i = 0; i < n; ++i)
+      {
+        fullGap &= bsa.words(i, w)[0];
+      }
+      nbUsedSites -= popCount(fullGap);
     }
-    else
+    nbUsedSites += nbPaddedSites - static_cast<unsigned int>(bsa.nbSites);
+  }
+
+  // List all tiles of the upper triangle of the matrix:
+  size_t nbTiles = (n + SIMILARITY_TILE_SIZE - 1) / SIMILARITY_TILE_SIZE;
+  vector< pair<size_t, size_t> > tiles;
+  for (size_t ti = 0; ti < nbTiles; ++ti)
+  {
+    for (size_t tj = ti; tj < nbTiles; ++tj)
     {
-      auto tmp = removeGapOnlySites(sites);
-      sites2 = make_unique<AlignedSequenceContainer>(*tmp);
+      tiles.push_back(make_pair(ti, tj));
     }
-    pairwiseGapOption = SIMILARITY_ALL;
   }
-  else
+
+  atomic<size_t> nextTile(0);
+  auto worker = [&]()
   {
-    sites2 = make_unique<AlignedSequenceContainer>(sites);
+    vector<PairCounts> counts;
+    size_t k;
+    while ((k = nextTile++) < tiles.size())
+    {
+      countTile(bsa, tiles[k].first, tiles[k].second, counts);
+      size_t i0 = tiles[k].first * SIMILARITY_TILE_SIZE;
+      size_t j0 = tiles[k].second * SIMILARITY_TILE_SIZE;
+      for (size_t i = i0; i < min(i0 + SIMILARITY_TILE_SIZE, n); ++i)
+      {
+        for (size_t j = max(j0, i + 1); j < min(j0 + SIMILARITY_TILE_SIZE, n); ++j)
+        {
+          const PairCounts& c = counts[(i - i0) * SIMILARITY_TILE_SIZE + (j - j0)];
+          unsigned int t;
+          if (gapOption == SIMILARITY_NODOUBLEGAP)
+            t = nbPaddedSites - c.doubleGaps;
+          else if (gapOption == SIMILARITY_NOGAP)
+            t = nbPaddedSites - c.anyGaps;
+          else
+            t = nbUsedSites;
+          double r = (t == 0 ? 0. : static_cast<double>(c.matches) / static_cast<double>(t));
+          (*mat)(i, j) = (*mat)(j, i) = dist ? 1 - r : r;
+        }
+      }
+    }
+  };
+
+  if (nbThreads == 0)
+    nbThreads = max(thread::hardware_concurrency(), 1u);
+  nbThreads = static_cast<unsigned int>(min(static_cast<size_t>(nbThreads), tiles.size()));
+  vector<thread> threads;
+  for (unsigned int k = 1; k < nbThreads; ++k)
+  {
+    threads.push_back(thread(worker));
+  }
+  worker();
+  for (auto& th : threads)
+  {
+    th.join();
   }
 
   for (size_t i = 0; i < n; ++i)
   {
     (*mat)(i, i) = dist ? 0. : 1.;
-    const Sequence& seq1 = sites2->sequence(i);
-    for (size_t j = i + 1; j < n; ++j)
-    {
-      const Sequence& seq2 = sites2->sequence(j);
-      (*mat)(i, j) = (*mat)(j, i) = computeSimilarity(seq1, seq2, dist, pairwiseGapOption, unresolvedAsGap);
-    }
   }
   return mat;
 }
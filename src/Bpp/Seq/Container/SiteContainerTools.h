@@ -9,6 +9,7 @@
 #include "SiteContainer.h"
 #include "VectorSiteContainer.h"
 #include "AlignedSequenceContainer.h"
+#include "OutOfCoreSiteContainer.h"
 #include "SequenceContainerTools.h"
 #include "AlignmentData.h"
 #include "../AlphabetIndex/AlphabetIndex2.h"
@@ -24,6 +25,7 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <type_traits>
 
 namespace bpp
 {
@@ -105,6 +107,7 @@ public:
    *
    * This function builds a new VectorSiteContainer instance without sites with only gaps.
    * The container passed as input is not modified, all sites are copied.
+   * An OutOfCoreSiteContainer is read block by block, from its packed states.
    *
    * @param sites The container to analyse.
    * @return A pointer toward a new SiteContainer.
@@ -118,6 +121,33 @@ public:
     std::vector<std::string> sequenceKeys = sites.getSequenceKeys();
     auto alphaPtr = sites.getAlphabet();
     auto newContainer = std::make_unique<TemplateVectorSiteContainer<SiteType, SequenceType>>(sequenceKeys, alphaPtr);
+    if constexpr (std::is_same<SiteType, Site>::value)
+    {
+      auto ooc = dynamic_cast<const OutOfCoreSiteContainer*>(&sites);
+      if (ooc)
+      {
+        size_t n = sites.getNumberOfSequences();
+        uint8_t gap = static_cast<uint8_t>(alphaPtr->getGapCharacterCode() - ooc->getStateOffset());
+        for (size_t k = 0; k < ooc->getNumberOfBlocks(); ++k)
+        {
+          size_t first = k * ooc->getBlockSize();
+          size_t nbSites = std::min(ooc->getBlockSize(), sites.getNumberOfSites() - first);
+          const uint8_t* data = ooc->getBlockData(k);
+          SiteSelection selection;
+          for (size_t j = 0; j < nbSites; ++j)
+          {
+            const uint8_t* states = data + j * n;
+            if (std::find_if(states, states + n, [gap](uint8_t x) { return x != gap; }) != states + n)
+              selection.push_back(first + j);
+          }
+          for (auto& site : ooc->getSites(selection))
+          {
+            newContainer->addSite(site, false);
+          }
+        }
+        return newContainer;
+      }
+    }
     for (size_t i = 0; i < sites.getNumberOfSites(); ++i)
     {
       const Site& site = sites.site(i);
@@ -258,12 +288,13 @@ public:
 
     std::vector<std::string> sequenceKeys = sites.getSequenceKeys();
     auto newContainer = std::make_unique<TemplateVectorSiteContainer<SiteType, SequenceType>>(sequenceKeys, sites.getAlphabet());
+    int offset = SiteTools::getDenseCountsOffset(*sites.getAlphabet());
+    std::vector<double> freq;
     for (size_t i = 0; i < sites.getNumberOfSites(); ++i)
     {
-      std::map<int, double> freq;
       const Site& site = sites.site(i);
-      SiteTools::getFrequencies(site, freq);
-      if (freq[-1] <= maxFreqGaps)
+      SiteTools::getDenseFrequencies(site, freq);
+      if (offset > -1 || freq[static_cast<size_t>(-1 - offset)] <= maxFreqGaps)
       {
         auto site2 = std::make_unique<SiteType>(site.clone());
         newContainer->addSite(site2, false);
@@ -288,11 +319,12 @@ public:
     if (sites.getNumberOfSequences() == 0)
       throw Exception("SiteContainerTools::removeGapSites. Container is empty.");
 
+    int offset = SiteTools::getDenseCountsOffset(*sites.getAlphabet());
+    std::vector<double> freq;
     for (size_t i = sites.getNumberOfSites(); i > 0; --i)
     {
-      std::map<int, double> freq;
-      SiteTools::getFrequencies(sites.site(i - 1), freq);
-      if (freq[-1] > maxFreqGaps)
+      SiteTools::getDenseFrequencies(sites.site(i - 1), freq);
+      if (offset <= -1 && freq[static_cast<size_t>(-1 - offset)] > maxFreqGaps)
       {
         sites.deleteSite(i - 1);
       }
@@ -378,6 +410,7 @@ public:
    * A SiteContainer is filled with specified sites.
    *
    * Sites are specified by their indice, beginning at 0. Sites may be selected multiple times.
+   * The sites of an OutOfCoreSiteContainer are read block by block, whatever their order in the selection.
    *
    * @param sites       The container from which sequences are to be taken.
    * @param selection   The positions of all sites to retrieve.
@@ -389,6 +422,19 @@ public:
       const SiteSelection& selection,
       TemplateSiteContainerInterface<SiteType, SequenceType, HashType>& outputSites)
   {
+    if constexpr (std::is_same<SiteType, Site>::value)
+    {
+      auto ooc = dynamic_cast<const OutOfCoreSiteContainer*>(&sites);
+      if (ooc)
+      {
+        for (auto& site : ooc->getSites(selection))
+        {
+          outputSites.addSite(site, false);
+        }
+        outputSites.setSequenceNames(sites.getSequenceNames(), true);
+        return;
+      }
+    }
     for (auto pos : selection)
     {
       auto sitePtr = std::unique_ptr<SiteType>(sites.site(pos).clone());
@@ -701,6 +747,7 @@ public:
    * @brief Align two sequences using the Needleman-Wunsch dynamic algorithm.
    *
    * If the input sequences contain gaps, they will be ignored.
+   * The alignment is computed in linear memory, see PairwiseAligner for more options.
    *
    * @see BLOSUM50, DefaultNucleotideScore for score matrices.
    *
@@ -721,6 +768,8 @@ public:
    * @brief Align two sequences using the Needleman-Wunsch dynamic algorithm.
    *
    * If the input sequences contain gaps, they will be ignored.
+   * A gap of length \f$k\f$ scores opening + k * extending.
+   * The alignment is computed in linear memory, see PairwiseAligner for more options.
    *
    * @see BLOSUM50, DefaultNucleotideScore for score matrices.
    *
@@ -739,6 +788,32 @@ public:
       double opening,
       double extending);
 
+  /**
+   * @brief Align two sequences using the Smith-Waterman dynamic algorithm.
+   *
+   * The best local alignment is returned: only the aligned subsequences are in the output container,
+   * which is empty if no pair of positions has a positive score.
+   * If the input sequences contain gaps, they will be ignored.
+   * A gap of length \f$k\f$ scores opening + k * extending.
+   * The alignment is computed in linear memory, see PairwiseAligner for more options.
+   *
+   * @see BLOSUM50, DefaultNucleotideScore for score matrices.
+   *
+   * @param seq1 The first sequence.
+   * @param seq2 The second sequence.
+   * @param s The score matrix to use.
+   * @param opening Gap opening penalty.
+   * @param extending Gap extending penalty.
+   * @return A new SiteContainer instance.
+   * @throw AlphabetMismatchException If the sequences and the score matrix do not share the same alphabet.
+   */
+  static std::unique_ptr<AlignedSequenceContainer> alignSW(
+      const Sequence& seq1,
+      const Sequence& seq2,
+      const AlphabetIndex2& s,
+      double opening,
+      double extending);
+
   /**
    * @brief Sample sites in an alignment.
    *
@@ -746,6 +821,7 @@ public:
    * positions. You may wish to call the reindexSites() method on the returned container.
    *
    * Note: This method will be optimal with a container with vertical storage like VectorSiteContainer.
+   * The sites of an OutOfCoreSiteContainer are read block by block.
    *
    * @param sites An input alignment to sample.
    * @param nbSites The size of the resulting container.
@@ -759,16 +835,15 @@ public:
       TemplateSiteContainerInterface<SiteType, SequenceType, HashType>& outSites,
       std::shared_ptr<std::vector<size_t>> index = nullptr)
   {
+    // Positions are drawn first, so that out-of-core containers are read block by block:
+    SiteSelection selection(nbSites);
     for (size_t i = 0; i < nbSites; ++i)
     {
-      size_t pos = static_cast<size_t>(RandomTools::giveIntRandomNumberBetweenZeroAndEntry(static_cast<int>(sites.getNumberOfSites())));
-      auto s = std::unique_ptr<SiteType>(sites.site(pos).clone());
-      outSites.addSite(s, false);
-
-      if (index)
-        index->push_back(pos);
+      selection[i] = static_cast<size_t>(RandomTools::giveIntRandomNumberBetweenZeroAndEntry(static_cast<int>(sites.getNumberOfSites())));
     }
-    outSites.setSequenceNames(sites.getSequenceNames(), true);
+    if (index)
+      index->insert(index->end(), selection.begin(), selection.end());
+    getSelectedSites(sites, selection, outSites);
   }
 
 
@@ -779,6 +854,7 @@ public:
    * positions. You may wish to call the reindexSites() method on the returned container.
    *
    * Note: This method will be optimal with a container with vertical storage like VectorSiteContainer.
+   * The sites of an OutOfCoreSiteContainer are read block by block.
    *
    * @param sites An input alignment to sample.
    * @param nbSites The size of the resulting container.
@@ -805,6 +881,7 @@ public:
    * positions. You may wish to call the reindexSites() method on the returned container.
    *
    * Note: This method will be optimal with a container with vertical storage like VectorSiteContainer.
+   * The sites of an OutOfCoreSiteContainer are read block by block.
    *
    * @param sites An input alignment to sample.
    * @param outputSites A container that will contain the sampled alignment.
@@ -825,6 +902,7 @@ public:
    * positions. You may wish to call the reindexSites() method on the returned container.
    *
    * Note: This method will be optimal with a container with vertical storage like VectorSiteContainer.
+   * The sites of an OutOfCoreSiteContainer are read block by block.
    *
    * @param sites An input alignment to sample.
    * @return A container that contains the sampled alignment.
@@ -879,21 +957,29 @@ public:
    * - SIMILARITY_NODOUBLEGAP: ignore all positions with a gap in the two sequences for each pair.
    * - SIMILARITY_NOGAP: ignore all positions with a gap in at least one of the two sequences for each pair.
    *
+   * The results are identical to the ones of computeSimilarity, but the alignment is first
+   * converted to a bit-sliced representation: each state is given a binary code, and each bit
+   * of the codes, as well as the gap positions, are stored as bitmasks of 64 sites. Identities
+   * for 64 sites are then counted with a few bitwise operations and population counts.
+   * Pairs of sequences are processed by tiles, which are distributed over several threads.
    *
-   * @see computeSimilarityMatrix
+   * @see computeSimilarity
    *
    * @param sites The input alignment.
    * @param dist Shall we return a distance instead of similarity?
    * @param gapOption How to deal with gaps.
    * @param unresolvedAsGap Tell if unresolved characters must be considered as gaps when counting.
    * If set to yes, the gap option will also apply to unresolved characters.
+   * @param nbThreads The number of threads to use. If 0, the number of hardware threads is used.
    * @return All pairwise similarity measures.
+   * @throw Exception If an invalid gapOption is passed.
    */
   static std::unique_ptr<DistanceMatrix> computeSimilarityMatrix(
       const SiteContainerInterface& sites,
       bool dist = false,
       const std::string& gapOption = SIMILARITY_NOFULLGAP,
-      bool unresolvedAsGap = true);
+      bool unresolvedAsGap = true,
+      unsigned int nbThreads = 0);
 
   static const std::string SIMILARITY_ALL;
   static const std::string SIMILARITY_NOFULLGAP;
@@ -926,7 +1012,7 @@ public:
       const TemplateSiteContainerInterface<SiteType, SequenceType, HashType>& seqCont2,
       bool leavePositionAsIs = false)
   {
-    if (seqCont1.getAlphabet()->getAlphabetType() != seqCont2.getAlphabet()->getAlphabetType())
+    if (!seqCont1.getAlphabet()->isCompatibleWith(*seqCont2.getAlphabet()))
       throw AlphabetMismatchException("SiteContainerTools::merge.", seqCont1.getAlphabet(), seqCont2.getAlphabet());
 
     std::vector<HashType> seqKeys1 = seqCont1.getSequenceKeys();
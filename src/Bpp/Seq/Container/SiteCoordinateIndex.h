@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_CONTAINER_SITECOORDINATEINDEX_H
+#define BPP_SEQ_CONTAINER_SITECOORDINATEINDEX_H
+
+#include <Bpp/Numeric/VectorTools.h>
+
+// From the STL:
+#include <limits>
+#include <unordered_map>
+
+namespace bpp
+{
+/**
+ * @brief A hash index of the site coordinates of a container.
+ *
+ * This class is used by site containers to check in constant time whether
+ * a coordinate is already in use when adding or setting a site. It stores
+ * the number of sites with a given coordinate, so that containers where
+ * coordinates were not checked (and may hence contain duplicates) can still
+ * be indexed.
+ *
+ * The index is built lazily: it is invalid until build() is called, and
+ * add() and remove() do nothing while it is invalid. Containers should
+ * invalidate it whenever coordinates are changed in bulk (e.g. reindexing),
+ * and build it again the next time a check is requested.
+ *
+ * As coordinates are most often added in increasing order, the largest
+ * indexed coordinate is kept, and any larger coordinate is known to be
+ * absent without querying the hash table.
+ */
+class SiteCoordinateIndex
+{
+private:
+  std::unordered_map<int, size_t> counts_;
+
+  /**
+   * @brief An upper bound of the indexed coordinates.
+   */
+  int max_;
+
+  bool valid_;
+
+public:
+  SiteCoordinateIndex() :
+    counts_(),
+    max_(std::numeric_limits<int>::min()),
+    valid_(false)
+  {}
+
+public:
+  /**
+   * @return True if the index is synchronized with the container.
+   */
+  bool isValid() const { return valid_; }
+
+  /**
+   * @brief Discard the index content. build() has to be called before it can be used again.
+   */
+  void invalidate()
+  {
+    counts_.clear();
+    max_ = std::numeric_limits<int>::min();
+    valid_ = false;
+  }
+
+  /**
+   * @brief (Re)build the index from a list of coordinates.
+   *
+   * @param coordinates The coordinates of all sites in the container.
+   */
+  void build(const Vint& coordinates)
+  {
+    invalidate();
+    counts_.reserve(coordinates.size());
+    for (auto coordinate : coordinates)
+    {
+      ++counts_[coordinate];
+      if (coordinate > max_)
+        max_ = coordinate;
+    }
+    valid_ = true;
+  }
+
+  /**
+   * @return The number of indexed sites with the given coordinate.
+   * @param coordinate The coordinate to look for.
+   */
+  size_t count(int coordinate) const
+  {
+    if (coordinate > max_)
+      return 0;
+    auto it = counts_.find(coordinate);
+    return it == counts_.end() ? 0 : it->second;
+  }
+
+  /**
+   * @brief Record a new site coordinate. Does nothing if the index is not valid.
+   *
+   * @param coordinate The coordinate of the added site.
+   */
+  void add(int coordinate)
+  {
+    if (!valid_)
+      return;
+    ++counts_[coordinate];
+    if (coordinate > max_)
+      max_ = coordinate;
+  }
+
+  /**
+   * @brief Remove a site coordinate. Does nothing if the index is not valid.
+   *
+   * @param coordinate The coordinate of the removed site.
+   */
+  void remove(int coordinate)
+  {
+    if (!valid_)
+      return;
+    auto it = counts_.find(coordinate);
+    if (it != counts_.end() && --it->second == 0)
+      counts_.erase(it);
+  }
+};
+} // end of namespace bpp
+#endif // BPP_SEQ_CONTAINER_SITECOORDINATEINDEX_H
@@ -267,7 +267,7 @@ public:
 
   void addSequence(const std::string& sequenceKey, std::unique_ptr<SequenceType>& sequencePtr) override
   {
-    if (sequencePtr->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!sequencePtr->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("VectorSequenceContainer::addSequence : Alphabets do not match.", getAlphabet(), sequencePtr->getAlphabet());
 
     std::shared_ptr<SequenceType> sequencePtr2(sequencePtr.release(), SwitchDeleter<SequenceType>());
@@ -298,7 +298,7 @@ public:
 
   void setSequence(size_t sequencePosition, std::unique_ptr<SequenceType>& sequencePtr) override
   {
-    if (sequencePtr->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!sequencePtr->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("VectorSequenceContainer::setSequence : Alphabets don't match", getAlphabet(), sequencePtr->getAlphabet());
 
     sequenceVectorMap_.addObject(std::move(sequencePtr), sequencePosition, sequenceKey(sequencePosition), false);
@@ -306,7 +306,7 @@ public:
 
   void setSequence(size_t sequencePosition, std::unique_ptr<SequenceType>& sequencePtr, const std::string& sequenceKey) override
   {
-    if (sequencePtr->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!sequencePtr->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("VectorSequenceContainer::setSequence : Alphabets don't match", getAlphabet(), sequencePtr->getAlphabet());
 
     sequenceVectorMap_.addObject(std::move(sequencePtr), sequencePosition, sequenceKey, false);
@@ -314,7 +314,7 @@ public:
 
   void insertSequence(size_t sequencePosition, std::unique_ptr<SequenceType>& sequencePtr, const std::string& sequenceKey) override
   {
-    if (sequencePtr->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!sequencePtr->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("VectorSequenceContainer::insertSequence : Alphabets don't match", getAlphabet(), sequencePtr->getAlphabet());
 
     sequenceVectorMap_.insertObject(std::move(sequencePtr), sequencePosition, sequenceKey);
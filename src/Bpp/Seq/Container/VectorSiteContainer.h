@@ -10,6 +10,7 @@
 #include "SequenceContainer.h"
 #include "AbstractSequenceContainer.h"
 #include "SiteContainer.h"
+#include "SiteCoordinateIndex.h"
 #include "VectorPositionedContainer.h"
 #include "VectorMappedContainer.h"
 
@@ -48,13 +49,16 @@ protected:
   std::vector<std::string> sequenceNames_;
   std::vector<Comments> sequenceComments_;
 
+  // Hash index of the site coordinates, used to check for duplicates
+  SiteCoordinateIndex coordinateIndex_;
+
 public:
   /**
    * @brief Build a new container from a set of sites.
    *
    * @param vs A std::vector of sites.
    * @param alphabet The common alphabet for all sites.
-   * @param checkPositions Check for the redundancy of site position tag. This may turn to be very time consuming!
+   * @param checkPositions Check for the redundancy of site position tag.
    * @throw Exception If sites differ in size or in alphabet.
    */
   TemplateVectorSiteContainer(
@@ -65,7 +69,8 @@ public:
     siteContainer_(),
     sequenceContainer_(),
     sequenceNames_(),
-    sequenceComments_()
+    sequenceComments_(),
+    coordinateIndex_()
   {
     if (vs.size() == 0)
       throw Exception("VectorSiteContainer::VectorSiteContainer. Empty site set.");
@@ -98,7 +103,8 @@ public:
     siteContainer_(),
     sequenceContainer_(),
     sequenceNames_(),
-    sequenceComments_(size)
+    sequenceComments_(size),
+    coordinateIndex_()
   {
     for (size_t i = 0; i < size; ++i)
     {
@@ -123,7 +129,8 @@ public:
     siteContainer_(),
     sequenceContainer_(),
     sequenceNames_(),
-    sequenceComments_(sequenceKeys.size())
+    sequenceComments_(sequenceKeys.size()),
+    coordinateIndex_()
   {
     unsigned int i = 0;
     if (useKeysAsNames)
@@ -157,7 +164,8 @@ public:
     siteContainer_(),
     sequenceContainer_(),
     sequenceNames_(),
-    sequenceComments_()
+    sequenceComments_(),
+    coordinateIndex_()
   {}
 
 
@@ -166,7 +174,8 @@ public:
     siteContainer_(),
     sequenceContainer_(),
     sequenceNames_(vsc.sequenceNames_),
-    sequenceComments_(vsc.sequenceComments_)
+    sequenceComments_(vsc.sequenceComments_),
+    coordinateIndex_()
   {
     for (auto sequenceKey : vsc.getSequenceKeys())
     {
@@ -186,7 +195,8 @@ public:
     siteContainer_(),
     sequenceContainer_(),
     sequenceNames_(sc.getSequenceNames()),
-    sequenceComments_(sc.getSequenceComments())
+    sequenceComments_(sc.getSequenceComments()),
+    coordinateIndex_()
   {
     for (auto& sequenceKey : sc.getSequenceKeys())
     {
@@ -205,7 +215,8 @@ public:
     siteContainer_(),
     sequenceContainer_(),
     sequenceNames_(),
-    sequenceComments_()
+    sequenceComments_(),
+    coordinateIndex_()
   {
     for (auto& sequenceKey: sc.getSequenceKeys())
     {
@@ -310,23 +321,28 @@ public:
     }
 
     // New site's alphabet and site container's alphabet matching verification
-    if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("TemplateVectorSiteContainer::setSite", getAlphabet(), site->getAlphabet());
 
     // Check coordinate:
     if (checkCoordinate)
     {
       int coordinate = site->getCoordinate();
-      // For all coordinates in vector: throw exception if position already exists
-      for (size_t i = 0; i < getNumberOfSites(); ++i)
+      // Throw exception if position already exists, the replaced site excepted
+      size_t n = getCoordinateIndex_().count(coordinate);
+      if (this->site(sitePosition).getCoordinate() == coordinate)
+        n--;
+      if (n > 0)
       {
-        if (i != sitePosition && this->site(i).getCoordinate() == coordinate)
-        {
-          throw SiteException("TemplateVectorSiteContainer::setSite: Site position already exists in container", site.get());
-        }
+        throw SiteException("TemplateVectorSiteContainer::setSite: Site position already exists in container", site.get());
       }
     }
 
+    if (coordinateIndex_.isValid())
+    {
+      coordinateIndex_.remove(this->site(sitePosition).getCoordinate());
+      coordinateIndex_.add(site->getCoordinate());
+    }
     std::shared_ptr<SiteType> sitePtr(site.release(), SwitchDeleter<SiteType>());
     siteContainer_.addObject(sitePtr, sitePosition, false);
 
@@ -339,6 +355,8 @@ public:
     // Clean Sequence Container cache
     sequenceContainer_.nullify();
 
+    if (coordinateIndex_.isValid())
+      coordinateIndex_.remove(site(sitePosition).getCoordinate());
     auto sitePtr = siteContainer_.removeObject(sitePosition);
     std::get_deleter<SwitchDeleter<SiteType>>(sitePtr)->off();
     return std::unique_ptr<SiteType>(sitePtr.get());
@@ -346,6 +364,8 @@ public:
 
   void deleteSite(size_t sitePosition) override
   {
+    if (coordinateIndex_.isValid())
+      coordinateIndex_.remove(site(sitePosition).getCoordinate());
     siteContainer_.deleteObject(sitePosition);
     // Clean Sequence Container cache
     sequenceContainer_.nullify();
@@ -359,21 +379,18 @@ public:
       throw SiteException("TemplateVectorSiteContainer::addSite. Site does not have the appropriate length", site.get());
 
     // New site's alphabet and site container's alphabet matching verification
-    if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("TemplateVectorSiteContainer::addSite", getAlphabet(), site->getAlphabet());
 
     // Check coordinate:
     if (checkCoordinate)
     {
-      int coordinate = site->getCoordinate();
-      // For all positions in vector : throw exception if position already exists
-      for (size_t i = 0; i < getNumberOfSites(); ++i)
-      {
-        if (this->site(i).getCoordinate() == coordinate)
-          throw SiteException("TemplateVectorSiteContainer::addSite(site, bool): Site position already exists in container", site.get());
-      }
+      // Throw exception if position already exists
+      if (getCoordinateIndex_().count(site->getCoordinate()) > 0)
+        throw SiteException("TemplateVectorSiteContainer::addSite(site, bool): Site position already exists in container", site.get());
     }
 
+    coordinateIndex_.add(site->getCoordinate());
     std::shared_ptr<SiteType> sitePtr(site.release(), SwitchDeleter<SiteType>());
     siteContainer_.appendObject(sitePtr);
 
@@ -405,21 +422,18 @@ public:
       throw SiteException("TemplateVectorSiteContainer::addSite. Site does not have the appropriate length", site.get());
 
     // New site's alphabet and site container's alphabet matching verification
-    if (site->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!site->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("TemplateVectorSiteContainer::addSite", getAlphabet(), site->getAlphabet());
 
     // Check coordinate:
     if (checkCoordinate)
     {
-      int coordinate = site->getCoordinate();
-      // For all positions in vector : throw exception if position already exists
-      for (size_t i = 0; i < getNumberOfSites(); i++)
-      {
-        if (i != sitePosition && this->site(i).getCoordinate() == coordinate)
-          throw SiteException("TemplateVectorSiteContainer::addSite. Site coordinate already exists in container", site.get());
-      }
+      // Throw exception if position already exists
+      if (getCoordinateIndex_().count(site->getCoordinate()) > 0)
+        throw SiteException("TemplateVectorSiteContainer::addSite. Site coordinate already exists in container", site.get());
     }
 
+    coordinateIndex_.add(site->getCoordinate());
     std::shared_ptr<SiteType> sitePtr(site.release(), SwitchDeleter<SiteType>());
     siteContainer_.insertObject(sitePtr, sitePosition);
 
@@ -443,6 +457,10 @@ public:
 
   void deleteSites(size_t sitePosition, size_t length) override
   {
+    for (size_t i = sitePosition; coordinateIndex_.isValid() && i < sitePosition + length; ++i)
+    {
+      coordinateIndex_.remove(site(i).getCoordinate());
+    }
     siteContainer_.deleteObjects(sitePosition, length);
   }
 
@@ -457,6 +475,7 @@ public:
     {
       site_(i).setCoordinate(static_cast<int>(i) + 1);
     }
+    coordinateIndex_.invalidate();
   }
 
   Vint getSiteCoordinates() const override
@@ -478,6 +497,7 @@ public:
     {
       site_(i).setCoordinate(vCoordinates[i]);
     }
+    coordinateIndex_.invalidate();
   }
 
   /** @} */
@@ -637,6 +657,7 @@ public:
     sequenceContainer_.clear();
     sequenceNames_.clear();
     sequenceComments_.clear();
+    coordinateIndex_.invalidate();
   }
 
   TemplateVectorSiteContainer<SiteType, SequenceType>* createEmptyContainer() const override
@@ -715,7 +736,7 @@ public:
       throw SequenceNotAlignedException("VectorSiteContainer::setSequence", sequence.get());
 
     // New sequence's alphabet and site container's alphabet matching verification
-    if (sequence->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!sequence->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("VectorSiteContainer::setSequence", getAlphabet(), sequence->getAlphabet());
 
     // Update elements at each site:
@@ -735,7 +756,7 @@ public:
       realloc_(sequence->size());
 
     // New sequence's alphabet and site container's alphabet matching verification
-    if (sequence->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!sequence->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("VectorSiteContainer::addSequence", getAlphabet(), sequence->getAlphabet());
 
     if (sequence->size() != getNumberOfSites())
@@ -768,7 +789,7 @@ public:
       throw SequenceNotAlignedException("VectorSiteContainer::insertSequence", sequence.get());
 
     // New sequence's alphabet and site container's alphabet matching verification
-    if (sequence->getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+    if (!sequence->getAlphabet()->isCompatibleWith(*getAlphabet()))
       throw AlphabetMismatchException("VectorSiteContainer::insertSequence", getAlphabet(), sequence->getAlphabet());
 
     // Update elements at each site:
@@ -803,6 +824,16 @@ protected:
     return *siteContainer_.getObject(sitePosition);
   }
 
+  /**
+   * @return The site coordinate index, built first if needed.
+   */
+  const SiteCoordinateIndex& getCoordinateIndex_()
+  {
+    if (!coordinateIndex_.isValid())
+      coordinateIndex_.build(getSiteCoordinates());
+    return coordinateIndex_;
+  }
+
   // Create n void sites:
   void realloc_(size_t n)
   {
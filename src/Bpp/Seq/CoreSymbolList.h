@@ -6,6 +6,7 @@
 #define BPP_SEQ_CORESYMBOLLIST_H
 
 #include <Bpp/Clonable.h>
+#include <Bpp/Exceptions.h>
 
 #include "Alphabet/Alphabet.h"
 
@@ -314,6 +315,15 @@ public:
 };
 
 
+/**
+ * @brief Deletion of a range of elements, or of scattered elements.
+ *
+ * In the latter case, the event carries a mask telling which elements of the
+ * list before the deletion are kept, so that listeners can filter their own
+ * data in one pass. Such an event does not describe a range: getPosition()
+ * and getLength() throw an Exception, and listeners must check isScattered()
+ * before calling them, or use filter(), which handles both cases.
+ */
 template<class T>
 class CoreSymbolListDeletionEvent :
   public CoreSymbolListEditionEvent<T>
@@ -321,21 +331,85 @@ class CoreSymbolListDeletionEvent :
 private:
   size_t pos_;
   size_t len_;
+  std::vector<bool> kept_;
 
 public:
   CoreSymbolListDeletionEvent(TemplateCoreSymbolListInterface<T>* list, size_t pos, size_t len) :
-    CoreSymbolListEditionEvent<T>(list), pos_(pos), len_(len)
+    CoreSymbolListEditionEvent<T>(list), pos_(pos), len_(len), kept_()
   {}
 
+  /**
+   * @param list The list edited.
+   * @param kept For each element of the list before the deletion, tell if it is kept.
+   */
+  CoreSymbolListDeletionEvent(TemplateCoreSymbolListInterface<T>* list, std::vector<bool> kept) :
+    CoreSymbolListEditionEvent<T>(list), pos_(0), len_(0), kept_(std::move(kept))
+  {
+    // Elements before the first deleted one are not filtered:
+    pos_ = static_cast<size_t>(std::find(kept_.begin(), kept_.end(), false) - kept_.begin());
+  }
+
 public:
+  /**
+   * @return The position of the first deleted element.
+   * @throw Exception If the deleted elements are scattered.
+   */
   virtual size_t getPosition() const
   {
+    if (isScattered())
+      throw Exception("CoreSymbolListDeletionEvent::getPosition: the deleted elements are scattered, see getKeptElements().");
     return pos_;
   }
+
+  /**
+   * @return The number of deleted elements.
+   * @throw Exception If the deleted elements are scattered.
+   */
   virtual size_t getLength() const
   {
+    if (isScattered())
+      throw Exception("CoreSymbolListDeletionEvent::getLength: the deleted elements are scattered, see getKeptElements().");
     return len_;
   }
+
+  /**
+   * @return True if the deleted elements are given by a mask rather than a range.
+   */
+  bool isScattered() const
+  {
+    return !kept_.empty();
+  }
+
+  /**
+   * @return For each element of the list before the deletion, true if it is kept.
+   * Empty if a range of elements is deleted.
+   */
+  const std::vector<bool>& getKeptElements() const
+  {
+    return kept_;
+  }
+
+  /**
+   * @brief Apply the deletion to data with one element per element of the list.
+   *
+   * @param data The data to filter, of the size of the list before the deletion.
+   */
+  template<class U>
+  void filter(std::vector<U>& data) const
+  {
+    if (!isScattered())
+    {
+      data.erase(data.begin() + static_cast<std::ptrdiff_t>(pos_), data.begin() + static_cast<std::ptrdiff_t>(pos_ + len_));
+      return;
+    }
+    size_t n = pos_;
+    for (size_t i = pos_; i < data.size(); ++i)
+    {
+      if (kept_[i])
+        data[n++] = data[i];
+    }
+    data.resize(n);
+  }
 };
 
 
@@ -0,0 +1,521 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include "Alphabet/AlphabetExceptions.h"
+#include "FMIndex.h"
+#include "SymbolListTools.h"
+
+// From the STL:
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BPP_SEQ_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace bpp;
+using namespace std;
+
+namespace
+{
+/**
+ * @brief The header of index files, in 64 bits words, followed by the sections of the index.
+ */
+enum HeaderField
+{
+  MAGIC, VERSION, TEXT_LENGTH, NB_CODES, SA_SAMPLING, NB_SEQUENCES, OFFSET,
+  ALPHABET_TYPE_SIZE, NAMES_SIZE, NB_SAMPLES, DATA_SIZE, HEADER_SIZE
+};
+
+const char MAGIC_STRING[8] = { 'B', 'P', 'P', 'F', 'M', 'I', 'D', 'X' };
+const uint64_t FORMAT_VERSION = 1;
+
+size_t getNumberOfWords(size_t nbBytes)
+{
+  return (nbBytes + 7) / 8;
+}
+
+/**
+ * @brief Build the suffix array of a text with SA-IS.
+ *
+ * Codes of the text must be in [0, upper]. Unlike the original algorithm, the
+ * text does not need to end with a unique sentinel. Positions are signed, as
+ * -1 marks empty cells.
+ */
+template<class Code, class Position>
+vector<Position> buildSuffixArray(const vector<Code>& text, Position upper)
+{
+  Position n = static_cast<Position>(text.size());
+  if (n == 0)
+    return vector<Position>();
+  if (n == 1)
+    return vector<Position>(1, 0);
+  if (n == 2)
+    return text[0] < text[1] ? vector<Position>({ 0, 1 }) : vector<Position>({ 1, 0 });
+
+  // S-type suffixes are smaller than the next one, L-type ones are larger:
+  vector<Position> sa(text.size());
+  vector<bool> sType(text.size(), false);
+  for (Position i = n - 2; i >= 0; --i)
+  {
+    sType[i] = text[i] == text[i + 1] ? sType[i + 1] : text[i] < text[i + 1];
+  }
+
+  // The start of the L-type and S-type buckets of each code:
+  vector<Position> lStarts(static_cast<size_t>(upper) + 1, 0);
+  vector<Position> sStarts(static_cast<size_t>(upper) + 1, 0);
+  for (Position i = 0; i < n; ++i)
+  {
+    if (!sType[i])
+      sStarts[text[i]]++;
+    else
+      lStarts[text[i] + 1]++;
+  }
+  for (Position c = 0; c <= upper; ++c)
+  {
+    sStarts[c] += lStarts[c];
+    if (c < upper)
+      lStarts[c + 1] += sStarts[c];
+  }
+
+  // Sort all suffixes from sorted LMS suffixes:
+  vector<Position> buckets(static_cast<size_t>(upper) + 1);
+  auto induce = [&](const vector<Position>& lms) {
+    fill(sa.begin(), sa.end(), -1);
+    copy(sStarts.begin(), sStarts.end(), buckets.begin());
+    for (Position p : lms)
+    {
+      if (p != n)
+        sa[buckets[text[p]]++] = p;
+    }
+    copy(lStarts.begin(), lStarts.end(), buckets.begin());
+    sa[buckets[text[n - 1]]++] = n - 1;
+    for (Position i = 0; i < n; ++i)
+    {
+      Position p = sa[i];
+      if (p >= 1 && !sType[p - 1])
+        sa[buckets[text[p - 1]]++] = p - 1;
+    }
+    copy(lStarts.begin(), lStarts.end(), buckets.begin());
+    for (Position i = n - 1; i >= 0; --i)
+    {
+      Position p = sa[i];
+      if (p >= 1 && sType[p - 1])
+        sa[--buckets[text[p - 1] + 1]] = p - 1;
+    }
+  };
+
+  // Leftmost S-type (LMS) positions:
+  vector<Position> lmsIndices(text.size() + 1, -1);
+  vector<Position> lms;
+  for (Position i = 1; i < n; ++i)
+  {
+    if (!sType[i - 1] && sType[i])
+    {
+      lmsIndices[i] = static_cast<Position>(lms.size());
+      lms.push_back(i);
+    }
+  }
+  Position m = static_cast<Position>(lms.size());
+  induce(lms);
+
+  if (m > 0)
+  {
+    // Name LMS substrings in their induced order, and sort them recursively if names are not unique:
+    vector<Position> sortedLms;
+    sortedLms.reserve(lms.size());
+    for (Position p : sa)
+    {
+      if (lmsIndices[p] != -1)
+        sortedLms.push_back(p);
+    }
+    vector<Position> reduced(lms.size());
+    Position name = 0;
+    reduced[lmsIndices[sortedLms[0]]] = 0;
+    for (Position i = 1; i < m; ++i)
+    {
+      Position l = sortedLms[i - 1];
+      Position r = sortedLms[i];
+      Position endL = lmsIndices[l] + 1 < m ? lms[lmsIndices[l] + 1] : n;
+      Position endR = lmsIndices[r] + 1 < m ? lms[lmsIndices[r] + 1] : n;
+      bool same = true;
+      if (endL - l != endR - r)
+        same = false;
+      else
+      {
+        while (l < endL && text[l] == text[r])
+        {
+          ++l;
+          ++r;
+        }
+        if (l == n || text[l] != text[r])
+          same = false;
+      }
+      if (!same)
+        ++name;
+      reduced[lmsIndices[sortedLms[i]]] = name;
+    }
+    vector<Position> reducedSa = buildSuffixArray<Position, Position>(reduced, name);
+    for (Position i = 0; i < m; ++i)
+    {
+      sortedLms[i] = lms[reducedSa[i]];
+    }
+    induce(sortedLms);
+  }
+  return sa;
+}
+
+/**
+ * @brief Compute the sections of the index from the suffix array: code counts,
+ * occurrences before each block of the transform, sampled rows and the transform.
+ */
+template<class Position>
+void fillSections(const vector<uint8_t>& text, const vector<Position>& sa, size_t saSampling, size_t nbCodes, uint64_t* counts)
+{
+  size_t textLength = text.size();
+  size_t nbBlocks = textLength / 64 + 1;
+  uint64_t* occurrences = counts + nbCodes + 1;
+  uint64_t* marks = occurrences + nbBlocks * nbCodes;
+  uint64_t* ranks = marks + nbBlocks;
+  uint64_t* samples = ranks + nbBlocks;
+  uint8_t* bwt = reinterpret_cast<uint8_t*>(samples + (textLength + saSampling - 1) / saSampling);
+  vector<uint64_t> codeCounts(nbCodes, 0);
+  size_t nbSampled = 0;
+  for (size_t row = 0; row < textLength; ++row)
+  {
+    if (row % 64 == 0)
+    {
+      copy(codeCounts.begin(), codeCounts.end(), occurrences + (row / 64) * nbCodes);
+      ranks[row / 64] = nbSampled;
+    }
+    size_t position = static_cast<size_t>(sa[row]);
+    uint8_t code = text[position == 0 ? textLength - 1 : position - 1];
+    bwt[row] = code;
+    codeCounts[code]++;
+    if (position % saSampling == 0)
+    {
+      marks[row / 64] |= static_cast<uint64_t>(1) << (row % 64);
+      samples[nbSampled++] = position;
+    }
+  }
+  if (textLength % 64 == 0)
+  {
+    copy(codeCounts.begin(), codeCounts.end(), occurrences + (textLength / 64) * nbCodes);
+    ranks[textLength / 64] = nbSampled;
+  }
+  for (size_t c = 0; c < nbCodes; ++c)
+  {
+    counts[c + 1] = counts[c] + codeCounts[c];
+  }
+}
+}
+
+/******************************************************************************/
+
+FMIndex::FMIndex(const SequenceContainerInterface& sequences, size_t saSampling) :
+  alphabet_(sequences.getAlphabet()),
+  names_(),
+  buffer_(),
+  data_(nullptr),
+  dataSize_(0),
+  mapped_(false),
+  textLength_(0),
+  nbCodes_(0),
+  saSampling_(saSampling),
+  offset_(SymbolListTools::getDenseCountsOffset(*sequences.getAlphabet())),
+  starts_(nullptr),
+  counts_(nullptr),
+  occurrences_(nullptr),
+  marks_(nullptr),
+  ranks_(nullptr),
+  samples_(nullptr),
+  bwt_(nullptr)
+{
+  if (saSampling_ == 0)
+    throw Exception("FMIndex. The suffix array sampling must be positive.");
+  size_t nbCodes = SymbolListTools::getDenseCountsSize(*alphabet_) + 2;
+  if (nbCodes > 256)
+    throw Exception("FMIndex. Alphabets with more than 254 states are not supported.");
+
+  // The text, with a separator after each sequence, and a final sentinel:
+  size_t nbSequences = sequences.getNumberOfSequences();
+  vector<uint64_t> starts(nbSequences + 1);
+  string names;
+  size_t textLength = 1;
+  for (size_t i = 0; i < nbSequences; ++i)
+  {
+    textLength += sequences.sequence(i).size() + 1;
+  }
+  vector<uint8_t> text;
+  text.reserve(textLength);
+  for (size_t i = 0; i < nbSequences; ++i)
+  {
+    const SequenceInterface& sequence = sequences.sequence(i);
+    starts[i] = text.size();
+    for (int state : sequence.getContent())
+    {
+      text.push_back(static_cast<uint8_t>(state - offset_ + 2));
+    }
+    text.push_back(1);
+    names_.push_back(sequence.getName());
+    names += sequence.getName();
+    names += '\0';
+  }
+  starts[nbSequences] = text.size();
+  text.push_back(0);
+
+  // Lay the sections out:
+  size_t nbBlocks = textLength / 64 + 1;
+  size_t nbSamples = (textLength + saSampling_ - 1) / saSampling_;
+  string alphabetType = alphabet_->getAlphabetType();
+  size_t dataSize = HEADER_SIZE + getNumberOfWords(alphabetType.size()) + nbSequences + 1 + getNumberOfWords(names.size())
+      + nbCodes + 1 + nbBlocks * nbCodes + 2 * nbBlocks + nbSamples + getNumberOfWords(textLength);
+  buffer_.assign(dataSize, 0);
+  memcpy(&buffer_[MAGIC], MAGIC_STRING, 8);
+  buffer_[VERSION] = FORMAT_VERSION;
+  buffer_[TEXT_LENGTH] = textLength;
+  buffer_[NB_CODES] = nbCodes;
+  buffer_[SA_SAMPLING] = saSampling_;
+  buffer_[NB_SEQUENCES] = nbSequences;
+  buffer_[OFFSET] = static_cast<uint64_t>(static_cast<int64_t>(offset_));
+  buffer_[ALPHABET_TYPE_SIZE] = alphabetType.size();
+  buffer_[NAMES_SIZE] = names.size();
+  buffer_[NB_SAMPLES] = nbSamples;
+  buffer_[DATA_SIZE] = dataSize;
+  data_ = buffer_.data();
+  dataSize_ = dataSize * 8;
+  setSections_();
+  uint64_t* section = &buffer_[HEADER_SIZE];
+  memcpy(section, alphabetType.data(), alphabetType.size());
+  section += getNumberOfWords(alphabetType.size());
+  copy(starts.begin(), starts.end(), section);
+  section += nbSequences + 1;
+  memcpy(section, names.data(), names.size());
+
+  // Positions are stored on 32 bits whenever possible, to save memory:
+  uint64_t* sections = buffer_.data() + (counts_ - data_);
+  if (textLength < static_cast<size_t>(INT32_MAX))
+  {
+    vector<int32_t> sa = buildSuffixArray<uint8_t, int32_t>(text, static_cast<int32_t>(nbCodes - 1));
+    fillSections(text, sa, saSampling_, nbCodes, sections);
+  }
+  else
+  {
+    vector<int64_t> sa = buildSuffixArray<uint8_t, int64_t>(text, static_cast<int64_t>(nbCodes - 1));
+    fillSections(text, sa, saSampling_, nbCodes, sections);
+  }
+}
+
+/******************************************************************************/
+
+FMIndex::FMIndex(const string& path, shared_ptr<const Alphabet> alphabet, bool memoryMapped) :
+  alphabet_(alphabet),
+  names_(),
+  buffer_(),
+  data_(nullptr),
+  dataSize_(0),
+  mapped_(false),
+  textLength_(0),
+  nbCodes_(0),
+  saSampling_(0),
+  offset_(0),
+  starts_(nullptr),
+  counts_(nullptr),
+  occurrences_(nullptr),
+  marks_(nullptr),
+  ranks_(nullptr),
+  samples_(nullptr),
+  bwt_(nullptr)
+{
+#ifdef BPP_SEQ_HAVE_MMAP
+  if (memoryMapped)
+  {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw IOException("FMIndex: can't open file " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+      ::close(fd);
+      throw IOException("FMIndex: can't stat file " + path);
+    }
+    dataSize_ = static_cast<size_t>(st.st_size);
+    if (dataSize_ < HEADER_SIZE * 8)
+    {
+      ::close(fd);
+      throw IOException("FMIndex: file " + path + " is not an index file.");
+    }
+    void* addr = ::mmap(nullptr, dataSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+      throw IOException("FMIndex: can't map file " + path);
+# ifdef MADV_RANDOM
+    ::madvise(addr, dataSize_, MADV_RANDOM);
+# endif
+    data_ = static_cast<const uint64_t*>(addr);
+    mapped_ = true;
+  }
+#endif
+  if (!mapped_)
+  {
+    ifstream input(path.c_str(), ios::in | ios::binary);
+    if (!input)
+      throw IOException("FMIndex: can't open file " + path);
+    input.seekg(0, ios::end);
+    dataSize_ = static_cast<size_t>(input.tellg());
+    input.seekg(0, ios::beg);
+    if (dataSize_ < HEADER_SIZE * 8)
+      throw IOException("FMIndex: file " + path + " is not an index file.");
+    buffer_.resize(getNumberOfWords(dataSize_));
+    input.read(reinterpret_cast<char*>(buffer_.data()), static_cast<streamsize>(dataSize_));
+    if (!input)
+      throw IOException("FMIndex: can't read file " + path);
+    data_ = buffer_.data();
+  }
+
+  if (memcmp(&data_[MAGIC], MAGIC_STRING, 8) != 0 || data_[VERSION] != FORMAT_VERSION || data_[DATA_SIZE] * 8 != dataSize_)
+  {
+    unmap_();
+    throw IOException("FMIndex: file " + path + " is not an index file, or was written by another version.");
+  }
+  string alphabetType(reinterpret_cast<const char*>(&data_[HEADER_SIZE]), static_cast<size_t>(data_[ALPHABET_TYPE_SIZE]));
+  if (alphabetType != alphabet_->getAlphabetType())
+  {
+    unmap_();
+    throw AlphabetException("FMIndex: file " + path + " indexes sequences with alphabet " + alphabetType + ".", alphabet_);
+  }
+  setSections_();
+  const char* names = reinterpret_cast<const char*>(starts_ + data_[NB_SEQUENCES] + 1);
+  for (size_t i = 0; i < data_[NB_SEQUENCES]; ++i)
+  {
+    names_.push_back(string(names));
+    names += names_.back().size() + 1;
+  }
+}
+
+/******************************************************************************/
+
+FMIndex::~FMIndex()
+{
+  unmap_();
+}
+
+void FMIndex::unmap_()
+{
+#ifdef BPP_SEQ_HAVE_MMAP
+  if (mapped_)
+    ::munmap(const_cast<uint64_t*>(data_), dataSize_);
+#endif
+  mapped_ = false;
+}
+
+/******************************************************************************/
+
+void FMIndex::setSections_()
+{
+  textLength_ = static_cast<size_t>(data_[TEXT_LENGTH]);
+  nbCodes_ = static_cast<size_t>(data_[NB_CODES]);
+  saSampling_ = static_cast<size_t>(data_[SA_SAMPLING]);
+  offset_ = static_cast<int>(static_cast<int64_t>(data_[OFFSET]));
+  size_t nbBlocks = textLength_ / 64 + 1;
+  starts_ = data_ + HEADER_SIZE + getNumberOfWords(static_cast<size_t>(data_[ALPHABET_TYPE_SIZE]));
+  counts_ = starts_ + data_[NB_SEQUENCES] + 1 + getNumberOfWords(static_cast<size_t>(data_[NAMES_SIZE]));
+  occurrences_ = counts_ + nbCodes_ + 1;
+  marks_ = occurrences_ + nbBlocks * nbCodes_;
+  ranks_ = marks_ + nbBlocks;
+  samples_ = ranks_ + nbBlocks;
+  bwt_ = reinterpret_cast<const uint8_t*>(samples_ + data_[NB_SAMPLES]);
+}
+
+/******************************************************************************/
+
+FMIndex::Range FMIndex::extend(const Range& range, int state) const
+{
+  Range extended;
+  int code = state - offset_ + 2;
+  if (range.empty() || code < 2 || code >= static_cast<int>(nbCodes_))
+    return extended;
+  uint8_t c = static_cast<uint8_t>(code);
+  extended.begin = static_cast<size_t>(counts_[c]) + getRank_(c, range.begin);
+  extended.end = static_cast<size_t>(counts_[c]) + getRank_(c, range.end);
+  return extended;
+}
+
+/******************************************************************************/
+
+FMIndex::Range FMIndex::find(const vector<int>& pattern) const
+{
+  if (pattern.empty())
+    return Range();
+  Range range = getFullRange();
+  for (size_t i = pattern.size(); i > 0 && !range.empty(); --i)
+  {
+    range = extend(range, pattern[i - 1]);
+  }
+  return range;
+}
+
+FMIndex::Range FMIndex::find(const SequenceInterface& pattern) const
+{
+  if (!pattern.alphabet().isCompatibleWith(*alphabet_))
+    throw AlphabetMismatchException("FMIndex::find. The pattern and the index do not have the same alphabet.", alphabet_, pattern.getAlphabet());
+  return find(pattern.getContent());
+}
+
+/******************************************************************************/
+
+FMIndex::Occurrence FMIndex::locate(size_t row) const
+{
+  if (row >= textLength_)
+    throw IndexOutOfBoundsException("FMIndex::locate.", row, 0, textLength_ - 1);
+  // Walk back in the text until a sampled position is found:
+  size_t steps = 0;
+  while (!((marks_[row / 64] >> (row % 64)) & 1))
+  {
+    uint8_t c = bwt_[row];
+    row = static_cast<size_t>(counts_[c]) + getRank_(c, row);
+    ++steps;
+  }
+  uint64_t lowBits = marks_[row / 64] & ((static_cast<uint64_t>(1) << (row % 64)) - 1);
+  size_t sample = static_cast<size_t>(ranks_[row / 64] + bitset<64>(lowBits).count());
+  size_t position = static_cast<size_t>(samples_[sample]) + steps;
+
+  const uint64_t* end = starts_ + names_.size() + 1;
+  size_t sequence = static_cast<size_t>(upper_bound(starts_, end, position) - starts_) - 1;
+  Occurrence occurrence;
+  occurrence.sequence = sequence;
+  occurrence.position = position - static_cast<size_t>(starts_[sequence]);
+  return occurrence;
+}
+
+void FMIndex::locate(const Range& range, vector<Occurrence>& occurrences) const
+{
+  size_t first = occurrences.size();
+  for (size_t row = range.begin; row < range.end; ++row)
+  {
+    occurrences.push_back(locate(row));
+  }
+  sort(occurrences.begin() + static_cast<ptrdiff_t>(first), occurrences.end(), [](const Occurrence& occurrence1, const Occurrence& occurrence2) {
+    return occurrence1.sequence < occurrence2.sequence || (occurrence1.sequence == occurrence2.sequence && occurrence1.position < occurrence2.position);
+  });
+}
+
+/******************************************************************************/
+
+void FMIndex::write(const string& path) const
+{
+  ofstream output(path.c_str(), ios::out | ios::binary | ios::trunc);
+  output.write(reinterpret_cast<const char*>(data_), static_cast<streamsize>(dataSize_));
+  output.close();
+  if (!output)
+    throw IOException("FMIndex: can't write file " + path);
+}
+
+/******************************************************************************/
@@ -0,0 +1,275 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_FMINDEX_H
+#define BPP_SEQ_FMINDEX_H
+
+#include "Alphabet/Alphabet.h"
+#include "Container/SequenceContainer.h"
+#include "Sequence.h"
+
+// From the STL:
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief A full-text index of a set of sequences, for exact substring queries.
+ *
+ * The sequences are concatenated, with a separator after each of them, and
+ * their suffix array is built with the SA-IS algorithm (Nong, Zhang and Chan,
+ * 2009), in linear time. The index only keeps the Burrows-Wheeler transform of
+ * the text, with sampled occurrence counts, and one suffix array entry out of
+ * a given number of text positions (FM-index, Ferragina and Manzini, 2000).
+ *
+ * The occurrences of a pattern form a range of rows of the suffix array,
+ * found by backward search, one state at a time, from the end of the pattern.
+ * Counting the occurrences only takes time proportional to the length of the
+ * pattern, while locating each of them takes at most the sampling distance
+ * steps. Ranges can also be extended state by state, for seed extension.
+ *
+ * Queries match states exactly: gaps and ambiguity codes are indexed as any
+ * other state, and occurrences never span several sequences.
+ *
+ * An index can be written to a file, and reloaded at once by mapping the file
+ * in memory, on systems supporting it. Otherwise, the file is read in memory.
+ */
+class FMIndex
+{
+public:
+  /**
+   * @brief A range [begin, end[ of rows of the suffix array, that is, of suffixes in lexicographic order.
+   */
+  struct Range
+  {
+    size_t begin = 0;
+    size_t end = 0;
+
+    size_t size() const
+    {
+      return end - begin;
+    }
+
+    bool empty() const
+    {
+      return end <= begin;
+    }
+  };
+
+  /**
+   * @brief An occurrence of a pattern.
+   */
+  struct Occurrence
+  {
+    size_t sequence = 0; // The index of the sequence, in the order of the container.
+    size_t position = 0; // The position of the first state, 0-based.
+  };
+
+private:
+  std::shared_ptr<const Alphabet> alphabet_;
+  std::vector<std::string> names_;
+
+  // The index data, in the layout of the files, either in a buffer or mapped:
+  std::vector<uint64_t> buffer_;
+  const uint64_t* data_;
+  size_t dataSize_;
+  bool mapped_;
+
+  size_t textLength_;        // With separators and the final sentinel.
+  size_t nbCodes_;           // Codes of the text: 0 for the sentinel, 1 for separators, then states.
+  size_t saSampling_;
+  int offset_;               // The smallest state of the alphabet, coded 2.
+  const uint64_t* starts_;   // The position of each sequence in the text, and the position of the sentinel.
+  const uint64_t* counts_;   // The number of codes smaller than each code.
+  const uint64_t* occurrences_; // The number of occurrences of each code before each block of the transform.
+  const uint64_t* marks_;    // The rows whose suffix array entry is sampled.
+  const uint64_t* ranks_;    // The number of sampled rows before each block.
+  const uint64_t* samples_;  // The sampled suffix array entries.
+  const uint8_t* bwt_;       // The Burrows-Wheeler transform, one code per byte.
+
+public:
+  /**
+   * @brief Build the index of all the sequences of a container.
+   *
+   * @param sequences The sequences to index.
+   * @param saSampling The distance between sampled suffix array entries, in
+   * text positions. Larger values save memory, but slow down locate queries.
+   * @throw Exception If the sampling is 0, or the alphabet has too many states.
+   */
+  FMIndex(const SequenceContainerInterface& sequences, size_t saSampling = 32);
+
+  /**
+   * @brief Load an index from a file written by write().
+   *
+   * @param path The path of the file.
+   * @param alphabet The alphabet of the indexed sequences.
+   * @param memoryMapped Tell if the file should be mapped in memory rather than read.
+   * @throw IOException If the file can't be read, or is not an index file.
+   * @throw AlphabetException If the index was built with another alphabet.
+   */
+  FMIndex(const std::string& path, std::shared_ptr<const Alphabet> alphabet, bool memoryMapped = true);
+
+  virtual ~FMIndex();
+
+private:
+  FMIndex(const FMIndex&) = delete;
+  FMIndex& operator=(const FMIndex&) = delete;
+
+public:
+  const Alphabet& alphabet() const
+  {
+    return *alphabet_;
+  }
+
+  std::shared_ptr<const Alphabet> getAlphabet() const
+  {
+    return alphabet_;
+  }
+
+  size_t getNumberOfSequences() const
+  {
+    return names_.size();
+  }
+
+  const std::string& getSequenceName(size_t sequence) const
+  {
+    return names_[sequence];
+  }
+
+  size_t getSequenceLength(size_t sequence) const
+  {
+    return static_cast<size_t>(starts_[sequence + 1] - starts_[sequence] - 1);
+  }
+
+  /**
+   * @return The distance between sampled suffix array entries, in text positions.
+   */
+  size_t getSuffixArraySampling() const
+  {
+    return saSampling_;
+  }
+
+  /**
+   * @return True if the index is mapped from a file.
+   */
+  bool isMemoryMapped() const
+  {
+    return mapped_;
+  }
+
+  /**
+   * @return The range of all the suffixes, which is the starting point of backward searches.
+   */
+  Range getFullRange() const
+  {
+    Range range;
+    range.end = textLength_;
+    return range;
+  }
+
+  /**
+   * @brief One step of backward search.
+   *
+   * @param range The range of the suffixes starting with a pattern.
+   * @param state A state of the alphabet.
+   * @return The range of the suffixes starting with the state followed by the pattern.
+   */
+  Range extend(const Range& range, int state) const;
+
+  /**
+   * @return The range of the suffixes starting with a pattern, found by backward search.
+   * An empty pattern is not found.
+   * @param pattern The states of the pattern.
+   */
+  Range find(const std::vector<int>& pattern) const;
+
+  /**
+   * @return The range of the suffixes starting with a pattern.
+   * @param pattern The pattern.
+   * @throw AlphabetMismatchException If the pattern does not have the alphabet of the index.
+   */
+  Range find(const SequenceInterface& pattern) const;
+
+  /**
+   * @return The number of occurrences of a pattern in the indexed sequences.
+   * @param pattern The states of the pattern.
+   */
+  size_t count(const std::vector<int>& pattern) const
+  {
+    return find(pattern).size();
+  }
+
+  /**
+   * @return The number of occurrences of a pattern in the indexed sequences.
+   * @param pattern The pattern.
+   * @throw AlphabetMismatchException If the pattern does not have the alphabet of the index.
+   */
+  size_t count(const SequenceInterface& pattern) const
+  {
+    return find(pattern).size();
+  }
+
+  /**
+   * @return The occurrence corresponding to a row of the suffix array.
+   * @param row A row of a range returned by the search of a non-empty pattern.
+   * @throw IndexOutOfBoundsException If the row is not a row of the suffix array.
+   */
+  Occurrence locate(size_t row) const;
+
+  /**
+   * @brief Locate all the occurrences of a range.
+   *
+   * @param range A range returned by a search.
+   * @param occurrences [out] The vector where occurrences are appended, sorted by sequence and position.
+   */
+  void locate(const Range& range, std::vector<Occurrence>& occurrences) const;
+
+  /**
+   * @brief Locate all the occurrences of a pattern.
+   *
+   * @param pattern The pattern.
+   * @param occurrences [out] The vector where occurrences are appended, sorted by sequence and position.
+   * @throw AlphabetMismatchException If the pattern does not have the alphabet of the index.
+   */
+  void locate(const SequenceInterface& pattern, std::vector<Occurrence>& occurrences) const
+  {
+    locate(find(pattern), occurrences);
+  }
+
+  /**
+   * @brief Write the index to a file, which can be mapped in memory later on.
+   *
+   * @param path The path of the file.
+   * @throw IOException If the file can't be written.
+   */
+  void write(const std::string& path) const;
+
+private:
+  /**
+   * @brief Set the pointers to the sections of the index data.
+   */
+  void setSections_();
+
+  void unmap_();
+
+  /**
+   * @return The number of occurrences of a code in the rows [0, row[ of the transform.
+   */
+  size_t getRank_(uint8_t code, size_t row) const
+  {
+    size_t block = row / 64;
+    size_t rank = static_cast<size_t>(occurrences_[block * nbCodes_ + code]);
+    for (size_t i = block * 64; i < row; ++i)
+    {
+      if (bwt_[i] == code)
+        ++rank;
+    }
+    return rank;
+  }
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_FMINDEX_H
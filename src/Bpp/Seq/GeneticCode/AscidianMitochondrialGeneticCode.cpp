@@ -77,4 +77,5 @@ void AscidianMitochondrialGeneticCode::init_()
   tlnTable_[62] = 10; // TTG -> L
   tlnTable_[63] = 13; // TTT -> F
   tlnTable_[codonAlphabet_->getUnknownCharacterCode()] = proteicAlphabet_->getUnknownCharacterCode();
+  initTables_();
 }
@@ -11,6 +11,13 @@ using namespace std;
 
 /**********************************************************************************************/
 
+const int GeneticCode::NO_TRANSLATION = -99;
+const unsigned char GeneticCode::STOP = 1;
+const unsigned char GeneticCode::START = 2;
+const unsigned char GeneticCode::ALT_START = 4;
+
+/**********************************************************************************************/
+
 StopCodonException::StopCodonException(const std::string& text, const std::string& codon) :
   Exception("StopCodonException: " + text + "(" + codon + ")"),
   codon_(codon)
@@ -18,8 +25,65 @@ StopCodonException::StopCodonException(const std::string& text, const std::strin
 
 /**********************************************************************************************/
 
+void GeneticCode::initTables_()
+{
+  // Gap, resolved codons and unknown codon:
+  size_t nbCodons = codonAlphabet_->getSize();
+  aminoAcids_.assign(nbCodons + 2, NO_TRANSLATION);
+  codonTypes_.assign(nbCodons + 2, 0);
+  nucleotideTranslations_.assign(nbCodons, proteicAlphabet_->getUnknownCharacterCode());
+  synonyms_.clear();
+  int stop = proteicAlphabet_->charToInt("*");
+  for (int state = -1; state <= static_cast<int>(nbCodons); ++state)
+  {
+    size_t i = static_cast<size_t>(state + 1);
+    codonTypes_[i] = computeCodonType_(state);
+    auto it = tlnTable_.find(state);
+    if (!(codonTypes_[i] & STOP) && it != tlnTable_.end())
+      aminoAcids_[i] = it->second;
+    if (state >= 0 && state < static_cast<int>(nbCodons))
+    {
+      nucleotideTranslations_[i - 1] = (codonTypes_[i] & STOP) ? stop : aminoAcids_[i];
+      if (aminoAcids_[i] >= 0)
+      {
+        size_t aa = static_cast<size_t>(aminoAcids_[i]);
+        if (aa >= synonyms_.size())
+          synonyms_.resize(aa + 1);
+        synonyms_[aa].push_back(state);
+      }
+    }
+  }
+}
+
+/**********************************************************************************************/
+
+unsigned char GeneticCode::computeCodonType_(int state) const
+{
+  unsigned char type = 0;
+  if (isStop(state))
+    type |= STOP;
+  if (isStart(state))
+    type |= START;
+  if (isAltStart(state))
+    type |= ALT_START;
+  return type;
+}
+
+/**********************************************************************************************/
+
 int GeneticCode::translate(int state) const
 {
+  size_t i = static_cast<size_t>(state + 1);
+  if (i < aminoAcids_.size())
+  {
+    if (codonTypes_[i] & STOP)
+      throw StopCodonException("GeneticCode::translate().", codonAlphabet_->intToChar(state));
+    if (aminoAcids_[i] == NO_TRANSLATION)
+      throw BadIntException(state, "GeneticCode::translate().", codonAlphabet_.get());
+    return aminoAcids_[i];
+  }
+
+  // Invalid states, or codes without dense tables:
   if (isStop(state))
     throw StopCodonException("GeneticCode::translate().", codonAlphabet_->intToChar(state));
 
@@ -45,6 +109,13 @@ vector<int> GeneticCode::getSynonymous(int aminoacid) const
   // test:
   proteicAlphabet_->intToChar(aminoacid);
 
+  if (!aminoAcids_.empty())
+  {
+    if (aminoacid < 0 || static_cast<size_t>(aminoacid) >= synonyms_.size())
+      return vector<int>();
+    return synonyms_[static_cast<size_t>(aminoacid)];
+  }
+
   vector<int> synonyms;
   for (int i = 0; i < static_cast<int>(codonAlphabet_->getSize()); ++i)
   {
@@ -67,15 +138,9 @@ std::vector<std::string> GeneticCode::getSynonymous(const std::string& aminoacid
   int aa = proteicAlphabet_->charToInt(aminoacid);
 
   vector<string> synonyms;
-  for (int i = 0; i < static_cast<int>(codonAlphabet_->getSize()); ++i)
+  for (int i : getSynonymous(aa))
   {
-    try
-    {
-      if (translate(i) == aa)
-        synonyms.push_back(codonAlphabet_->intToChar(i));
-    }
-    catch (StopCodonException&)
-    {}
+    synonyms.push_back(codonAlphabet_->intToChar(i));
   }
   return synonyms;
 }
@@ -179,3 +244,52 @@ unique_ptr<Sequence> GeneticCode::getCodingSequence(
 }
 
 /**********************************************************************************************/
+
+size_t GeneticCode::translateNucleotides(const int* nucleotides, size_t length, int* aminoAcids, bool reverseComplement) const
+{
+  if (nucleotideTranslations_.empty())
+    throw Exception("GeneticCode::translateNucleotides. The genetic code has no translation table.");
+  const int* table = nucleotideTranslations_.data();
+  int unknown = proteicAlphabet_->getUnknownCharacterCode();
+  int gap = proteicAlphabet_->getGapCharacterCode();
+  size_t nbCodons = length / 3;
+  ptrdiff_t step = reverseComplement ? -1 : 1;
+  for (size_t k = 0; k < nbCodons; ++k)
+  {
+    const int* p = reverseComplement ? nucleotides + length - 3 * k - 1 : nucleotides + 3 * k;
+    int codon = getNucleotideCodon_(p, reverseComplement);
+    if (codon >= 0)
+      aminoAcids[k] = table[codon];
+    else if (p[0] == -1 && p[step] == -1 && p[2 * step] == -1)
+      aminoAcids[k] = gap;
+    else
+      aminoAcids[k] = unknown;
+  }
+  return nbCodons;
+}
+
+/**********************************************************************************************/
+
+vector<unique_ptr<Sequence>> GeneticCode::translateSixFrames(const SequenceInterface& sequence) const
+{
+  if (!AlphabetTools::isNucleicAlphabet(sequence.alphabet()))
+    throw AlphabetException("GeneticCode::translateSixFrames. Sequence must be a nucleotide sequence.", sequence.getAlphabet());
+  const vector<int>& content = sequence.getContent();
+  shared_ptr<const Alphabet> alphabet = proteicAlphabet_;
+  vector<unique_ptr<Sequence>> frames;
+  for (bool reverseComplement : { false, true })
+  {
+    for (size_t frame = 0; frame < 3; ++frame)
+    {
+      size_t length = content.size() > frame ? content.size() - frame : 0;
+      vector<int> aminoAcids(length / 3);
+      if (length > 0)
+        translateNucleotides(reverseComplement ? content.data() : content.data() + frame, length, aminoAcids.data(), reverseComplement);
+      auto protein = make_unique<Sequence>(sequence.getName(), aminoAcids, alphabet);
+      frames.push_back(std::move(protein));
+    }
+  }
+  return frames;
+}
+
+/**********************************************************************************************/
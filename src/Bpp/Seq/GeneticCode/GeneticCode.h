@@ -12,6 +12,11 @@
 #include "../Alphabet/ProteicAlphabet.h"
 #include "../Transliterator.h"
 
+// From the STL:
+#include <map>
+#include <memory>
+#include <vector>
+
 namespace bpp
 {
 /**
@@ -57,12 +62,42 @@ protected:
   std::shared_ptr<const ProteicAlphabet> proteicAlphabet_;
   std::map<int, int> tlnTable_;
 
+  /**
+   * @name Dense version of the code, built by initTables_().
+   *
+   * Codon tables are indexed by the codon state + 1, so that the gap comes first.
+   *
+   * @{
+   */
+  std::vector<int> aminoAcids_; // The translation of each codon, NO_TRANSLATION for stops and gaps.
+  std::vector<unsigned char> codonTypes_; // STOP, START and ALT_START flags.
+  std::vector<int> nucleotideTranslations_; // Translation of the 64 resolved codons, stops included.
+  std::vector<std::vector<int>> synonyms_; // The codons encoding each amino acid.
+  /** @} */
+
+  static const int NO_TRANSLATION;
+
+public:
+  /**
+   * @name Codon types, as returned by getCodonType().
+   *
+   * @{
+   */
+  static const unsigned char STOP;
+  static const unsigned char START;
+  static const unsigned char ALT_START;
+  /** @} */
+
 public:
   GeneticCode(std::shared_ptr<const NucleicAlphabet> alphabet) :
     AbstractTransliterator(),
     codonAlphabet_(new CodonAlphabet(alphabet)),
     proteicAlphabet_(AlphabetTools::PROTEIN_ALPHABET),
-    tlnTable_()
+    tlnTable_(),
+    aminoAcids_(),
+    codonTypes_(),
+    nucleotideTranslations_(),
+    synonyms_()
   {}
 
   virtual ~GeneticCode()
@@ -224,6 +259,33 @@ public:
    */
   virtual bool isAltStart(const std::string& state) const = 0;
 
+  /**
+   * @brief Get the type of a codon, in constant time.
+   *
+   * @param state The numeric code for the codon.
+   * @return The STOP, START and ALT_START flags of the codon, 0 for gaps and unknown codons.
+   * @throw BadIntException If the state is not a codon of the alphabet.
+   */
+  unsigned char getCodonType(int state) const
+  {
+    size_t i = static_cast<size_t>(state + 1);
+    return i < codonTypes_.size() ? codonTypes_[i] : computeCodonType_(state);
+  }
+
+  /**
+   * @brief Get the type of a codon read from nucleotide states, as in translateNucleotides().
+   *
+   * @param nucleotides A pointer to the first nucleotide of the codon, or to
+   * its last one on the complementary strand, where the codon is read backward.
+   * @param reverseComplement Tell if the codon is read on the complementary strand.
+   * @return The STOP, START and ALT_START flags of the codon, 0 if a nucleotide is not resolved.
+   */
+  unsigned char getCodonType(const int* nucleotides, bool reverseComplement = false) const
+  {
+    int codon = getNucleotideCodon_(nucleotides, reverseComplement);
+    return codon < 0 ? 0 : getCodonType(codon);
+  }
+
   /**
    * @brief Tell if two codons are synonymous, that is, if they encode the same amino-acid.
    *
@@ -278,7 +340,68 @@ public:
    * @return A nucleotide/codon subsequence.
    */
   std::unique_ptr<Sequence> getCodingSequence(const SequenceInterface& sequence, bool lookForInitCodon = false, bool includeInitCodon = false) const;
+
+  /**
+   * @brief Translate nucleotides into amino acids, in one reading frame.
+   *
+   * Nucleotides are read three by three from the start of the buffer, or
+   * from its end on the complementary strand, and an incomplete last codon is
+   * ignored. No codon sequence is built. Stop codons are translated into the
+   * stop state of the protein alphabet ('*'), codons made of gaps only into
+   * gaps, and codons with other gaps or unresolved nucleotides into unknown
+   * amino acids.
+   *
+   * @param nucleotides States of a nucleic alphabet (DNA or RNA).
+   * @param length The number of nucleotides in the buffer.
+   * @param aminoAcids [out] A buffer for at least length / 3 amino acid states.
+   * @param reverseComplement Tell if the buffer is read on the complementary strand,
+   * starting from its end.
+   * @return The number of amino acids written.
+   */
+  size_t translateNucleotides(const int* nucleotides, size_t length, int* aminoAcids, bool reverseComplement = false) const;
+
+  /**
+   * @brief Translate a nucleotide sequence in its six reading frames.
+   *
+   * Translation is performed as with translateNucleotides().
+   *
+   * @param sequence A DNA or RNA sequence.
+   * @return Six protein sequences with the name of the input sequence: the
+   * translations in frames 1, 2 and 3 of the sequence, then in frames 1, 2 and
+   * 3 of its reverse complement.
+   * @throw AlphabetException If the sequence is not a nucleotide sequence.
+   */
+  std::vector<std::unique_ptr<Sequence>> translateSixFrames(const SequenceInterface& sequence) const;
   /** @} */
+
+protected:
+  /**
+   * @return The codon made of three nucleotide states, read backward and complemented
+   * on the complementary strand, or -1 if a nucleotide is not resolved.
+   */
+  static int getNucleotideCodon_(const int* nucleotides, bool reverseComplement)
+  {
+    int n1 = nucleotides[0];
+    int n2 = reverseComplement ? nucleotides[-1] : nucleotides[1];
+    int n3 = reverseComplement ? nucleotides[-2] : nucleotides[2];
+    if ((n1 | n2 | n3) & ~3)
+      return -1;
+    // A, C, G and T (or U) are coded 0 to 3, and complement each other as x and 3 - x:
+    int codon = 16 * n1 + 4 * n2 + n3;
+    return reverseComplement ? 63 - codon : codon;
+  }
+
+  /**
+   * @return The type of a codon, for codes without dense tables.
+   */
+  unsigned char computeCodonType_(int state) const;
+
+  /**
+   * @brief Build the dense version of the code, from tlnTable_ and the stop and start codons.
+   *
+   * This must be called by derived classes once tlnTable_ is filled.
+   */
+  void initTables_();
 };
 } // end of namespace bpp.
 #endif // BPP_SEQ_GENETICCODE_GENETICCODE_H
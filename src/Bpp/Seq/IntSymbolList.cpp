@@ -5,10 +5,148 @@
 #include "IntSymbolList.h"
 #include "StringSequenceTools.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace bpp;
 
 using namespace std;
 
+namespace
+{
+/**
+ * @brief Move the elements different from a given state to the front of an array.
+ *
+ * @return The number of elements kept.
+ */
+size_t removeState(int* content, size_t length, int state)
+{
+  size_t i = 0;
+  size_t j = 0;
+#if defined(__SSE2__)
+  __m128i s = _mm_set1_epi32(state);
+  for ( ; i + 4 <= length; i += 4)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(content + i));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, s)));
+    if (mask == 0)
+    {
+      // Nothing to remove: the whole block is moved (j <= i, and the block is already loaded).
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(content + j), v);
+      j += 4;
+    }
+    else if (mask != 0xF)
+    {
+      alignas(16) int block[4];
+      _mm_store_si128(reinterpret_cast<__m128i*>(block), v);
+      for (int k = 0; k < 4; ++k)
+      {
+        if (!(mask & (1 << k)))
+          content[j++] = block[k];
+      }
+    }
+  }
+#endif
+  for ( ; i < length; ++i)
+  {
+    if (content[i] != state)
+      content[j++] = content[i];
+  }
+  return j;
+}
+
+/**
+ * @brief Complement nucleotides 4 at a time, and possibly reverse the array.
+ *
+ * The table t maps states 0 to 3 to t[0] - state. Blocks containing other
+ * states are converted one element at a time.
+ *
+ * @return The number of elements converted from the start of the array, and
+ * from its end if it is reversed.
+ */
+size_t complementBlocks(int* content, size_t length, const int* t, bool reverse)
+{
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128i k = _mm_set1_epi32(t[0]);
+  __m128i notResolved = _mm_set1_epi32(~3);
+  __m128i zero = _mm_setzero_si128();
+  if (!reverse)
+  {
+    for ( ; i + 4 <= length; i += 4)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(content + i));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(v, notResolved), zero)) == 0xFFFF)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(content + i), _mm_sub_epi32(k, v));
+      else
+      {
+        for (size_t m = i; m < i + 4; ++m)
+        {
+          content[m] = t[content[m]];
+        }
+      }
+    }
+    return i;
+  }
+  // The block at the start of the array and the symmetric block at its end are swapped:
+  for ( ; 2 * i + 8 <= length; i += 4)
+  {
+    int* front = content + i;
+    int* back = content + length - i - 4;
+    __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(front));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(back));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(f, b), notResolved), zero)) == 0xFFFF)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(front), _mm_sub_epi32(k, _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 1, 2, 3))));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(back), _mm_sub_epi32(k, _mm_shuffle_epi32(f, _MM_SHUFFLE(0, 1, 2, 3))));
+    }
+    else
+    {
+      for (size_t m = 0; m < 4; ++m)
+      {
+        int x = front[m];
+        front[m] = t[back[3 - m]];
+        back[3 - m] = t[x];
+      }
+    }
+  }
+#endif
+  return i;
+}
+}
+
+
+/****************************************************************************************/
+
+void IntSymbolListInterface::removeStates(const vector<bool>& removed, int offset)
+{
+  vector<int> content;
+  content.reserve(size());
+  for (int x : getContent())
+  {
+    if (x < offset || static_cast<size_t>(x - offset) >= removed.size() || !removed[static_cast<size_t>(x - offset)])
+      content.push_back(x);
+  }
+  if (content.size() != size())
+    setContent(content);
+}
+
+/****************************************************************************************/
+
+void IntSymbolListInterface::translateStates(const vector<int>& table, int offset, bool reverse)
+{
+  vector<int> content(getContent());
+  for (int& x : content)
+  {
+    if (x < offset || static_cast<size_t>(x - offset) >= table.size())
+      throw Exception("IntSymbolListInterface::translateStates. The conversion table does not cover all states of the alphabet.");
+    x = table[static_cast<size_t>(x - offset)];
+  }
+  if (reverse)
+    std::reverse(content.begin(), content.end());
+  setContent(content);
+}
 
 /****************************************************************************************/
 
@@ -16,14 +154,14 @@ void IntSymbolList::setContent(const vector<string>& list)
 {
   // Check list for incorrect characters
   vector<int> coded(list.size());
-  for (auto i : list)
+  for (const auto& i : list)
   {
     if (!getAlphabet()->isCharInAlphabet(i))
       throw BadCharException(i, "IntSymbolList::setContent", getAlphabet());
   }
 
   size_t j = 0;
-  for (auto i : list)
+  for (const auto& i : list)
   {
     coded[j++] = getAlphabet()->charToInt(i);
   }
@@ -67,18 +205,87 @@ string IntSymbolList::getChar(size_t pos) const
 
 /****************************************************************************************/
 
+void IntSymbolList::removeStates(const vector<bool>& removed, int offset)
+{
+  size_t nbRemoved = static_cast<size_t>(count(removed.begin(), removed.end(), true));
+  if (nbRemoved == 0)
+    return;
+  size_t kept;
+  if (nbRemoved == 1)
+  {
+    // Typically gaps:
+    int state = offset + static_cast<int>(find(removed.begin(), removed.end(), true) - removed.begin());
+    kept = removeState(content_.data(), content_.size(), state);
+  }
+  else
+  {
+    kept = 0;
+    for (size_t i = 0; i < content_.size(); ++i)
+    {
+      int x = content_[i];
+      if (x < offset || static_cast<size_t>(x - offset) >= removed.size() || !removed[static_cast<size_t>(x - offset)])
+        content_[kept++] = x;
+    }
+  }
+  content_.resize(kept);
+}
+
+/****************************************************************************************/
+
+void IntSymbolList::translateStates(const vector<int>& table, int offset, bool reverse)
+{
+  const vector<int>& states = getAlphabet()->getSupportedInts();
+  auto range = minmax_element(states.begin(), states.end());
+  if (*range.first < offset || static_cast<size_t>(*range.second - offset) >= table.size())
+    throw Exception("IntSymbolList::translateStates. The conversion table does not cover all states of the alphabet.");
+  for (int x : table)
+  {
+    if (!getAlphabet()->isIntInAlphabet(x))
+      throw BadIntException(x, "IntSymbolList::translateStates", getAlphabet());
+  }
+
+  // Nucleotide complements are vectorized:
+  size_t done = 0;
+  const int* t = table.data() - offset;
+  if (offset <= 0 && table.size() >= static_cast<size_t>(4 - offset) &&
+      t[1] == t[0] - 1 && t[2] == t[0] - 2 && t[3] == t[0] - 3)
+    done = complementBlocks(content_.data(), content_.size(), t, reverse);
+
+  size_t n = content_.size();
+  if (reverse)
+  {
+    for (size_t i = done; i < n / 2; ++i)
+    {
+      int x = content_[i];
+      content_[i] = t[content_[n - 1 - i]];
+      content_[n - 1 - i] = t[x];
+    }
+    if (n % 2)
+      content_[n / 2] = t[content_[n / 2]];
+  }
+  else
+  {
+    for (size_t i = done; i < n; ++i)
+    {
+      content_[i] = t[content_[i]];
+    }
+  }
+}
+
+/****************************************************************************************/
+
 void EventDrivenIntSymbolList::setContent(const vector<string>& list)
 {
   // Check list for incorrect characters
   vector<int> coded(list.size());
-  for (auto i : list)
+  for (const auto& i : list)
   {
     if (!getAlphabet()->isCharInAlphabet(i))
       throw BadCharException(i, "EventDrivenIntSymbolList::setContent", getAlphabet());
   }
 
   size_t j = 0;
-  for (auto i : list)
+  for (const auto& i : list)
   {
     coded[j++] = getAlphabet()->charToInt(i);
   }
@@ -146,3 +353,48 @@ string EventDrivenIntSymbolList::getChar(size_t pos) const
   }
   return c;
 }
+
+/****************************************************************************************/
+
+void EventDrivenIntSymbolList::removeStates(const vector<bool>& removed, int offset)
+{
+  if (getNumberOfListeners() == 0)
+  {
+    IntSymbolListEditionEvent event(this);
+    fireBeforeSequenceChanged(event);
+    IntSymbolList::removeStates(removed, offset);
+    fireAfterSequenceChanged(event);
+    return;
+  }
+
+  // Listeners filter their data with the mask of the kept elements:
+  vector<bool> kept(content_.size());
+  bool changed = false;
+  for (size_t i = 0; i < content_.size(); ++i)
+  {
+    int x = content_[i];
+    kept[i] = x < offset || static_cast<size_t>(x - offset) >= removed.size() || !removed[static_cast<size_t>(x - offset)];
+    changed = changed || !kept[i];
+  }
+  if (!changed)
+    return;
+  IntSymbolListDeletionEvent event(this, move(kept));
+  fireBeforeSequenceDeleted(event);
+  event.filter(content_);
+  fireAfterSequenceDeleted(event);
+}
+
+/****************************************************************************************/
+
+void EventDrivenIntSymbolList::translateStates(const vector<int>& table, int offset, bool reverse)
+{
+  if (content_.empty())
+  {
+    IntSymbolList::translateStates(table, offset, reverse);
+    return;
+  }
+  IntSymbolListSubstitutionEvent event(this, 0, content_.size() - 1);
+  fireBeforeSequenceSubstituted(event);
+  IntSymbolList::translateStates(table, offset, reverse);
+  fireAfterSequenceSubstituted(event);
+}
@@ -93,6 +93,43 @@ public:
   virtual std::string getChar(size_t pos) const = 0;
 
   /** @} */
+
+  /**
+   * @name Bulk edition methods.
+   *
+   * These methods rewrite the whole content of the list in one pass, which
+   * is much faster than editing elements one by one.
+   *
+   * @{
+   */
+
+  /**
+   * @brief Remove all elements in a given set of states.
+   *
+   * @param removed A table telling, for each state s, if elements in state s
+   * are removed (removed[s - offset] is true). Elements in states outside the
+   * table are kept.
+   * @param offset The state corresponding to the first position in the table.
+   *
+   * The default implementation rewrites the content with setContent().
+   */
+  virtual void removeStates(const std::vector<bool>& removed, int offset);
+
+  /**
+   * @brief Replace all states using a conversion table, and possibly reverse the list.
+   *
+   * @param table A table giving, for each state s, the new state table[s - offset].
+   * The table must cover all the states supported by the alphabet.
+   * @param offset The state corresponding to the first position in the table.
+   * @param reverse Tell if the order of the elements is also reversed.
+   * @throw Exception If the table does not cover all the states of the alphabet.
+   * @throw BadIntException If the table contains an invalid state.
+   *
+   * The default implementation rewrites the content with setContent().
+   */
+  virtual void translateStates(const std::vector<int>& table, int offset, bool reverse);
+
+  /** @} */
 };
 
 
@@ -182,6 +219,21 @@ public:
 
   void setContent(const std::vector<std::string>& list) override;
 
+  /**
+   * @brief Exchange the content of the list with a vector of states, without copy.
+   *
+   * This is meant to be used by parsers that decode a whole list in one pass.
+   *
+   * @warning No alphabet checking is performed, so use with care, or
+   * consider using the setContent() method.
+   *
+   * @param list The new content of the list. On output, contains the former content of the list.
+   */
+  void swapContent(std::vector<int>& list)
+  {
+    content_.swap(list);
+  }
+
   std::string toString() const override
   {
     auto alphaPtr = getAlphabet();
@@ -213,6 +265,10 @@ public:
 
   std::string getChar(size_t pos) const override;
 
+  void removeStates(const std::vector<bool>& removed, int offset) override;
+
+  void translateStates(const std::vector<int>& table, int offset, bool reverse) override;
+
   /**
    * @brief get value of a state at a position
    *
@@ -383,6 +439,23 @@ public:
 
   virtual std::string getChar(size_t pos) const override;
 
+  /**
+   * @brief Remove all elements in a given set of states.
+   *
+   * Without listeners, a single content change event is fired. Otherwise,
+   * a single deletion event is fired, carrying the mask of the kept elements,
+   * so that listeners can filter their own data in one pass
+   * (see CoreSymbolListDeletionEvent::filter).
+   */
+  void removeStates(const std::vector<bool>& removed, int offset) override;
+
+  /**
+   * @brief Replace all states using a conversion table, and possibly reverse the list.
+   *
+   * A single substitution event is fired for the whole list.
+   */
+  void translateStates(const std::vector<int>& table, int offset, bool reverse) override;
+
   void addIntSymbolListListener(std::shared_ptr<IntSymbolListListener> listener)
   {
     addCoreSymbolListListener(std::move(listener));
@@ -10,6 +10,7 @@
 #include "../Container/AlignedSequenceContainer.h"
 #include "../Container/VectorSiteContainer.h"
 #include "AbstractISequence.h"
+#include "BgzfStream.h"
 
 // From the STL:
 #include <string>
@@ -94,11 +95,10 @@ protected:
    */
   virtual void appendAlignmentFromFile(const std::string& path, SequenceContainerInterface& sc) const
   {
-    std::ifstream input(path.c_str(), std::ios::in);
-    if (!input)
+    auto input = BgzfInputStream::openFile(path);
+    if (!*input)
       throw IOException("AbstractIAlignment::appendAlignmentFromFile: can't read file " + path);
-    appendAlignmentFromStream(input, sc);
-    input.close();
+    appendAlignmentFromStream(*input, sc);
   }
 
   /**
@@ -255,11 +255,10 @@ protected:
    */
   virtual void appendAlignmentFromFile(const std::string& path, ProbabilisticSequenceContainerInterface& sc) const
   {
-    std::ifstream input(path.c_str(), std::ios::in);
-    if (!input)
+    auto input = BgzfInputStream::openFile(path);
+    if (!*input)
       throw IOException("AbstractIProbabilisticAlignment::appendAlignmentFromFile: can't read file " + path);
-    appendAlignmentFromStream(input, sc);
-    input.close();
+    appendAlignmentFromStream(*input, sc);
   }
 
   /**
@@ -8,6 +8,7 @@
 
 #include "../Alphabet/Alphabet.h"
 #include "../Container/VectorSequenceContainer.h"
+#include "BgzfStream.h"
 #include "ISequence.h"
 
 // From the STL:
@@ -93,11 +94,10 @@ protected:
    */
   virtual void appendSequencesFromFile(const std::string& path, SequenceContainerInterface& sc) const
   {
-    std::ifstream input(path.c_str(), std::ios::in);
-    if (!input)
+    auto input = BgzfInputStream::openFile(path);
+    if (!*input)
       throw IOException("AbstractIAlignment::appendSequencesFromFile: can't read file " + path);
-    appendSequencesFromStream(input, sc);
-    input.close();
+    appendSequencesFromStream(*input, sc);
   }
 
   /**
@@ -207,11 +207,10 @@ protected:
    */
   virtual void appendSequencesFromFile(const std::string& path, ProbabilisticSequenceContainerInterface& sc) const
   {
-    std::ifstream input(path.c_str(), std::ios::in);
-    if (!input)
+    auto input = BgzfInputStream::openFile(path);
+    if (!*input)
       throw IOException("AbstractIProbabilisticSequences::appendSequencesFromFile: can't read file " + path);
-    appendSequencesFromStream(input, sc);
-    input.close();
+    appendSequencesFromStream(*input, sc);
   }
 
   /**
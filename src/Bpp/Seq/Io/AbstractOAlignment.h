@@ -8,6 +8,7 @@
 
 #include "../Alphabet/Alphabet.h"
 #include "../Container/VectorSequenceContainer.h"
+#include "BgzfStream.h"
 #include "OSequence.h"
 
 // From the STL:
@@ -39,9 +40,9 @@ public:
   void writeAlignment(const std::string& path, const SiteContainerInterface& sc, bool overwrite = true) const override
   {
     // Open file in specified mode
-    std::ofstream output(path.c_str(), overwrite ? (std::ios::out) : (std::ios::out | std::ios::app));
-    writeAlignment(output, sc);
-    output.close();
+    auto output = BgzfOutputStream::openFile(path, !overwrite);
+    writeAlignment(*output, sc);
+    BgzfOutputStream::closeFile(*output);
   }
   /** @} */
 };
@@ -69,9 +70,9 @@ public:
   void writeAlignment(const std::string& path, const ProbabilisticSiteContainerInterface& psc, bool overwrite = true) const override
   {
     // Open file in specified mode
-    std::ofstream output(path.c_str(), overwrite ? (std::ios::out) : (std::ios::out | std::ios::app));
-    writeAlignment(output, psc);
-    output.close();
+    auto output = BgzfOutputStream::openFile(path, !overwrite);
+    writeAlignment(*output, psc);
+    BgzfOutputStream::closeFile(*output);
   }
 
   /** @} */
@@ -9,6 +9,7 @@
 #include "../Alphabet/Alphabet.h"
 #include "../Container/VectorSequenceContainer.h"
 #include "../ProbabilisticSequence.h"
+#include "BgzfStream.h"
 #include "OSequence.h"
 
 // From the STL:
@@ -40,9 +41,9 @@ public:
   void writeSequences(const std::string& path, const SequenceContainerInterface& sc, bool overwrite = true) const override
   {
     // Open file in specified mode
-    std::ofstream output(path.c_str(), overwrite ? (std::ios::out) : (std::ios::out | std::ios::app));
-    writeSequences(output, sc);
-    output.close();
+    auto output = BgzfOutputStream::openFile(path, !overwrite);
+    writeSequences(*output, sc);
+    BgzfOutputStream::closeFile(*output);
   }
   /** @} */
 };
@@ -109,9 +110,9 @@ public:
   void writeSequences(const std::string& path, const ProbabilisticSequenceContainerInterface& psc, bool overwrite = true) const override
   {
     // Open file in specified mode
-    std::ofstream output(path.c_str(), overwrite ? (std::ios::out) : (std::ios::out | std::ios::app));
-    writeSequences(output, psc);
-    output.close();
+    auto output = BgzfOutputStream::openFile(path, !overwrite);
+    writeSequences(*output, psc);
+    BgzfOutputStream::closeFile(*output);
   }
 
   /** @} */
@@ -0,0 +1,758 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include "BgzfStream.h"
+
+// From the STL:
+#include <algorithm>
+#include <limits>
+
+#include <zlib.h>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+namespace
+{
+const size_t BGZF_MAX_BLOCK_SIZE = 65536;
+const size_t BGZF_HEADER_SIZE = 18;
+const size_t BGZF_FOOTER_SIZE = 8;
+
+// The empty block ending BGZF files:
+const unsigned char BGZF_EOF[28] = {
+  0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43,
+  0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+uint32_t readUint(const unsigned char* bytes, size_t size)
+{
+  uint32_t value = 0;
+  for (size_t i = size; i > 0; --i)
+  {
+    value = (value << 8) | bytes[i - 1];
+  }
+  return value;
+}
+
+void writeUint(unsigned char* bytes, uint64_t value, size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+}
+
+unsigned int getNumberOfThreads(unsigned int nbThreads)
+{
+  return nbThreads == 0 ? max(thread::hardware_concurrency(), 1u) : nbThreads;
+}
+
+/**
+ * @brief Read the header of a BGZF block.
+ *
+ * @param input The stream, positioned at the beginning of a block.
+ * @param headerSize [out] The number of bytes read.
+ * @return The total size of the block, or 0 at the end of the stream.
+ * @throw IOException If the data are not a BGZF block.
+ */
+size_t readBlockHeader(istream& input, size_t& headerSize)
+{
+  unsigned char header[12];
+  input.read(reinterpret_cast<char*>(header), 12);
+  if (input.gcount() == 0)
+    return 0;
+  if (input.gcount() != 12 || header[0] != 0x1f || header[1] != 0x8b || header[2] != 8 || !(header[3] & 4))
+    throw IOException("BgzfInputStreamBuffer: invalid BGZF block header.");
+  size_t xlen = readUint(header + 10, 2);
+  vector<unsigned char> extra(xlen);
+  input.read(reinterpret_cast<char*>(extra.data()), static_cast<streamsize>(xlen));
+  if (static_cast<size_t>(input.gcount()) != xlen)
+    throw IOException("BgzfInputStreamBuffer: truncated BGZF block header.");
+  headerSize = 12 + xlen;
+  // Look for the BC subfield giving the size of the block:
+  for (size_t i = 0; i + 4 <= xlen;)
+  {
+    size_t length = readUint(&extra[i + 2], 2);
+    if (extra[i] == 'B' && extra[i + 1] == 'C' && length == 2 && i + 6 <= xlen)
+    {
+      size_t size = readUint(&extra[i + 4], 2) + 1;
+      if (size < headerSize + BGZF_FOOTER_SIZE)
+        throw IOException("BgzfInputStreamBuffer: invalid BGZF block size.");
+      return size;
+    }
+    i += 4 + length;
+  }
+  throw IOException("BgzfInputStreamBuffer: gzip member without BGZF block size.");
+}
+
+/**
+ * @brief Decompress a block, given the data following its header.
+ */
+void inflateBlock(const vector<char>& payload, vector<char>& data)
+{
+  const unsigned char* footer = reinterpret_cast<const unsigned char*>(payload.data() + payload.size() - BGZF_FOOTER_SIZE);
+  uint32_t crc = readUint(footer, 4);
+  size_t size = readUint(footer + 4, 4);
+  data.resize(size);
+  char dummy;
+  z_stream zs;
+  zs.zalloc = Z_NULL;
+  zs.zfree = Z_NULL;
+  zs.opaque = Z_NULL;
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(payload.data()));
+  zs.avail_in = static_cast<uInt>(payload.size() - BGZF_FOOTER_SIZE);
+  if (inflateInit2(&zs, -15) != Z_OK)
+    throw IOException("BgzfInputStreamBuffer: cannot initialize decompression.");
+  zs.next_out = reinterpret_cast<Bytef*>(size > 0 ? data.data() : &dummy);
+  zs.avail_out = static_cast<uInt>(size > 0 ? size : 1);
+  int status = inflate(&zs, Z_FINISH);
+  size_t produced = zs.total_out;
+  inflateEnd(&zs);
+  if (status != Z_STREAM_END || produced != size)
+    throw IOException("BgzfInputStreamBuffer: corrupted BGZF block.");
+  uLong check = crc32(0L, Z_NULL, 0);
+  if (size > 0)
+    check = crc32(check, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(size));
+  if (check != crc)
+    throw IOException("BgzfInputStreamBuffer: CRC error in BGZF block.");
+}
+
+/**
+ * @brief Compress data into a complete BGZF block.
+ */
+void deflateBlock(const vector<char>& data, vector<char>& block, int level)
+{
+  block.resize(BGZF_MAX_BLOCK_SIZE);
+  z_stream zs;
+  zs.zalloc = Z_NULL;
+  zs.zfree = Z_NULL;
+  zs.opaque = Z_NULL;
+  if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    throw IOException("BgzfOutputStreamBuffer: cannot initialize compression.");
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  zs.avail_in = static_cast<uInt>(data.size());
+  zs.next_out = reinterpret_cast<Bytef*>(block.data() + BGZF_HEADER_SIZE);
+  zs.avail_out = static_cast<uInt>(BGZF_MAX_BLOCK_SIZE - BGZF_HEADER_SIZE - BGZF_FOOTER_SIZE);
+  int status = deflate(&zs, Z_FINISH);
+  size_t csize = zs.total_out;
+  deflateEnd(&zs);
+  if (status != Z_STREAM_END)
+    throw IOException("BgzfOutputStreamBuffer: compressed block too large.");
+
+  size_t size = BGZF_HEADER_SIZE + csize + BGZF_FOOTER_SIZE;
+  block.resize(size);
+  unsigned char* bytes = reinterpret_cast<unsigned char*>(block.data());
+  copy(BGZF_EOF, BGZF_EOF + 16, bytes);
+  writeUint(bytes + 16, size - 1, 2);
+  uLong crc = crc32(0L, Z_NULL, 0);
+  if (!data.empty())
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size()));
+  writeUint(bytes + size - 8, crc, 4);
+  writeUint(bytes + size - 4, data.size(), 4);
+}
+} // end of anonymous namespace.
+
+/******************************************************************************/
+
+BgzfInputStreamBuffer::BgzfInputStreamBuffer(const std::string& path, unsigned int nbThreads) :
+  path_(path),
+  file_(path.c_str(), ios::in | ios::binary),
+  nbThreads_(getNumberOfThreads(nbThreads)),
+  workers_(),
+  mutex_(),
+  ready_(),
+  space_(),
+  blocks_(),
+  current_(),
+  nextCoffset_(0),
+  endOfFile_(false),
+  stop_(false),
+  currentCoffset_(0),
+  currentUoffset_(0),
+  index_(),
+  indexEnd_(0, 0)
+{
+  if (!file_)
+    throw IOException("BgzfInputStreamBuffer: can't open file " + path);
+}
+
+BgzfInputStreamBuffer::~BgzfInputStreamBuffer()
+{
+  stopWorkers_();
+}
+
+/******************************************************************************/
+
+bool BgzfInputStreamBuffer::isBgzfFile(const std::string& path)
+{
+  ifstream input(path.c_str(), ios::in | ios::binary);
+  try
+  {
+    size_t headerSize;
+    return input && readBlockHeader(input, headerSize) > 0;
+  }
+  catch (IOException&)
+  {
+    return false;
+  }
+}
+
+/******************************************************************************/
+
+void BgzfInputStreamBuffer::startWorkers_()
+{
+  for (unsigned int k = 0; k < nbThreads_; ++k)
+  {
+    workers_.push_back(thread(&BgzfInputStreamBuffer::work_, this));
+  }
+}
+
+void BgzfInputStreamBuffer::stopWorkers_()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  space_.notify_all();
+  for (auto& th : workers_)
+  {
+    th.join();
+  }
+  workers_.clear();
+  stop_ = false;
+}
+
+/******************************************************************************/
+
+void BgzfInputStreamBuffer::work_()
+{
+  unique_lock<mutex> lock(mutex_);
+  while (true)
+  {
+    space_.wait(lock, [this]() {
+      return stop_ || (!endOfFile_ && blocks_.size() < 4 * static_cast<size_t>(nbThreads_));
+    });
+    if (stop_)
+      return;
+
+    // Blocks are read in turn, and decompressed in parallel:
+    blocks_.push_back(make_unique<Block_>());
+    Block_& block = *blocks_.back();
+    block.coffset = nextCoffset_;
+    try
+    {
+      if (readBlock_(block))
+        nextCoffset_ += block.csize;
+      else
+      {
+        block.last = true;
+        block.ready = true;
+        endOfFile_ = true;
+      }
+    }
+    catch (...)
+    {
+      block.error = current_exception();
+      block.ready = true;
+      endOfFile_ = true;
+    }
+    if (block.ready)
+    {
+      ready_.notify_all();
+      continue;
+    }
+
+    lock.unlock();
+    try
+    {
+      inflateBlock(block.compressed, block.data);
+    }
+    catch (...)
+    {
+      block.error = current_exception();
+    }
+    block.compressed.clear();
+    block.compressed.shrink_to_fit();
+    lock.lock();
+    block.ready = true;
+    ready_.notify_all();
+  }
+}
+
+/******************************************************************************/
+
+bool BgzfInputStreamBuffer::readBlock_(Block_& block)
+{
+  size_t headerSize;
+  size_t size = readBlockHeader(file_, headerSize);
+  if (size == 0)
+    return false;
+  block.csize = size;
+  block.compressed.resize(size - headerSize);
+  file_.read(block.compressed.data(), static_cast<streamsize>(block.compressed.size()));
+  if (static_cast<size_t>(file_.gcount()) != block.compressed.size())
+    throw IOException("BgzfInputStreamBuffer: truncated BGZF block in file " + path_);
+  return true;
+}
+
+/******************************************************************************/
+
+BgzfInputStreamBuffer::int_type BgzfInputStreamBuffer::underflow()
+{
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  if (workers_.empty())
+    startWorkers_();
+
+  unique_lock<mutex> lock(mutex_);
+  while (true)
+  {
+    if (current_)
+    {
+      currentCoffset_ = current_->coffset + current_->csize;
+      currentUoffset_ += current_->data.size();
+      current_.reset();
+      setg(nullptr, nullptr, nullptr);
+    }
+    ready_.wait(lock, [this]() { return !blocks_.empty() && blocks_.front()->ready; });
+    Block_& front = *blocks_.front();
+    if (front.error)
+      rethrow_exception(front.error);
+    if (front.last)
+      return traits_type::eof();
+    current_ = std::move(blocks_.front());
+    blocks_.pop_front();
+    space_.notify_one();
+    indexCurrentBlock_();
+    if (!current_->data.empty())
+    {
+      char* data = current_->data.data();
+      setg(data, data, data + current_->data.size());
+      return traits_type::to_int_type(*gptr());
+    }
+  }
+}
+
+/******************************************************************************/
+
+void BgzfInputStreamBuffer::indexCurrentBlock_()
+{
+  if (current_->coffset == indexEnd_.first)
+  {
+    index_.push_back(indexEnd_);
+    indexEnd_.first += current_->csize;
+    indexEnd_.second += current_->data.size();
+  }
+}
+
+/******************************************************************************/
+
+void BgzfInputStreamBuffer::extendIndex_(uint64_t uoffset, uint64_t coffset)
+{
+  ifstream input(path_.c_str(), ios::in | ios::binary);
+  input.seekg(static_cast<streamoff>(indexEnd_.first));
+  while (input && (indexEnd_.second <= uoffset || indexEnd_.first <= coffset))
+  {
+    size_t headerSize;
+    size_t size = readBlockHeader(input, headerSize);
+    if (size == 0)
+      break;
+    unsigned char footer[4];
+    input.seekg(static_cast<streamoff>(indexEnd_.first + size - 4));
+    input.read(reinterpret_cast<char*>(footer), 4);
+    if (input.gcount() != 4)
+      throw IOException("BgzfInputStreamBuffer: truncated BGZF block in file " + path_);
+    index_.push_back(indexEnd_);
+    indexEnd_.first += size;
+    indexEnd_.second += readUint(footer, 4);
+  }
+}
+
+void BgzfInputStreamBuffer::buildIndex()
+{
+  extendIndex_(numeric_limits<uint64_t>::max(), numeric_limits<uint64_t>::max());
+}
+
+/******************************************************************************/
+
+void BgzfInputStreamBuffer::readIndex(const std::string& path)
+{
+  ifstream input(path.c_str(), ios::in | ios::binary);
+  if (!input)
+    throw IOException("BgzfInputStreamBuffer::readIndex: can't open file " + path);
+  unsigned char bytes[16];
+  input.read(reinterpret_cast<char*>(bytes), 8);
+  if (input.gcount() != 8)
+    throw IOException("BgzfInputStreamBuffer::readIndex: invalid index file " + path);
+  uint64_t n = readUint(bytes, 4) | (static_cast<uint64_t>(readUint(bytes + 4, 4)) << 32);
+  vector<pair<uint64_t, uint64_t>> index(1, make_pair(0, 0));
+  for (uint64_t i = 0; i < n; ++i)
+  {
+    input.read(reinterpret_cast<char*>(bytes), 16);
+    if (input.gcount() != 16)
+      throw IOException("BgzfInputStreamBuffer::readIndex: truncated index file " + path);
+    index.push_back(make_pair(
+        readUint(bytes, 4) | (static_cast<uint64_t>(readUint(bytes + 4, 4)) << 32),
+        readUint(bytes + 8, 4) | (static_cast<uint64_t>(readUint(bytes + 12, 4)) << 32)));
+  }
+  // The end of the last block is not known, so the last block will be indexed again when needed:
+  if (index.back().first > indexEnd_.first)
+  {
+    indexEnd_ = index.back();
+    index.pop_back();
+    index_ = index;
+  }
+}
+
+void BgzfInputStreamBuffer::writeIndex(const std::string& path)
+{
+  buildIndex();
+  ofstream output(path.c_str(), ios::out | ios::binary);
+  if (!output)
+    throw IOException("BgzfInputStreamBuffer::writeIndex: can't open file " + path);
+  unsigned char bytes[16];
+  writeUint(bytes, index_.empty() ? 0 : index_.size() - 1, 8);
+  output.write(reinterpret_cast<char*>(bytes), 8);
+  for (size_t i = 1; i < index_.size(); ++i)
+  {
+    writeUint(bytes, index_[i].first, 8);
+    writeUint(bytes + 8, index_[i].second, 8);
+    output.write(reinterpret_cast<char*>(bytes), 16);
+  }
+  if (!output)
+    throw IOException("BgzfInputStreamBuffer::writeIndex: can't write file " + path);
+}
+
+/******************************************************************************/
+
+uint64_t BgzfInputStreamBuffer::getVirtualOffset() const
+{
+  if (current_)
+    return (current_->coffset << 16) | static_cast<uint64_t>(gptr() - eback());
+  return currentCoffset_ << 16;
+}
+
+void BgzfInputStreamBuffer::seekVirtualOffset(uint64_t offset)
+{
+  uint64_t coffset = offset >> 16;
+  if (coffset >= indexEnd_.first)
+    extendIndex_(0, coffset);
+  auto it = lower_bound(index_.begin(), index_.end(), make_pair(coffset, uint64_t(0)));
+  if (it == index_.end() || it->first != coffset)
+    throw IOException("BgzfInputStreamBuffer::seekVirtualOffset: no block at this offset.");
+  seekBlock_(static_cast<size_t>(it - index_.begin()), it->second + (offset & 0xffff));
+}
+
+/******************************************************************************/
+
+void BgzfInputStreamBuffer::seekBlock_(size_t entry, uint64_t uoffset)
+{
+  stopWorkers_();
+  blocks_.clear();
+  current_.reset();
+  setg(nullptr, nullptr, nullptr);
+  file_.clear();
+  file_.seekg(static_cast<streamoff>(index_[entry].first));
+  nextCoffset_ = currentCoffset_ = index_[entry].first;
+  currentUoffset_ = index_[entry].second;
+  endOfFile_ = false;
+
+  uint64_t skip = uoffset - currentUoffset_;
+  if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+  {
+    if (skip > 0)
+      throw IOException("BgzfInputStreamBuffer: offset beyond the end of the file.");
+    return;
+  }
+  if (currentUoffset_ + static_cast<uint64_t>(egptr() - eback()) < uoffset)
+    throw IOException("BgzfInputStreamBuffer: offset beyond the end of the block.");
+  setg(eback(), eback() + (uoffset - currentUoffset_), egptr());
+}
+
+/******************************************************************************/
+
+BgzfInputStreamBuffer::pos_type BgzfInputStreamBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+  if (!(which & ios_base::in))
+    return pos_type(off_type(-1));
+  uint64_t current = currentUoffset_ + (current_ ? static_cast<uint64_t>(gptr() - eback()) : 0);
+  off_type target;
+  if (dir == ios_base::beg)
+    target = off;
+  else if (dir == ios_base::cur)
+  {
+    if (off == 0)
+      return pos_type(static_cast<off_type>(current));
+    target = static_cast<off_type>(current) + off;
+  }
+  else
+  {
+    buildIndex();
+    target = static_cast<off_type>(indexEnd_.second) + off;
+  }
+  return seekpos(pos_type(target), which);
+}
+
+BgzfInputStreamBuffer::pos_type BgzfInputStreamBuffer::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+  off_type target = static_cast<off_type>(pos);
+  if (!(which & ios_base::in) || target < 0)
+    return pos_type(off_type(-1));
+  uint64_t uoffset = static_cast<uint64_t>(target);
+
+  // Move within the current block:
+  if (current_ && uoffset >= currentUoffset_ && uoffset <= currentUoffset_ + current_->data.size())
+  {
+    setg(eback(), eback() + (uoffset - currentUoffset_), egptr());
+    return pos;
+  }
+
+  if (uoffset >= indexEnd_.second)
+    extendIndex_(uoffset, 0);
+  if (index_.empty() || uoffset > indexEnd_.second)
+    return pos_type(off_type(-1));
+  auto it = upper_bound(index_.begin(), index_.end(), uoffset,
+      [](uint64_t u, const pair<uint64_t, uint64_t>& entry) { return u < entry.second; });
+  seekBlock_(static_cast<size_t>(it - index_.begin()) - 1, uoffset);
+  return pos;
+}
+
+/******************************************************************************/
+
+const size_t BgzfOutputStreamBuffer::BLOCK_DATA_SIZE = 0xff00;
+
+BgzfOutputStreamBuffer::BgzfOutputStreamBuffer(const std::string& path, bool append, unsigned int nbThreads, int level) :
+  file_(path.c_str(), append ? (ios::out | ios::binary | ios::app) : (ios::out | ios::binary)),
+  level_(level),
+  nbThreads_(getNumberOfThreads(nbThreads)),
+  workers_(),
+  mutex_(),
+  jobAvailable_(),
+  space_(),
+  jobs_(),
+  buffer_(BLOCK_DATA_SIZE),
+  written_(0),
+  stop_(false),
+  closed_(false),
+  error_()
+{
+  if (!file_)
+    throw IOException("BgzfOutputStreamBuffer: can't open file " + path);
+  if (append)
+  {
+    file_.seekp(0, ios::end);
+    written_ = static_cast<uint64_t>(file_.tellp());
+  }
+  setp(buffer_.data(), buffer_.data() + buffer_.size());
+  for (unsigned int k = 0; k < nbThreads_; ++k)
+  {
+    workers_.push_back(thread(&BgzfOutputStreamBuffer::work_, this));
+  }
+}
+
+BgzfOutputStreamBuffer::~BgzfOutputStreamBuffer()
+{
+  try
+  {
+    close();
+  }
+  catch (...)
+  {}
+}
+
+/******************************************************************************/
+
+void BgzfOutputStreamBuffer::work_()
+{
+  unique_lock<mutex> lock(mutex_);
+  while (true)
+  {
+    Job_* job = nullptr;
+    jobAvailable_.wait(lock, [this, &job]() {
+      for (auto& j : jobs_)
+      {
+        if (!j->taken)
+        {
+          job = j.get();
+          return true;
+        }
+      }
+      return stop_;
+    });
+    if (!job)
+      return;
+    job->taken = true;
+
+    lock.unlock();
+    exception_ptr error;
+    try
+    {
+      deflateBlock(job->data, job->compressed, level_);
+    }
+    catch (...)
+    {
+      error = current_exception();
+    }
+    lock.lock();
+    if (error && !error_)
+      error_ = error;
+    job->done = true;
+
+    // Compressed blocks are written in order:
+    while (!jobs_.empty() && jobs_.front()->done)
+    {
+      if (!error_)
+      {
+        const vector<char>& block = jobs_.front()->compressed;
+        file_.write(block.data(), static_cast<streamsize>(block.size()));
+        written_ += block.size();
+        if (!file_)
+          error_ = make_exception_ptr(IOException("BgzfOutputStreamBuffer: write error."));
+      }
+      jobs_.pop_front();
+    }
+    space_.notify_all();
+  }
+}
+
+/******************************************************************************/
+
+void BgzfOutputStreamBuffer::submitBlock_()
+{
+  if (pptr() == pbase())
+    return;
+  auto job = make_unique<Job_>();
+  job->data.assign(pbase(), pptr());
+  setp(buffer_.data(), buffer_.data() + buffer_.size());
+
+  unique_lock<mutex> lock(mutex_);
+  space_.wait(lock, [this]() {
+    return error_ || jobs_.size() < 4 * static_cast<size_t>(nbThreads_);
+  });
+  if (error_)
+    rethrow_exception(error_);
+  jobs_.push_back(std::move(job));
+  jobAvailable_.notify_one();
+}
+
+void BgzfOutputStreamBuffer::waitForBlocks_()
+{
+  unique_lock<mutex> lock(mutex_);
+  space_.wait(lock, [this]() { return error_ || jobs_.empty(); });
+  if (error_)
+    rethrow_exception(error_);
+}
+
+/******************************************************************************/
+
+BgzfOutputStreamBuffer::int_type BgzfOutputStreamBuffer::overflow(int_type c)
+{
+  if (closed_)
+    return traits_type::eof();
+  submitBlock_();
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+  *pptr() = traits_type::to_char_type(c);
+  pbump(1);
+  return c;
+}
+
+int BgzfOutputStreamBuffer::sync()
+{
+  // The current block is not ended, only compressed blocks are flushed:
+  lock_guard<mutex> lock(mutex_);
+  file_.flush();
+  return error_ || !file_ ? -1 : 0;
+}
+
+uint64_t BgzfOutputStreamBuffer::getVirtualOffset()
+{
+  waitForBlocks_();
+  return (written_ << 16) | static_cast<uint64_t>(pptr() - pbase());
+}
+
+/******************************************************************************/
+
+void BgzfOutputStreamBuffer::close()
+{
+  if (closed_)
+    return;
+  closed_ = true;
+  exception_ptr error;
+  try
+  {
+    submitBlock_();
+    waitForBlocks_();
+  }
+  catch (...)
+  {
+    error = current_exception();
+  }
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  jobAvailable_.notify_all();
+  for (auto& th : workers_)
+  {
+    th.join();
+  }
+  workers_.clear();
+  if (error)
+  {
+    file_.close();
+    rethrow_exception(error);
+  }
+  file_.write(reinterpret_cast<const char*>(BGZF_EOF), sizeof(BGZF_EOF));
+  written_ += sizeof(BGZF_EOF);
+  file_.close();
+  if (file_.fail())
+    throw IOException("BgzfOutputStreamBuffer: write error.");
+}
+
+/******************************************************************************/
+
+std::unique_ptr<std::istream> BgzfInputStream::openFile(const std::string& path, unsigned int nbThreads)
+{
+  ifstream probe(path.c_str(), ios::in | ios::binary);
+  if (!probe)
+    throw IOException("BgzfInputStream::openFile: can't open file " + path);
+  unsigned char magic[2];
+  probe.read(reinterpret_cast<char*>(magic), 2);
+  if (probe.gcount() == 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+  {
+    if (!BgzfInputStreamBuffer::isBgzfFile(path))
+      throw IOException("BgzfInputStream::openFile: file " + path + " is compressed, but not in the BGZF format.");
+    auto input = make_unique<BgzfInputStream>(path, nbThreads);
+    if (ifstream(path + ".gzi"))
+      input->buffer().readIndex(path + ".gzi");
+    return input;
+  }
+  return make_unique<ifstream>(path.c_str(), ios::in);
+}
+
+/******************************************************************************/
+
+std::unique_ptr<std::ostream> BgzfOutputStream::openFile(const std::string& path, bool append)
+{
+  if (path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0)
+    return make_unique<BgzfOutputStream>(path, append);
+  auto output = make_unique<ofstream>(path.c_str(), append ? (ios::out | ios::app) : ios::out);
+  if (!*output)
+    throw IOException("BgzfOutputStream::openFile: can't open file " + path);
+  return output;
+}
+
+void BgzfOutputStream::closeFile(std::ostream& output)
+{
+  auto bgzf = dynamic_cast<BgzfOutputStream*>(&output);
+  if (bgzf)
+    bgzf->close();
+  else if (auto file = dynamic_cast<ofstream*>(&output))
+    file->close();
+}
+
+/******************************************************************************/
@@ -0,0 +1,370 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_IO_BGZFSTREAM_H
+#define BPP_SEQ_IO_BGZFSTREAM_H
+
+#include <Bpp/Exceptions.h>
+
+// From the STL:
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief A read-only stream buffer over a file compressed in the BGZF format.
+ *
+ * The BGZF format (blocked GNU zip format, used by bgzip, samtools and htslib)
+ * is a series of gzip members, called blocks, of at most 64 kb each. A BGZF
+ * file is thus a valid gzip file, but each block can be decompressed
+ * independently.
+ *
+ * Blocks are read and decompressed ahead by a pool of threads, while the
+ * current block is parsed by the reader. Positions in the stream are offsets
+ * in the uncompressed data, so that a std::istream using this buffer can be
+ * used in place of a stream over the uncompressed file, including for random
+ * access (see Fasta::FileIndex). Seeking uses a table of the positions of the
+ * blocks, which is filled while reading, extended by scanning the block
+ * headers when needed, or loaded from a .gzi file (see readIndex()).
+ *
+ * The virtual offsets of htslib are also supported: the offset of the
+ * beginning of the current block in the compressed file, shifted by 16 bits,
+ * plus the offset in the uncompressed block.
+ */
+class BgzfInputStreamBuffer :
+  public std::streambuf
+{
+private:
+  struct Block_
+  {
+    uint64_t coffset = 0;       // Offset of the block in the compressed file.
+    size_t csize = 0;           // Size of the compressed block.
+    std::vector<char> compressed = {};
+    std::vector<char> data = {};
+    bool ready = false;         // True when the block is decompressed.
+    bool last = false;          // True for the end of the file.
+    std::exception_ptr error = nullptr;
+  };
+
+  std::string path_;
+  std::ifstream file_;
+  unsigned int nbThreads_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::condition_variable space_;
+  std::deque<std::unique_ptr<Block_>> blocks_;
+  std::unique_ptr<Block_> current_;
+  uint64_t nextCoffset_;        // Offset of the next block to read.
+  bool endOfFile_;
+  bool stop_;
+  uint64_t currentCoffset_;     // Offset of the current block in the compressed file.
+  uint64_t currentUoffset_;     // Offset of the current block in the uncompressed data.
+
+  /**
+   * @brief The start of the blocks, as (compressed offset, uncompressed offset) pairs.
+   *
+   * The table always describes the beginning of the file: indexEnd_ gives the
+   * offsets of the block following the last indexed one.
+   */
+  std::vector<std::pair<uint64_t, uint64_t>> index_;
+  std::pair<uint64_t, uint64_t> indexEnd_;
+
+public:
+  /**
+   * @brief Open a BGZF file.
+   *
+   * @param path The path to the file.
+   * @param nbThreads The number of decompression threads, 0 for the number of hardware threads.
+   * @throw IOException If the file cannot be opened.
+   */
+  BgzfInputStreamBuffer(const std::string& path, unsigned int nbThreads = 0);
+
+  virtual ~BgzfInputStreamBuffer();
+
+private:
+  // Recopy is forbidden
+  BgzfInputStreamBuffer(const BgzfInputStreamBuffer&) = delete;
+  BgzfInputStreamBuffer& operator=(const BgzfInputStreamBuffer&) = delete;
+
+public:
+  /**
+   * @return True if the file starts with a BGZF block.
+   *
+   * @param path The path to the file.
+   */
+  static bool isBgzfFile(const std::string& path);
+
+  /**
+   * @return The virtual offset of the current position.
+   */
+  uint64_t getVirtualOffset() const;
+
+  /**
+   * @brief Move to a virtual offset.
+   *
+   * @param offset A virtual offset, as returned by getVirtualOffset().
+   * @throw IOException If the offset does not point to a block of the file.
+   */
+  void seekVirtualOffset(uint64_t offset);
+
+  /**
+   * @brief Index all blocks of the file, by reading their headers only.
+   */
+  void buildIndex();
+
+  /**
+   * @brief Read the block index from a .gzi file, as written by bgzip -i.
+   *
+   * @throw IOException If the file cannot be read.
+   */
+  void readIndex(const std::string& path);
+
+  /**
+   * @brief Write the block index of the whole file in the .gzi format.
+   *
+   * @throw IOException If the file cannot be written.
+   */
+  void writeIndex(const std::string& path);
+
+protected:
+  int_type underflow() override;
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) override;
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override;
+
+private:
+  void startWorkers_();
+
+  void stopWorkers_();
+
+  void work_();
+
+  /**
+   * @brief Read a compressed block at the current position of the file.
+   *
+   * @return false at the end of the file.
+   * @throw IOException If the block is not a valid BGZF block.
+   */
+  bool readBlock_(Block_& block);
+
+  /**
+   * @brief Index blocks by reading their headers, until a given uncompressed
+   * offset or compressed offset is reached, or until the end of the file.
+   */
+  void extendIndex_(uint64_t uoffset, uint64_t coffset);
+
+  /**
+   * @brief Move to a given uncompressed offset, in the block starting at a given index entry.
+   */
+  void seekBlock_(size_t entry, uint64_t uoffset);
+
+  /**
+   * @brief Record the current block in the index, if it follows the last indexed one.
+   */
+  void indexCurrentBlock_();
+};
+
+/**
+ * @brief A write-only stream buffer producing a file in the BGZF format.
+ *
+ * Data are cut in blocks of 65280 bytes, which are compressed by a pool of
+ * threads while the next blocks are being written by the program. Compressed
+ * blocks are written in order, and the empty block marking the end of a BGZF
+ * file is added when the buffer is closed.
+ *
+ * To keep the compression ratio, flushing the stream (for instance with
+ * std::endl) does not end the current block: only close() writes it.
+ */
+class BgzfOutputStreamBuffer :
+  public std::streambuf
+{
+public:
+  /**
+   * @brief The maximum size of the uncompressed data of a block.
+   */
+  static const size_t BLOCK_DATA_SIZE;
+
+private:
+  struct Job_
+  {
+    std::vector<char> data = {};
+    std::vector<char> compressed = {};
+    bool taken = false;
+    bool done = false;
+  };
+
+  std::ofstream file_;
+  int level_;
+  unsigned int nbThreads_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable jobAvailable_;
+  std::condition_variable space_;
+  std::deque<std::unique_ptr<Job_>> jobs_;
+  std::vector<char> buffer_;
+  uint64_t written_;            // Number of compressed bytes written.
+  bool stop_;
+  bool closed_;
+  std::exception_ptr error_;
+
+public:
+  /**
+   * @brief Create a BGZF file.
+   *
+   * @param path The path to the file.
+   * @param append Tells if the data must be appended to an existing file.
+   * @param nbThreads The number of compression threads, 0 for the number of hardware threads.
+   * @param level The compression level, from 0 to 9, -1 for the zlib default.
+   * @throw IOException If the file cannot be opened.
+   */
+  BgzfOutputStreamBuffer(const std::string& path, bool append = false, unsigned int nbThreads = 0, int level = -1);
+
+  virtual ~BgzfOutputStreamBuffer();
+
+private:
+  // Recopy is forbidden
+  BgzfOutputStreamBuffer(const BgzfOutputStreamBuffer&) = delete;
+  BgzfOutputStreamBuffer& operator=(const BgzfOutputStreamBuffer&) = delete;
+
+public:
+  /**
+   * @brief Write all pending data and the end of file marker, and close the file.
+   *
+   * @throw IOException If the data cannot be compressed or written.
+   */
+  void close();
+
+  /**
+   * @return The virtual offset of the current position, once all pending blocks are written.
+   */
+  uint64_t getVirtualOffset();
+
+protected:
+  int_type overflow(int_type c) override;
+
+  int sync() override;
+
+private:
+  /**
+   * @brief Send the current block to the compression threads.
+   */
+  void submitBlock_();
+
+  /**
+   * @brief Wait until all submitted blocks are written.
+   */
+  void waitForBlocks_();
+
+  void work_();
+};
+
+/**
+ * @brief An input stream reading from a BGZF file.
+ *
+ * @see BgzfInputStreamBuffer
+ */
+class BgzfInputStream :
+  public std::istream
+{
+private:
+  BgzfInputStreamBuffer buffer_;
+
+public:
+  BgzfInputStream(const std::string& path, unsigned int nbThreads = 0) :
+    std::istream(nullptr),
+    buffer_(path, nbThreads)
+  {
+    rdbuf(&buffer_);
+  }
+
+  virtual ~BgzfInputStream()
+  {}
+
+public:
+  BgzfInputStreamBuffer& buffer()
+  {
+    return buffer_;
+  }
+
+  /**
+   * @brief Open a file for reading, decompressing it if it is in the BGZF format.
+   *
+   * If a .gzi index is found next to a BGZF file, it is loaded.
+   *
+   * @param path The path to the file.
+   * @param nbThreads The number of decompression threads, 0 for the number of hardware threads.
+   * @return A BgzfInputStream or a std::ifstream.
+   * @throw IOException If the file cannot be opened, or if it is compressed in another gzip format.
+   */
+  static std::unique_ptr<std::istream> openFile(const std::string& path, unsigned int nbThreads = 0);
+};
+
+/**
+ * @brief An output stream writing to a BGZF file.
+ *
+ * @see BgzfOutputStreamBuffer
+ */
+class BgzfOutputStream :
+  public std::ostream
+{
+private:
+  BgzfOutputStreamBuffer buffer_;
+
+public:
+  BgzfOutputStream(const std::string& path, bool append = false, unsigned int nbThreads = 0, int level = -1) :
+    std::ostream(nullptr),
+    buffer_(path, append, nbThreads, level)
+  {
+    rdbuf(&buffer_);
+  }
+
+  virtual ~BgzfOutputStream()
+  {}
+
+public:
+  BgzfOutputStreamBuffer& buffer()
+  {
+    return buffer_;
+  }
+
+  void close()
+  {
+    buffer_.close();
+  }
+
+  /**
+   * @brief Open a file for writing, compressing it in the BGZF format if its name ends with ".gz".
+   *
+   * @param path The path to the file.
+   * @param append Tells if the data must be appended to an existing file.
+   * @return A BgzfOutputStream or a std::ofstream.
+   * @throw IOException If the file cannot be opened.
+   */
+  static std::unique_ptr<std::ostream> openFile(const std::string& path, bool append = false);
+
+  /**
+   * @brief Close a stream returned by openFile().
+   *
+   * @param output The stream to close.
+   * @throw IOException If the data cannot be written.
+   */
+  static void closeFile(std::ostream& output);
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_IO_BGZFSTREAM_H
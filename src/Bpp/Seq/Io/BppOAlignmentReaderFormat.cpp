@@ -72,7 +72,10 @@ unique_ptr<IAlignment> BppOAlignmentReaderFormat::read(const std::string& descri
   {
     bool strictNames = ApplicationTools::getBooleanParameter("strict_names", unparsedArguments_, false, "", true, warningLevel_);
     bool extended    = ApplicationTools::getBooleanParameter("extended", unparsedArguments_, false, "", true, warningLevel_);
-    iAln.reset(new Fasta(100, true, extended, strictNames));
+    bool mmap        = ApplicationTools::getBooleanParameter("memory_mapped", unparsedArguments_, false, "", true, warningLevel_);
+    auto fasta = make_unique<Fasta>(100, true, extended, strictNames);
+    fasta->memoryMapped(mmap);
+    iAln = std::move(fasta);
   }
   else if (format == "FastaCsv")
   {
@@ -72,7 +72,10 @@ unique_ptr<ISequence> BppOSequenceReaderFormat::read(const std::string& descript
   {
     bool strictNames = ApplicationTools::getBooleanParameter("strict_names", unparsedArguments_, false, "", true, warningLevel_);
     bool extended    = ApplicationTools::getBooleanParameter("extended", unparsedArguments_, false, "", true, warningLevel_);
-    iSeq.reset(new Fasta(100, true, extended, strictNames));
+    bool mmap        = ApplicationTools::getBooleanParameter("memory_mapped", unparsedArguments_, false, "", true, warningLevel_);
+    auto fasta = make_unique<Fasta>(100, true, extended, strictNames);
+    fasta->memoryMapped(mmap);
+    iSeq = std::move(fasta);
   }
   else if (format == "FastaCsv")
   {
@@ -8,6 +8,7 @@
 
 #include "BppOSequenceStreamReaderFormat.h"
 #include "Fasta.h"
+#include "Fastq.h"
 
 using namespace bpp;
 using namespace std;
@@ -24,6 +25,12 @@ unique_ptr<ISequenceStream> BppOSequenceStreamReaderFormat::read(const std::stri
     bool extended    = ApplicationTools::getBooleanParameter("extended", unparsedArguments_, false, "", true, false);
     iSeq = make_unique<Fasta>(100, true, extended, strictNames);
   }
+  else if (format == "Fastq")
+  {
+    bool strictNames = ApplicationTools::getBooleanParameter("strict_names", unparsedArguments_, false, "", true, false);
+    bool phred64     = ApplicationTools::getBooleanParameter("phred64", unparsedArguments_, false, "", true, false);
+    iSeq = make_unique<Fastq>(phred64, strictNames);
+  }
   else
   {
     throw IOException("Sequence format '" + format + "' unknown.");
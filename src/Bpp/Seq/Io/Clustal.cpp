@@ -7,6 +7,7 @@
 #include <Bpp/Text/TextTools.h>
 
 #include "Clustal.h"
+#include "SequenceWriterTools.h"
 
 using namespace bpp;
 
@@ -97,23 +98,35 @@ void Clustal::writeAlignment(std::ostream& output, const SiteContainerInterface&
   if (sc.getNumberOfSequences() == 0)
     return;
 
-  vector<string> text;
+  size_t n = sc.getNumberOfSequences();
+  vector<string> text(n);
   size_t length = 0;
-  for (size_t i = 0; i < sc.getNumberOfSequences(); ++i)
+  for (size_t i = 0; i < n; ++i)
   {
     const Sequence& seq = sc.sequence(i);
     if (seq.getName().size() > length)
       length = seq.getName().size();
-    text.push_back(sc.sequence(i).toString());
+    SequenceWriterTools::appendContent(text[i], seq);
   }
   length += nbSpacesBeforeSeq_;
-  for (unsigned int j = 0; j < text[0].size(); j += charsByLine_)
+  vector<string> names(n);
+  for (size_t i = 0; i < n; ++i)
   {
-    for (unsigned int i = 0; i < sc.getNumberOfSequences(); ++i)
+    names[i] = TextTools::resizeRight(sc.sequence(i).getName(), length);
+  }
+  // Blocks are formatted in memory and written at once:
+  string buffer;
+  for (size_t j = 0; j < text[0].size(); j += charsByLine_)
+  {
+    for (size_t i = 0; i < n; ++i)
     {
-      output << TextTools::resizeRight(sc.sequence(i).getName(), length);
-      output << text[i].substr(j, charsByLine_) << endl;
+      buffer += names[i];
+      if (j < text[i].size())
+        buffer.append(text[i], j, charsByLine_);
+      buffer += "\n";
     }
-    output << endl;
+    buffer += "\n";
+    SequenceWriterTools::flush(output, buffer);
   }
+  SequenceWriterTools::flush(output, buffer, true);
 }
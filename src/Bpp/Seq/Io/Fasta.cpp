@@ -5,23 +5,185 @@
 #include <Bpp/Io/FileTools.h>
 #include <Bpp/Text/StringTokenizer.h>
 #include <Bpp/Text/TextTools.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <climits>
 #include <fstream>
 
+#include "../Alphabet/LetterAlphabet.h"
 #include "../StringSequenceTools.h"
 #include "Fasta.h"
+#include "PipelinedSequenceIterator.h"
+#include "SequenceWriterTools.h"
 
 using namespace bpp;
 using namespace std;
 
+namespace
+{
+// Special values in the decoding table of the memory-mapped parser:
+const int FASTA_UNDEF_CHAR = INT_MIN;
+const int FASTA_SKIP_CHAR = INT_MIN + 1;
+}
+
+/******************************************************************************/
+
+vector<int> Fasta::getDecodingTable_(const Alphabet& alphabet, bool& direct)
+{
+  vector<int> table;
+  direct = false;
+  auto letterAlphabet = dynamic_cast<const LetterAlphabet*>(&alphabet);
+  if (!letterAlphabet)
+    return table;
+  direct = true;
+  table.resize(256, FASTA_UNDEF_CHAR);
+  // Only ASCII characters are allowed. Letters are converted to upper case,
+  // as in the stream parser:
+  for (int c = 0; c < 128; ++c)
+  {
+    char ch = static_cast<char>(c);
+    if (TextTools::isWhiteSpaceCharacter(ch))
+    {
+      table[static_cast<size_t>(c)] = FASTA_SKIP_CHAR;
+      continue;
+    }
+    char state = static_cast<char>(toupper(c));
+    if (letterAlphabet->isCharInAlphabet(state))
+      table[static_cast<size_t>(c)] = letterAlphabet->charToInt(state);
+    // Case-sensitive alphabets can't encode lines directly:
+    if (table[static_cast<size_t>(c)] != (letterAlphabet->isCharInAlphabet(ch) ? letterAlphabet->charToInt(ch) : FASTA_UNDEF_CHAR))
+      direct = false;
+  }
+  return table;
+}
+
+/******************************************************************************/
+
+void Fasta::setSequenceHeader_(string seqname, Sequence& seq) const
+{
+  seqname = TextTools::removeWhiteSpaces(seqname);
+
+  // Sequence name and comments isolation
+  if (strictNames_ || extended_)
+  {
+    Comments seqcmts;
+    size_t pos = seqname.find_first_of(" \t\n");
+    string seqcmt;
+    if (pos != string::npos)
+    {
+      seqcmt = seqname.substr(pos + 1);
+      seqname = seqname.substr(0, pos);
+    }
+    if (extended_)
+    {
+      StringTokenizer st(seqcmt, " \\", true, false);
+      while (st.hasMoreToken())
+      {
+        seqcmts.push_back(st.nextToken());
+      }
+    }
+    else
+    {
+      seqcmts.push_back(seqcmt);
+    }
+    seq.setComments(seqcmts);
+  }
+  seq.setName(seqname);
+}
+
+/******************************************************************************/
+
+bool Fasta::nextSequenceFromBuffer_(istream& input, MemoryMappedStreamBuffer& buffer, Sequence& seq, const vector<int>& table, bool direct) const
+{
+  const char* p = buffer.current();
+  const char* end = buffer.end();
+  string seqname = "";
+  vector<int> content;
+  short seqcpt = 0;
+  while (p < end)
+  {
+    const char* eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    const char* lineEnd = eol ? eol : end;
+    char c = *p;
+
+    // Sequence beginning detection
+    if (c == '>')
+    {
+      // Stop if find a new sequence
+      if (seqcpt++)
+        break;
+      // Get the sequence name line
+      seqname.assign(p + 1, lineEnd);
+    }
+    else if (!TextTools::isWhiteSpaceCharacter(c))
+    {
+      // Sequence content, decoded in place
+      const char* contentEnd = lineEnd;
+      while (contentEnd > p && TextTools::isWhiteSpaceCharacter(*(contentEnd - 1)))
+      {
+        --contentEnd;
+      }
+      size_t length = static_cast<size_t>(contentEnd - p);
+      size_t previousSize = content.size();
+      if (direct && !memchr(p, ' ', length) && !memchr(p, '\t', length))
+      {
+        content.resize(previousSize + length);
+        try
+        {
+          seq.alphabet().encode(p, length, content.data() + previousSize);
+          p = eol ? eol + 1 : end;
+          continue;
+        }
+        catch (BadCharException&)
+        {
+          // Use the table, which also reports the error.
+          content.resize(previousSize);
+        }
+      }
+      content.reserve(previousSize + length);
+      for (const char* q = p; q < contentEnd; ++q)
+      {
+        int code = table[static_cast<unsigned char>(*q)];
+        if (code == FASTA_SKIP_CHAR)
+          continue;
+        if (code == FASTA_UNDEF_CHAR)
+          throw BadCharException(string(1, *q), "Fasta::nextSequence", seq.getAlphabet());
+        content.push_back(code);
+      }
+    }
+    p = eol ? eol + 1 : end;
+  }
+  buffer.setCurrent(p);
+
+  bool res = (p < end);
+  if (!res)
+    input.setstate(ios::eofbit);
+
+  setSequenceHeader_(seqname, seq);
+  seq.swapContent(content);
+  return res;
+}
+
 /******************************************************************************/
 
 bool Fasta::nextSequence(istream& input, Sequence& seq) const
 {
   if (!input)
     throw IOException("Fasta::nextSequence: can't read from istream input");
+
+  // Fast path for memory-mapped input:
+  auto mapped = dynamic_cast<MemoryMappedStreamBuffer*>(input.rdbuf());
+  if (mapped)
+  {
+    bool direct;
+    vector<int> table = getDecodingTable_(seq.alphabet(), direct);
+    if (!table.empty())
+      return nextSequenceFromBuffer_(input, *mapped, seq, table, direct);
+  }
+
   string seqname = "";
   string content = "";
-  Comments seqcmts;
   short seqcpt = 0;
   string linebuffer = "";
   char c;
@@ -51,67 +213,64 @@ bool Fasta::nextSequence(istream& input, Sequence& seq) const
     }
   }
 
-  seqname = TextTools::removeWhiteSpaces(seqname);
-
   bool res = (!input.eof());
-  // Sequence name and comments isolation
-  if (strictNames_ || extended_)
-  {
-    size_t pos = seqname.find_first_of(" \t\n");
-    string seqcmt;
-    if (pos != string::npos)
-    {
-      seqcmt = seqname.substr(pos + 1);
-      seqname = seqname.substr(0, pos);
-    }
-    if (extended_)
-    {
-      StringTokenizer st(seqcmt, " \\", true, false);
-      while (st.hasMoreToken())
-      {
-        seqcmts.push_back(st.nextToken());
-      }
-    }
-    else
-    {
-      seqcmts.push_back(seqcmt);
-    }
-    seq.setComments(seqcmts);
-  }
-  seq.setName(seqname);
+  setSequenceHeader_(seqname, seq);
   seq.setContent(content);
   return res;
 }
 
 /******************************************************************************/
 
-void Fasta::writeSequence(ostream& output, const Sequence& seq) const
+const char* Fasta::findLastRecordEnd(const char* begin, const char* end, bool atEnd, ScanState& scan) const
+{
+  if (atEnd)
+    return end;
+  // The last record may be incomplete, so the buffer is cut before its header.
+  // Previous scans did not find any header after the beginning of the buffer:
+  const char* from = begin + scan.scanned;
+  scan.scanned = static_cast<size_t>(end - begin);
+  for (const char* p = end; p > from; --p)
+  {
+    if (*(p - 1) == '>' && (p - 1 == begin || *(p - 2) == '\n'))
+      return p - 1;
+  }
+  return begin;
+}
+
+/******************************************************************************/
+
+void Fasta::formatSequence_(const Sequence& seq, string& buffer) const
 {
-  if (!output)
-    throw IOException("Fasta::writeSequence: can't write to ostream output");
   // Sequence name
-  output << ">" << seq.getName();
+  buffer += ">" + seq.getName();
   // Sequence comments
   if (extended_)
   {
-    for (unsigned int i = 0; i < seq.getComments().size(); i++)
-    {
-      output << " \\" << seq.getComments()[i];
-    }
-  }
-  output << endl;
-  // Sequence content
-  string buffer; // use a buffer to format sequence with states > 1 char
-  for (size_t i = 0; i < seq.size(); ++i)
-  {
-    buffer += seq.getChar(i);
-    if (buffer.size() >= charsByLine_)
+    for (const auto& comment : seq.getComments())
     {
-      output << string(buffer.begin(), buffer.begin() + charsByLine_) << endl;
-      buffer.erase(0, charsByLine_);
+      buffer += " \\" + comment;
     }
   }
-  output << string(buffer.begin(), buffer.end()) << endl;
+  buffer += "\n";
+  // Sequence content, decoded at once then cut in lines. The last line is
+  // always written, even if empty.
+  string text;
+  SequenceWriterTools::appendContent(text, seq);
+  size_t full = charsByLine_ > 0 ? (text.size() / charsByLine_) * charsByLine_ : 0;
+  SequenceWriterTools::appendLines(buffer, text.data(), full, charsByLine_);
+  buffer.append(text, full, string::npos);
+  buffer += "\n";
+}
+
+/******************************************************************************/
+
+void Fasta::writeSequence(ostream& output, const Sequence& seq) const
+{
+  if (!output)
+    throw IOException("Fasta::writeSequence: can't write to ostream output");
+  string buffer;
+  formatSequence_(seq, buffer);
+  SequenceWriterTools::flush(output, buffer, true);
 }
 
 /******************************************************************************/
@@ -120,6 +279,59 @@ void Fasta::appendSequencesFromStream(istream& input, SequenceContainerInterface
 {
   if (!input)
     throw IOException("Fasta::appendFromStream: can't read from istream input");
+
+  // Pipelined decoding:
+  if (nbThreads_ != 1 && !extended_)
+  {
+    auto reader = make_shared<Fasta>(*this);
+    reader->numberOfThreads(1);
+    PipelinedSequenceIterator it(reader, shared_ptr<istream>(&input, [](istream*) {}), vsc.getAlphabet(), nbThreads_);
+    while (it.hasMoreSequences())
+    {
+      auto seq = it.nextSequence();
+      vsc.addSequence(seq->getName(), seq);
+    }
+    return;
+  }
+
+  // Fast path for memory-mapped input:
+  auto mapped = dynamic_cast<MemoryMappedStreamBuffer*>(input.rdbuf());
+  if (mapped)
+  {
+    bool direct;
+    vector<int> table = getDecodingTable_(vsc.alphabet(), direct);
+    if (!table.empty())
+    {
+      Comments cmts;
+      const char* p = mapped->current();
+      const char* end = mapped->end();
+      // Skip everything before the first sequence, but general comments:
+      while (p < end && *p != '>')
+      {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* lineEnd = eol ? eol : end;
+        if (extended_ && *p == '#' && p + 1 < lineEnd && p[1] == '\\')
+          cmts.push_back(string(p + 2, lineEnd));
+        p = eol ? eol + 1 : end;
+      }
+      mapped->setCurrent(p);
+      bool hasSeq = (p < end);
+      while (hasSeq)
+      {
+        auto alphaPtr = vsc.getAlphabet();
+        auto tmpseq = make_unique<Sequence>("", "", alphaPtr);
+        hasSeq = nextSequenceFromBuffer_(input, *mapped, *tmpseq, table, direct);
+        vsc.addSequence(tmpseq->getName(), tmpseq);
+      }
+      if (mapped->current() == end)
+        input.setstate(ios::eofbit);
+      if (extended_ && cmts.size())
+      {
+        vsc.setComments(cmts);
+      }
+      return;
+    }
+  }
   char c = '\n';
   char last_c;
   bool header = false;
@@ -175,6 +387,19 @@ void Fasta::appendSequencesFromStream(istream& input, SequenceContainerInterface
 
 /******************************************************************************/
 
+void Fasta::appendSequencesFromFile(const std::string& path, SequenceContainerInterface& sc) const
+{
+  if (!memoryMapped_ || BgzfInputStreamBuffer::isBgzfFile(path))
+  {
+    AbstractISequence::appendSequencesFromFile(path, sc);
+    return;
+  }
+  MemoryMappedInputStream input(path);
+  appendSequencesFromStream(input, sc);
+}
+
+/******************************************************************************/
+
 void Fasta::writeSequences(ostream& output, const SequenceContainerInterface& sc) const
 {
   if (!output)
@@ -190,12 +415,31 @@ void Fasta::writeSequences(ostream& output, const SequenceContainerInterface& sc
     output << endl;
   }
 
-  // Main loop : for all sequences in vector container
-  vector<string> names = sc.getSequenceNames();
-  for (size_t i = 0; i < names.size(); ++i)
-  {
-    writeSequence(output, sc.sequence(names[i]));
-  }
+  // Containers may build sequences on demand, and free them on a later access:
+  // a single sequence is formatted right after being retrieved, and the
+  // sequences of a group formatted in parallel are copied first.
+  vector<unique_ptr<Sequence>> copies;
+  vector<const Sequence*> group;
+  size_t groupFirst = 0;
+  SequenceWriterTools::writePreparedRecords(output, sc.getNumberOfSequences(),
+    [&sc, &copies, &group, &groupFirst](size_t first, size_t last) {
+      copies.clear();
+      group.clear();
+      groupFirst = first;
+      if (last - first == 1)
+      {
+        group.push_back(&sc.sequence(first));
+        return;
+      }
+      for (size_t i = first; i < last; ++i)
+      {
+        copies.emplace_back(sc.sequence(i).clone());
+        group.push_back(copies.back().get());
+      }
+    },
+    [this, &group, &groupFirst](size_t i, string& buffer) {
+      formatSequence_(*group[i - groupFirst], buffer);
+    }, nbThreads_);
 }
 
 /******************************************************************************/
@@ -204,69 +448,203 @@ void Fasta::writeSequences(ostream& output, const SequenceContainerInterface& sc
 
 void Fasta::FileIndex::build(const std::string& path, const bool strictSequenceNames)
 {
-  // open the file
-  std::ifstream f_in(path.c_str());
-  // get the size of the file
-  f_in.seekg(0, std::ios::end);
-  fileSize_ = f_in.tellg();
-  // feed the map
-  f_in.seekg(0, std::ios::beg);
-  streampos pos = f_in.tellg();
-  char ch;
-  std::string seq_id = "";
-  while (f_in.get(ch))
+  auto input = openFile(path);
+  istream& f_in = *input;
+  if (!f_in)
+    throw IOException("Fasta::FileIndex::build: failed to open file " + path);
+  entries_.clear();
+  index_.clear();
+
+  // The file is read by blocks, and parsed byte by byte:
+  vector<char> buffer(1 << 20);
+  size_t pos = 0;
+  bool inHeader = false;
+  bool atLineStart = true;
+  bool lastLineSeen = false; // True when a line shorter than the first one was found in the record.
+  size_t nbLines = 0;
+  size_t lineBytes = 0;
+  size_t lineBases = 0;
+  Entry entry;
+  bool hasEntry = false;
+  auto endLine = [&]()
   {
-    if (ch == '>')
+    if (nbLines == 0)
     {
-      pos = static_cast<int>(f_in.tellg()) - 1;
-      std::getline(f_in, seq_id);
-      if (strictSequenceNames)
+      entry.lineBases = lineBases;
+      entry.lineWidth = lineBytes;
+    }
+    else if (lineBases > 0 && (lastLineSeen || lineBases > entry.lineBases))
+      throw Exception("Fasta::FileIndex::build: different line length in sequence '" + entry.name + "'.");
+    if (lineBases > 0 && lineBytes != entry.lineWidth)
+      lastLineSeen = true;
+    if (lineBases == 0 && nbLines > 0)
+      lastLineSeen = true;
+    entry.length += lineBases;
+    ++nbLines;
+    lineBytes = 0;
+    lineBases = 0;
+  };
+
+  while (f_in)
+  {
+    f_in.read(buffer.data(), static_cast<streamsize>(buffer.size()));
+    size_t n = static_cast<size_t>(f_in.gcount());
+    for (size_t i = 0; i < n; ++i, ++pos)
+    {
+      char c = buffer[i];
+      if (inHeader)
+      {
+        if (c == '\n')
+        {
+          // The name ends at the first blank in strict mode:
+          if (strictSequenceNames)
+            entry.name = entry.name.substr(0, entry.name.find_first_of(" \t\r"));
+          else if (!entry.name.empty() && entry.name.back() == '\r')
+            entry.name.pop_back();
+          entry.offset = pos + 1;
+          inHeader = false;
+          atLineStart = true;
+        }
+        else
+          entry.name += c;
+        continue;
+      }
+      if (atLineStart && c == '>')
       {
-        seq_id = seq_id.substr(0, seq_id.find_first_of(" \t\n"));
+        if (hasEntry)
+        {
+          if (lineBytes > 0)
+            endLine();
+          addEntry_(entry);
+        }
+        entry = Entry();
+        entry.header = static_cast<streamoff>(pos);
+        hasEntry = true;
+        inHeader = true;
+        nbLines = 0;
+        lineBytes = 0;
+        lineBases = 0;
+        lastLineSeen = false;
+        continue;
       }
-      index_[seq_id] = pos;
+      ++lineBytes;
+      atLineStart = (c == '\n');
+      if (c == '\n')
+        endLine();
+      else if (!isspace(static_cast<unsigned char>(c)))
+        ++lineBases;
     }
   }
-  f_in.close();
+  if (hasEntry)
+  {
+    if (inHeader)
+      entry.offset = pos;
+    else if (lineBytes > 0)
+    {
+      // Last line without end of line character:
+      ++lineBytes;
+      endLine();
+    }
+    addEntry_(entry);
+  }
+  fileSize_ = static_cast<streamoff>(pos);
 }
 
-streampos Fasta::FileIndex::getSequencePosition(const std::string& id) const
+/******************************************************************************/
+
+void Fasta::FileIndex::addEntry_(const Entry& entry)
+{
+  index_[entry.name] = entries_.size();
+  entries_.push_back(entry);
+}
+
+std::unique_ptr<std::istream> Fasta::FileIndex::openFile(const std::string& path)
 {
-  std::map<std::string, streampos>::const_iterator it = index_.find(id);
-  if (it != index_.end())
+  if (BgzfInputStreamBuffer::isBgzfFile(path))
   {
-    return it->second;
+    // Random accesses only need one block at a time:
+    auto input = make_unique<BgzfInputStream>(path, 1);
+    if (FileTools::fileExists(path + ".gzi"))
+      input->buffer().readIndex(path + ".gzi");
+    return input;
   }
-  throw Exception("Sequence not found: " + id);
+  return make_unique<ifstream>(path.c_str(), ios::in | ios::binary);
+}
+
+/******************************************************************************/
+
+const Fasta::FileIndex::Entry& Fasta::FileIndex::getEntry(const std::string& id) const
+{
+  auto it = index_.find(id);
+  if (it == index_.end())
+    throw Exception("Sequence not found: " + id);
+  return entries_[it->second];
+}
+
+/******************************************************************************/
+
+streampos Fasta::FileIndex::getSequencePosition(const std::string& id) const
+{
+  const Entry& entry = getEntry(id);
+  if (entry.header == streampos(-1))
+    throw Exception("Fasta::FileIndex::getSequencePosition: the position of the header of sequence '" + id + "' is unknown.");
+  return entry.header;
 }
 
+/******************************************************************************/
+
 void Fasta::FileIndex::read(const std::string& path)
 {
   std::ifstream f_in(path.c_str());
+  if (!f_in)
+    throw IOException("Fasta::FileIndex::read: failed to open file " + path);
+  entries_.clear();
+  index_.clear();
   std::string line_buffer = "";
-  while (!f_in.eof())
+  while (std::getline(f_in, line_buffer))
   {
-    std::getline(f_in, line_buffer);
     if (bpp::TextTools::isEmpty(bpp::TextTools::removeSurroundingWhiteSpaces(line_buffer)))
     {
       continue;
     }
     bpp::StringTokenizer tk(line_buffer, "\t");
-    index_[tk.getToken(0)] = bpp::TextTools::toInt(tk.getToken(1));
+    Entry entry;
+    entry.name = tk.getToken(0);
+    if (tk.numberOfRemainingTokens() == 2)
+    {
+      // Index written by previous versions: name and position of the header.
+      entry.header = static_cast<streamoff>(bpp::TextTools::to<long long>(tk.getToken(1)));
+    }
+    else if (tk.numberOfRemainingTokens() >= 5)
+    {
+      entry.length = bpp::TextTools::to<size_t>(tk.getToken(1));
+      entry.offset = bpp::TextTools::to<size_t>(tk.getToken(2));
+      entry.lineBases = bpp::TextTools::to<size_t>(tk.getToken(3));
+      entry.lineWidth = bpp::TextTools::to<size_t>(tk.getToken(4));
+    }
+    else
+      throw Exception("Fasta::FileIndex::read: invalid index line: " + line_buffer);
+    addEntry_(entry);
   }
   f_in.close();
 }
 
+/******************************************************************************/
+
 void Fasta::FileIndex::write(const std::string& path)
 {
   std::ofstream f_out(path.c_str());
-  for (std::map<std::string, streampos>::const_iterator it = index_.begin(); it != index_.end(); ++it)
+  if (!f_out)
+    throw IOException("Fasta::FileIndex::write: failed to open file " + path);
+  for (const auto& entry : entries_)
   {
-    f_out << it->first << "\t" << bpp::TextTools::toString(it->second) << std::endl;
+    f_out << entry.name << "\t" << entry.length << "\t" << entry.offset << "\t" << entry.lineBases << "\t" << entry.lineWidth << "\n";
   }
   f_out.close();
 }
 
+/******************************************************************************/
+
 void Fasta::FileIndex::getSequence(const std::string& seqid, Sequence& seq, const std::string& path) const
 {
   getSequence(seqid, seq, path, false);
@@ -274,13 +652,116 @@ void Fasta::FileIndex::getSequence(const std::string& seqid, Sequence& seq, cons
 
 void Fasta::FileIndex::getSequence(const std::string& seqid, Sequence& seq, const std::string& path, const bool strictSequenceNames) const
 {
-  Fasta fs(60);
-  fs.strictNames(strictSequenceNames);
-  streampos seq_pos = this->getSequencePosition(seqid);
-  std::ifstream fasta(path.c_str());
-  fasta.seekg(seq_pos);
-  fs.nextSequence(fasta, seq);
-  fasta.close();
+  const Entry& entry = getEntry(seqid);
+  auto fasta = openFile(path);
+  if (!*fasta)
+    throw IOException("Fasta::FileIndex::getSequence: failed to open file " + path);
+  if (entry.header == streampos(-1))
+  {
+    // Only the position of the bases is known:
+    seq.setName(seqid);
+    seq.setContent(getSubsequence(*fasta, seqid, 0, entry.length));
+  }
+  else
+  {
+    Fasta fs(60);
+    fs.strictNames(strictSequenceNames);
+    fasta->seekg(entry.header);
+    fs.nextSequence(*fasta, seq);
+  }
+}
+
+/******************************************************************************/
+
+std::string Fasta::FileIndex::getSubsequence(std::istream& input, const std::string& seqid, size_t begin, size_t end) const
+{
+  const Entry& entry = getEntry(seqid);
+  if (entry.lineBases == 0 && entry.length > 0)
+    throw Exception("Fasta::FileIndex::getSubsequence: no line information for sequence '" + seqid + "'.");
+  end = min(end, entry.length);
+  if (begin >= end)
+    return "";
+
+  // Position of a base in the file:
+  auto offset = [&entry](size_t i)
+  {
+    return entry.offset + (i / entry.lineBases) * entry.lineWidth + i % entry.lineBases;
+  };
+  size_t first = offset(begin);
+  size_t last = offset(end - 1) + 1;
+  string raw(last - first, '\0');
+  input.clear();
+  input.seekg(static_cast<streamoff>(first));
+  input.read(&raw[0], static_cast<streamsize>(raw.size()));
+  if (static_cast<size_t>(input.gcount()) != raw.size())
+    throw IOException("Fasta::FileIndex::getSubsequence: unexpected end of file in sequence '" + seqid + "'.");
+
+  // End of line characters are removed:
+  if (entry.lineWidth == entry.lineBases)
+    return raw;
+  string bases;
+  bases.reserve(end - begin);
+  size_t i = 0;
+  size_t column = begin % entry.lineBases;
+  while (bases.size() < end - begin)
+  {
+    size_t count = min(entry.lineBases - column, end - begin - bases.size());
+    bases.append(raw, i, count);
+    i += count + entry.lineWidth - entry.lineBases;
+    column = 0;
+  }
+  return bases;
+}
+
+/******************************************************************************/
+
+void Fasta::FileIndex::parseRegion(const std::string& region, std::string& seqid, size_t& begin, size_t& end) const
+{
+  begin = 0;
+  end = string::npos;
+  size_t colon = region.rfind(':');
+  if (index_.find(region) != index_.end() || colon == string::npos)
+  {
+    seqid = region;
+    return;
+  }
+  seqid = region.substr(0, colon);
+  string range = region.substr(colon + 1);
+  range.erase(std::remove(range.begin(), range.end(), ','), range.end());
+  size_t dash = range.find('-');
+  string from = range.substr(0, dash);
+  string to = dash == string::npos ? "" : range.substr(dash + 1);
+  if (from.empty() || !TextTools::isDecimalInteger(from) || (!to.empty() && !TextTools::isDecimalInteger(to)))
+    throw Exception("Fasta::FileIndex::parseRegion: invalid region: " + region);
+  size_t start = TextTools::to<size_t>(from);
+  if (start == 0)
+    throw Exception("Fasta::FileIndex::parseRegion: positions start at 1 in region: " + region);
+  begin = start - 1;
+  if (!to.empty())
+  {
+    end = TextTools::to<size_t>(to);
+    if (end < start)
+      throw Exception("Fasta::FileIndex::parseRegion: invalid region: " + region);
+  }
+}
+
+/******************************************************************************/
+
+void Fasta::FileIndex::getRegion(std::istream& input, const std::string& region, Sequence& seq) const
+{
+  string seqid;
+  size_t begin, end;
+  parseRegion(region, seqid, begin, end);
+  seq.setName(region);
+  seq.setContent(getSubsequence(input, seqid, begin, end));
+}
+
+void Fasta::FileIndex::getRegion(const std::string& region, Sequence& seq, const std::string& path) const
+{
+  auto fasta = openFile(path);
+  if (!*fasta)
+    throw IOException("Fasta::FileIndex::getRegion: failed to open file " + path);
+  getRegion(*fasta, region, seq);
 }
 
 /******************************************************************************/
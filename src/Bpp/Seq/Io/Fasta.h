@@ -12,23 +12,41 @@
 #include "AbstractIAlignment.h"
 #include "AbstractISequence.h"
 #include "AbstractOSequence.h"
+#include "BgzfStream.h"
 #include "ISequenceStream.h"
+#include "MemoryMappedStream.h"
 #include "OSequenceStream.h"
 #include "SequenceFileIndex.h"
 
+// From the STL:
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace bpp
 {
 /**
  * @brief The fasta sequence file format.
  *
  * Read and write from/to Fasta files.
+ *
+ * When reading from a MemoryMappedInputStream, or from a file with the
+ * memory-mapped mode switched on, records are decoded directly from the mapped
+ * buffer, without intermediate string allocations. This fast path is used for
+ * all single-letter alphabets, and is otherwise equivalent to the standard one.
+ *
+ * Files compressed in the BGZF format are decompressed on the fly when read
+ * from a path (see BgzfInputStream), and written compressed when the path ends
+ * with ".gz" (see BgzfOutputStream). Memory mapping does not apply to them.
  */
 class Fasta :
   public AbstractISequence,
   public AbstractIAlignment,
   public AbstractOSequence2,
   public virtual ISequenceStream,
-  public virtual OSequenceStream
+  public virtual OSequenceStream,
+  public ISequenceRecordSplitter
 {
 protected:
   /**
@@ -38,6 +56,8 @@ protected:
   bool checkNames_;            // If names must be checked in container
   bool extended_;              // If using HUPO-PSI extensions
   bool strictNames_;           // If name is between '>' and first space
+  bool memoryMapped_;          // If files are memory-mapped (input only)
+  unsigned int nbThreads_;     // Number of decoding and formatting threads
 
 public:
   /**
@@ -48,7 +68,7 @@ public:
    * @param extended Tells if we should read general comments and sequence comments in HUPO-PSI format.
    * @param strictSequenceNames Tells if the sequence names should be restricted to the characters between '>' and the first blank one.
    */
-  Fasta(unsigned int charsByLine = 100, bool checkSequenceNames = true, bool extended = false, bool strictSequenceNames = false) : charsByLine_(charsByLine), checkNames_(checkSequenceNames), extended_(extended), strictNames_(strictSequenceNames)
+  Fasta(unsigned int charsByLine = 100, bool checkSequenceNames = true, bool extended = false, bool strictSequenceNames = false) : charsByLine_(charsByLine), checkNames_(checkSequenceNames), extended_(extended), strictNames_(strictSequenceNames), memoryMapped_(false), nbThreads_(1)
   {}
 
   // Class destructor
@@ -62,6 +82,8 @@ public:
    * @{
    */
   void appendSequencesFromStream(std::istream& input, SequenceContainerInterface& sc) const override;
+
+  void appendSequencesFromFile(const std::string& path, SequenceContainerInterface& sc) const override;
   /** @} */
 
   /**
@@ -73,6 +95,11 @@ public:
   {
     appendSequencesFromStream(input, sc); // This may raise an exception if sequences are not aligned!
   }
+
+  void appendAlignmentFromFile(const std::string& path, SequenceContainerInterface& sc) const override
+  {
+    appendSequencesFromFile(path, sc); // This may raise an exception if sequences are not aligned!
+  }
   /** @} */
 
   /**
@@ -112,6 +139,14 @@ public:
   bool nextSequence(std::istream& input, Sequence& seq) const override;
   /** @} */
 
+  /**
+   * @name The ISequenceRecordSplitter interface.
+   *
+   * @{
+   */
+  const char* findLastRecordEnd(const char* begin, const char* end, bool atEnd, ScanState& scan) const override;
+  /** @} */
+
   /**
    * @name The OSequenceStream interface.
    *
@@ -156,14 +191,121 @@ public:
     strictNames_ = yn;
   }
 
+  /**
+   * @return true if files are memory-mapped when reading sequences from a path.
+   */
+  bool memoryMapped() const
+  {
+    return memoryMapped_;
+  }
+
+  /**
+   * @brief Tell whether files should be memory-mapped when reading sequences from a path.
+   *
+   * @param yn whether files should be memory-mapped.
+   */
+  void memoryMapped(bool yn)
+  {
+    memoryMapped_ = yn;
+  }
+
+  /**
+   * @return The number of threads used to decode or format sequences when reading or writing a whole container.
+   */
+  unsigned int numberOfThreads() const
+  {
+    return nbThreads_;
+  }
+
+  /**
+   * @brief Set the number of threads used to decode or format sequences when reading or writing a whole container.
+   *
+   * With more than one thread, records are read by one thread and decoded by
+   * the others (see PipelinedSequenceIterator). This mode is not used with
+   * the HUPO-PSI extensions, which need the general comments of the file.
+   * When writing, records are formatted in parallel and written in order
+   * (see SequenceWriterTools).
+   *
+   * @param nbThreads The number of threads, 0 for the number of hardware threads.
+   */
+  void numberOfThreads(unsigned int nbThreads)
+  {
+    nbThreads_ = nbThreads;
+  }
+
+private:
+  /**
+   * @brief Read one sequence directly from a memory-mapped buffer.
+   *
+   * @param input  The stream owning the buffer.
+   * @param buffer The memory-mapped buffer, positioned at the beginning of a record.
+   * @param seq    The sequence to fill.
+   * @param table  The decoding table, indexed by unsigned char (see getDecodingTable_).
+   * @param direct Whether lines can be encoded directly by the alphabet (see getDecodingTable_).
+   * @return true if there are remaining records, as for nextSequence.
+   */
+  bool nextSequenceFromBuffer_(std::istream& input, MemoryMappedStreamBuffer& buffer, Sequence& seq, const std::vector<int>& table, bool direct) const;
+
+  /**
+   * @brief Set the name and comments of a sequence from the raw header line.
+   */
+  void setSequenceHeader_(std::string seqname, Sequence& seq) const;
+
+  /**
+   * @brief Append the record of a sequence to a buffer.
+   */
+  void formatSequence_(const Sequence& seq, std::string& buffer) const;
+
+  /**
+   * @brief Build the char to state table used by the memory-mapped parser.
+   *
+   * @param alphabet The alphabet of the sequences.
+   * @param direct [out] Whether the alphabet itself encodes non-blank characters as the
+   * table does, in which case lines without blanks can be passed to Alphabet::encode.
+   * @return A table of 256 elements, empty if the alphabet is not a single-letter one.
+   */
+  static std::vector<int> getDecodingTable_(const Alphabet& alphabet, bool& direct);
+
+public:
+
   /**
    * @brief The SequenceFileIndex class for Fasta format
+   *
+   * The index stores, for each record, the information of the samtools faidx
+   * format: the name of the sequence, its length, the offset of its first
+   * base in the file, the number of bases per line and the number of bytes
+   * per line, including the end of line characters. It can be read and
+   * written as a .fai file, compatible with samtools and htslib.
+   *
+   * As all lines of a record, except the last one, have the same length, the
+   * position in the file of any base of a sequence can be computed directly.
+   * Regions of sequences can thus be retrieved by reading and decoding only
+   * the requested bases, see getSubsequence() and getRegion().
+   *
+   * Files compressed in the BGZF format (with bgzip) can be indexed and
+   * accessed in the same way: offsets are then positions in the
+   * uncompressed data, as with samtools faidx, and only the blocks holding
+   * the requested bases are decompressed (see BgzfInputStreamBuffer).
+   *
    * @author Sylvain Gaillard
    */
   class FileIndex : SequenceFileIndex
   {
 public:
-    FileIndex() : index_(), fileSize_(0)
+    /**
+     * @brief The index entry of a record.
+     */
+    struct Entry
+    {
+      std::string name{};
+      size_t length = 0;           // Number of bases in the sequence.
+      size_t offset = 0;           // Offset of the first base in the file.
+      size_t lineBases = 0;        // Number of bases per line.
+      size_t lineWidth = 0;        // Number of bytes per line, including end of line characters.
+      std::streampos header = -1;  // Position of the header line, -1 if unknown.
+    };
+
+    FileIndex() : entries_(), index_(), fileSize_(0)
     {}
     ~FileIndex()
     {}
@@ -176,19 +318,45 @@ public:
      *
      * @param path The path to the file.
      * @param strictSequenceNames Tells if the sequence names should be restricted to the characters between '>' and the first blank one.
+     * @throw IOException If the file cannot be read.
+     * @throw Exception If the lines of a record do not all have the same length, except the last one.
      */
     void build(const std::string& path, const bool strictSequenceNames);
+    /**
+     * @return The position of the header line of a record.
+     * @throw Exception If the sequence is not indexed, or if the index was read from a .fai file,
+     * which does not store the positions of headers.
+     */
     std::streampos getSequencePosition(const std::string& id) const;
     size_t getNumberOfSequences() const
     {
-      return index_.size();
+      return entries_.size();
+    }
+    /**
+     * @return The index entry of a sequence.
+     * @throw Exception If the sequence is not indexed.
+     */
+    const Entry& getEntry(const std::string& id) const;
+    /**
+     * @return The index entries, in file order.
+     */
+    const std::vector<Entry>& getEntries() const
+    {
+      return entries_;
     }
     /**
      * @brief Read the index from a file
+     *
+     * Both .fai files and files written by previous versions of this class,
+     * with only the name and position of each header, can be read.
+     *
+     * @throw IOException If the file cannot be read.
      */
     void read(const std::string& path);
     /**
-     * @brief Write the index to a file
+     * @brief Write the index to a file, in .fai format.
+     *
+     * @throw IOException If the file cannot be written.
      */
     void write(const std::string& path);
     /**
@@ -196,9 +364,58 @@ public:
      */
     void getSequence(const std::string& seqid, Sequence& seq, const std::string& path) const;
     void getSequence(const std::string& seqid, Sequence& seq, const std::string& path, const bool strictSequenceNames) const;
+    /**
+     * @brief Get a part of a sequence.
+     *
+     * Only the bases of the requested part are read from the stream, which
+     * can be used for any number of calls.
+     *
+     * @param input The stream of the indexed file.
+     * @param seqid The name of the sequence.
+     * @param begin The position of the first base, starting at 0.
+     * @param end The position after the last base. It is truncated to the length of the sequence.
+     * @return The bases, as written in the file.
+     * @throw Exception If the sequence is not indexed, or if the index has no line information.
+     * @throw IOException If the stream cannot be read.
+     */
+    std::string getSubsequence(std::istream& input, const std::string& seqid, size_t begin, size_t end) const;
+    /**
+     * @brief Get a region of a sequence given in the samtools format.
+     *
+     * Regions are written `name`, `name:begin` or `name:begin-end`, where
+     * positions start at 1 and the end is included. Positions may contain
+     * commas as thousand separators. If the whole region is the name of a
+     * sequence, the complete sequence is returned.
+     *
+     * @param input The stream of the indexed file.
+     * @param region The region to retrieve.
+     * @param seq The sequence to fill. Its name is set to the region.
+     * @throw Exception If the region is invalid or the sequence is not indexed.
+     */
+    void getRegion(std::istream& input, const std::string& region, Sequence& seq) const;
+    void getRegion(const std::string& region, Sequence& seq, const std::string& path) const;
+    /**
+     * @brief Parse a region given in the samtools format.
+     *
+     * @param region The region, see getRegion().
+     * @param seqid [out] The name of the sequence.
+     * @param begin [out] The position of the first base, starting at 0.
+     * @param end [out] The position after the last base, or std::string::npos if not specified.
+     * @throw Exception If the region is not valid.
+     */
+    void parseRegion(const std::string& region, std::string& seqid, size_t& begin, size_t& end) const;
+    /**
+     * @brief Open an indexed file, decompressing it if it is in the BGZF format.
+     *
+     * The block index of BGZF files (.gzi) is loaded if present.
+     */
+    static std::unique_ptr<std::istream> openFile(const std::string& path);
 
 private:
-    std::map<std::string, std::streampos> index_;
+    void addEntry_(const Entry& entry);
+
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, size_t> index_;
     std::streampos fileSize_;
   };
 };
@@ -0,0 +1,354 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include <Bpp/Text/TextTools.h>
+
+#include "Fastq.h"
+#include "MemoryMappedStream.h"
+
+// From the STL:
+#include <algorithm>
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+namespace
+{
+/**
+ * @brief Lines of a standard stream.
+ */
+class StreamLines
+{
+private:
+  istream& input_;
+  string line_;
+
+public:
+  StreamLines(istream& input) :
+    input_(input),
+    line_()
+  {}
+
+  bool next(const char*& begin, const char*& end)
+  {
+    if (!getline(input_, line_))
+      return false;
+    begin = line_.data();
+    end = begin + line_.size();
+    return true;
+  }
+
+  /**
+   * @return true if non-blank characters are left.
+   */
+  bool hasMore()
+  {
+    int c;
+    while ((c = input_.peek()) != char_traits<char>::eof() && TextTools::isWhiteSpaceCharacter(static_cast<char>(c)))
+    {
+      input_.get();
+    }
+    return c != char_traits<char>::eof();
+  }
+};
+
+/**
+ * @brief Lines of a memory-mapped file, read in place.
+ */
+class MappedLines
+{
+private:
+  MemoryMappedStreamBuffer& buffer_;
+  const char* p_;
+  const char* end_;
+
+public:
+  MappedLines(MemoryMappedStreamBuffer& buffer) :
+    buffer_(buffer),
+    p_(buffer.current()),
+    end_(buffer.end())
+  {}
+
+  ~MappedLines()
+  {
+    buffer_.setCurrent(p_);
+  }
+
+  // Recopy is forbidden
+  MappedLines(const MappedLines&) = delete;
+  MappedLines& operator=(const MappedLines&) = delete;
+
+  bool next(const char*& begin, const char*& end)
+  {
+    if (p_ >= end_)
+      return false;
+    const char* eol = static_cast<const char*>(memchr(p_, '\n', static_cast<size_t>(end_ - p_)));
+    begin = p_;
+    end = eol ? eol : end_;
+    p_ = eol ? eol + 1 : end_;
+    return true;
+  }
+
+  bool hasMore()
+  {
+    while (p_ < end_ && TextTools::isWhiteSpaceCharacter(*p_))
+    {
+      ++p_;
+    }
+    return p_ < end_;
+  }
+};
+
+/**
+ * @brief Parse one record.
+ *
+ * @return false if no record was found before the end of the input.
+ */
+template<class Lines>
+bool parseRecord(Lines& lines, const Alphabet& alphabet, int offset, string& header, vector<int>& content, vector<int>& quality)
+{
+  const char* begin;
+  const char* end;
+  auto trim = [&]() {
+    while (end > begin && TextTools::isWhiteSpaceCharacter(*(end - 1)))
+    {
+      --end;
+    }
+  };
+
+  // Header, after optional blank lines:
+  do
+  {
+    if (!lines.next(begin, end))
+      return false;
+    trim();
+  }
+  while (begin == end);
+  if (*begin != '@')
+    throw IOException("Fastq: record does not start with '@': " + string(begin, end));
+  header.assign(begin + 1, end);
+
+  // Bases, up to the separator line:
+  content.clear();
+  while (true)
+  {
+    if (!lines.next(begin, end))
+      throw IOException("Fastq: truncated record '" + header + "'.");
+    trim();
+    if (begin < end && *begin == '+')
+      break;
+    size_t previousSize = content.size();
+    content.resize(previousSize + static_cast<size_t>(end - begin));
+    alphabet.encode(begin, static_cast<size_t>(end - begin), content.data() + previousSize);
+  }
+
+  // As many quality characters as bases, possibly on several lines:
+  quality.clear();
+  quality.reserve(content.size());
+  while (quality.size() < content.size())
+  {
+    if (!lines.next(begin, end))
+      throw IOException("Fastq: truncated quality of record '" + header + "'.");
+    trim();
+    for (const char* q = begin; q < end; ++q)
+    {
+      unsigned char c = static_cast<unsigned char>(*q);
+      int score = static_cast<int>(c) - offset;
+      if (score < 0 || c > '~')
+        throw IOException("Fastq: invalid quality character '" + string(1, *q) + "' in record '" + header + "'.");
+      quality.push_back(score);
+    }
+  }
+  if (quality.size() != content.size())
+    throw IOException("Fastq: quality and sequence lengths differ in record '" + header + "'.");
+  return true;
+}
+} // end of anonymous namespace.
+
+/******************************************************************************/
+
+bool Fastq::readRecord_(istream& input, const Alphabet& alphabet, string& header, vector<int>& content, vector<int>& quality, bool& found) const
+{
+  if (!input)
+    throw IOException("Fastq::nextSequence: can't read from istream input");
+  if (alphabet.getStateCodingSize() != 1)
+    throw AlphabetException("Fastq::nextSequence: only alphabets with one character per state are supported.", &alphabet);
+
+  // Fast path for memory-mapped input:
+  auto mapped = dynamic_cast<MemoryMappedStreamBuffer*>(input.rdbuf());
+  if (mapped)
+  {
+    MappedLines lines(*mapped);
+    found = parseRecord(lines, alphabet, qualityOffset_, header, content, quality);
+    bool more = lines.hasMore();
+    if (!more)
+      input.setstate(ios::eofbit);
+    return more;
+  }
+  StreamLines lines(input);
+  found = parseRecord(lines, alphabet, qualityOffset_, header, content, quality);
+  return lines.hasMore();
+}
+
+/******************************************************************************/
+
+void Fastq::setSequenceHeader_(const string& header, SequenceInterface& seq) const
+{
+  if (strictNames_)
+  {
+    size_t pos = header.find_first_of(" \t");
+    seq.setName(header.substr(0, pos));
+    Comments comments;
+    if (pos != string::npos)
+      comments.push_back(TextTools::removeSurroundingWhiteSpaces(header.substr(pos + 1)));
+    seq.setComments(comments);
+  }
+  else
+  {
+    seq.setName(header);
+    seq.setComments(Comments());
+  }
+}
+
+/******************************************************************************/
+
+bool Fastq::nextSequence(istream& input, Sequence& seq) const
+{
+  string header;
+  vector<int> content, quality;
+  bool found;
+  bool more = readRecord_(input, seq.alphabet(), header, content, quality, found);
+  setSequenceHeader_(header, seq);
+  seq.swapContent(content);
+  return more;
+}
+
+/******************************************************************************/
+
+bool Fastq::nextSequence(istream& input, SequenceWithQuality& seq) const
+{
+  string header;
+  vector<int> content, quality;
+  bool found;
+  bool more = readRecord_(input, seq.alphabet(), header, content, quality, found);
+  setSequenceHeader_(header, seq);
+  seq.setContent(content);
+  seq.setQualities(quality);
+  return more;
+}
+
+/******************************************************************************/
+
+size_t Fastq::nextSequences(
+    istream& input,
+    shared_ptr<const Alphabet> alphabet,
+    size_t maxNumber,
+    vector<unique_ptr<SequenceWithQuality>>& seqs) const
+{
+  string header;
+  vector<int> content, quality;
+  size_t nbRead = 0;
+  bool more = static_cast<bool>(input);
+  while (more && nbRead < maxNumber)
+  {
+    bool found;
+    more = readRecord_(input, *alphabet, header, content, quality, found);
+    if (!found)
+      break;
+    auto seq = make_unique<SequenceWithQuality>(alphabet);
+    setSequenceHeader_(header, *seq);
+    seq->setContent(content);
+    seq->setQualities(quality);
+    seqs.push_back(std::move(seq));
+    ++nbRead;
+  }
+  return nbRead;
+}
+
+/******************************************************************************/
+
+const char* Fastq::findLastRecordEnd(const char* begin, const char* end, bool atEnd, ScanState& scan) const
+{
+  if (atEnd)
+    return end;
+  // Records are followed line by line without decoding them, as lines
+  // starting with '@' may be quality lines. The scan resumes at the first
+  // line not read yet, in the header (step 0), the sequence (step 1) or the
+  // qualities (step 2) of a record, with the number of bases and scores read.
+  const char* p = begin + scan.scanned;
+  while (true)
+  {
+    const char* eol = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (!eol)
+      break;
+    const char* line = p;
+    const char* lineEnd = eol;
+    while (lineEnd > line && TextTools::isWhiteSpaceCharacter(*(lineEnd - 1)))
+    {
+      --lineEnd;
+    }
+    size_t length = static_cast<size_t>(lineEnd - line);
+    p = eol + 1;
+    if (scan.step == 0)
+    {
+      if (length > 0)
+      {
+        scan.step = 1;
+        scan.count1 = 0;
+      }
+    }
+    else if (scan.step == 1)
+    {
+      if (length > 0 && *line == '+')
+      {
+        scan.step = 2;
+        scan.count2 = 0;
+      }
+      else
+        scan.count1 += length;
+    }
+    else
+      scan.count2 += length;
+    if (scan.step == 2 && scan.count2 >= scan.count1)
+    {
+      scan.step = 0;
+      scan.lastEnd = static_cast<size_t>(p - begin);
+    }
+  }
+  scan.scanned = static_cast<size_t>(p - begin);
+  return begin + scan.lastEnd;
+}
+
+/******************************************************************************/
+
+void Fastq::writeSequence(ostream& output, const SequenceWithQuality& seq) const
+{
+  if (!output)
+    throw IOException("Fastq::writeSequence: can't write to ostream output");
+  // The record is formatted at once:
+  string record = "@" + seq.getName();
+  if (strictNames_)
+  {
+    for (const auto& comment : seq.getComments())
+    {
+      record += " " + comment;
+    }
+  }
+  record += "\n" + seq.toString() + "\n+\n";
+  const vector<int>& quality = seq.getQualities();
+  size_t start = record.size();
+  record.resize(start + quality.size() + 1);
+  int maxScore = '~' - qualityOffset_;
+  for (size_t i = 0; i < quality.size(); ++i)
+  {
+    record[start + i] = static_cast<char>(min(max(quality[i], 0), maxScore) + qualityOffset_);
+  }
+  record.back() = '\n';
+  output.write(record.data(), static_cast<streamsize>(record.size()));
+}
+
+/******************************************************************************/
@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_IO_FASTQ_H
+#define BPP_SEQ_IO_FASTQ_H
+
+
+#include "../Sequence.h"
+#include "../SequenceWithQuality.h"
+#include "ISequenceStream.h"
+#include "OSequenceStream.h"
+
+// From the STL:
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief The FASTQ sequence file format.
+ *
+ * Read and write sequences with quality scores, as produced by
+ * high-throughput sequencers. Each record is made of a header line starting
+ * with '@', one or more sequence lines, a separator line starting with '+',
+ * and as many quality characters as bases. Qualities are Phred scores,
+ * encoded as ASCII characters with an offset of 33 (Sanger and Illumina 1.8+)
+ * or 64 (Illumina 1.3 to 1.7).
+ *
+ * Records are parsed line by line: the bases of each line are encoded at once
+ * by the alphabet, and quality characters are converted directly into the
+ * quality vector. When reading from a MemoryMappedInputStream, lines are
+ * scanned in the mapped buffer, without intermediate copy.
+ *
+ * Reading into a Sequence discards the quality scores, reading into a
+ * SequenceWithQuality keeps them, so that this class can be used with both
+ * StreamSequenceIterator and StreamSequenceWithQualityIterator, or their
+ * pipelined counterparts (see PipelinedSequenceIterator).
+ *
+ * @par Usage
+ *
+ * @code
+ * Fastq fq;
+ * std::ifstream in("reads.fastq");
+ * std::vector<std::unique_ptr<SequenceWithQuality>> reads;
+ * while (fq.nextSequences(in, AlphabetTools::DNA_ALPHABET, 100000, reads) > 0)
+ * {
+ *   // Process the reads...
+ *   reads.clear();
+ * }
+ * @endcode
+ */
+class Fastq :
+  public virtual ISequenceStream,
+  public virtual ISequenceWithQualityStream,
+  public virtual OSequenceWithQualityStream,
+  public ISequenceRecordSplitter
+{
+private:
+  int qualityOffset_;
+  bool strictNames_;
+
+public:
+  /**
+   * @brief Build a new Fastq object.
+   *
+   * @param phred64 Tells if quality scores are encoded with an offset of 64 instead of 33.
+   * @param strictSequenceNames Tells if the sequence names should be restricted to the characters between '@' and the first blank one,
+   * the remaining of the header line being stored as a comment.
+   */
+  Fastq(bool phred64 = false, bool strictSequenceNames = false) :
+    qualityOffset_(phred64 ? 64 : 33),
+    strictNames_(strictSequenceNames)
+  {}
+
+  virtual ~Fastq()
+  {}
+
+public:
+  /**
+   * @name The IOFormat interface.
+   *
+   * @{
+   */
+  const std::string getFormatName() const override
+  {
+    return "FASTQ";
+  }
+
+  const std::string getFormatDescription() const override
+  {
+    return "Sequences with quality scores, following the FASTQ format, with Phred+33 or Phred+64 encoded qualities.";
+  }
+
+  const std::string getDataType() const override
+  {
+    return "SequenceWithQuality";
+  }
+  /** @} */
+
+  /**
+   * @name The ISequenceStream interface.
+   *
+   * The return value tells if more records follow the one which was read.
+   *
+   * @{
+   */
+  bool nextSequence(std::istream& input, Sequence& seq) const override;
+
+  bool nextSequence(std::istream& input, SequenceWithQuality& seq) const override;
+  /** @} */
+
+  /**
+   * @brief Read several records at once.
+   *
+   * @param input The stream to read.
+   * @param alphabet The alphabet of the sequences.
+   * @param maxNumber The maximum number of records to read.
+   * @param seqs The vector where the new sequences are appended.
+   * @return The number of records read, 0 at the end of the stream.
+   * @throw IOException If a record is not properly formatted.
+   */
+  size_t nextSequences(
+      std::istream& input,
+      std::shared_ptr<const Alphabet> alphabet,
+      size_t maxNumber,
+      std::vector<std::unique_ptr<SequenceWithQuality>>& seqs) const;
+
+  /**
+   * @name The ISequenceRecordSplitter interface.
+   *
+   * @{
+   */
+  const char* findLastRecordEnd(const char* begin, const char* end, bool atEnd, ScanState& scan) const override;
+  /** @} */
+
+  /**
+   * @name The OSequenceStream interface.
+   *
+   * Quality scores are truncated to the range allowed by the encoding:
+   * unknown scores (see SequenceQuality::DEFAULT_QUALITY_VALUE) are written as 0.
+   *
+   * @{
+   */
+  void writeSequence(std::ostream& output, const SequenceWithQuality& seq) const override;
+  /** @} */
+
+  /**
+   * @return The offset of the quality characters, 33 or 64.
+   */
+  int getQualityOffset() const
+  {
+    return qualityOffset_;
+  }
+
+  /**
+   * @return true if the names are to be considered as strict.
+   */
+  bool strictNames() const
+  {
+    return strictNames_;
+  }
+
+  /**
+   * @brief Tell whether the sequence names should be restricted to the characters between '@' and the first blank one.
+   *
+   * @param yn whether the sequence names should be restricted.
+   */
+  void strictNames(bool yn)
+  {
+    strictNames_ = yn;
+  }
+
+private:
+  /**
+   * @brief Read one record.
+   *
+   * @param input The stream to read.
+   * @param alphabet The alphabet of the sequence.
+   * @param header [out] The header line, without the leading '@'.
+   * @param content [out] The encoded bases.
+   * @param quality [out] The quality scores.
+   * @param found [out] Tells if a record was read.
+   * @return true if more records follow.
+   */
+  bool readRecord_(std::istream& input, const Alphabet& alphabet, std::string& header, std::vector<int>& content, std::vector<int>& quality, bool& found) const;
+
+  /**
+   * @brief Set the name and comments of a sequence from a header line.
+   */
+  void setSequenceHeader_(const std::string& header, SequenceInterface& seq) const;
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_IO_FASTQ_H
@@ -45,6 +45,51 @@ public:
   virtual bool nextSequence(std::istream& input, SequenceType& seq) const = 0;
 };
 
+/**
+ * @brief Interface for sequence stream formats whose records can be delimited without being decoded.
+ *
+ * This allows to cut an input in chunks of whole records, which can then be
+ * decoded independently (see PipelinedSequenceIterator).
+ */
+class ISequenceRecordSplitter
+{
+public:
+  /**
+   * @brief Where the scan of a buffer stopped, so that a buffer growing at its end is only scanned once.
+   *
+   * A new scan starts with default values. When the beginning of the buffer
+   * is removed, offsets must be shifted accordingly.
+   */
+  struct ScanState
+  {
+    size_t scanned = 0; // The number of bytes already scanned, from the beginning of the buffer.
+    size_t lastEnd = 0; // The end of the last complete record found, from the beginning of the buffer.
+    unsigned int step = 0; // Where the scan is in the current record, depending on the format.
+    size_t count1 = 0;  // Format-specific counts in the current record.
+    size_t count2 = 0;
+  };
+
+public:
+  ISequenceRecordSplitter()
+  {}
+  virtual ~ISequenceRecordSplitter()
+  {}
+
+public:
+  /**
+   * @brief Find the end of the last complete record in a buffer.
+   *
+   * Only the bytes after scan.scanned are read, the state of the scan being updated.
+   *
+   * @param begin A pointer toward the beginning of the buffer, which is also the beginning of a record.
+   * @param end A pointer toward the end of the buffer.
+   * @param atEnd Tells if the buffer ends with the input, in which case the last record is complete.
+   * @param scan [in,out] Where the previous scan of the same buffer stopped.
+   * @return A pointer after the last complete record, or begin if the buffer does not contain any.
+   */
+  virtual const char* findLastRecordEnd(const char* begin, const char* end, bool atEnd, ScanState& scan) const = 0;
+};
+
 using ISequenceStream = TemplateISequenceStream<Sequence>;
 using ISequenceWithQualityStream = TemplateISequenceStream<SequenceWithQuality>;
 using IProbabilisticSequenceStream = TemplateISequenceStream<ProbabilisticSequence>;
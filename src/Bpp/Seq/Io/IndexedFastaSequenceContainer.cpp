@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include <Bpp/Io/FileTools.h>
+#include <Bpp/Text/TextTools.h>
+
+#include "../Container/SequenceContainerExceptions.h"
+#include "IndexedFastaSequenceContainer.h"
+
+// From the STL:
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+IndexedFastaSequenceContainer::IndexedFastaSequenceContainer(const string& path, shared_ptr<const Alphabet> alphabet, size_t cacheSize) :
+  AbstractTemplateSequenceContainer<Sequence, string>(alphabet),
+  path_(path),
+  index_(),
+  names_(),
+  positions_(),
+  cacheSize_(max<size_t>(cacheSize, 1)),
+  input_(),
+  cache_(),
+  recentlyUsed_(),
+  usePositions_()
+{
+  // Names stop at the first blank character, as in .fai files:
+  if (FileTools::fileExists(path + ".fai"))
+    index_.read(path + ".fai");
+  else
+    index_.build(path, true);
+  init_();
+}
+
+IndexedFastaSequenceContainer::IndexedFastaSequenceContainer(const string& path, const Fasta::FileIndex& index, shared_ptr<const Alphabet> alphabet, size_t cacheSize) :
+  AbstractTemplateSequenceContainer<Sequence, string>(alphabet),
+  path_(path),
+  index_(index),
+  names_(),
+  positions_(),
+  cacheSize_(max<size_t>(cacheSize, 1)),
+  input_(),
+  cache_(),
+  recentlyUsed_(),
+  usePositions_()
+{
+  init_();
+}
+
+IndexedFastaSequenceContainer::IndexedFastaSequenceContainer(const IndexedFastaSequenceContainer& isc) :
+  AbstractTemplateSequenceContainer<Sequence, string>(isc),
+  path_(isc.path_),
+  index_(isc.index_),
+  names_(),
+  positions_(),
+  cacheSize_(isc.cacheSize_),
+  input_(),
+  cache_(),
+  recentlyUsed_(),
+  usePositions_()
+{
+  init_();
+}
+
+IndexedFastaSequenceContainer& IndexedFastaSequenceContainer::operator=(const IndexedFastaSequenceContainer& isc)
+{
+  AbstractTemplateSequenceContainer<Sequence, string>::operator=(isc);
+  path_ = isc.path_;
+  index_ = isc.index_;
+  cacheSize_ = isc.cacheSize_;
+  recentlyUsed_.clear();
+  init_();
+  return *this;
+}
+
+/******************************************************************************/
+
+void IndexedFastaSequenceContainer::init_()
+{
+  input_ = Fasta::FileIndex::openFile(path_);
+  if (!*input_)
+    throw IOException("IndexedFastaSequenceContainer: failed to open file " + path_);
+  const vector<Fasta::FileIndex::Entry>& entries = index_.getEntries();
+  names_.resize(entries.size());
+  positions_.clear();
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    names_[i] = entries[i].name;
+    positions_[names_[i]] = i;
+  }
+  cache_.clear();
+  cache_.resize(entries.size());
+  usePositions_.assign(entries.size(), recentlyUsed_.end());
+}
+
+/******************************************************************************/
+
+const string& IndexedFastaSequenceContainer::sequenceKey(size_t sequencePosition) const
+{
+  if (sequencePosition >= names_.size())
+    throw IndexOutOfBoundsException("IndexedFastaSequenceContainer::sequenceKey.", sequencePosition, 0, names_.size() - 1);
+  return names_[sequencePosition];
+}
+
+size_t IndexedFastaSequenceContainer::getSequencePosition(const string& sequenceKey) const
+{
+  auto it = positions_.find(sequenceKey);
+  if (it == positions_.end())
+    throw SequenceNotFoundException("IndexedFastaSequenceContainer::getSequencePosition.", sequenceKey);
+  return it->second;
+}
+
+size_t IndexedFastaSequenceContainer::getSequenceLength(size_t sequencePosition) const
+{
+  if (sequencePosition >= names_.size())
+    throw IndexOutOfBoundsException("IndexedFastaSequenceContainer::getSequenceLength.", sequencePosition, 0, names_.size() - 1);
+  return index_.getEntries()[sequencePosition].length;
+}
+
+/******************************************************************************/
+
+shared_ptr<const Sequence> IndexedFastaSequenceContainer::getSharedSequence(size_t sequencePosition) const
+{
+  if (sequencePosition >= names_.size())
+    throw IndexOutOfBoundsException("IndexedFastaSequenceContainer::getSharedSequence.", sequencePosition, 0, names_.size() - 1);
+
+  // Already decoded: the sequence becomes the most recently used one.
+  if (cache_[sequencePosition])
+  {
+    recentlyUsed_.splice(recentlyUsed_.begin(), recentlyUsed_, usePositions_[sequencePosition]);
+    return cache_[sequencePosition];
+  }
+
+  shared_ptr<const Sequence> seq = readSequence_(sequencePosition);
+  shrinkCache_(cacheSize_ - 1);
+  cache_[sequencePosition] = seq;
+  recentlyUsed_.push_front(sequencePosition);
+  usePositions_[sequencePosition] = recentlyUsed_.begin();
+  return seq;
+}
+
+/******************************************************************************/
+
+unique_ptr<Sequence> IndexedFastaSequenceContainer::readSequence_(size_t sequencePosition) const
+{
+  const Fasta::FileIndex::Entry& entry = index_.getEntries()[sequencePosition];
+  auto alphaPtr = getAlphabet();
+  auto seq = make_unique<Sequence>(alphaPtr);
+  if (entry.lineBases == 0 && entry.header != streampos(-1))
+  {
+    // Index without line information: the record is parsed from its header.
+    Fasta fasta;
+    fasta.strictNames(true);
+    input_->clear();
+    input_->seekg(entry.header);
+    fasta.nextSequence(*input_, *seq);
+    seq->setComments(Comments());
+  }
+  else
+    seq->setContent(TextTools::toUpper(index_.getSubsequence(*input_, entry.name, 0, entry.length)));
+  seq->setName(entry.name);
+  return seq;
+}
+
+/******************************************************************************/
+
+void IndexedFastaSequenceContainer::shrinkCache_(size_t maxSize) const
+{
+  while (recentlyUsed_.size() > maxSize)
+  {
+    size_t last = recentlyUsed_.back();
+    recentlyUsed_.pop_back();
+    cache_[last].reset();
+    usePositions_[last] = recentlyUsed_.end();
+  }
+}
+
+void IndexedFastaSequenceContainer::cacheSize(size_t cacheSize)
+{
+  cacheSize_ = max<size_t>(cacheSize, 1);
+  shrinkCache_(cacheSize_);
+}
+
+/******************************************************************************/
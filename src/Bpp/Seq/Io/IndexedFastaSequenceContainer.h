@@ -0,0 +1,339 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_IO_INDEXEDFASTASEQUENCECONTAINER_H
+#define BPP_SEQ_IO_INDEXEDFASTASEQUENCECONTAINER_H
+
+#include <Bpp/Exceptions.h>
+
+#include "../Container/AbstractSequenceContainer.h"
+#include "../Container/VectorSequenceContainer.h"
+#include "../Sequence.h"
+#include "Fasta.h"
+
+// From the STL:
+#include <istream>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief A read-only sequence container reading sequences from an indexed FASTA file on demand.
+ *
+ * Only the index of the file (see Fasta::FileIndex) is kept in memory, so
+ * that names and lengths of all sequences are available at once, whatever
+ * the size of the file. A sequence is decoded from the file the first time it
+ * is accessed, and kept in a cache holding at most cacheSize sequences: when
+ * the cache is full, the least recently used sequence is discarded.
+ *
+ * The index is read from the .fai file next to the sequence file if there is
+ * one, and built otherwise. BGZF-compressed files are supported, as by
+ * Fasta::FileIndex. Sequence names are those of the index, so they stop at
+ * the first blank character of the headers, and sequence comments are not
+ * read.
+ *
+ * Methods modifying the container throw an Exception. As sequences built by
+ * createEmptyContainer() are stored in a VectorSequenceContainer, the
+ * functions of SequenceContainerTools can be used with this container.
+ *
+ * @warning A reference returned by sequence() is only valid until cacheSize
+ * other sequences are accessed, so functions working on generic containers
+ * must not keep more than one at a time. A sequence can be kept longer with
+ * getSharedSequence(): it is then freed only when the caller releases it. The
+ * container is not thread-safe, even for read-only methods, as they share the
+ * cache and the file stream.
+ */
+class IndexedFastaSequenceContainer :
+  public AbstractTemplateSequenceContainer<Sequence, std::string>
+{
+private:
+  std::string path_;
+  Fasta::FileIndex index_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, size_t> positions_;
+  size_t cacheSize_;
+  mutable std::unique_ptr<std::istream> input_;
+  mutable std::vector<std::shared_ptr<const Sequence>> cache_;
+  mutable std::list<size_t> recentlyUsed_; // Cached sequences, the most recently used first.
+  mutable std::vector<std::list<size_t>::iterator> usePositions_;
+
+public:
+  /**
+   * @brief Open an indexed FASTA file.
+   *
+   * @param path The path to the FASTA file, possibly compressed with BGZF.
+   * @param alphabet The alphabet of the sequences.
+   * @param cacheSize The maximum number of decoded sequences kept in memory, at least 1.
+   * @throw IOException If the file or its index cannot be read.
+   */
+  IndexedFastaSequenceContainer(const std::string& path, std::shared_ptr<const Alphabet> alphabet, size_t cacheSize = 100);
+
+  /**
+   * @brief Open a FASTA file with a given index.
+   *
+   * @param path The path to the FASTA file, possibly compressed with BGZF.
+   * @param index The index of the file.
+   * @param alphabet The alphabet of the sequences.
+   * @param cacheSize The maximum number of decoded sequences kept in memory, at least 1.
+   * @throw IOException If the file cannot be read.
+   */
+  IndexedFastaSequenceContainer(const std::string& path, const Fasta::FileIndex& index, std::shared_ptr<const Alphabet> alphabet, size_t cacheSize = 100);
+
+  /**
+   * @brief Copy constructor. The file is opened again, with an empty cache.
+   */
+  IndexedFastaSequenceContainer(const IndexedFastaSequenceContainer& isc);
+
+  IndexedFastaSequenceContainer& operator=(const IndexedFastaSequenceContainer& isc);
+
+  virtual ~IndexedFastaSequenceContainer()
+  {}
+
+public:
+  /**
+   * @name The Clonable interface.
+   *
+   * @{
+   */
+  IndexedFastaSequenceContainer* clone() const override
+  {
+    return new IndexedFastaSequenceContainer(*this);
+  }
+  /** @} */
+
+  /**
+   * @name The SequenceContainer interface.
+   *
+   * @{
+   */
+  VectorSequenceContainer* createEmptyContainer() const override
+  {
+    auto vsc = new VectorSequenceContainer(getAlphabet());
+    vsc->setComments(getComments());
+    return vsc;
+  }
+
+  double getStateValueAt(size_t sitePosition, const std::string& sequenceKey, int state) const override
+  {
+    return sequence(sequenceKey).getStateValueAt(sitePosition, state);
+  }
+
+  double operator()(size_t sitePosition, const std::string& sequenceKey, int state) const override
+  {
+    return sequence(sequenceKey)(sitePosition, state);
+  }
+
+  double getStateValueAt(size_t sitePosition, size_t sequencePosition, int state) const override
+  {
+    return sequence(sequencePosition).getStateValueAt(sitePosition, state);
+  }
+
+  double operator()(size_t sitePosition, size_t sequencePosition, int state) const override
+  {
+    return sequence(sequencePosition)(sitePosition, state);
+  }
+
+  size_t getNumberOfSequences() const override
+  {
+    return names_.size();
+  }
+
+  std::vector<std::string> getSequenceKeys() const override
+  {
+    return names_;
+  }
+
+  void setSequenceKeys(const std::vector<std::string>& sequenceKeys) override
+  {
+    throwReadOnly_("setSequenceKeys");
+  }
+
+  const std::string& sequenceKey(size_t sequencePosition) const override;
+
+  size_t getSequencePosition(const std::string& sequenceKey) const override;
+
+  const int& valueAt(const std::string& sequenceKey, size_t elementPosition) const override
+  {
+    return sequence(sequenceKey)[elementPosition];
+  }
+
+  int& valueAt(const std::string& sequenceKey, size_t elementPosition) override
+  {
+    throwReadOnly_("valueAt");
+  }
+
+  const int& valueAt(size_t sequencePosition, size_t elementPosition) const override
+  {
+    return sequence(sequencePosition)[elementPosition];
+  }
+
+  int& valueAt(size_t sequencePosition, size_t elementPosition) override
+  {
+    throwReadOnly_("valueAt");
+  }
+
+  bool hasSequence(const std::string& sequenceKey) const override
+  {
+    return positions_.find(sequenceKey) != positions_.end();
+  }
+
+  const Sequence& sequence(const std::string& sequenceKey) const override
+  {
+    return sequence(getSequencePosition(sequenceKey));
+  }
+
+  const Sequence& sequence(size_t sequencePosition) const override
+  {
+    return *getSharedSequence(sequencePosition);
+  }
+
+  void setSequence(const std::string& sequenceKey, std::unique_ptr<Sequence>& sequencePtr) override
+  {
+    throwReadOnly_("setSequence");
+  }
+
+  void addSequence(const std::string& sequenceKey, std::unique_ptr<Sequence>& sequencePtr) override
+  {
+    throwReadOnly_("addSequence");
+  }
+
+  std::unique_ptr<Sequence> removeSequence(const std::string& sequenceKey) override
+  {
+    throwReadOnly_("removeSequence");
+  }
+
+  void deleteSequence(const std::string& sequenceKey) override
+  {
+    throwReadOnly_("deleteSequence");
+  }
+
+  void setSequence(size_t sequencePosition, std::unique_ptr<Sequence>& sequencePtr) override
+  {
+    throwReadOnly_("setSequence");
+  }
+
+  void setSequence(size_t sequencePosition, std::unique_ptr<Sequence>& sequencePtr, const std::string& sequenceKey) override
+  {
+    throwReadOnly_("setSequence");
+  }
+
+  void insertSequence(size_t sequencePosition, std::unique_ptr<Sequence>& sequencePtr, const std::string& sequenceKey) override
+  {
+    throwReadOnly_("insertSequence");
+  }
+
+  std::unique_ptr<Sequence> removeSequence(size_t sequencePosition) override
+  {
+    throwReadOnly_("removeSequence");
+  }
+
+  void deleteSequence(size_t sequencePosition) override
+  {
+    throwReadOnly_("deleteSequence");
+  }
+
+  void clear() override
+  {
+    throwReadOnly_("clear");
+  }
+
+  std::vector<std::string> getSequenceNames() const override
+  {
+    return names_;
+  }
+
+  void setSequenceNames(const std::vector<std::string>& names, bool updateKeys) override
+  {
+    throwReadOnly_("setSequenceNames");
+  }
+
+  /**
+   * @return Empty comments for all sequences, as comments are not read.
+   */
+  std::vector<Comments> getSequenceComments() const override
+  {
+    return std::vector<Comments>(names_.size());
+  }
+  /** @} */
+
+  /**
+   * @return The length of a sequence, as given by the index, without reading it.
+   * @param sequencePosition The position of the sequence in the container.
+   */
+  size_t getSequenceLength(size_t sequencePosition) const;
+
+  /**
+   * @return The index of the file.
+   */
+  const Fasta::FileIndex& getIndex() const
+  {
+    return index_;
+  }
+
+  /**
+   * @return The maximum number of decoded sequences kept in memory.
+   */
+  size_t cacheSize() const
+  {
+    return cacheSize_;
+  }
+
+  /**
+   * @brief Set the maximum number of decoded sequences kept in memory.
+   *
+   * The least recently used sequences are discarded if needed.
+   *
+   * @param cacheSize The size of the cache, at least 1.
+   */
+  void cacheSize(size_t cacheSize);
+
+  /**
+   * @brief Get a sequence, which remains valid when it is discarded from the cache.
+   *
+   * @param sequencePosition The position of the sequence.
+   * @return The sequence, shared with the cache.
+   * @throw IndexOutOfBoundsException If the position is not valid.
+   */
+  std::shared_ptr<const Sequence> getSharedSequence(size_t sequencePosition) const;
+
+  std::shared_ptr<const Sequence> getSharedSequence(const std::string& sequenceKey) const
+  {
+    return getSharedSequence(getSequencePosition(sequenceKey));
+  }
+
+  /**
+   * @return The number of sequences currently decoded.
+   */
+  size_t getNumberOfCachedSequences() const
+  {
+    return recentlyUsed_.size();
+  }
+
+private:
+  /**
+   * @brief Open the file and set up the names and the cache.
+   */
+  void init_();
+
+  /**
+   * @brief Read a sequence from the file.
+   */
+  std::unique_ptr<Sequence> readSequence_(size_t sequencePosition) const;
+
+  /**
+   * @brief Discard the least recently used sequences until at most maxSize are cached.
+   */
+  void shrinkCache_(size_t maxSize) const;
+
+  [[noreturn]] void throwReadOnly_(const std::string& method) const
+  {
+    throw Exception("IndexedFastaSequenceContainer::" + method + ": the container is read-only.");
+  }
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_IO_INDEXEDFASTASEQUENCECONTAINER_H
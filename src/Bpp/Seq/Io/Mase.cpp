@@ -4,6 +4,7 @@
 
 #include "../StringSequenceTools.h"
 #include "Mase.h"
+#include "SequenceWriterTools.h"
 
 using namespace bpp;
 using namespace std;
@@ -110,48 +111,36 @@ void Mase::writeSequences(ostream& output, const SequenceContainerInterface& sc)
     output << ";;" << comments[i] << endl;
   }
 
-  string seq, temp = ""; // Initialization
-
-  // Main loop : for all sequences
+  // Records are formatted in memory and written by large blocks:
+  string buffer;
   for (const auto& seqKey: sc.getSequenceKeys())
   {
-    comments = sc.sequence(seqKey).getComments();
+    const Sequence& seq = sc.sequence(seqKey);
 
     // Writing all sequence comments in file
     // If no comments are associated with current sequence, an empty commentary line will be writed
-    if (comments.size() == 0)
+    if (seq.getComments().size() == 0)
     {
-      output << ";" << endl;
+      buffer += ";\n";
     }
     else
     {
-      for (size_t j = 0; j < comments.size(); j++)
+      for (const auto& comment : seq.getComments())
       {
-        output << ";" << comments[j] << endl;
+        buffer += ";" + comment + "\n";
       }
     }
 
     // Sequence name writing
-    output << sc.sequence(seqKey).getName() << endl;
+    buffer += seq.getName() + "\n";
 
     // Sequence cutting to specified characters number per line
-    seq = sc.sequence(seqKey).toString();
-    while (seq != "")
-    {
-      if (seq.size() > charsByLine_)
-      {
-        temp = seq;
-        temp.erase(temp.begin() + static_cast<ptrdiff_t>(charsByLine_), temp.end());
-        output << temp  << endl;
-        seq.erase(seq.begin(), seq.begin() + static_cast<ptrdiff_t>(charsByLine_));
-      }
-      else
-      {
-        output << seq << endl;
-        seq = "";
-      }
-    }
+    string text;
+    SequenceWriterTools::appendContent(text, seq);
+    SequenceWriterTools::appendLines(buffer, text.data(), text.size(), charsByLine_);
+    SequenceWriterTools::flush(output, buffer);
   }
+  SequenceWriterTools::flush(output, buffer, true);
 }
 
 /****************************************************************************************/
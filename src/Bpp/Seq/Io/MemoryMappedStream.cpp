@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include "MemoryMappedStream.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BPP_SEQ_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+MemoryMappedStreamBuffer::MemoryMappedStreamBuffer(const std::string& path) :
+  data_(nullptr),
+  size_(0),
+  mapped_(false),
+  fallback_()
+{
+#ifdef BPP_SEQ_HAVE_MMAP
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw IOException("MemoryMappedStreamBuffer: can't open file " + path);
+  struct stat st;
+  if (::fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    throw IOException("MemoryMappedStreamBuffer: can't stat file " + path);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0)
+  {
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+      ::close(fd);
+      throw IOException("MemoryMappedStreamBuffer: can't map file " + path);
+    }
+# ifdef MADV_SEQUENTIAL
+    ::madvise(addr, size_, MADV_SEQUENTIAL);
+# endif
+    data_ = static_cast<char*>(addr);
+    mapped_ = true;
+  }
+  // The mapping remains valid after the descriptor is closed:
+  ::close(fd);
+#else
+  ifstream input(path.c_str(), ios::in | ios::binary);
+  if (!input)
+    throw IOException("MemoryMappedStreamBuffer: can't open file " + path);
+  input.seekg(0, ios::end);
+  size_ = static_cast<size_t>(input.tellg());
+  input.seekg(0, ios::beg);
+  fallback_.resize(size_);
+  if (size_ > 0)
+    input.read(&fallback_[0], static_cast<streamsize>(size_));
+  data_ = fallback_.data();
+#endif
+  setg(data_, data_, data_ + size_);
+}
+
+/******************************************************************************/
+
+MemoryMappedStreamBuffer::MemoryMappedStreamBuffer(std::vector<char>&& data) :
+  data_(nullptr),
+  size_(data.size()),
+  mapped_(false),
+  fallback_(std::move(data))
+{
+  data_ = fallback_.data();
+  setg(data_, data_, data_ + size_);
+}
+
+/******************************************************************************/
+
+MemoryMappedStreamBuffer::~MemoryMappedStreamBuffer()
+{
+#ifdef BPP_SEQ_HAVE_MMAP
+  if (mapped_)
+    ::munmap(data_, size_);
+#endif
+}
+
+/******************************************************************************/
+
+MemoryMappedStreamBuffer::pos_type MemoryMappedStreamBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+  if (!(which & ios_base::in))
+    return pos_type(off_type(-1));
+  off_type base = 0;
+  if (dir == ios_base::cur)
+    base = static_cast<off_type>(gptr() - data_);
+  else if (dir == ios_base::end)
+    base = static_cast<off_type>(size_);
+  off_type pos = base + off;
+  if (pos < 0 || pos > static_cast<off_type>(size_))
+    return pos_type(off_type(-1));
+  setg(data_, data_ + pos, data_ + size_);
+  return pos_type(pos);
+}
+
+/******************************************************************************/
+
+MemoryMappedStreamBuffer::pos_type MemoryMappedStreamBuffer::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+  return seekoff(off_type(pos), ios_base::beg, which);
+}
+
+/******************************************************************************/
@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_IO_MEMORYMAPPEDSTREAM_H
+#define BPP_SEQ_IO_MEMORYMAPPEDSTREAM_H
+
+#include <Bpp/Exceptions.h>
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <istream>
+#include <streambuf>
+
+namespace bpp
+{
+/**
+ * @brief A read-only stream buffer over a memory-mapped file.
+ *
+ * The whole file is mapped in memory, and the get area of the buffer points
+ * directly to the mapped region: no copy is performed when reading.
+ * Any reader can use it through a standard std::istream, but parsers aware of
+ * this class (see Fasta) can also scan the underlying memory directly.
+ *
+ * On systems without mmap support, the file is loaded in memory at once.
+ */
+class MemoryMappedStreamBuffer :
+  public std::streambuf
+{
+private:
+  char* data_;
+  size_t size_;
+  bool mapped_;
+  std::vector<char> fallback_;
+
+public:
+  /**
+   * @brief Map a file in memory.
+   *
+   * @param path The path to the file to map.
+   * @throw IOException If the file cannot be opened or mapped.
+   */
+  MemoryMappedStreamBuffer(const std::string& path);
+
+  /**
+   * @brief Read from data already in memory.
+   *
+   * This allows to use the fast paths of parsers on chunks of files read by
+   * other means (see PipelinedSequenceIterator).
+   *
+   * @param data The data to read, which are moved into the buffer.
+   */
+  MemoryMappedStreamBuffer(std::vector<char>&& data);
+
+  virtual ~MemoryMappedStreamBuffer();
+
+private:
+  // Recopy is forbidden
+  MemoryMappedStreamBuffer(const MemoryMappedStreamBuffer&) = delete;
+  MemoryMappedStreamBuffer& operator=(const MemoryMappedStreamBuffer&) = delete;
+
+public:
+  /**
+   * @return A pointer toward the beginning of the mapped region.
+   */
+  const char* begin() const
+  {
+    return data_;
+  }
+
+  /**
+   * @return A pointer toward the end of the mapped region.
+   */
+  const char* end() const
+  {
+    return data_ + size_;
+  }
+
+  /**
+   * @return The size of the mapped region, in bytes.
+   */
+  size_t size() const
+  {
+    return size_;
+  }
+
+  /**
+   * @return A pointer toward the current reading position.
+   */
+  const char* current() const
+  {
+    return gptr();
+  }
+
+  /**
+   * @brief Move the current reading position.
+   *
+   * @param pos The new reading position, which must lie within the mapped region.
+   */
+  void setCurrent(const char* pos)
+  {
+    setg(data_, data_ + (pos - data_), data_ + size_);
+  }
+
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) override;
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override;
+};
+
+/**
+ * @brief An input stream reading from a memory-mapped file.
+ *
+ * @see MemoryMappedStreamBuffer
+ */
+class MemoryMappedInputStream :
+  public std::istream
+{
+private:
+  MemoryMappedStreamBuffer buffer_;
+
+public:
+  MemoryMappedInputStream(const std::string& path) :
+    std::istream(nullptr),
+    buffer_(path)
+  {
+    rdbuf(&buffer_);
+  }
+
+  MemoryMappedInputStream(std::vector<char>&& data) :
+    std::istream(nullptr),
+    buffer_(std::move(data))
+  {
+    rdbuf(&buffer_);
+  }
+
+  virtual ~MemoryMappedInputStream()
+  {}
+
+public:
+  MemoryMappedStreamBuffer& buffer()
+  {
+    return buffer_;
+  }
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_IO_MEMORYMAPPEDSTREAM_H
@@ -8,10 +8,12 @@
 
 #include "../Container/SequenceContainerTools.h"
 #include "Phylip.h"
+#include "SequenceWriterTools.h"
 
 using namespace bpp;
 
 // From the STL:
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
@@ -218,16 +220,21 @@ void Phylip::writeSequential(std::ostream& out, const SiteContainerInterface& sc
 
   vector<string> seqNames = sc.getSequenceNames();
   vector<string> names = getSizedNames(seqNames);
+  string buffer;
+  string text;
   for (size_t i = 0; i < sc.getNumberOfSequences(); ++i)
   {
-    vector<string> seq = TextTools::split(sc.sequence(i).toString(), charsByLine_);
-    out << names[i] << seq[0] << endl;
-    for (size_t j = 1; j < seq.size(); ++j)
-    {
-      out << string(names[i].size(), ' ') << seq[j] << endl;
-    }
-    out << endl;
+    text.clear();
+    SequenceWriterTools::appendContent(text, sc.sequence(i));
+    buffer += names[i];
+    if (text.empty())
+      buffer += "\n";
+    else
+      SequenceWriterTools::appendLines(buffer, text.data(), text.size(), charsByLine_, string(names[i].size(), ' '));
+    buffer += "\n";
+    SequenceWriterTools::flush(out, buffer);
   }
+  SequenceWriterTools::flush(out, buffer, true);
 }
 
 void Phylip::writeInterleaved(std::ostream& out, const SiteContainerInterface& sc) const
@@ -238,27 +245,31 @@ void Phylip::writeInterleaved(std::ostream& out, const SiteContainerInterface& s
 
   vector<string> seqNames = sc.getSequenceNames();
   vector<string> names = getSizedNames(seqNames);
-  // Split sequences:
-  vector<vector<string>> seqs(sc.getNumberOfSequences());
-  for (size_t i = 0; i < sc.getNumberOfSequences(); ++i)
-  {
-    seqs[i] = TextTools::split(sc.sequence(i).toString(), charsByLine_);
-  }
-  // Write first block:
-  for (size_t i = 0; i < names.size(); ++i)
+  // Decode sequences:
+  size_t n = sc.getNumberOfSequences();
+  vector<string> texts(n);
+  for (size_t i = 0; i < n; ++i)
   {
-    out << names[i] << seqs[i][0] << endl;
+    SequenceWriterTools::appendContent(texts[i], sc.sequence(i));
   }
-  out << endl;
-  // Write other blocks:
-  for (size_t j = 1; j < seqs[0].size(); ++j)
+  // Write blocks, the first one with the names:
+  size_t nbBlocks = max<size_t>((texts[0].size() + charsByLine_ - 1) / charsByLine_, 1);
+  string buffer;
+  for (size_t j = 0; j < nbBlocks; ++j)
   {
-    for (size_t i = 0; i < sc.getNumberOfSequences(); ++i)
+    size_t pos = j * charsByLine_;
+    for (size_t i = 0; i < n; ++i)
     {
-      out << seqs[i][j] << endl;
+      if (j == 0)
+        buffer += names[i];
+      if (pos < texts[i].size())
+        buffer.append(texts[i], pos, charsByLine_);
+      buffer += "\n";
     }
-    out << endl;
+    buffer += "\n";
+    SequenceWriterTools::flush(out, buffer);
   }
+  SequenceWriterTools::flush(out, buffer, true);
 }
 
 /******************************************************************************/
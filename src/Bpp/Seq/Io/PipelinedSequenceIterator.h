@@ -0,0 +1,307 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_IO_PIPELINEDSEQUENCEITERATOR_H
+#define BPP_SEQ_IO_PIPELINEDSEQUENCEITERATOR_H
+
+
+#include "../SequenceIterator.h"
+#include "ISequenceStream.h"
+#include "MemoryMappedStream.h"
+
+// From the STL:
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief A sequence iterator decoding records in parallel.
+ *
+ * One thread reads the stream by chunks, and cuts them at record boundaries
+ * thanks to the ISequenceRecordSplitter interface of the format. A pool of
+ * threads then decodes whole chunks with the regular parser of the format,
+ * reading from memory (see MemoryMappedInputStream), while the calling thread
+ * consumes the sequences.
+ *
+ * Sequences are returned in the order of the input. At most queueDepth
+ * chunks are read ahead, which bounds the memory used.
+ *
+ * Fasta and Fastq support this mode.
+ */
+template<class SequenceType>
+class TemplatePipelinedSequenceIterator :
+  public virtual TemplateSequenceIteratorInterface<SequenceType>
+{
+private:
+  struct Chunk_
+  {
+    std::vector<char> text{};
+    std::vector<std::unique_ptr<SequenceType>> sequences{};
+    bool taken = false;         // True when a worker decodes the chunk.
+    bool ready = false;         // True when the sequences are available.
+    std::exception_ptr error{};
+  };
+
+  std::shared_ptr<const Alphabet> alphabet_;
+  std::shared_ptr<const TemplateISequenceStream<SequenceType>> seqStream_;
+  const ISequenceRecordSplitter* splitter_;
+  std::shared_ptr<std::istream> stream_;
+  size_t chunkSize_;
+  size_t queueDepth_;
+  std::thread reader_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable space_;
+  std::condition_variable work_;
+  std::condition_variable ready_;
+  std::deque<std::unique_ptr<Chunk_>> chunks_;
+  bool endOfInput_;
+  bool stop_;
+  std::unique_ptr<Chunk_> current_;
+  size_t position_;
+
+public:
+  /**
+   * @brief Start reading a stream.
+   *
+   * @param seqStream The format of the stream, which must implement ISequenceRecordSplitter.
+   * @param stream The stream to read.
+   * @param alphabet The alphabet of the sequences.
+   * @param nbThreads The number of decoding threads, 0 for the number of hardware threads.
+   * @param queueDepth The maximum number of chunks read ahead, 0 for four times the number of threads.
+   * @param chunkSize The size of the chunks to read, in bytes. Chunks are extended to hold at least one record.
+   * @throw Exception If the format does not support pipelined reading.
+   */
+  TemplatePipelinedSequenceIterator(
+      std::shared_ptr<const TemplateISequenceStream<SequenceType>> seqStream,
+      std::shared_ptr<std::istream> stream,
+      std::shared_ptr<const Alphabet> alphabet,
+      unsigned int nbThreads = 0,
+      size_t queueDepth = 0,
+      size_t chunkSize = 1 << 20) :
+    alphabet_(alphabet),
+    seqStream_(seqStream),
+    splitter_(dynamic_cast<const ISequenceRecordSplitter*>(seqStream.get())),
+    stream_(stream),
+    chunkSize_(std::max<size_t>(chunkSize, 1)),
+    queueDepth_(queueDepth),
+    reader_(),
+    workers_(),
+    mutex_(),
+    space_(),
+    work_(),
+    ready_(),
+    chunks_(),
+    endOfInput_(false),
+    stop_(false),
+    current_(),
+    position_(0)
+  {
+    if (!splitter_)
+      throw Exception("PipelinedSequenceIterator: format '" + seqStream->getFormatName() + "' does not support pipelined reading.");
+    if (nbThreads == 0)
+      nbThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (queueDepth_ == 0)
+      queueDepth_ = 4 * static_cast<size_t>(nbThreads);
+    reader_ = std::thread(&TemplatePipelinedSequenceIterator::read_, this);
+    for (unsigned int k = 0; k < nbThreads; ++k)
+    {
+      workers_.push_back(std::thread(&TemplatePipelinedSequenceIterator::decode_, this));
+    }
+    try
+    {
+      fetch_();
+    }
+    catch (...)
+    {
+      shutdown_();
+      throw;
+    }
+  }
+
+  virtual ~TemplatePipelinedSequenceIterator()
+  {
+    shutdown_();
+  }
+
+private:
+  // Recopy is forbidden
+  TemplatePipelinedSequenceIterator(const TemplatePipelinedSequenceIterator&) = delete;
+
+  TemplatePipelinedSequenceIterator& operator=(const TemplatePipelinedSequenceIterator&) = delete;
+
+  void shutdown_()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    space_.notify_all();
+    work_.notify_all();
+    reader_.join();
+    for (auto& th : workers_)
+    {
+      th.join();
+    }
+  }
+
+  /**
+   * @brief Read the stream and cut it in chunks of whole records.
+   */
+  void read_()
+  {
+    std::vector<char> pending;
+    ISequenceRecordSplitter::ScanState scan;
+    bool atEnd = false;
+    while (!atEnd)
+    {
+      auto chunk = std::make_unique<Chunk_>();
+      try
+      {
+        // Read until at least one record is complete:
+        const char* cut = nullptr;
+        while (!cut)
+        {
+          size_t previousSize = pending.size();
+          pending.resize(previousSize + chunkSize_);
+          stream_->read(pending.data() + previousSize, static_cast<std::streamsize>(chunkSize_));
+          pending.resize(previousSize + static_cast<size_t>(stream_->gcount()));
+          atEnd = !*stream_;
+          const char* begin = pending.data();
+          cut = splitter_->findLastRecordEnd(begin, begin + pending.size(), atEnd, scan);
+          if (cut == begin && !atEnd)
+            cut = nullptr;
+        }
+        size_t length = static_cast<size_t>(cut - pending.data());
+        chunk->text.assign(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(length));
+        pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(length));
+        // The rest of the buffer was already scanned:
+        scan.scanned = scan.scanned > length ? scan.scanned - length : 0;
+        scan.lastEnd = scan.lastEnd > length ? scan.lastEnd - length : 0;
+      }
+      catch (...)
+      {
+        chunk->error = std::current_exception();
+        chunk->taken = true;
+        chunk->ready = true;
+        atEnd = true;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      space_.wait(lock, [this]() { return stop_ || chunks_.size() < queueDepth_; });
+      if (stop_)
+        return;
+      chunks_.push_back(std::move(chunk));
+      work_.notify_one();
+      ready_.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    endOfInput_ = true;
+    ready_.notify_all();
+  }
+
+  /**
+   * @brief Decode chunks, in any order.
+   */
+  void decode_()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      Chunk_* chunk = nullptr;
+      work_.wait(lock, [this, &chunk]() {
+        if (stop_)
+          return true;
+        for (auto& c : chunks_)
+        {
+          if (!c->taken)
+          {
+            chunk = c.get();
+            return true;
+          }
+        }
+        return false;
+      });
+      if (stop_)
+        return;
+      chunk->taken = true;
+
+      lock.unlock();
+      try
+      {
+        MemoryMappedInputStream input(std::move(chunk->text));
+        bool more = true;
+        while (more && input)
+        {
+          auto seq = std::make_unique<SequenceType>(alphabet_);
+          more = seqStream_->nextSequence(input, *seq);
+          if (more || seq->getName() != "" || seq->size() > 0)
+            chunk->sequences.push_back(std::move(seq));
+        }
+      }
+      catch (...)
+      {
+        chunk->error = std::current_exception();
+      }
+      lock.lock();
+      chunk->ready = true;
+      ready_.notify_all();
+    }
+  }
+
+  /**
+   * @brief Make sure the current chunk has a sequence left, unless the input is over.
+   */
+  void fetch_()
+  {
+    while (!current_ || position_ >= current_->sequences.size())
+    {
+      current_.reset();
+      position_ = 0;
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this]() {
+        return (!chunks_.empty() && chunks_.front()->ready) || (chunks_.empty() && endOfInput_);
+      });
+      if (chunks_.empty())
+        return;
+      current_ = std::move(chunks_.front());
+      chunks_.pop_front();
+      space_.notify_one();
+      if (current_->error)
+      {
+        std::exception_ptr error = current_->error;
+        current_.reset();
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+public:
+  std::unique_ptr<SequenceType> nextSequence() override
+  {
+    if (!current_)
+      return nullptr;
+    std::unique_ptr<SequenceType> seq = std::move(current_->sequences[position_++]);
+    fetch_();
+    return seq;
+  }
+
+  bool hasMoreSequences() const override
+  {
+    return current_ != nullptr;
+  }
+};
+
+using PipelinedSequenceIterator = TemplatePipelinedSequenceIterator<Sequence>;
+using PipelinedSequenceWithQualityIterator = TemplatePipelinedSequenceIterator<SequenceWithQuality>;
+} // end of namespace bpp.
+#endif // BPP_SEQ_IO_PIPELINEDSEQUENCEITERATOR_H
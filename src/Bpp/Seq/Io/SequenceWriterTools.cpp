@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include "../Alphabet/AlphabetTools.h"
+#include "SequenceWriterTools.h"
+
+// From the STL:
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+const size_t SequenceWriterTools::BLOCK_SIZE = 1 << 20;
+
+/******************************************************************************/
+
+void SequenceWriterTools::appendContent(string& buffer, const SequenceInterface& seq)
+{
+  const Alphabet& alphabet = seq.alphabet();
+  if (AlphabetTools::checkAlphabetCodingSize(alphabet))
+  {
+    // All states have the same size, so the text is decoded in place:
+    size_t n = seq.size();
+    size_t start = buffer.size();
+    buffer.resize(start + n * alphabet.getStateCodingSize());
+    if (n > 0)
+      alphabet.decode(seq.getContent().data(), n, &buffer[start]);
+  }
+  else
+    buffer += seq.toString();
+}
+
+/******************************************************************************/
+
+void SequenceWriterTools::appendLines(string& buffer, const char* text, size_t length, size_t lineWidth, const string& indent)
+{
+  if (length == 0)
+    return;
+  if (lineWidth == 0)
+    lineWidth = length;
+  size_t nbLines = (length + lineWidth - 1) / lineWidth;
+  size_t start = buffer.size();
+  buffer.resize(start + length + nbLines + (nbLines - 1) * indent.size());
+  char* p = &buffer[start];
+  for (size_t i = 0; i < nbLines; ++i)
+  {
+    if (i > 0 && !indent.empty())
+    {
+      memcpy(p, indent.data(), indent.size());
+      p += indent.size();
+    }
+    size_t count = min(lineWidth, length);
+    memcpy(p, text, count);
+    p += count;
+    *p++ = '\n';
+    text += count;
+    length -= count;
+  }
+}
+
+/******************************************************************************/
+
+void SequenceWriterTools::flush(ostream& output, string& buffer, bool force)
+{
+  if (buffer.size() >= BLOCK_SIZE || (force && !buffer.empty()))
+  {
+    output.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    buffer.clear();
+  }
+}
+
+/******************************************************************************/
@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_IO_SEQUENCEWRITERTOOLS_H
+#define BPP_SEQ_IO_SEQUENCEWRITERTOOLS_H
+
+#include <Bpp/Exceptions.h>
+
+#include "../Sequence.h"
+
+// From the STL:
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief Utilitary methods for writing sequences in text formats.
+ *
+ * Writers format records in memory and send them to the stream by large
+ * blocks, instead of writing them symbol by symbol and flushing the stream
+ * at each line:
+ * - sequences are decoded at once in the buffer, using the lookup tables of
+ *   the alphabet,
+ * - line breaks are inserted while copying the decoded text,
+ * - records can be formatted in parallel, and are written in order.
+ */
+class SequenceWriterTools
+{
+public:
+  /**
+   * @brief The size above which buffers are written to the stream.
+   */
+  static const size_t BLOCK_SIZE;
+
+public:
+  /**
+   * @brief Append the text of a sequence to a buffer.
+   *
+   * @param buffer The buffer to update.
+   * @param seq The sequence to decode.
+   */
+  static void appendContent(std::string& buffer, const SequenceInterface& seq);
+
+  /**
+   * @brief Append a text to a buffer, cut in lines.
+   *
+   * Each line is followed by an end of line character. Nothing is appended
+   * for an empty text.
+   *
+   * @param buffer The buffer to update.
+   * @param text A pointer toward the text to append.
+   * @param length The length of the text.
+   * @param lineWidth The maximum number of characters per line, 0 for a single line.
+   * @param indent A string written before all lines but the first one.
+   */
+  static void appendLines(std::string& buffer, const char* text, size_t length, size_t lineWidth, const std::string& indent = "");
+
+  /**
+   * @brief Write a buffer to a stream if it is large enough, and empty it.
+   *
+   * @param output The stream to write.
+   * @param buffer The buffer to write.
+   * @param force Write the buffer whatever its size.
+   */
+  static void flush(std::ostream& output, std::string& buffer, bool force = false);
+
+  /**
+   * @brief Format records and write them in order.
+   *
+   * Records are formatted in groups, in parallel if several threads are
+   * used, then written in large blocks.
+   *
+   * @param output The stream to write.
+   * @param nbRecords The number of records.
+   * @param format A function object with signature `void (size_t i, std::string& buffer)`,
+   * appending the text of record i to a buffer. With several threads, it is called
+   * concurrently on different records, so it must not modify shared data (in
+   * particular, sequences built on demand by containers must be retrieved beforehand,
+   * see writePreparedRecords).
+   * @param nbThreads The number of threads to use, 0 for the number of hardware threads.
+   * @throw Exception The first exception thrown by the formatter, once all threads are stopped.
+   */
+  template<class Formatter>
+  static void writeRecords(std::ostream& output, size_t nbRecords, const Formatter& format, unsigned int nbThreads = 1)
+  {
+    writePreparedRecords(output, nbRecords, [](size_t, size_t) {}, format, nbThreads);
+  }
+
+  /**
+   * @brief Format records and write them in order, preparing each group first.
+   *
+   * Before records [first, last[ are formatted, the preparation step is called
+   * from the calling thread, with no formatter running. It is the place to retrieve
+   * data which may not be accessed concurrently, or which only remain valid until
+   * the next access (as sequences built on demand by some containers). With a single
+   * thread, records are prepared and formatted one at a time.
+   *
+   * @param output The stream to write.
+   * @param nbRecords The number of records.
+   * @param prepare A function object with signature `void (size_t first, size_t last)`.
+   * @param format A function object with signature `void (size_t i, std::string& buffer)`,
+   * appending the text of record i to a buffer, called for records of the last prepared group only.
+   * @param nbThreads The number of threads to use, 0 for the number of hardware threads.
+   * @throw Exception The first exception thrown by the preparation step or the formatter,
+   * once all threads are stopped.
+   */
+  template<class Preparer, class Formatter>
+  static void writePreparedRecords(std::ostream& output, size_t nbRecords, const Preparer& prepare, const Formatter& format, unsigned int nbThreads = 1)
+  {
+    if (nbThreads == 0)
+      nbThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::string buffer;
+    if (nbThreads == 1)
+    {
+      for (size_t i = 0; i < nbRecords; ++i)
+      {
+        prepare(i, i + 1);
+        format(i, buffer);
+        flush(output, buffer);
+      }
+      flush(output, buffer, true);
+      return;
+    }
+
+    // Records are formatted by groups, one buffer per record:
+    size_t groupSize = 16 * static_cast<size_t>(nbThreads);
+    std::vector<std::string> buffers(groupSize);
+    for (size_t first = 0; first < nbRecords; first += groupSize)
+    {
+      size_t last = std::min(first + groupSize, nbRecords);
+      prepare(first, last);
+      std::atomic<size_t> next(first);
+      std::exception_ptr error;
+      std::mutex errorMutex;
+      auto worker = [&]()
+      {
+        try
+        {
+          size_t i;
+          while ((i = next++) < last)
+          {
+            buffers[i - first].clear();
+            format(i, buffers[i - first]);
+          }
+        }
+        catch (...)
+        {
+          // Keep the first error, and stop the other workers:
+          std::lock_guard<std::mutex> lock(errorMutex);
+          if (!error)
+            error = std::current_exception();
+          next = last;
+        }
+      };
+      std::vector<std::thread> threads;
+      for (unsigned int k = 1; k < std::min(static_cast<size_t>(nbThreads), last - first); ++k)
+      {
+        threads.push_back(std::thread(std::ref(worker)));
+      }
+      worker();
+      for (auto& th : threads)
+      {
+        th.join();
+      }
+      if (error)
+        std::rethrow_exception(error);
+      for (size_t i = first; i < last; ++i)
+      {
+        buffer += buffers[i - first];
+        flush(output, buffer);
+      }
+    }
+    flush(output, buffer, true);
+  }
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_IO_SEQUENCEWRITERTOOLS_H
@@ -11,11 +11,16 @@
 
 // From the STL:
 #include <istream>
+#include <memory>
 
 namespace bpp
 {
 /**
  * @brief A sequence iterator based on a sequence stream.
+ *
+ * The stream can be any std::istream. In particular, using a
+ * MemoryMappedInputStream enables the zero-copy parsing mode of the
+ * formats supporting it (see Fasta).
  */
 template<class SequenceType>
 class TemplateStreamSequenceIterator :
@@ -23,75 +28,64 @@ class TemplateStreamSequenceIterator :
 {
 private:
   std::shared_ptr<const Alphabet> alphabet_;
-  std::shared_ptr<const ISequenceStream<SequenceType>> seqStream_;
-  str::shared_ptr<std::istream> stream_;
-  SequenceType* nextSeq_;
+  std::shared_ptr<const TemplateISequenceStream<SequenceType>> seqStream_;
+  std::shared_ptr<std::istream> stream_;
+  std::unique_ptr<SequenceType> nextSeq_;
+  bool hasMoreRecords_;
 
 public:
-  StreamSequenceIterator(
-      std::shared_ptr<ISequenceStream> seqStream,
+  TemplateStreamSequenceIterator(
+      std::shared_ptr<const TemplateISequenceStream<SequenceType>> seqStream,
       std::shared_ptr<std::istream> stream,
       std::shared_ptr<const Alphabet> alphabet) :
     alphabet_(alphabet),
     seqStream_(seqStream),
     stream_(stream),
-    nextSeq_(new SequenceType(alphabet_))
-
+    nextSeq_(),
+    hasMoreRecords_(true)
   {
-    bool test = seqStream_->nextSequence(*stream_, *nextSeq_);
-    if (!test)
-    {
-      delete nextSeq_;
-      nextSeq_ = 0; // No more sequence available
-    }
+    readNextSequence_();
   }
 
-  virtual ~StreamSequenceIterator()
+  virtual ~TemplateStreamSequenceIterator()
   {}
 
 private:
   // Recopy is forbidden
-  StreamSequenceIterator(const StreamSequenceIterator& ssi) :
-    alphabet_(ssi.alphabet_),
-    seqStream_(ssi.seqStream_),
-    stream_(ssi.stream_),
-    nextSeq_(0)
-  {}
+  TemplateStreamSequenceIterator(const TemplateStreamSequenceIterator& ssi) = delete;
+
+  TemplateStreamSequenceIterator& operator=(const TemplateStreamSequenceIterator& ssi) = delete;
 
-  StreamSequenceIterator& operator=(const StreamSequenceIterator& ssi)
+  void readNextSequence_()
   {
-    alphabet_  = ssi.alphabet_;
-    seqStream_ = ssi.seqStream_;
-    stream_    = ssi.stream_;
-    nextSeq_   = 0;
-    return *this;
+    nextSeq_.reset();
+    if (!hasMoreRecords_ || !(*stream_))
+      return;
+    auto seq = std::make_unique<SequenceType>(alphabet_);
+    // Readers return false when no record is left after the current one,
+    // which might have been read though:
+    hasMoreRecords_ = seqStream_->nextSequence(*stream_, *seq);
+    if (hasMoreRecords_ || seq->getName() != "" || seq->size() > 0)
+      nextSeq_ = std::move(seq);
   }
 
 public:
   std::unique_ptr<SequenceType> nextSequence() override
   {
-    unique_ptr<SequenceType> seq(nextSeq_);
-    if (nextSeq_)
-    {
-      nextSeq_ = new SequenceType(alphabet_);
-      bool test = seqStream_->nextSequence(*stream_, *nextSeq_);
-      if (!test)
-      {
-        delete nextSeq_;
-        nextSeq_ = 0; // No more sequence available
-      }
-    }
+    std::unique_ptr<SequenceType> seq = std::move(nextSeq_);
+    if (seq)
+      readNextSequence_();
     return seq;
   }
 
   bool hasMoreSequences() const override
   {
-    return nextSeq_ != 0;
+    return nextSeq_ != nullptr;
   }
 };
 
-using StreamSequenceIterator = TemplateStreamSequenceIterator<Sequence>
-    using StreamSequenceWithQualityIterator = TemplateStreamSequenceIterator<SequenceWithQuality>
-    using StreamProbabilisticSequenceIterator = TemplateStreamSequenceIterator<ProbabilisticSequence>
+using StreamSequenceIterator = TemplateStreamSequenceIterator<Sequence>;
+using StreamSequenceWithQualityIterator = TemplateStreamSequenceIterator<SequenceWithQuality>;
+using StreamProbabilisticSequenceIterator = TemplateStreamSequenceIterator<ProbabilisticSequence>;
 } // end of namespace bpp.
 #endif // BPP_SEQ_IO_STREAMSEQUENCEITERATOR_H
@@ -0,0 +1,478 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include "Alphabet/AlphabetTools.h"
+#include "MotifSearch.h"
+#include "SequenceTools.h"
+#include "SymbolListTools.h"
+
+// From the STL:
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+const size_t MotifSearch::MAX_EXPANSION = 1024;
+const size_t MotifSearch::MAX_SHIFT_OR_WORDS = 2;
+
+/******************************************************************************/
+
+MotifSearch::MotifSearch(const SequenceContainerInterface& motifs, bool strict, bool bothStrands) :
+  alphabet_(motifs.getAlphabet()),
+  strict_(strict),
+  bothStrands_(bothStrands),
+  matchUnresolved_(false),
+  names_(),
+  lengths_(),
+  offset_(SymbolListTools::getDenseCountsOffset(*motifs.getAlphabet())),
+  nbStates_(SymbolListTools::getDenseCountsSize(*motifs.getAlphabet())),
+  nbResolved_(motifs.getAlphabet()->getSize()),
+  nbColumns_(0),
+  transitions_(),
+  outputLinks_(),
+  outputStarts_(),
+  outputs_(),
+  resolvedStates_(),
+  nbWords_(0),
+  starts_(),
+  ends_(),
+  bitPatterns_(),
+  masks_()
+{
+  vector<vector<int>> patterns;
+  for (size_t i = 0; i < motifs.getNumberOfSequences(); ++i)
+  {
+    addMotif_(motifs.sequence(i), patterns);
+  }
+  build_(patterns);
+}
+
+MotifSearch::MotifSearch(const SequenceInterface& motif, bool strict, bool bothStrands) :
+  alphabet_(motif.getAlphabet()),
+  strict_(strict),
+  bothStrands_(bothStrands),
+  matchUnresolved_(false),
+  names_(),
+  lengths_(),
+  offset_(SymbolListTools::getDenseCountsOffset(motif.alphabet())),
+  nbStates_(SymbolListTools::getDenseCountsSize(motif.alphabet())),
+  nbResolved_(motif.alphabet().getSize()),
+  nbColumns_(0),
+  transitions_(),
+  outputLinks_(),
+  outputStarts_(),
+  outputs_(),
+  resolvedStates_(),
+  nbWords_(0),
+  starts_(),
+  ends_(),
+  bitPatterns_(),
+  masks_()
+{
+  vector<vector<int>> patterns;
+  addMotif_(motif, patterns);
+  build_(patterns);
+}
+
+/******************************************************************************/
+
+void MotifSearch::addMotif_(const SequenceInterface& motif, vector<vector<int>>& patterns)
+{
+  if (motif.size() == 0)
+    throw Exception("MotifSearch. Motif '" + motif.getName() + "' is empty.");
+  names_.push_back(motif.getName());
+  lengths_.push_back(motif.size());
+  patterns.push_back(motif.getContent());
+  if (bothStrands_)
+  {
+    if (!AlphabetTools::isNucleicAlphabet(*alphabet_))
+      throw AlphabetException("MotifSearch. Reverse complements can only be searched with nucleic alphabets.", alphabet_);
+    auto complement = SequenceTools::getComplement(motif);
+    const vector<int>& content = complement->getContent();
+    patterns.push_back(vector<int>(content.rbegin(), content.rend()));
+  }
+  else
+  {
+    patterns.push_back(vector<int>());
+  }
+}
+
+/******************************************************************************/
+
+bool MotifSearch::isCompatible_(int state1, int state2) const
+{
+  if (state1 == state2)
+    return true;
+  if (strict_)
+    return false;
+  vector<int> alias1 = alphabet_->getAlias(state1);
+  vector<int> alias2 = alphabet_->getAlias(state2);
+  for (int s : alias1)
+  {
+    if (find(alias2.begin(), alias2.end(), s) != alias2.end())
+      return true;
+  }
+  return false;
+}
+
+/******************************************************************************/
+
+size_t MotifSearch::getNumberOfExpansions_(const vector<int>& motif) const
+{
+  if (strict_)
+    return 1;
+  size_t nbExpansions = 1;
+  for (int state : motif)
+  {
+    size_t nbResolved = resolvedStates_[getIndex_(state)].size();
+    // Motifs with gaps cannot be expanded:
+    if (nbResolved == 0 || nbResolved != alphabet_->getAlias(state).size())
+      return MAX_EXPANSION + 1;
+    nbExpansions *= nbResolved;
+    if (nbExpansions > MAX_EXPANSION)
+      return MAX_EXPANSION + 1;
+  }
+  return nbExpansions;
+}
+
+/******************************************************************************/
+
+void MotifSearch::build_(const vector<vector<int>>& patterns)
+{
+  resolvedStates_.resize(nbStates_);
+  for (int state : alphabet_->getSupportedInts())
+  {
+    for (int s : alphabet_->getAlias(state))
+    {
+      if (s >= 0 && s < static_cast<int>(nbResolved_))
+        resolvedStates_[getIndex_(state)].push_back(s);
+    }
+  }
+
+  // Small sets of motifs are all searched with Shift-Or, which does not need expansions:
+  size_t nbBits = 0;
+  for (const auto& pattern : patterns)
+  {
+    nbBits += pattern.size();
+  }
+  vector<size_t> automatonPatterns;
+  vector<size_t> shiftOrPatterns;
+  bool small = (nbBits + 63) / 64 <= MAX_SHIFT_OR_WORDS;
+  for (size_t target = 0; target < patterns.size(); ++target)
+  {
+    if (patterns[target].empty())
+      continue;
+    if (small || getNumberOfExpansions_(patterns[target]) > MAX_EXPANSION)
+      shiftOrPatterns.push_back(target);
+    else
+      automatonPatterns.push_back(target);
+  }
+  buildAutomaton_(patterns, automatonPatterns);
+  buildShiftOr_(patterns, shiftOrPatterns);
+}
+
+/******************************************************************************/
+
+void MotifSearch::buildAutomaton_(const vector<vector<int>>& patterns, const vector<size_t>& selection)
+{
+  if (selection.empty())
+    return;
+  nbColumns_ = strict_ ? nbStates_ : nbResolved_;
+
+  // The trie of all the (expanded) motifs. The root is state 0, and 0 also stands for missing children:
+  transitions_.assign(nbColumns_, 0);
+  vector<vector<Pattern_>> stateOutputs(1);
+  vector<pair<uint32_t, size_t>> stack;
+  for (size_t target : selection)
+  {
+    const vector<int>& pattern = patterns[target];
+    stack.push_back(make_pair(0, 0));
+    while (!stack.empty())
+    {
+      uint32_t state = stack.back().first;
+      size_t depth = stack.back().second;
+      stack.pop_back();
+      if (depth == pattern.size())
+      {
+        stateOutputs[state].push_back(Pattern_{target, pattern.size()});
+        continue;
+      }
+      size_t index = getIndex_(pattern[depth]);
+      vector<int> columns = strict_ ? vector<int>(1, static_cast<int>(index)) : resolvedStates_[index];
+      for (int c : columns)
+      {
+        size_t t = state * nbColumns_ + static_cast<size_t>(c);
+        uint32_t child = transitions_[t];
+        if (child == 0)
+        {
+          child = static_cast<uint32_t>(stateOutputs.size());
+          transitions_[t] = child;
+          transitions_.resize(transitions_.size() + nbColumns_, 0);
+          stateOutputs.emplace_back();
+        }
+        stack.push_back(make_pair(child, depth + 1));
+      }
+    }
+  }
+
+  // Failure links, computed breadth-first, complete the transitions:
+  size_t nbStates = stateOutputs.size();
+  vector<uint32_t> failures(nbStates, 0);
+  vector<uint32_t> queue;
+  queue.reserve(nbStates);
+  for (size_t c = 0; c < nbColumns_; ++c)
+  {
+    if (transitions_[c] != 0)
+      queue.push_back(transitions_[c]);
+  }
+  for (size_t q = 0; q < queue.size(); ++q)
+  {
+    uint32_t state = queue[q];
+    const uint32_t* failureRow = &transitions_[failures[state] * nbColumns_];
+    uint32_t* row = &transitions_[state * nbColumns_];
+    for (size_t c = 0; c < nbColumns_; ++c)
+    {
+      if (row[c] != 0)
+      {
+        failures[row[c]] = failureRow[c];
+        queue.push_back(row[c]);
+      }
+      else
+        row[c] = failureRow[c];
+    }
+  }
+
+  outputLinks_.assign(nbStates, 0);
+  for (uint32_t state : queue)
+  {
+    uint32_t failure = failures[state];
+    outputLinks_[state] = stateOutputs[failure].empty() ? outputLinks_[failure] : failure;
+  }
+  outputStarts_.resize(nbStates + 1);
+  for (size_t state = 0; state < nbStates; ++state)
+  {
+    outputStarts_[state] = static_cast<uint32_t>(outputs_.size());
+    outputs_.insert(outputs_.end(), stateOutputs[state].begin(), stateOutputs[state].end());
+  }
+  outputStarts_[nbStates] = static_cast<uint32_t>(outputs_.size());
+}
+
+/******************************************************************************/
+
+void MotifSearch::buildShiftOr_(const vector<vector<int>>& patterns, const vector<size_t>& selection)
+{
+  if (selection.empty())
+    return;
+  size_t nbBits = 0;
+  for (size_t target : selection)
+  {
+    nbBits += patterns[target].size();
+  }
+  nbWords_ = (nbBits + 63) / 64;
+  starts_.assign(nbWords_, 0);
+  ends_.assign(nbWords_, 0);
+  bitPatterns_.resize(nbBits);
+  masks_.assign(nbStates_ * nbWords_, ~static_cast<uint64_t>(0));
+
+  // Compatible states are computed once, from the aliases:
+  const vector<int>& states = alphabet_->getSupportedInts();
+  vector<bool> compatible(nbStates_ * nbStates_, false);
+  for (int state1 : states)
+  {
+    for (int state2 : states)
+    {
+      compatible[getIndex_(state1) * nbStates_ + getIndex_(state2)] = isCompatible_(state1, state2);
+    }
+  }
+
+  size_t bit = 0;
+  for (size_t target : selection)
+  {
+    const vector<int>& pattern = patterns[target];
+    starts_[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
+    for (int motifState : pattern)
+    {
+      uint64_t b = static_cast<uint64_t>(1) << (bit % 64);
+      for (int state : states)
+      {
+        size_t index = getIndex_(state);
+        if (compatible[index * nbStates_ + getIndex_(motifState)])
+          masks_[index * nbWords_ + bit / 64] &= ~b;
+      }
+      ++bit;
+    }
+    ends_[(bit - 1) / 64] |= static_cast<uint64_t>(1) << ((bit - 1) % 64);
+    bitPatterns_[bit - 1] = Pattern_{target, pattern.size()};
+  }
+}
+
+/******************************************************************************/
+
+void MotifSearch::findAll(const SequenceInterface& sequence, vector<Match>& matches) const
+{
+  MatchIterator it(*this, sequence);
+  while (it.hasMoreMatches())
+  {
+    matches.push_back(it.nextMatch());
+  }
+}
+
+/******************************************************************************/
+
+MotifSearch::MatchIterator::MatchIterator(const MotifSearch& search, const SequenceInterface& sequence) :
+  search_(search),
+  content_(sequence.getContent()),
+  matchUnresolved_(search.matchUnresolved()),
+  position_(0),
+  matches_(),
+  nextMatch_(0),
+  states_(1, 0),
+  buffer_(),
+  bits_(search.nbWords_, ~static_cast<uint64_t>(0)),
+  reported_(2 * search.getNumberOfMotifs(), 0)
+{
+  if (!sequence.alphabet().isCompatibleWith(search.alphabet()))
+    throw AlphabetMismatchException("MotifSearch::MatchIterator. The sequence and the motifs do not have the same alphabet.", search.getAlphabet(), sequence.getAlphabet());
+  scan_();
+}
+
+/******************************************************************************/
+
+MotifSearch::Match MotifSearch::MatchIterator::nextMatch()
+{
+  if (!hasMoreMatches())
+    throw Exception("MotifSearch::MatchIterator::nextMatch. No more matches.");
+  Match match = matches_[nextMatch_++];
+  if (nextMatch_ == matches_.size())
+    scan_();
+  return match;
+}
+
+/******************************************************************************/
+
+void MotifSearch::MatchIterator::scan_()
+{
+  matches_.clear();
+  nextMatch_ = 0;
+  while (matches_.empty() && position_ < content_.size())
+  {
+    int state = content_[position_];
+    stepAutomaton_(state);
+    stepShiftOr_(state);
+    ++position_;
+  }
+  sort(matches_.begin(), matches_.end(), [](const Match& match1, const Match& match2) {
+    return match1.begin < match2.begin || (match1.begin == match2.begin && (match1.motif < match2.motif || (match1.motif == match2.motif && match1.reverse < match2.reverse)));
+  });
+}
+
+/******************************************************************************/
+
+void MotifSearch::MatchIterator::report_(size_t target, size_t length)
+{
+  // Several resolutions of ambiguous states may lead to the same match:
+  size_t end = position_ + 1;
+  if (reported_[target] == end)
+    return;
+  reported_[target] = end;
+  Match match;
+  match.motif = target / 2;
+  match.begin = end - length;
+  match.end = end;
+  match.reverse = target % 2 == 1;
+  matches_.push_back(match);
+}
+
+/******************************************************************************/
+
+void MotifSearch::MatchIterator::stepAutomaton_(int state)
+{
+  const MotifSearch& s = search_;
+  if (s.transitions_.empty())
+    return;
+  size_t index = s.getIndex_(state);
+  bool resolved = state >= 0 && state < static_cast<int>(s.nbResolved_);
+  if (s.strict_ || resolved)
+  {
+    // One transition per current state:
+    size_t column = s.strict_ ? index : static_cast<size_t>(state);
+    for (auto& current : states_)
+    {
+      current = s.transitions_[current * s.nbColumns_ + column];
+    }
+  }
+  else
+  {
+    buffer_.clear();
+    if (matchUnresolved_)
+    {
+      // Follow all the resolved states:
+      for (uint32_t current : states_)
+      {
+        for (int c : s.resolvedStates_[index])
+        {
+          buffer_.push_back(s.transitions_[current * s.nbColumns_ + static_cast<size_t>(c)]);
+        }
+      }
+    }
+    if (buffer_.empty())
+      buffer_.push_back(0);
+    states_.swap(buffer_);
+  }
+  if (states_.size() > 1)
+  {
+    // The states of the different resolutions merge again once past the unresolved states:
+    sort(states_.begin(), states_.end());
+    states_.erase(unique(states_.begin(), states_.end()), states_.end());
+  }
+
+  for (uint32_t current : states_)
+  {
+    for (uint32_t o = current; ; o = s.outputLinks_[o])
+    {
+      for (uint32_t k = s.outputStarts_[o]; k < s.outputStarts_[o + 1]; ++k)
+      {
+        report_(s.outputs_[k].target, s.outputs_[k].length);
+      }
+      if (s.outputLinks_[o] == 0)
+        break;
+    }
+  }
+}
+
+/******************************************************************************/
+
+void MotifSearch::MatchIterator::stepShiftOr_(int state)
+{
+  const MotifSearch& s = search_;
+  if (s.nbWords_ == 0)
+    return;
+  bool resolved = state >= 0 && state < static_cast<int>(s.nbResolved_);
+  if (!s.strict_ && !matchUnresolved_ && !resolved)
+  {
+    bits_.assign(s.nbWords_, ~static_cast<uint64_t>(0));
+    return;
+  }
+  const uint64_t* masks = &s.masks_[s.getIndex_(state) * s.nbWords_];
+  uint64_t carry = 0;
+  for (size_t w = 0; w < s.nbWords_; ++w)
+  {
+    uint64_t bits = bits_[w];
+    bits_[w] = (((bits << 1) | carry) & ~s.starts_[w]) | masks[w];
+    carry = bits >> 63;
+  }
+  for (size_t w = 0; w < s.nbWords_; ++w)
+  {
+    uint64_t found = ~bits_[w] & s.ends_[w];
+    for (size_t b = 64 * w; found != 0; ++b, found >>= 1)
+    {
+      if (found & 1)
+        report_(s.bitPatterns_[b].target, s.bitPatterns_[b].length);
+    }
+  }
+}
+
+/******************************************************************************/
@@ -0,0 +1,303 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_MOTIFSEARCH_H
+#define BPP_SEQ_MOTIFSEARCH_H
+
+#include "Alphabet/Alphabet.h"
+#include "Container/SequenceContainer.h"
+#include "Sequence.h"
+
+// From the STL:
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief Search a set of motifs in sequences, on one or both strands.
+ *
+ * All the motifs are searched at once, in a single pass over the sequences.
+ * In strict mode, motif states only match identical states. Otherwise, two
+ * states match if they share at least one resolved state, as in
+ * AlphabetTools::match: an IUPAC motif like CTNAG matches CTAAG, but also
+ * CTNAG, and CTAAG itself matches CWAAG.
+ *
+ * Two engines are used, both reading the integer states of the sequences
+ * directly:
+ * - An Aho-Corasick automaton over the resolved states, for large sets of
+ *   motifs. In non-strict mode, ambiguous motifs are expanded into all the
+ *   resolved motifs they stand for, and ambiguous states of the sequences are
+ *   followed along all their resolved states.
+ * - A bit-parallel Shift-Or matcher, with one bit per motif position and one
+ *   mask per state computed from Alphabet::getAlias. It is used for small sets
+ *   of motifs, and for the motifs too degenerate to be expanded in the automaton.
+ *
+ * With nucleic alphabets, the reverse complements of the motifs can be searched
+ * too, so that both strands are scanned in the same pass. Coordinates are
+ * always given on the forward strand.
+ *
+ * By default, unresolved states of the searched sequences match no motif
+ * state, as they may form long runs (N runs in assemblies) that would match
+ * all motifs in non-strict mode, and make the set of states of the automaton
+ * explode. Matching them as in AlphabetTools::match can be enabled with
+ * matchUnresolved().
+ */
+class MotifSearch
+{
+public:
+  /**
+   * @brief An occurrence of a motif, with coordinates on the forward strand.
+   */
+  struct Match
+  {
+    size_t motif = 0;     // The index of the motif, in the order of the input.
+    size_t begin = 0;     // The position of the first matching state, 0-based.
+    size_t end = 0;       // The position after the last matching state.
+    bool reverse = false; // Tell if the reverse complement of the motif was found.
+  };
+
+  /**
+   * @brief Enumerate the occurrences of the motifs in a sequence.
+   *
+   * The sequence is scanned lazily, as matches are requested. Matches are
+   * enumerated by increasing end position, then start position, motif index
+   * and strand. A palindromic motif found on both strands is reported twice.
+   *
+   * The sequence and the search object must outlive the iterator.
+   */
+  class MatchIterator
+  {
+private:
+    const MotifSearch& search_;
+    const std::vector<int>& content_;
+    bool matchUnresolved_;
+    size_t position_;
+    std::vector<Match> matches_;   // The matches ending at the last scanned position.
+    size_t nextMatch_;
+    std::vector<uint32_t> states_; // The current states of the automaton.
+    std::vector<uint32_t> buffer_; // The next states of the automaton, on unresolved states.
+    std::vector<uint64_t> bits_;   // The Shift-Or state vector, 0 for the matched prefixes.
+    std::vector<size_t> reported_; // The last end position reported for each motif and strand.
+
+public:
+    /**
+     * @param search The motifs to search.
+     * @param sequence The sequence to scan.
+     * @throw AlphabetMismatchException If the sequence and the motifs do not share the same alphabet.
+     */
+    MatchIterator(const MotifSearch& search, const SequenceInterface& sequence);
+
+    virtual ~MatchIterator()
+    {}
+
+private:
+    MatchIterator(const MatchIterator&) = delete;
+    MatchIterator& operator=(const MatchIterator&) = delete;
+
+public:
+    bool hasMoreMatches() const
+    {
+      return nextMatch_ < matches_.size();
+    }
+
+    /**
+     * @return The next match.
+     * @throw Exception If there are no more matches.
+     */
+    Match nextMatch();
+
+private:
+    /**
+     * @brief Scan the sequence until new matches are found, or the end of the sequence is reached.
+     */
+    void scan_();
+
+    void stepAutomaton_(int state);
+
+    void stepShiftOr_(int state);
+
+    void report_(size_t target, size_t length);
+  };
+
+private:
+  /**
+   * @brief A motif of the automaton, resolved in non-strict mode.
+   */
+  struct Pattern_
+  {
+    size_t target; // 2 * motif index + 1 if reverse.
+    size_t length;
+  };
+
+  std::shared_ptr<const Alphabet> alphabet_;
+  bool strict_;
+  bool bothStrands_;
+  bool matchUnresolved_;
+  std::vector<std::string> names_;
+  std::vector<size_t> lengths_;
+  int offset_;               // The smallest state of the alphabet.
+  size_t nbStates_;          // The number of integers between the smallest and the largest states.
+  unsigned int nbResolved_;  // Resolved states are 0 to nbResolved_ - 1.
+
+  // The automaton, with one column per state (strict mode) or per resolved state:
+  size_t nbColumns_;
+  std::vector<uint32_t> transitions_;
+  std::vector<uint32_t> outputLinks_;  // The closest suffix state with outputs, or 0.
+  std::vector<uint32_t> outputStarts_; // The outputs of state i are in [outputStarts_[i], outputStarts_[i + 1][.
+  std::vector<Pattern_> outputs_;
+  std::vector<std::vector<int>> resolvedStates_; // The resolved states of each state, for non-strict mode.
+
+  // The Shift-Or matcher:
+  size_t nbWords_;
+  std::vector<uint64_t> starts_;       // The first bit of each motif.
+  std::vector<uint64_t> ends_;         // The last bit of each motif.
+  std::vector<Pattern_> bitPatterns_;  // The motif ending at each bit.
+  std::vector<uint64_t> masks_;        // nbWords_ words per state, 0 where the state matches the motif.
+
+public:
+  /**
+   * @brief The maximum number of resolved motifs an ambiguous motif can be expanded into.
+   *
+   * More degenerate motifs are searched with the Shift-Or matcher.
+   */
+  static const size_t MAX_EXPANSION;
+
+  /**
+   * @brief Motifs are all searched with the Shift-Or matcher when they fit in this number of 64 bits words.
+   */
+  static const size_t MAX_SHIFT_OR_WORDS;
+
+public:
+  /**
+   * @brief Build a search for all the sequences of a container.
+   *
+   * @param motifs The motifs to search, which are copied.
+   * @param strict Tell if states must be identical to match.
+   * @param bothStrands Tell if the reverse complements of the motifs are searched too.
+   * @throw Exception If a motif is empty.
+   * @throw AlphabetException If both strands are searched with a non-nucleic alphabet.
+   */
+  MotifSearch(const SequenceContainerInterface& motifs, bool strict = false, bool bothStrands = false);
+
+  /**
+   * @brief Build a search for a single motif.
+   *
+   * @param motif The motif to search.
+   * @param strict Tell if states must be identical to match.
+   * @param bothStrands Tell if the reverse complement of the motif is searched too.
+   * @throw Exception If the motif is empty.
+   * @throw AlphabetException If both strands are searched with a non-nucleic alphabet.
+   */
+  MotifSearch(const SequenceInterface& motif, bool strict = false, bool bothStrands = false);
+
+  virtual ~MotifSearch()
+  {}
+
+public:
+  const Alphabet& alphabet() const
+  {
+    return *alphabet_;
+  }
+
+  std::shared_ptr<const Alphabet> getAlphabet() const
+  {
+    return alphabet_;
+  }
+
+  bool isStrict() const
+  {
+    return strict_;
+  }
+
+  bool searchesBothStrands() const
+  {
+    return bothStrands_;
+  }
+
+  size_t getNumberOfMotifs() const
+  {
+    return names_.size();
+  }
+
+  /**
+   * @return The name of a motif.
+   * @param motif The index of the motif.
+   */
+  const std::string& getMotifName(size_t motif) const
+  {
+    return names_[motif];
+  }
+
+  /**
+   * @return The length of a motif.
+   * @param motif The index of the motif.
+   */
+  size_t getMotifLength(size_t motif) const
+  {
+    return lengths_[motif];
+  }
+
+  /**
+   * @return True if unresolved states of the sequences, like gaps or N, match compatible motif states in non-strict mode.
+   */
+  bool matchUnresolved() const
+  {
+    return matchUnresolved_;
+  }
+
+  /**
+   * @brief Tell if unresolved states of the sequences match compatible motif states in non-strict mode.
+   *
+   * If so, they match as in AlphabetTools::match, which may be slow on long
+   * runs of N. Otherwise, which is the default, they match no motif state.
+   * It has no effect in strict mode, or on iterators already created.
+   *
+   * @param yn Whether unresolved states of the sequences match compatible states.
+   */
+  void matchUnresolved(bool yn)
+  {
+    matchUnresolved_ = yn;
+  }
+
+  /**
+   * @brief Find all the occurrences of the motifs in a sequence.
+   *
+   * @param sequence The sequence to scan.
+   * @param matches [out] The vector where matches are appended, in the order of MatchIterator.
+   * @throw AlphabetMismatchException If the sequence and the motifs do not share the same alphabet.
+   */
+  void findAll(const SequenceInterface& sequence, std::vector<Match>& matches) const;
+
+private:
+  /**
+   * @brief Record a motif and its reverse complement, if needed.
+   */
+  void addMotif_(const SequenceInterface& motif, std::vector<std::vector<int>>& patterns);
+
+  /**
+   * @brief Build the engines, from the motifs (even indices) and their reverse complements (odd indices, may be empty).
+   */
+  void build_(const std::vector<std::vector<int>>& patterns);
+
+  void buildAutomaton_(const std::vector<std::vector<int>>& motifs, const std::vector<size_t>& selection);
+
+  void buildShiftOr_(const std::vector<std::vector<int>>& motifs, const std::vector<size_t>& selection);
+
+  /**
+   * @return The number of resolved motifs an ambiguous motif stands for, or MAX_EXPANSION + 1 if there are more.
+   */
+  size_t getNumberOfExpansions_(const std::vector<int>& motif) const;
+
+  bool isCompatible_(int state1, int state2) const;
+
+  size_t getIndex_(int state) const
+  {
+    return static_cast<size_t>(state - offset_);
+  }
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_MOTIFSEARCH_H
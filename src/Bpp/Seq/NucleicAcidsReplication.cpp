@@ -48,7 +48,7 @@ std::string NucleicAcidsReplication::translate(const std::string& state) const
 
 unique_ptr<Sequence> NucleicAcidsReplication::translate(const SequenceInterface& sequence) const
 {
-  if (sequence.getAlphabet()->getAlphabetType() != getSourceAlphabet()->getAlphabetType())
+  if (!sequence.getAlphabet()->isCompatibleWith(*getSourceAlphabet()))
     throw AlphabetMismatchException("NucleicAcidsReplication::translate", getSourceAlphabet(), getTargetAlphabet());
   auto alphaPtr = getTargetAlphabet();
   auto tSeq = make_unique<Sequence>(sequence.getName(), "", sequence.getComments(), alphaPtr);
@@ -74,7 +74,7 @@ std::string NucleicAcidsReplication::reverse(const std::string& state) const
 
 unique_ptr<Sequence> NucleicAcidsReplication::reverse(const SequenceInterface& sequence) const
 {
-  if (sequence.getAlphabet()->getAlphabetType() != getTargetAlphabet()->getAlphabetType())
+  if (!sequence.getAlphabet()->isCompatibleWith(*getTargetAlphabet()))
     throw AlphabetMismatchException("NucleicAcidsReplication::reverse", getSourceAlphabet(), getTargetAlphabet());
   auto alphaPtr = getSourceAlphabet();
   auto rSeq = make_unique<Sequence>(sequence.getName(), "", sequence.getComments(), alphaPtr);
@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include "Alphabet/AlphabetTools.h"
+#include "OrfFinder.h"
+
+// From the STL:
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+const size_t OrfFinder::NONE = static_cast<size_t>(-1);
+const size_t OrfFinder::MIN_CHUNK_SIZE = 100000;
+
+/******************************************************************************/
+
+OrfFinder::OrfFinder(shared_ptr<const GeneticCode> gCode) :
+  gCode_(gCode),
+  minLength_(75),
+  alternativeStarts_(false),
+  requireStart_(true),
+  partialOrfs_(false),
+  translate_(false),
+  nbThreads_(1)
+{}
+
+/******************************************************************************/
+
+void OrfFinder::scanChunk_(const int* nucleotides, size_t length, bool reverse, unsigned int frame, size_t from, size_t to, ChunkSummary_& summary) const
+{
+  summary.firstStop = NONE;
+  summary.firstStart = NONE;
+  summary.orfs.clear();
+  size_t start = NONE;
+  for (size_t k = from; k < to; ++k)
+  {
+    unsigned char type = getCodonType_(nucleotides, length, reverse, frame, k);
+    if (type & GeneticCode::STOP)
+    {
+      if (summary.firstStop == NONE)
+      {
+        summary.firstStop = k;
+        summary.firstStart = start;
+      }
+      else if (start != NONE)
+        summary.orfs.push_back(make_pair(start, k));
+      start = NONE;
+    }
+    else if (start == NONE && (isStart_(type) || !requireStart_))
+      start = k;
+  }
+  if (summary.firstStop == NONE)
+    summary.firstStart = start;
+  summary.lastStart = start;
+}
+
+/******************************************************************************/
+
+void OrfFinder::addOrf_(
+    const SequenceInterface& sequence,
+    bool reverse,
+    unsigned int frame,
+    size_t startCodon,
+    size_t endCodon,
+    bool hasStop,
+    vector<Orf>& orfs) const
+{
+  size_t nbCodons = hasStop ? endCodon + 1 - startCodon : endCodon - startCodon;
+  if (3 * nbCodons < minLength_ || nbCodons == 0)
+    return;
+  const vector<int>& content = sequence.getContent();
+  size_t length = content.size();
+  Orf orf;
+  orf.sequenceName = sequence.getName();
+  orf.reverse = reverse;
+  orf.frame = frame;
+  orf.hasStop = hasStop;
+  orf.hasStart = isStart_(getCodonType_(content.data(), length, reverse, frame, startCodon));
+  size_t first = frame + 3 * startCodon;
+  size_t last = first + 3 * nbCodons;
+  orf.begin = reverse ? length - last : first;
+  orf.end = reverse ? length - first : last;
+  if (translate_)
+  {
+    // The stop codon is at the end of the ORF on its strand:
+    size_t nbAminoAcids = hasStop ? nbCodons - 1 : nbCodons;
+    orf.protein.resize(nbAminoAcids);
+    size_t begin = reverse && hasStop ? orf.begin + 3 : orf.begin;
+    gCode_->translateNucleotides(content.data() + begin, 3 * nbAminoAcids, orf.protein.data(), reverse);
+    if (orf.hasStart && nbAminoAcids > 0)
+      orf.protein[0] = gCode_->proteicAlphabet().charToInt("M");
+  }
+  orfs.push_back(std::move(orf));
+}
+
+/******************************************************************************/
+
+void OrfFinder::findOrfs(const SequenceInterface& sequence, vector<Orf>& orfs) const
+{
+  if (!AlphabetTools::isNucleicAlphabet(sequence.alphabet()))
+    throw AlphabetException("OrfFinder::findOrfs. Sequence must be a nucleotide sequence.", sequence.getAlphabet());
+  const vector<int>& content = sequence.getContent();
+  const int* nucleotides = content.data();
+  size_t length = content.size();
+
+  // Each strand and frame is split in the same number of chunks:
+  unsigned int nbThreads = nbThreads_ == 0 ? max(thread::hardware_concurrency(), 1u) : nbThreads_;
+  size_t nbChunks = min(static_cast<size_t>(nbThreads), max<size_t>(length / MIN_CHUNK_SIZE, 1));
+  vector<ChunkSummary_> summaries(6 * nbChunks);
+  auto getNumberOfCodons = [length](unsigned int frame) {
+    return length > frame ? (length - frame) / 3 : 0;
+  };
+  atomic<size_t> nextChunk(0);
+  auto worker = [&]() {
+    for (size_t c = nextChunk++; c < nbChunks; c = nextChunk++)
+    {
+      for (size_t f = 0; f < 6; ++f)
+      {
+        unsigned int frame = static_cast<unsigned int>(f % 3);
+        size_t nbCodons = getNumberOfCodons(frame);
+        scanChunk_(nucleotides, length, f >= 3, frame, nbCodons * c / nbChunks, nbCodons * (c + 1) / nbChunks, summaries[f * nbChunks + c]);
+      }
+    }
+  };
+  vector<thread> threads;
+  for (size_t k = 1; k < nbChunks; ++k)
+  {
+    threads.push_back(thread(worker));
+  }
+  worker();
+  for (auto& th : threads)
+  {
+    th.join();
+  }
+
+  // ORFs spanning several chunks are completed with the start carried over from the previous chunks:
+  vector<Orf> found;
+  for (size_t f = 0; f < 6; ++f)
+  {
+    bool reverse = f >= 3;
+    unsigned int frame = static_cast<unsigned int>(f % 3);
+    size_t start = NONE;
+    bool stopFound = false;
+    for (size_t c = 0; c < nbChunks; ++c)
+    {
+      const ChunkSummary_& summary = summaries[f * nbChunks + c];
+      if (summary.firstStop == NONE)
+      {
+        if (start == NONE)
+          start = summary.firstStart;
+        continue;
+      }
+      if (start == NONE)
+        start = summary.firstStart;
+      // Without start codons, the ORF before the first stop codon is truncated by the beginning of the strand:
+      if (start != NONE && (stopFound || requireStart_ || partialOrfs_))
+        addOrf_(sequence, reverse, frame, start, summary.firstStop, true, found);
+      stopFound = true;
+      for (const auto& orf : summary.orfs)
+      {
+        addOrf_(sequence, reverse, frame, orf.first, orf.second, true, found);
+      }
+      start = summary.lastStart;
+    }
+    if (start != NONE && partialOrfs_)
+      addOrf_(sequence, reverse, frame, start, getNumberOfCodons(frame), false, found);
+  }
+  stable_sort(found.begin(), found.end(), [](const Orf& orf1, const Orf& orf2) {
+    return orf1.begin < orf2.begin || (orf1.begin == orf2.begin && (orf1.end < orf2.end || (orf1.end == orf2.end && orf1.reverse < orf2.reverse)));
+  });
+  orfs.insert(orfs.end(), make_move_iterator(found.begin()), make_move_iterator(found.end()));
+}
+
+/******************************************************************************/
+
+void OrfFinder::findOrfs(TemplateSequenceIteratorInterface<Sequence>& sequences, vector<Orf>& orfs) const
+{
+  while (sequences.hasMoreSequences())
+  {
+    auto sequence = sequences.nextSequence();
+    if (sequence)
+      findOrfs(*sequence, orfs);
+  }
+}
+
+/******************************************************************************/
@@ -0,0 +1,259 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_ORFFINDER_H
+#define BPP_SEQ_ORFFINDER_H
+
+#include "GeneticCode/GeneticCode.h"
+#include "Sequence.h"
+#include "SequenceIterator.h"
+
+// From the STL:
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief Find open reading frames (ORFs) in nucleotide sequences.
+ *
+ * Both strands of a sequence are scanned in their three reading frames,
+ * directly on the nucleotide states, using the start and stop codons of a
+ * genetic code. An ORF starts at the first start codon following a stop
+ * codon (or the start of the sequence), and ends with the next stop codon,
+ * which is included. ORFs are therefore the longest ones: start codons within
+ * an ORF do not start new ORFs. Codons with gaps or unresolved nucleotides are
+ * neither start nor stop codons.
+ *
+ * If start codons are not required, ORFs go from stop codon to stop codon.
+ * ORFs reaching the end of a strand without a stop codon are only reported
+ * on demand.
+ *
+ * Long sequences can be split in chunks scanned in parallel. The ORFs found
+ * are the same whatever the number of threads.
+ */
+class OrfFinder
+{
+public:
+  /**
+   * @brief An ORF, with coordinates on the forward strand of the sequence.
+   */
+  struct Orf
+  {
+    std::string sequenceName = "";
+    size_t begin = 0;              // The position of the first nucleotide, 0-based.
+    size_t end = 0;                // The position after the last nucleotide, stop codon included.
+    bool reverse = false;          // Tell if the ORF is on the reverse strand.
+    unsigned int frame = 0;        // The reading frame, 0 to 2, counted from the start of the strand.
+    bool hasStart = false;         // Tell if the ORF begins with a start codon.
+    bool hasStop = false;          // Tell if the ORF ends with a stop codon.
+    std::vector<int> protein = {}; // The translation of the ORF, without the stop codon, if requested.
+
+    size_t length() const
+    {
+      return end - begin;
+    }
+  };
+
+private:
+  /**
+   * @brief What is known of the ORFs of a strand and frame from a chunk of codons.
+   */
+  struct ChunkSummary_
+  {
+    size_t firstStop = 0;                             // The first stop codon in the chunk.
+    size_t firstStart = 0;                            // The first possible start before the first stop codon.
+    size_t lastStart = 0;                             // The first possible start after the last stop codon.
+    std::vector<std::pair<size_t, size_t>> orfs = {}; // Start and stop codons of ORFs after the first stop codon.
+  };
+
+  std::shared_ptr<const GeneticCode> gCode_;
+  size_t minLength_;
+  bool alternativeStarts_;
+  bool requireStart_;
+  bool partialOrfs_;
+  bool translate_;
+  unsigned int nbThreads_;
+
+  static const size_t NONE;
+  static const size_t MIN_CHUNK_SIZE;
+
+public:
+  /**
+   * @brief Build a new ORF finder.
+   *
+   * By default, ORFs must start with the start codon of the genetic code, and be at
+   * least 75 nucleotides long. Proteins are not translated, and one thread is used.
+   *
+   * @param gCode The genetic code defining start and stop codons.
+   */
+  OrfFinder(std::shared_ptr<const GeneticCode> gCode);
+
+  virtual ~OrfFinder()
+  {}
+
+public:
+  /**
+   * @return The minimum length of ORFs, in nucleotides, stop codon included.
+   */
+  size_t minLength() const
+  {
+    return minLength_;
+  }
+
+  /**
+   * @param minLength The minimum length of ORFs, in nucleotides, stop codon included.
+   */
+  void minLength(size_t minLength)
+  {
+    minLength_ = minLength;
+  }
+
+  /**
+   * @return True if alternative start codons of the genetic code also start ORFs.
+   */
+  bool alternativeStarts() const
+  {
+    return alternativeStarts_;
+  }
+
+  /**
+   * @param yn Tell if alternative start codons of the genetic code also start ORFs.
+   */
+  void alternativeStarts(bool yn)
+  {
+    alternativeStarts_ = yn;
+  }
+
+  /**
+   * @return True if ORFs must begin with a start codon. Otherwise, they go from stop codon to stop codon.
+   */
+  bool requireStart() const
+  {
+    return requireStart_;
+  }
+
+  /**
+   * @param yn Tell if ORFs must begin with a start codon.
+   */
+  void requireStart(bool yn)
+  {
+    requireStart_ = yn;
+  }
+
+  /**
+   * @return True if ORFs truncated by the ends of the strands are reported: ORFs without
+   * a stop codon at the end and, if start codons are not required, ORFs without a stop
+   * codon before them.
+   */
+  bool partialOrfs() const
+  {
+    return partialOrfs_;
+  }
+
+  /**
+   * @param yn Tell if ORFs truncated by the ends of the strands are reported.
+   */
+  void partialOrfs(bool yn)
+  {
+    partialOrfs_ = yn;
+  }
+
+  /**
+   * @return True if ORFs are translated.
+   */
+  bool translate() const
+  {
+    return translate_;
+  }
+
+  /**
+   * @brief Tell if ORFs are translated.
+   *
+   * Translation is performed with GeneticCode::translateNucleotides, and the
+   * start codon, if any, is translated into a methionine.
+   *
+   * @param yn Whether proteins are computed.
+   */
+  void translate(bool yn)
+  {
+    translate_ = yn;
+  }
+
+  /**
+   * @return The number of threads scanning chunks of a sequence, 0 meaning all available cores.
+   */
+  unsigned int getNumberOfThreads() const
+  {
+    return nbThreads_;
+  }
+
+  /**
+   * @param nbThreads The number of threads scanning chunks of a sequence, 0 meaning all available cores.
+   */
+  void setNumberOfThreads(unsigned int nbThreads)
+  {
+    nbThreads_ = nbThreads;
+  }
+
+  /**
+   * @brief Find the ORFs of a sequence.
+   *
+   * ORFs are appended to the output, sorted by position, then strand.
+   *
+   * @param sequence A DNA or RNA sequence.
+   * @param orfs [out] The vector where ORFs are appended.
+   * @throw AlphabetException If the sequence is not a nucleotide sequence.
+   */
+  void findOrfs(const SequenceInterface& sequence, std::vector<Orf>& orfs) const;
+
+  /**
+   * @brief Find the ORFs of all sequences read from an iterator, for instance on a file.
+   *
+   * Sequences are read and scanned one by one, so that they are never all in memory.
+   *
+   * @param sequences The sequences to scan.
+   * @param orfs [out] The vector where ORFs are appended, sequence after sequence.
+   * @throw AlphabetException If a sequence is not a nucleotide sequence.
+   */
+  void findOrfs(TemplateSequenceIteratorInterface<Sequence>& sequences, std::vector<Orf>& orfs) const;
+
+private:
+  /**
+   * @brief Scan the codons [from, to[ of a strand and frame.
+   */
+  void scanChunk_(const int* nucleotides, size_t length, bool reverse, unsigned int frame, size_t from, size_t to, ChunkSummary_& summary) const;
+
+  /**
+   * @brief Build an ORF from its first codon, and its stop codon or the number of codons in the frame.
+   */
+  void addOrf_(
+      const SequenceInterface& sequence,
+      bool reverse,
+      unsigned int frame,
+      size_t startCodon,
+      size_t endCodon,
+      bool hasStop,
+      std::vector<Orf>& orfs) const;
+
+  /**
+   * @return The GeneticCode flags of the codon at a given index of a strand and frame.
+   */
+  unsigned char getCodonType_(const int* nucleotides, size_t length, bool reverse, unsigned int frame, size_t codon) const
+  {
+    size_t p = frame + 3 * codon;
+    return gCode_->getCodonType(reverse ? nucleotides + length - 1 - p : nucleotides + p, reverse);
+  }
+
+  /**
+   * @return True if a codon of a given type starts ORFs.
+   */
+  bool isStart_(unsigned char type) const
+  {
+    return (type & GeneticCode::START) || (alternativeStarts_ && (type & GeneticCode::ALT_START));
+  }
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_ORFFINDER_H
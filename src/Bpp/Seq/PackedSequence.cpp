@@ -0,0 +1,589 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include <Bpp/Text/TextTools.h>
+#include <Bpp/Numeric/Random/RandomTools.h>
+
+#include "Alphabet/AlphabetTools.h"
+#include "PackedSequence.h" // class's header file
+
+using namespace bpp;
+
+// From the STL:
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// Number of states decoded at once when converting from or to strings:
+static const size_t PACKED_SEQUENCE_CHUNK_SIZE = 65536;
+
+/******************************************************************************/
+
+PackedSequence::PackedSequence(std::shared_ptr<const Alphabet> alpha, unsigned int bitsPerState) :
+  AbstractCoreSequence(),
+  alphabet_(alpha),
+  bitsPerState_(bitsPerState),
+  offset_(0),
+  size_(0),
+  data_(),
+  exceptions_()
+{
+  checkAlphabet_();
+}
+
+/******************************************************************************/
+
+PackedSequence::PackedSequence(
+    const std::string& name,
+    const std::string& sequence,
+    std::shared_ptr<const Alphabet> alpha,
+    unsigned int bitsPerState) :
+  AbstractCoreSequence(name),
+  alphabet_(alpha),
+  bitsPerState_(bitsPerState),
+  offset_(0),
+  size_(0),
+  data_(),
+  exceptions_()
+{
+  checkAlphabet_();
+  if (sequence != "")
+    setContent(sequence);
+}
+
+/******************************************************************************/
+
+PackedSequence::PackedSequence(
+    const std::string& name,
+    const std::vector<int>& sequence,
+    std::shared_ptr<const Alphabet> alpha,
+    unsigned int bitsPerState) :
+  AbstractCoreSequence(name),
+  alphabet_(alpha),
+  bitsPerState_(bitsPerState),
+  offset_(0),
+  size_(0),
+  data_(),
+  exceptions_()
+{
+  checkAlphabet_();
+  setContent(sequence);
+}
+
+/******************************************************************************/
+
+PackedSequence::PackedSequence(const SequenceInterface& seq, unsigned int bitsPerState) :
+  AbstractCoreSequence(seq),
+  alphabet_(seq.getAlphabet()),
+  bitsPerState_(bitsPerState),
+  offset_(0),
+  size_(0),
+  data_(),
+  exceptions_()
+{
+  checkAlphabet_();
+  // The sequence content is already valid:
+  const vector<int>& content = seq.getContent();
+  resize_(content.size());
+  for (size_t i = 0; i < content.size(); ++i)
+  {
+    setState_(i, content[i]);
+  }
+}
+
+/******************************************************************************/
+
+unsigned int PackedSequence::getDefaultBitsPerState(const Alphabet& alphabet)
+{
+  int minState = 0;
+  int maxState = 0;
+  for (int state : alphabet.getSupportedInts())
+  {
+    minState = min(minState, state);
+    maxState = max(maxState, state);
+  }
+  if (maxState - minState < 16)
+    return 4;
+  if (maxState - minState < 256)
+    return 8;
+  throw AlphabetException("PackedSequence::getDefaultBitsPerState. Too many states to be packed.", &alphabet);
+}
+
+/******************************************************************************/
+
+void PackedSequence::checkAlphabet_()
+{
+  if (bitsPerState_ == 0)
+    bitsPerState_ = getDefaultBitsPerState(*alphabet_);
+  if (bitsPerState_ == 2)
+    return; // Any state can be stored as an exception.
+  if (bitsPerState_ != 4 && bitsPerState_ != 8)
+    throw Exception("PackedSequence: states can only be stored on 2, 4 or 8 bits.");
+  // Negative states (gap, stop...) are stored first:
+  for (int state : alphabet_->getSupportedInts())
+  {
+    offset_ = min(offset_, state);
+  }
+  for (int state : alphabet_->getSupportedInts())
+  {
+    if (!isPackable_(state))
+      throw AlphabetException("PackedSequence: alphabet can not be stored on " + TextTools::toString(bitsPerState_) + " bits per state.", alphabet_);
+  }
+}
+
+/******************************************************************************/
+
+string PackedSequence::toString() const
+{
+  string result = "";
+  if (AlphabetTools::checkAlphabetCodingSize(*alphabet_))
+  {
+    size_t codingSize = alphabet_->getStateCodingSize();
+    result.resize(size_ * codingSize);
+    vector<int> buffer(min(size_, PACKED_SEQUENCE_CHUNK_SIZE));
+    for (size_t i = 0; i < size_; i += buffer.size())
+    {
+      size_t n = min(buffer.size(), size_ - i);
+      unpack(i, i + n, buffer.data());
+      alphabet_->decode(buffer.data(), n, &result[i * codingSize]);
+    }
+  }
+  else
+  {
+    for (const_iterator it = begin(); it != end(); ++it)
+    {
+      result += alphabet_->decodeState(*it);
+    }
+  }
+  return result;
+}
+
+/******************************************************************************/
+
+void PackedSequence::setContent(const std::string& sequence)
+{
+  string seq = TextTools::removeWhiteSpaces(sequence);
+  // Warning, an exception may be thrown here!
+  size_t codingSize = AlphabetTools::getAlphabetCodingSize(*alphabet_);
+  // Incomplete trailing states are ignored:
+  size_t nbStates = seq.size() / codingSize;
+  resize_(0);
+  data_.reserve((nbStates * bitsPerState_ + 7) / 8);
+  vector<int> buffer(min(nbStates, PACKED_SEQUENCE_CHUNK_SIZE));
+  for (size_t i = 0; i < nbStates; i += buffer.size())
+  {
+    size_t n = min(buffer.size(), nbStates - i);
+    alphabet_->encode(seq.data() + i * codingSize, n * codingSize, buffer.data());
+    append(buffer.data(), n);
+  }
+}
+
+/******************************************************************************/
+
+void PackedSequence::setContent(const std::vector<int>& list)
+{
+  resize_(0);
+  data_.reserve((list.size() * bitsPerState_ + 7) / 8);
+  append(list.data(), list.size());
+}
+
+/******************************************************************************/
+
+void PackedSequence::append(const int* states, size_t length)
+{
+  size_t oldSize = size_;
+  resize_(size_ + length);
+  for (size_t i = 0; i < length; ++i)
+  {
+    if (!alphabet_->isIntInAlphabet(states[i]))
+    {
+      resize_(oldSize + i);
+      throw BadIntException(states[i], "PackedSequence::append", alphabet_);
+    }
+    setState_(oldSize + i, states[i]);
+  }
+}
+
+/******************************************************************************/
+
+int PackedSequence::getValue(size_t pos) const
+{
+  if (pos >= size_)
+    throw IndexOutOfBoundsException("PackedSequence::getValue. Invalid position.", pos, 0, size_ - 1);
+  return getValue_(pos);
+}
+
+/******************************************************************************/
+
+void PackedSequence::setElement(size_t pos, int state)
+{
+  if (pos >= size_)
+    throw IndexOutOfBoundsException("PackedSequence::setElement. Invalid position.", pos, 0, size_ - 1);
+  if (!alphabet_->isIntInAlphabet(state))
+    throw BadIntException(state, "PackedSequence::setElement", alphabet_);
+  setState_(pos, state);
+}
+
+/******************************************************************************/
+
+void PackedSequence::addElement(size_t pos, int state)
+{
+  if (pos >= size_)
+    throw IndexOutOfBoundsException("PackedSequence::addElement. Invalid position.", pos, 0, size_ - 1);
+  if (!alphabet_->isIntInAlphabet(state))
+    throw BadIntException(state, "PackedSequence::addElement", alphabet_);
+  insertSpace_(pos, 1);
+  setState_(pos, state);
+}
+
+/******************************************************************************/
+
+void PackedSequence::deleteElement(size_t pos)
+{
+  if (pos >= size_)
+    throw IndexOutOfBoundsException("PackedSequence::deleteElement. Invalid position.", pos, 0, size_ - 1);
+  deleteElements(pos, 1);
+}
+
+/******************************************************************************/
+
+void PackedSequence::deleteElements(size_t pos, size_t len)
+{
+  if (pos + len > size_)
+    throw IndexOutOfBoundsException("PackedSequence::deleteElements. Invalid position.", pos + len, 0, size_ - 1);
+  if (len == 0)
+    return;
+
+  // Exceptions after the deleted region are shifted to the left:
+  eraseExceptions_(pos, pos + len);
+  for (auto& run : exceptions_)
+  {
+    if (run.begin >= pos + len)
+      run.begin -= len;
+  }
+  mergeExceptions_();
+
+  if (bitsPerState_ == 8)
+  {
+    data_.erase(data_.begin() + static_cast<ptrdiff_t>(pos), data_.begin() + static_cast<ptrdiff_t>(pos + len));
+    size_ -= len;
+    return;
+  }
+  for (size_t i = pos + len; i < size_; ++i)
+  {
+    setPacked_(i - len, getPacked_(i));
+  }
+  size_ -= len;
+  data_.resize((size_ * bitsPerState_ + 7) / 8);
+}
+
+/******************************************************************************/
+
+void PackedSequence::shuffle()
+{
+  vector<int> content = unpack();
+  std::shuffle(content.begin(), content.end(), RandomTools::DEFAULT_GENERATOR);
+  exceptions_.clear();
+  for (size_t i = 0; i < size_; ++i)
+  {
+    setState_(i, content[i]);
+  }
+}
+
+/******************************************************************************/
+
+void PackedSequence::setToSizeR(size_t newSize)
+{
+  // Size verification
+  size_t seqSize = size_;
+  if (newSize == seqSize)
+    return;
+
+  if (newSize < seqSize)
+  {
+    resize_(newSize);
+    return;
+  }
+
+  // Add gaps up to specified size
+  resize_(newSize);
+  fill_(seqSize, newSize, alphabet_->getGapCharacterCode());
+}
+
+/******************************************************************************/
+
+void PackedSequence::setToSizeL(size_t newSize)
+{
+  // Size verification
+  size_t seqSize = size_;
+  if (newSize == seqSize)
+    return;
+
+  if (newSize < seqSize)
+  {
+    // We must truncate sequence from the left.
+    deleteElements(0, seqSize - newSize);
+    return;
+  }
+
+  // Add gaps up to specified size
+  insertSpace_(0, newSize - seqSize);
+  fill_(0, newSize - seqSize, alphabet_->getGapCharacterCode());
+}
+
+/******************************************************************************/
+
+void PackedSequence::unpack(size_t begin, size_t end, int* states) const
+{
+  if (end > size_ || begin > end)
+    throw IndexOutOfBoundsException("PackedSequence::unpack. Invalid range.", end, 0, size_);
+
+  size_t i = begin;
+  int* out = states;
+  if (bitsPerState_ == 8)
+  {
+    for (; i < end; ++i)
+    {
+      *out++ = static_cast<int>(data_[i]) + offset_;
+    }
+  }
+  else
+  {
+    // Decode the first positions up to a byte boundary, then whole bytes:
+    size_t spb = 8 / bitsPerState_;
+    uint8_t mask = static_cast<uint8_t>((1u << bitsPerState_) - 1);
+    for ( ; i < end && i % spb != 0; ++i)
+    {
+      *out++ = unpackState_(getPacked_(i));
+    }
+    for ( ; i + spb <= end; i += spb)
+    {
+      uint8_t byte = data_[i / spb];
+      for (size_t j = 0; j < spb; ++j)
+      {
+        *out++ = unpackState_(static_cast<uint8_t>((byte >> (j * bitsPerState_)) & mask));
+      }
+    }
+    for ( ; i < end; ++i)
+    {
+      *out++ = unpackState_(getPacked_(i));
+    }
+  }
+
+  // Exceptions override the content of the packed array:
+  auto it = partition_point(exceptions_.begin(), exceptions_.end(),
+      [begin](const ExceptionRun_& run) {
+        return run.begin + run.length <= begin;
+      });
+  for ( ; it != exceptions_.end() && it->begin < end; ++it)
+  {
+    size_t from = max(it->begin, begin);
+    size_t to = min(it->begin + it->length, end);
+    std::fill(states + (from - begin), states + (to - begin), it->state);
+  }
+}
+
+/******************************************************************************/
+
+vector<int> PackedSequence::unpack() const
+{
+  vector<int> content(size_);
+  unpack(0, size_, content.data());
+  return content;
+}
+
+/******************************************************************************/
+
+unique_ptr<Sequence> PackedSequence::toSequence() const
+{
+  auto alpha = alphabet_;
+  auto seq = make_unique<Sequence>(getName(), unpack(), getComments(), alpha);
+  return seq;
+}
+
+/******************************************************************************/
+
+int PackedSequence::getValue_(size_t pos) const
+{
+  if (!exceptions_.empty())
+  {
+    auto it = upper_bound(exceptions_.begin(), exceptions_.end(), pos,
+        [](size_t p, const ExceptionRun_& run) {
+          return p < run.begin;
+        });
+    if (it != exceptions_.begin())
+    {
+      --it;
+      if (pos < it->begin + it->length)
+        return it->state;
+    }
+  }
+  return unpackState_(getPacked_(pos));
+}
+
+/******************************************************************************/
+
+void PackedSequence::setState_(size_t pos, int state)
+{
+  if (bitsPerState_ == 2)
+    eraseExceptions_(pos, pos + 1);
+  if (isPackable_(state))
+  {
+    setPacked_(pos, packState_(state));
+  }
+  else
+  {
+    setPacked_(pos, 0);
+    insertException_(pos, 1, state);
+  }
+}
+
+/******************************************************************************/
+
+void PackedSequence::fill_(size_t begin, size_t end, int state)
+{
+  if (begin >= end)
+    return;
+  if (bitsPerState_ == 2)
+    eraseExceptions_(begin, end);
+  uint8_t value = 0;
+  if (isPackable_(state))
+    value = packState_(state);
+  else
+    insertException_(begin, end - begin, state);
+  for (size_t i = begin; i < end; ++i)
+  {
+    setPacked_(i, value);
+  }
+}
+
+/******************************************************************************/
+
+void PackedSequence::resize_(size_t newSize)
+{
+  if (newSize < size_)
+    eraseExceptions_(newSize, size_);
+  size_ = newSize;
+  data_.resize((size_ * bitsPerState_ + 7) / 8);
+}
+
+/******************************************************************************/
+
+void PackedSequence::insertSpace_(size_t pos, size_t length)
+{
+  size_t oldSize = size_;
+  resize_(size_ + length);
+  if (bitsPerState_ == 8)
+  {
+    memmove(&data_[pos + length], &data_[pos], oldSize - pos);
+  }
+  else
+  {
+    for (size_t i = oldSize; i > pos; --i)
+    {
+      setPacked_(i - 1 + length, getPacked_(i - 1));
+    }
+  }
+
+  // Shift exceptions, splitting the run overlapping the insertion point if any:
+  vector<ExceptionRun_> split;
+  for (auto& run : exceptions_)
+  {
+    if (run.begin >= pos)
+    {
+      run.begin += length;
+    }
+    else if (run.begin + run.length > pos)
+    {
+      split.push_back({ pos + length, run.begin + run.length - pos, run.state });
+      run.length = pos - run.begin;
+    }
+  }
+  if (!split.empty())
+  {
+    auto it = partition_point(exceptions_.begin(), exceptions_.end(),
+        [pos](const ExceptionRun_& run) {
+          return run.begin < pos;
+        });
+    exceptions_.insert(it, split.begin(), split.end());
+  }
+}
+
+/******************************************************************************/
+
+void PackedSequence::eraseExceptions_(size_t begin, size_t end)
+{
+  auto first = partition_point(exceptions_.begin(), exceptions_.end(),
+      [begin](const ExceptionRun_& run) {
+        return run.begin + run.length <= begin;
+      });
+  auto last = first;
+  vector<ExceptionRun_> kept;
+  for ( ; last != exceptions_.end() && last->begin < end; ++last)
+  {
+    size_t runEnd = last->begin + last->length;
+    if (last->begin < begin)
+      kept.push_back({ last->begin, begin - last->begin, last->state });
+    if (runEnd > end)
+      kept.push_back({ end, runEnd - end, last->state });
+  }
+  if (first == last)
+    return;
+  auto it = exceptions_.erase(first, last);
+  exceptions_.insert(it, kept.begin(), kept.end());
+}
+
+/******************************************************************************/
+
+void PackedSequence::insertException_(size_t begin, size_t length, int state)
+{
+  auto it = partition_point(exceptions_.begin(), exceptions_.end(),
+      [begin](const ExceptionRun_& run) {
+        return run.begin < begin;
+      });
+  // Try to extend the previous run:
+  if (it != exceptions_.begin())
+  {
+    auto prev = it - 1;
+    if (prev->begin + prev->length == begin && prev->state == state)
+    {
+      prev->length += length;
+      if (it != exceptions_.end() && it->begin == begin + length && it->state == state)
+      {
+        prev->length += it->length;
+        exceptions_.erase(it);
+      }
+      return;
+    }
+  }
+  // Try to extend the next run:
+  if (it != exceptions_.end() && it->begin == begin + length && it->state == state)
+  {
+    it->begin = begin;
+    it->length += length;
+    return;
+  }
+  exceptions_.insert(it, { begin, length, state });
+}
+
+/******************************************************************************/
+
+void PackedSequence::mergeExceptions_()
+{
+  if (exceptions_.size() < 2)
+    return;
+  size_t j = 0;
+  for (size_t i = 1; i < exceptions_.size(); ++i)
+  {
+    ExceptionRun_& last = exceptions_[j];
+    if (last.begin + last.length == exceptions_[i].begin && last.state == exceptions_[i].state)
+      last.length += exceptions_[i].length;
+    else
+      exceptions_[++j] = exceptions_[i];
+  }
+  exceptions_.resize(j + 1);
+}
+
+/******************************************************************************/
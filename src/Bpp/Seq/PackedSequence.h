@@ -0,0 +1,557 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#ifndef BPP_SEQ_PACKEDSEQUENCE_H
+#define BPP_SEQ_PACKEDSEQUENCE_H
+
+
+#include "CoreSequence.h"
+#include "Sequence.h"
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <cstdint>
+
+namespace bpp
+{
+/**
+ * @brief A memory-efficient sequence, storing states on 2, 4 or 8 bits.
+ *
+ * Sequence objects store each state as an int, that is 32 bits per position.
+ * This class stores the same content in a bit-packed array:
+ * - 8 bits per state can hold any alphabet with up to 256 states, gaps and stops included (e.g. proteins),
+ * - 4 bits per state can hold the nucleic alphabets, including all IUPAC codes and the gap,
+ * - 2 bits per state only hold states 0 to 3 (A, C, G, T/U for nucleic alphabets).
+ *   All other states (gaps, generic characters) are stored as a list of runs of identical states,
+ *   which is efficient for genomic sequences where such states are rare or come in long stretches (N blocks).
+ *
+ * Positions can be read one at a time with getValue() or through iterators,
+ * and ranges of positions can be decoded at once with unpack().
+ * Tools working on Sequence objects can be applied to a packed sequence after
+ * conversion with toSequence(), or window by window using unpack().
+ *
+ * Edition methods are supported, but operations changing the length of the
+ * sequence anywhere but at its end have a cost linear in the size of the sequence.
+ *
+ * @see Sequence
+ */
+class PackedSequence :
+  public virtual CoreSequenceInterface,
+  public AbstractCoreSequence
+{
+private:
+  /**
+   * @brief A stretch of identical states which cannot be stored in the packed array (2-bit mode only).
+   */
+  struct ExceptionRun_
+  {
+    size_t begin;
+    size_t length;
+    int state;
+  };
+
+  std::shared_ptr<const Alphabet> alphabet_;
+  unsigned int bitsPerState_;
+
+  /**
+   * @brief The state stored as 0 in the packed array.
+   */
+  int offset_;
+  size_t size_;
+  std::vector<uint8_t> data_;
+  std::vector<ExceptionRun_> exceptions_;
+
+public:
+  /**
+   * @brief Build an empty packed sequence.
+   *
+   * @param alpha The alphabet of the sequence.
+   * @param bitsPerState The number of bits used to store each state (2, 4 or 8).
+   * If 0, the smallest lossless packing (4 or 8 bits) is chosen according to the alphabet.
+   * @throw AlphabetException If the alphabet cannot be stored on the required number of bits.
+   */
+  PackedSequence(std::shared_ptr<const Alphabet> alpha, unsigned int bitsPerState = 0);
+
+  /**
+   * @brief Build a packed sequence from a string.
+   *
+   * @param name The sequence name.
+   * @param sequence The sequence content, as a string.
+   * @param alpha The alphabet of the sequence.
+   * @param bitsPerState The number of bits used to store each state (2, 4 or 8, 0 for automatic).
+   * @throw AlphabetException If the alphabet cannot be stored on the required number of bits.
+   * @throw BadCharException If the sequence contains a character not in the alphabet.
+   */
+  PackedSequence(
+      const std::string& name,
+      const std::string& sequence,
+      std::shared_ptr<const Alphabet> alpha,
+      unsigned int bitsPerState = 0);
+
+  /**
+   * @brief Build a packed sequence from a list of states.
+   *
+   * @param name The sequence name.
+   * @param sequence The sequence content.
+   * @param alpha The alphabet of the sequence.
+   * @param bitsPerState The number of bits used to store each state (2, 4 or 8, 0 for automatic).
+   * @throw AlphabetException If the alphabet cannot be stored on the required number of bits.
+   * @throw BadIntException If the sequence contains a state not in the alphabet.
+   */
+  PackedSequence(
+      const std::string& name,
+      const std::vector<int>& sequence,
+      std::shared_ptr<const Alphabet> alpha,
+      unsigned int bitsPerState = 0);
+
+  /**
+   * @brief Pack a sequence. Name and comments are copied.
+   *
+   * @param seq The sequence to pack.
+   * @param bitsPerState The number of bits used to store each state (2, 4 or 8, 0 for automatic).
+   * @throw AlphabetException If the alphabet cannot be stored on the required number of bits.
+   */
+  PackedSequence(const SequenceInterface& seq, unsigned int bitsPerState = 0);
+
+  PackedSequence(const PackedSequence& seq) = default;
+
+  PackedSequence& operator=(const PackedSequence& seq) = default;
+
+  virtual ~PackedSequence()
+  {}
+
+public:
+  /**
+   * @name The Clonable interface
+   *
+   * @{
+   */
+  PackedSequence* clone() const override
+  {
+    return new PackedSequence(*this);
+  }
+  /** @} */
+
+  /**
+   * @brief Get the smallest number of bits allowing to store all states of an alphabet without exceptions.
+   *
+   * @param alphabet The alphabet to test.
+   * @return 4 or 8.
+   * @throw AlphabetException If the alphabet has too many states to be packed.
+   */
+  static unsigned int getDefaultBitsPerState(const Alphabet& alphabet);
+
+  /**
+   * @return The number of bits used to store each state.
+   */
+  unsigned int getBitsPerState() const
+  {
+    return bitsPerState_;
+  }
+
+  /**
+   * @return The number of runs of states stored outside of the packed array (2-bit mode only).
+   */
+  size_t getNumberOfExceptionRuns() const
+  {
+    return exceptions_.size();
+  }
+
+  /**
+   * @return The approximate number of bytes used to store the content of the sequence.
+   */
+  size_t getStorageSize() const
+  {
+    return data_.capacity() + exceptions_.capacity() * sizeof(ExceptionRun_);
+  }
+
+  std::shared_ptr<const Alphabet> getAlphabet() const override
+  {
+    return alphabet_;
+  }
+
+  const Alphabet& alphabet() const override
+  {
+    return *alphabet_;
+  }
+
+  size_t size() const override
+  {
+    return size_;
+  }
+
+  std::string toString() const override;
+
+  /**
+   * @name Acting on the content of the sequence.
+   *
+   * @{
+   */
+
+  /**
+   * @brief Set the whole content of the sequence.
+   *
+   * @param sequence The new content of the sequence.
+   * @throw BadCharException If the sequence contains a character not in the alphabet.
+   */
+  void setContent(const std::string& sequence);
+
+  /**
+   * @brief Set the whole content of the sequence.
+   *
+   * @param list The new content of the sequence.
+   * @throw BadIntException If the sequence contains a state not in the alphabet.
+   */
+  void setContent(const std::vector<int>& list);
+
+  /**
+   * @brief Append states at the end of the sequence.
+   *
+   * @param states A pointer toward the first state to add.
+   * @param length The number of states to add.
+   * @throw BadIntException If a state is not in the alphabet. States before the faulty one are kept.
+   */
+  void append(const int* states, size_t length);
+
+  /**
+   * @brief Append states at the end of the sequence.
+   *
+   * @param content The states to add.
+   * @throw BadIntException If a state is not in the alphabet.
+   */
+  void append(const std::vector<int>& content)
+  {
+    append(content.data(), content.size());
+  }
+
+  /**
+   * @brief Get the state at a given position.
+   *
+   * @param pos The position of the state.
+   * @return The state at the given position.
+   * @throw IndexOutOfBoundsException If the position is invalid.
+   */
+  int getValue(size_t pos) const;
+
+  /**
+   * @brief Get the state at a given position, without checking the position.
+   */
+  int operator[](size_t pos) const
+  {
+    return getValue_(pos);
+  }
+
+  /**
+   * @brief Set the state at a given position.
+   *
+   * @param pos The position of the state.
+   * @param state The new state.
+   * @throw IndexOutOfBoundsException If the position is invalid.
+   * @throw BadIntException If the state is not in the alphabet.
+   */
+  void setElement(size_t pos, int state);
+
+  /**
+   * @brief Add a state at the end of the sequence.
+   *
+   * @param state The state to add.
+   * @throw BadIntException If the state is not in the alphabet.
+   */
+  void addElement(int state)
+  {
+    append(&state, 1);
+  }
+
+  /**
+   * @brief Insert a state in the sequence.
+   *
+   * @param pos The position where to insert the state.
+   * @param state The state to add.
+   * @throw IndexOutOfBoundsException If the position is invalid.
+   * @throw BadIntException If the state is not in the alphabet.
+   */
+  void addElement(size_t pos, int state);
+
+  void deleteElement(size_t pos) override;
+
+  void deleteElements(size_t pos, size_t len) override;
+
+  /**
+   * @brief Randomly shuffle the content of the list.
+   *
+   * The sequence is temporarily unpacked.
+   */
+  void shuffle() override;
+
+  void setToSizeR(size_t newSize) override;
+
+  void setToSizeL(size_t newSize) override;
+  /** @} */
+
+  /**
+   * @name Bulk decoding.
+   *
+   * @{
+   */
+
+  /**
+   * @brief Decode a range of positions.
+   *
+   * @param begin The first position to decode.
+   * @param end The position after the last one to decode.
+   * @param states A pointer toward an array of at least end - begin elements, where decoded states are written.
+   * @throw IndexOutOfBoundsException If the range is invalid.
+   */
+  void unpack(size_t begin, size_t end, int* states) const;
+
+  /**
+   * @brief Decode the whole sequence.
+   *
+   * @return A vector with all states of the sequence.
+   */
+  std::vector<int> unpack() const;
+
+  /**
+   * @brief Convert to a regular sequence, with the same name, comments and content.
+   *
+   * @return A new Sequence object.
+   */
+  std::unique_ptr<Sequence> toSequence() const;
+  /** @} */
+
+  double getStateValueAt(size_t position, int state) const override
+  {
+    if (position >= size_)
+      throw IndexOutOfBoundsException("PackedSequence::getStateValueAt.", position, 0, size_ - 1);
+    return alphabet_->isResolvedIn(getValue_(position), state) ? 1. : 0.;
+  }
+
+  double operator()(size_t position, int state) const override
+  {
+    return alphabet_->isResolvedIn(getValue_(position), state) ? 1. : 0.;
+  }
+
+  /**
+   * @brief A read-only random access iterator over the states of a packed sequence.
+   */
+  class const_iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef int value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const int* pointer;
+    typedef int reference;
+
+  private:
+    const PackedSequence* seq_;
+    size_t pos_;
+
+  public:
+    const_iterator() :
+      seq_(nullptr),
+      pos_(0)
+    {}
+
+    const_iterator(const PackedSequence& seq, size_t pos) :
+      seq_(&seq),
+      pos_(pos)
+    {}
+
+  public:
+    int operator*() const
+    {
+      return seq_->getValue_(pos_);
+    }
+
+    int operator[](difference_type n) const
+    {
+      return seq_->getValue_(static_cast<size_t>(static_cast<difference_type>(pos_) + n));
+    }
+
+    const_iterator& operator++()
+    {
+      ++pos_;
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator tmp(*this);
+      ++pos_;
+      return tmp;
+    }
+
+    const_iterator& operator--()
+    {
+      --pos_;
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      const_iterator tmp(*this);
+      --pos_;
+      return tmp;
+    }
+
+    const_iterator& operator+=(difference_type n)
+    {
+      pos_ = static_cast<size_t>(static_cast<difference_type>(pos_) + n);
+      return *this;
+    }
+
+    const_iterator& operator-=(difference_type n)
+    {
+      pos_ = static_cast<size_t>(static_cast<difference_type>(pos_) - n);
+      return *this;
+    }
+
+    const_iterator operator+(difference_type n) const
+    {
+      const_iterator tmp(*this);
+      return tmp += n;
+    }
+
+    const_iterator operator-(difference_type n) const
+    {
+      const_iterator tmp(*this);
+      return tmp -= n;
+    }
+
+    difference_type operator-(const const_iterator& it) const
+    {
+      return static_cast<difference_type>(pos_) - static_cast<difference_type>(it.pos_);
+    }
+
+    bool operator==(const const_iterator& it) const
+    {
+      return pos_ == it.pos_;
+    }
+
+    bool operator!=(const const_iterator& it) const
+    {
+      return pos_ != it.pos_;
+    }
+
+    bool operator<(const const_iterator& it) const
+    {
+      return pos_ < it.pos_;
+    }
+
+    bool operator>(const const_iterator& it) const
+    {
+      return pos_ > it.pos_;
+    }
+
+    bool operator<=(const const_iterator& it) const
+    {
+      return pos_ <= it.pos_;
+    }
+
+    bool operator>=(const const_iterator& it) const
+    {
+      return pos_ >= it.pos_;
+    }
+  };
+
+  const_iterator begin() const
+  {
+    return const_iterator(*this, 0);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(*this, size_);
+  }
+
+private:
+  void checkAlphabet_();
+
+  uint8_t getPacked_(size_t pos) const
+  {
+    if (bitsPerState_ == 8)
+      return data_[pos];
+    unsigned int spb = 8 / bitsPerState_;
+    unsigned int shift = static_cast<unsigned int>(pos % spb) * bitsPerState_;
+    return static_cast<uint8_t>((data_[pos / spb] >> shift) & ((1u << bitsPerState_) - 1));
+  }
+
+  void setPacked_(size_t pos, uint8_t value)
+  {
+    if (bitsPerState_ == 8)
+    {
+      data_[pos] = value;
+      return;
+    }
+    unsigned int spb = 8 / bitsPerState_;
+    unsigned int shift = static_cast<unsigned int>(pos % spb) * bitsPerState_;
+    uint8_t mask = static_cast<uint8_t>(((1u << bitsPerState_) - 1) << shift);
+    uint8_t& byte = data_[pos / spb];
+    byte = static_cast<uint8_t>((byte & ~mask) | ((value << shift) & mask));
+  }
+
+  /**
+   * @return True if the state can be stored in the packed array.
+   */
+  bool isPackable_(int state) const
+  {
+    return state >= offset_ && state - offset_ < (1 << bitsPerState_);
+  }
+
+  uint8_t packState_(int state) const
+  {
+    return static_cast<uint8_t>(state - offset_);
+  }
+
+  int unpackState_(uint8_t value) const
+  {
+    return static_cast<int>(value) + offset_;
+  }
+
+  int getValue_(size_t pos) const;
+
+  /**
+   * @brief Store a state, which is assumed to be valid, at a given position.
+   */
+  void setState_(size_t pos, int state);
+
+  /**
+   * @brief Store the same valid state in the range [begin, end[.
+   */
+  void fill_(size_t begin, size_t end, int state);
+
+  void resize_(size_t newSize);
+
+  /**
+   * @brief Open a hole of 'length' positions starting at 'pos'.
+   *
+   * Positions in the hole have undefined content and must be set afterwards.
+   */
+  void insertSpace_(size_t pos, size_t length);
+
+  /**
+   * @brief Remove exceptions in the range [begin, end[.
+   */
+  void eraseExceptions_(size_t begin, size_t end);
+
+  /**
+   * @brief Register a run of exceptional states, merging it with its neighbours if possible.
+   *
+   * The range must not overlap any existing run.
+   */
+  void insertException_(size_t begin, size_t length, int state);
+
+  /**
+   * @brief Merge adjacent runs with identical states.
+   */
+  void mergeExceptions_();
+
+  friend class const_iterator;
+};
+} // end of namespace bpp.
+#endif // BPP_SEQ_PACKEDSEQUENCE_H
@@ -72,7 +72,7 @@ void Sequence::setToSizeL(size_t newSize)
 
 void Sequence::append(const SequenceInterface& seq)
 {
-  if (seq.getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+  if (!seq.getAlphabet()->isCompatibleWith(*getAlphabet()))
     throw AlphabetMismatchException("Sequence::append", getAlphabet(), seq.getAlphabet());
   // Check list for incorrect characters
   for (auto i : seq.getContent())
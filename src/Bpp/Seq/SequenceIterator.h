@@ -5,6 +5,8 @@
 #ifndef BPP_SEQ_SEQUENCEITERATOR_H
 #define BPP_SEQ_SEQUENCEITERATOR_H
 
+// From the STL:
+#include <memory>
 
 namespace bpp
 {
@@ -6,6 +6,7 @@
 #include <Bpp/Numeric/VectorTools.h>
 
 #include "Alphabet/AlphabetTools.h"
+#include "MotifSearch.h"
 #include "SequenceTools.h"
 #include "StringSequenceTools.h"
 
@@ -13,6 +14,7 @@ using namespace bpp;
 
 // From the STL:
 #include <ctype.h>
+#include <algorithm>
 #include <cmath>
 #include <list>
 #include <iostream>
@@ -24,12 +26,57 @@ NucleicAcidsReplication SequenceTools::DNARep_(AlphabetTools::DNA_ALPHABET, Alph
 NucleicAcidsReplication SequenceTools::RNARep_(AlphabetTools::RNA_ALPHABET, AlphabetTools::RNA_ALPHABET);
 NucleicAcidsReplication SequenceTools::transc_(AlphabetTools::DNA_ALPHABET, AlphabetTools::RNA_ALPHABET);
 
+namespace
+{
+/**
+ * @brief Tell, for each state supported by an alphabet, if it satisfies a predicate.
+ *
+ * @param alphabet The alphabet.
+ * @param offset [out] The state corresponding to the first position in the table.
+ * @param test The predicate, taking a state.
+ */
+template<class Predicate>
+vector<bool> getStateSelection(const Alphabet& alphabet, int& offset, Predicate test)
+{
+  const vector<int>& states = alphabet.getSupportedInts();
+  auto range = minmax_element(states.begin(), states.end());
+  offset = *range.first;
+  vector<bool> selection(static_cast<size_t>(*range.second - offset + 1), false);
+  for (int state : states)
+  {
+    selection[static_cast<size_t>(state - offset)] = test(state);
+  }
+  return selection;
+}
+
+/**
+ * @brief Build a conversion table for all the states supported by an alphabet.
+ *
+ * @param alphabet The alphabet.
+ * @param offset [out] The state corresponding to the first position in the table.
+ * @param convert The conversion, taking a state and returning the new state.
+ */
+template<class Conversion>
+vector<int> getStateTable(const Alphabet& alphabet, int& offset, Conversion convert)
+{
+  const vector<int>& states = alphabet.getSupportedInts();
+  auto range = minmax_element(states.begin(), states.end());
+  offset = *range.first;
+  vector<int> table(static_cast<size_t>(*range.second - offset + 1), alphabet.getGapCharacterCode());
+  for (int state : states)
+  {
+    table[static_cast<size_t>(state - offset)] = convert(state);
+  }
+  return table;
+}
+}
+
 /******************************************************************************/
 
 bool SequenceTools::areSequencesIdentical(const SequenceInterface& seq1, const SequenceInterface& seq2)
 {
   // Site's size and content checking
-  if (seq1.getAlphabet()->getAlphabetType() != seq2.getAlphabet()->getAlphabetType())
+  if (!seq1.getAlphabet()->isCompatibleWith(*seq2.getAlphabet()))
     return false;
   if (seq1.size() != seq2.size())
     return false;
@@ -62,10 +109,11 @@ void SequenceTools::complement(SequenceInterface& seq)
   {
     throw AlphabetException("SequenceTools::complement: Sequence must be nucleic.", seq.getAlphabet());
   }
-  for (size_t i = 0; i < seq.size(); ++i)
-  {
-    seq.setElement(i, NAR->translate(seq.getValue(i)));
-  }
+  int offset;
+  vector<int> table = getStateTable(seq.alphabet(), offset, [NAR](int state) {
+    return NAR->translate(state);
+  });
+  seq.translateStates(table, offset, false);
 }
 
 /******************************************************************************/
@@ -120,16 +168,11 @@ unique_ptr<Sequence> SequenceTools::reverseTranscript(const Sequence& sequence)
 
 void SequenceTools::invert(SequenceInterface& seq)
 {
-  size_t seq_size = seq.size(); // store seq size for efficiency
-  int tmp_state = 0; // to store one state when swapping positions
-  size_t j = seq_size; // symmetric position iterator from sequence end
-  for (size_t i = 0; i < seq_size / 2; ++i)
-  {
-    j = seq_size - 1 - i;
-    tmp_state = seq.getValue(i);
-    seq.setElement(i, seq.getValue(j));
-    seq.setElement(j, tmp_state);
-  }
+  int offset;
+  vector<int> table = getStateTable(seq.alphabet(), offset, [](int state) {
+    return state;
+  });
+  seq.translateStates(table, offset, true);
 }
 
 /******************************************************************************/
@@ -159,23 +202,11 @@ void SequenceTools::invertComplement(SequenceInterface& seq)
   {
     throw AlphabetException("SequenceTools::invertComplement: Sequence must be nucleic.", seq.getAlphabet());
   }
-  // for (size_t i = 0 ; i < seq.size() ; i++) {
-  //  seq.setElement(i, NAR->translate(seq.getValue(i)));
-  // }
-  size_t seq_size = seq.size(); // store seq size for efficiency
-  int tmp_state = 0; // to store one state when swapping positions
-  size_t j = seq_size; // symmetric position iterator from sequence end
-  for (size_t i = 0; i < seq_size / 2; ++i)
-  {
-    j = seq_size - 1 - i;
-    tmp_state = seq.getValue(i);
-    seq.setElement(i, NAR->translate(seq.getValue(j)));
-    seq.setElement(j, NAR->translate(tmp_state));
-  }
-  if (seq_size % 2) // treat the state in the middle of odd sequences
-  {
-    seq.setElement(seq_size / 2, NAR->translate(seq.getValue(seq_size / 2)));
-  }
+  int offset;
+  vector<int> table = getStateTable(seq.alphabet(), offset, [NAR](int state) {
+    return NAR->translate(state);
+  });
+  seq.translateStates(table, offset, true);
 }
 
 /******************************************************************************/
@@ -185,7 +216,7 @@ double SequenceTools::getPercentIdentity(
     const SequenceInterface& seq2,
     bool ignoreGaps)
 {
-  if (seq1.alphabet().getAlphabetType() != seq2.alphabet().getAlphabetType())
+  if (!seq1.alphabet().isCompatibleWith(seq2.alphabet()))
     throw AlphabetMismatchException("SequenceTools::getPercentIdentity", seq1.getAlphabet(), seq2.getAlphabet());
   if (seq1.size() != seq2.size())
     throw SequenceNotAlignedException("SequenceTools::getPercentIdentity", &seq2);
@@ -248,14 +279,12 @@ size_t SequenceTools::getNumberOfCompleteSites(const SequenceInterface& seq)
 unique_ptr<SequenceInterface> SequenceTools::getSequenceWithCompleteSites(const SequenceInterface& seq)
 {
   auto& alpha = seq.alphabet();
-  vector<int> content;
-  for (size_t i = 0; i < seq.size(); ++i)
-  {
-    if (!(alpha.isGap(seq[i]) || alpha.isUnresolved(seq[i])))
-      content.push_back(seq[i]);
-  }
+  int offset;
+  vector<bool> removed = getStateSelection(alpha, offset, [&alpha](int state) {
+    return alpha.isGap(state) || alpha.isUnresolved(state);
+  });
   auto newSeq = unique_ptr<SequenceInterface>(seq.clone());
-  newSeq->setContent(content);
+  newSeq->removeStates(removed, offset);
   return newSeq;
 }
 
@@ -277,15 +306,8 @@ size_t SequenceTools::getNumberOfUnresolvedSites(const SequenceInterface& seq)
 
 unique_ptr<SequenceInterface> SequenceTools::getSequenceWithoutGaps(const SequenceInterface& seq)
 {
-  auto alphaPtr = seq.getAlphabet();
-  vector<int> content;
-  for (size_t i = 0; i < seq.size(); ++i)
-  {
-    if (!alphaPtr->isGap(seq[i]))
-      content.push_back(seq[i]);
-  }
   auto newSeq = unique_ptr<SequenceInterface>(seq.clone());
-  newSeq->setContent(content);
+  removeGaps(*newSeq);
   return newSeq;
 }
 
@@ -293,12 +315,12 @@ unique_ptr<SequenceInterface> SequenceTools::getSequenceWithoutGaps(const Sequen
 
 void SequenceTools::removeGaps(SequenceInterface& seq)
 {
-  auto alphaPtr = seq.getAlphabet();
-  for (size_t i = seq.size(); i > 0; --i)
-  {
-    if (alphaPtr->isGap(seq[i - 1]))
-      seq.deleteElement(i - 1);
-  }
+  auto& alpha = seq.alphabet();
+  int offset;
+  vector<bool> removed = getStateSelection(alpha, offset, [&alpha](int state) {
+    return alpha.isGap(state);
+  });
+  seq.removeStates(removed, offset);
 }
 
 /******************************************************************************/
@@ -308,14 +330,8 @@ unique_ptr<SequenceInterface> SequenceTools::getSequenceWithoutStops(const Seque
   auto calpha = dynamic_pointer_cast<const CodonAlphabet>(seq.getAlphabet());
   if (!calpha)
     throw Exception("SequenceTools::getSequenceWithoutStops. Input sequence should have a codon alphabet.");
-  vector<int> content;
-  for (size_t i = 0; i < seq.size(); ++i)
-  {
-    if (!gCode.isStop(seq[i]))
-      content.push_back(seq[i]);
-  }
   auto newSeq = unique_ptr<SequenceInterface>(seq.clone());
-  newSeq->setContent(content);
+  removeStops(*newSeq, gCode);
   return newSeq;
 }
 
@@ -326,11 +342,11 @@ void SequenceTools::removeStops(SequenceInterface& seq, const GeneticCode& gCode
   auto calpha = dynamic_pointer_cast<const CodonAlphabet>(seq.getAlphabet());
   if (!calpha)
     throw Exception("SequenceTools::removeStops. Input sequence should have a codon alphabet.");
-  for (size_t i = seq.size(); i > 0; --i)
-  {
-    if (gCode.isStop(seq[i - 1]))
-      seq.deleteElement(i - 1);
-  }
+  int offset;
+  vector<bool> removed = getStateSelection(*calpha, offset, [&gCode](int state) {
+    return gCode.isStop(state);
+  });
+  seq.removeStates(removed, offset);
 }
 
 /******************************************************************************/
@@ -341,11 +357,11 @@ void SequenceTools::replaceStopsWithGaps(SequenceInterface& seq, const GeneticCo
   if (!calpha)
     throw Exception("SequenceTools::replaceStopsWithGaps. Input sequence should have a codon alphabet.");
   int gap = calpha->getGapCharacterCode();
-  for (size_t i = 0; i < seq.size(); ++i)
-  {
-    if (gCode.isStop(seq[i]))
-      seq.setElement(i, gap);
-  }
+  int offset;
+  vector<int> table = getStateTable(*calpha, offset, [&gCode, gap](int state) {
+    return gCode.isStop(state) ? gap : state;
+  });
+  seq.translateStates(table, offset, false);
 }
 
 /******************************************************************************/
@@ -463,7 +479,7 @@ unique_ptr<Sequence> SequenceTools::combineSequences(
     const SequenceInterface& s1,
     const SequenceInterface& s2)
 {
-  if (s1.alphabet().getAlphabetType() != s2.alphabet().getAlphabetType())
+  if (!s1.alphabet().isCompatibleWith(s2.alphabet()))
   {
     throw AlphabetMismatchException("SequenceTools::combineSequences(const Sequence& s1, const Sequence& s2): s1 and s2 don't have same Alphabet.", s1.getAlphabet(), s2.getAlphabet());
   }
@@ -615,25 +631,24 @@ void SequenceTools::getCDS(
   auto alphabet = dynamic_pointer_cast<const CodonAlphabet>(sequence.getAlphabet());
   if (!alphabet)
     throw AlphabetException("SequenceTools::getCDS. Sequence is not a codon sequence.", sequence.getAlphabet());
+  // Each end is trimmed in one edition:
   if (checkInit)
   {
     size_t i;
     for (i = 0; i < sequence.size() && !gCode.isStart(sequence[i]); ++i)
     {}
-    for (size_t j = 0; includeInit ? j < i : j <= i; ++j)
-    {
-      sequence.deleteElement(j);
-    }
+    size_t length = includeInit ? i : min(i + 1, sequence.size());
+    if (length > 0)
+      sequence.deleteElements(0, length);
   }
   if (checkStop)
   {
     size_t i;
     for (i = 0; i < sequence.size() && !gCode.isStop(sequence[i]); ++i)
     {}
-    for (size_t j = includeStop ? i + 1 : i; j < sequence.size(); ++j)
-    {
-      sequence.deleteElement(j);
-    }
+    size_t begin = includeStop ? min(i + 1, sequence.size()) : i;
+    if (begin < sequence.size())
+      sequence.deleteElements(begin, sequence.size() - begin);
   }
 }
 
@@ -644,32 +659,12 @@ size_t SequenceTools::findFirstOf(
     const SequenceInterface& motif,
     bool strict)
 {
-  if (motif.size() > seq.size())
+  if (motif.size() > seq.size() || motif.size() == 0)
     return seq.size();
-  for (size_t seqi = 0; seqi < seq.size() - motif.size() + 1; seqi++)
-  {
-    bool match = false;
-    for (size_t moti = 0; moti < motif.size(); moti++)
-    {
-      if (strict)
-      {
-        match = seq.getValue(seqi + moti) == motif.getValue(moti);
-      }
-      else
-      {
-        match = AlphabetTools::match(seq.getAlphabet(), seq.getValue(seqi + moti), motif.getValue(moti));
-      }
-      if (!match)
-      {
-        break;
-      }
-    }
-    if (match)
-    {
-      return seqi;
-    }
-  }
-  return seq.size();
+  MotifSearch search(motif, strict);
+  search.matchUnresolved(true);
+  MotifSearch::MatchIterator it(search, seq);
+  return it.hasMoreMatches() ? it.nextMatch().begin : seq.size();
 }
 
 /******************************************************************************/
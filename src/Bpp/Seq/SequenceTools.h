@@ -159,7 +159,7 @@ public:
   static std::unique_ptr<SequenceTypeOut> concatenate(const SequenceInterface& seq1, const SequenceInterface& seq2)
   {
     // Sequence's alphabets matching verification
-    if ((seq1.alphabet().getAlphabetType()) != (seq2.alphabet().getAlphabetType()))
+    if (!seq1.alphabet().isCompatibleWith(seq2.alphabet()))
       throw AlphabetMismatchException("SequenceTools::concatenate : Sequence's alphabets don't match ", seq1.getAlphabet(), seq2.getAlphabet());
 
     // Sequence's names matching verification
@@ -281,7 +281,7 @@ public:
   /**
    * @brief keep only complete sites in a sequence.
    *
-   * The deleteElement method of the Sequence object will be used where appropriate.
+   * The original sequence is cloned, and gaps and unresolved sites are removed from the copy.
    * @param seq The sequence to analyse.
    */
   static std::unique_ptr<SequenceInterface> getSequenceWithCompleteSites(const SequenceInterface& seq);
@@ -299,7 +299,7 @@ public:
   /**
    * @brief Remove gaps from a sequence.
    *
-   * The deleteElement method of the Sequence object will be used where appropriate.
+   * All gaps are removed in one pass, with the removeStates method of the sequence.
    * @param seq The sequence to analyse.
    */
   static void removeGaps(SequenceInterface& seq);
@@ -307,8 +307,7 @@ public:
   /**
    * @brief Get a copy of the sequence without gaps.
    *
-   * A whole new sequence will be created by adding all non-gap positions.
-   * The original sequence will be cloned to serve as a template.
+   * The original sequence is cloned, and gaps are removed from the copy.
    *
    * @param seq The sequence to analyse.
    * @return A new sequence object without gaps.
@@ -318,7 +317,7 @@ public:
   /**
    * @brief Remove stops from a codon sequence.
    *
-   * The deleteElement method of the Sequence object will be used where appropriate.
+   * All stops are removed in one pass, with the removeStates method of the sequence.
    * @param seq The sequence to analyse.
    * @param gCode The genetic code according to which stop codons are specified.
    * @throw Exception if the input sequence does not have a codon alphabet.
@@ -328,8 +327,7 @@ public:
   /**
    * @brief Get a copy of the codon sequence without stops.
    *
-   * A whole new sequence will be created by adding all non-stop positions.
-   * The original sequence will be cloned to serve as a template.
+   * The original sequence is cloned, and stops are removed from the copy.
    *
    * @param seq The sequence to analyse.
    * @param gCode The genetic code according to which stop codons are specified.
@@ -466,6 +464,9 @@ public:
   /**
    * @brief Find the position of a motif in a sequence
    *
+   * The sequence is scanned with a MotifSearch, in a single pass. Use a MotifSearch
+   * directly to find all the occurrences of many motifs, or on both strands.
+   *
    * @param seq The reference sequence
    * @param motif The motif to find
    * @param strict If true (default) find exactly the motif
@@ -86,7 +86,7 @@ void SequenceWithAnnotation::setToSizeL(size_t newSize)
 
 void SequenceWithAnnotation::append(const SequenceInterface& seq)
 {
-  if (seq.getAlphabet()->getAlphabetType() != getAlphabet()->getAlphabetType())
+  if (!seq.getAlphabet()->isCompatibleWith(*getAlphabet()))
     throw AlphabetMismatchException("SequenceWithAnnotation::append", getAlphabet(), seq.getAlphabet());
   IntSymbolListInsertionEvent event(this, content_.size(), seq.size());
   fireBeforeSequenceInserted(event);
@@ -166,7 +166,7 @@ vector<string> SequenceWithAnnotation::getAnnotationTypes() const
 void SequenceWithAnnotation::merge(const SequenceWithAnnotation& swa)
 {
   // Sequence's alphabets matching verification
-  if ((swa.getAlphabet()->getAlphabetType()) != (getAlphabet()->getAlphabetType()))
+  if (!swa.getAlphabet()->isCompatibleWith(*getAlphabet()))
     throw AlphabetMismatchException("SequenceWithAnnotation::merge: Sequence's alphabets don't match ", swa.getAlphabet(), getAlphabet());
 
   // Sequence's names matching verification
@@ -30,8 +30,7 @@ void SequenceMask::afterSequenceInserted(const IntSymbolListInsertionEvent& even
 
 void SequenceMask::afterSequenceDeleted(const IntSymbolListDeletionEvent& event)
 {
-  mask_.erase(mask_.begin() + static_cast<ptrdiff_t>(event.getPosition()),
-      mask_.begin() + static_cast<ptrdiff_t>(event.getPosition() + event.getLength()));
+  event.filter(mask_);
 }
 
 /******************************************************************************/
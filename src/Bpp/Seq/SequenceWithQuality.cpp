@@ -37,9 +37,7 @@ void SequenceQuality::afterSequenceInserted(const IntSymbolListInsertionEvent& e
 
 void SequenceQuality::afterSequenceDeleted(const IntSymbolListDeletionEvent& event)
 {
-  qualScores_.erase(
-      qualScores_.begin() + static_cast<ptrdiff_t>(event.getPosition()),
-      qualScores_.begin() + static_cast<ptrdiff_t>(event.getPosition() + event.getLength()));
+  event.filter(qualScores_);
 }
 
 /******************************************************************************/
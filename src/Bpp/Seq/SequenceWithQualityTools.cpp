@@ -18,7 +18,7 @@ unique_ptr<SequenceWithQuality> SequenceWithQualityTools::concatenate(
     const SequenceWithQuality& seqwq2)
 {
   // Sequence's alphabets matching verification
-  if ((seqwq1.getAlphabet()->getAlphabetType()) != (seqwq2.getAlphabet()->getAlphabetType()))
+  if (!seqwq1.getAlphabet()->isCompatibleWith(*seqwq2.getAlphabet()))
     throw AlphabetMismatchException("SequenceTools::concatenate : Sequence's alphabets don't match ", seqwq1.getAlphabet(), seqwq2.getAlphabet());
 
   // Sequence's names matching verification
@@ -236,22 +236,11 @@ double StringSequenceTools::getGCcontent(const string& sequence, size_t pos, siz
 
 vector<int> StringSequenceTools::codeSequence(const string& sequence, std::shared_ptr<const Alphabet>& alphabet)
 {
-  unsigned int size = AlphabetTools::getAlphabetCodingSize(*alphabet); // Warning,
-                                                                       // an
-                                                                       // exception
-                                                                       // may
-                                                                       // be
-                                                                       // casted
-                                                                       // here!
-  vector<int> code(static_cast<size_t>(floor(static_cast<double>(sequence.size()) / static_cast<double>(size))));
-  size_t pos = 0;
-  size_t count = 0;
-  while (pos + size <= sequence.size())
-  {
-    code[count] = alphabet->charToInt(sequence.substr(pos, size));
-    count++;
-    pos += size;
-  }
+  // Warning, an exception may be thrown here!
+  unsigned int size = AlphabetTools::getAlphabetCodingSize(*alphabet);
+  // Incomplete trailing states are ignored:
+  vector<int> code(sequence.size() / size);
+  alphabet->encode(sequence.data(), code.size() * size, code.data());
   return code;
 }
 
@@ -260,9 +249,17 @@ vector<int> StringSequenceTools::codeSequence(const string& sequence, std::share
 string StringSequenceTools::decodeSequence(const vector<int>& sequence, std::shared_ptr<const Alphabet>& alphabet)
 {
   string result = "";
-  for (auto i : sequence)
+  if (AlphabetTools::checkAlphabetCodingSize(*alphabet))
   {
-    result += alphabet->intToChar(i);
+    result.resize(sequence.size() * alphabet->getStateCodingSize());
+    alphabet->decode(sequence.data(), sequence.size(), &result[0]);
+  }
+  else
+  {
+    for (auto i : sequence)
+    {
+      result += alphabet->decodeState(i);
+    }
   }
   return result;
 }
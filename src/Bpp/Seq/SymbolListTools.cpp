@@ -5,13 +5,15 @@
 #include <Bpp/Numeric/NumTools.h>
 #include <Bpp/Numeric/Random/RandomTools.h>
 #include <Bpp/Numeric/VectorTools.h>
-#include <Bpp/Utils/MapTools.h>
 
 #include "Alphabet/AlphabetTools.h"
 #include "SymbolListTools.h"
 
 // From the STL:
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 
 using namespace std;
 
@@ -218,7 +220,7 @@ bool SymbolListTools::areSymbolListsIdentical(
     const IntSymbolListInterface& list2)
 {
   // IntCoreSymbolList's size and content checking
-  if (list1.getAlphabet()->getAlphabetType() != list2.getAlphabet()->getAlphabetType())
+  if (!list1.getAlphabet()->isCompatibleWith(*list2.getAlphabet()))
     return false;
   if (list1.size() != list2.size())
     return false;
@@ -238,7 +240,7 @@ bool SymbolListTools::areSymbolListsIdentical(
     const ProbabilisticSymbolListInterface& list2)
 {
   // IntCoreSymbolList's size and content checking
-  if (list1.getAlphabet()->getAlphabetType() != list2.getAlphabet()->getAlphabetType())
+  if (!list1.getAlphabet()->isCompatibleWith(*list2.getAlphabet()))
     return false;
   if (list1.size() != list2.size())
     return false;
@@ -412,6 +414,218 @@ void SymbolListTools::getFrequencies(
   }
 }
 
+int SymbolListTools::getDenseCountsOffset(const Alphabet& alphabet)
+{
+  const vector<int>& states = alphabet.getSupportedInts();
+  return *min_element(states.begin(), states.end());
+}
+
+size_t SymbolListTools::getDenseCountsSize(const Alphabet& alphabet)
+{
+  const vector<int>& states = alphabet.getSupportedInts();
+  auto range = minmax_element(states.begin(), states.end());
+  return static_cast<size_t>(*range.second - *range.first + 1);
+}
+
+void SymbolListTools::getDenseCounts(
+    const ProbabilisticSymbolListInterface& list,
+    vector<double>& counts)
+{
+  const Alphabet& alphabet = *list.getAlphabet();
+  size_t size = getDenseCountsSize(alphabet);
+  if (counts.size() < size)
+    counts.resize(size);
+  // Probabilities of state j are in column j:
+  double* c = counts.data() - getDenseCountsOffset(alphabet);
+  for (size_t i = 0; i < list.size(); ++i)
+  {
+    const vector<double>& p = list[i];
+    for (size_t j = 0; j < p.size(); ++j)
+    {
+      c[j] += p[j];
+    }
+  }
+}
+
+void SymbolListTools::getDenseCountsResolveUnknowns(
+    const IntSymbolListInterface& list,
+    vector<double>& counts)
+{
+  const Alphabet& alphabet = *list.getAlphabet();
+  int offset = getDenseCountsOffset(alphabet);
+  size_t size = getDenseCountsSize(alphabet);
+  if (counts.size() < size)
+    counts.resize(size);
+
+  // Count the states first, so that the aliases of each state are computed only once:
+  vector<size_t> raw;
+  getDenseCounts(list, raw);
+  for (size_t k = 0; k < size; ++k)
+  {
+    if (raw[k] == 0)
+      continue;
+    vector<int> alias = alphabet.getAlias(static_cast<int>(k) + offset);
+    double n = static_cast<double>(raw[k]) / static_cast<double>(alias.size());
+    for (int state : alias)
+    {
+      counts[static_cast<size_t>(state - offset)] += n;
+    }
+  }
+}
+
+void SymbolListTools::getDenseCountsResolveUnknowns(
+    const ProbabilisticSymbolListInterface& list,
+    vector<double>& counts)
+{
+  const Alphabet& alphabet = *list.getAlphabet();
+  size_t size = getDenseCountsSize(alphabet);
+  if (counts.size() < size)
+    counts.resize(size);
+  double* c = counts.data() - getDenseCountsOffset(alphabet);
+  for (size_t i = 0; i < list.size(); ++i)
+  {
+    const vector<double>& p = list[i];
+    double s = VectorTools::sum(p);
+    if (s != 0)
+    {
+      for (size_t j = 0; j < p.size(); ++j)
+      {
+        c[j] += p[j] / s;
+      }
+    }
+  }
+}
+
+void SymbolListTools::getDenseCounts(
+    const CruxSymbolListInterface& list,
+    vector<double>& counts,
+    bool resolveUnknowns)
+{
+  auto intList = dynamic_cast<const IntSymbolListInterface*>(&list);
+  if (intList)
+  {
+    if (resolveUnknowns)
+      getDenseCountsResolveUnknowns(*intList, counts);
+    else
+      getDenseCounts(*intList, counts);
+    return;
+  }
+  auto probList = dynamic_cast<const ProbabilisticSymbolListInterface*>(&list);
+  if (probList)
+  {
+    if (resolveUnknowns)
+      getDenseCountsResolveUnknowns(*probList, counts);
+    else
+      getDenseCounts(*probList, counts);
+    return;
+  }
+  throw Exception("SymbolListTools::getDenseCounts : unsupported CruxSymbolListInterface implementation (" + std::string(typeid(list).name()) + ").");
+}
+
+void SymbolListTools::getDenseCounts(
+    const CruxSymbolListInterface& list1,
+    const CruxSymbolListInterface& list2,
+    vector<double>& counts,
+    bool resolveUnknowns)
+{
+  if (list1.size() != list2.size())
+    throw DimensionException("SymbolListTools::getDenseCounts: the two lists must have the same size.", list1.size(), list2.size());
+  const Alphabet& alphabet1 = *list1.getAlphabet();
+  const Alphabet& alphabet2 = *list2.getAlphabet();
+  int offset1 = getDenseCountsOffset(alphabet1);
+  int offset2 = getDenseCountsOffset(alphabet2);
+  size_t size1 = getDenseCountsSize(alphabet1);
+  size_t size2 = getDenseCountsSize(alphabet2);
+  if (counts.size() < size1 * size2)
+    counts.resize(size1 * size2);
+
+  auto intList1 = dynamic_cast<const IntSymbolListInterface*>(&list1);
+  auto intList2 = dynamic_cast<const IntSymbolListInterface*>(&list2);
+  if (intList1 && intList2)
+  {
+    // Count pairs of states first, then resolve them if needed:
+    const vector<int>& content1 = intList1->getContent();
+    const vector<int>& content2 = intList2->getContent();
+    vector<size_t> raw(size1 * size2);
+    for (size_t i = 0; i < content1.size(); ++i)
+    {
+      raw[static_cast<size_t>(content1[i] - offset1) * size2 + static_cast<size_t>(content2[i] - offset2)]++;
+    }
+    vector< vector<int> > aliases1(size1), aliases2(size2);
+    for (size_t x = 0; x < size1; ++x)
+    {
+      for (size_t y = 0; y < size2; ++y)
+      {
+        size_t n = raw[x * size2 + y];
+        if (n == 0)
+          continue;
+        if (!resolveUnknowns)
+        {
+          counts[x * size2 + y] += static_cast<double>(n);
+          continue;
+        }
+        if (aliases1[x].empty())
+          aliases1[x] = alphabet1.getAlias(static_cast<int>(x) + offset1);
+        if (aliases2[y].empty())
+          aliases2[y] = alphabet2.getAlias(static_cast<int>(y) + offset2);
+        double c = static_cast<double>(n) / static_cast<double>(aliases1[x].size() * aliases2[y].size());
+        for (int s1 : aliases1[x])
+        {
+          for (int s2 : aliases2[y])
+          {
+            counts[static_cast<size_t>(s1 - offset1) * size2 + static_cast<size_t>(s2 - offset2)] += c;
+          }
+        }
+      }
+    }
+    return;
+  }
+
+  auto probList1 = dynamic_cast<const ProbabilisticSymbolListInterface*>(&list1);
+  auto probList2 = dynamic_cast<const ProbabilisticSymbolListInterface*>(&list2);
+  if (probList1 && probList2)
+  {
+    for (size_t i = 0; i < list1.size(); ++i)
+    {
+      const vector<double>& p1 = (*probList1)[i];
+      const vector<double>& p2 = (*probList2)[i];
+      double s = 1.;
+      if (resolveUnknowns)
+      {
+        s = VectorTools::sum(p1) * VectorTools::sum(p2);
+        if (s == 0)
+          continue;
+      }
+      for (size_t j = 0; j < p1.size(); ++j)
+      {
+        double* row = &counts[static_cast<size_t>(static_cast<int>(j) - offset1) * size2] - offset2;
+        for (size_t k = 0; k < p2.size(); ++k)
+        {
+          row[k] += p1[j] * p2[k] / s;
+        }
+      }
+    }
+    return;
+  }
+  throw Exception("SymbolListTools::getDenseCounts : unsupported CruxSymbolListInterface implementation (" + std::string(typeid(list1).name()) + ", " + std::string(typeid(list2).name()) + ").");
+}
+
+void SymbolListTools::getDenseFrequencies(
+    const CruxSymbolListInterface& list,
+    vector<double>& frequencies,
+    bool resolveUnknowns)
+{
+  frequencies.assign(getDenseCountsSize(*list.getAlphabet()), 0.);
+  if (list.size() == 0)
+    return;
+  getDenseCounts(list, frequencies, resolveUnknowns);
+  double n = static_cast<double>(list.size());
+  for (auto& f : frequencies)
+  {
+    f /= n;
+  }
+}
+
 double SymbolListTools::getGCContent(
     const IntSymbolListInterface& list,
     bool ignoreUnresolved,
@@ -470,7 +684,7 @@ size_t SymbolListTools::getNumberOfDistinctPositions(
     const IntSymbolListInterface& l1,
     const IntSymbolListInterface& l2)
 {
-  if (l1.getAlphabet()->getAlphabetType() != l2.getAlphabet()->getAlphabetType())
+  if (!l1.getAlphabet()->isCompatibleWith(*l2.getAlphabet()))
     throw AlphabetMismatchException("SymbolListTools::getNumberOfDistinctPositions.", l1.getAlphabet(), l2.getAlphabet());
   size_t n = min(l1.size(), l2.size());
   size_t count = 0;
@@ -486,7 +700,7 @@ size_t SymbolListTools::getNumberOfPositionsWithoutGap(
     const IntSymbolListInterface& l1,
     const IntSymbolListInterface& l2)
 {
-  if (l1.getAlphabet()->getAlphabetType() != l2.getAlphabet()->getAlphabetType())
+  if (!l1.getAlphabet()->isCompatibleWith(*l2.getAlphabet()))
     throw AlphabetMismatchException("SymbolListTools::getNumberOfDistinctPositions.", l1.getAlphabet(), l2.getAlphabet());
   size_t n = min(l1.size(), l2.size());
   size_t count = 0;
@@ -582,7 +796,7 @@ size_t SymbolListTools::getNumberOfDistinctPositions(
     const ProbabilisticSymbolListInterface& l1,
     const ProbabilisticSymbolListInterface& l2)
 {
-  if (l1.getAlphabet()->getAlphabetType() != l2.getAlphabet()->getAlphabetType())
+  if (!l1.getAlphabet()->isCompatibleWith(*l2.getAlphabet()))
     throw AlphabetMismatchException("SymbolListTools::getNumberOfDistinctPositions.", l1.getAlphabet(), l2.getAlphabet());
 
   size_t n = min(l1.size(), l2.size());
@@ -599,7 +813,7 @@ size_t SymbolListTools::getNumberOfPositionsWithoutGap(
     const ProbabilisticSymbolListInterface& l1,
     const ProbabilisticSymbolListInterface& l2)
 {
-  if (l1.getAlphabet()->getAlphabetType() != l2.getAlphabet()->getAlphabetType())
+  if (!l1.getAlphabet()->isCompatibleWith(*l2.getAlphabet()))
     throw AlphabetMismatchException("SymbolListTools::getNumberOfDistinctPositions.", l1.getAlphabet(), l2.getAlphabet());
   size_t n = min(l1.size(), l2.size());
   size_t count = 0;
@@ -637,13 +851,14 @@ double SymbolListTools::variabilityShannon(
   if (list.size() == 0)
     throw Exception("SymbolListTools::variabilityShannon: Incorrect specified list, size must be > 0.");
 
-  map<int, double> p;
-  getFrequencies(list, p, resolveUnknown);
+  vector<double> p;
+  getDenseFrequencies(list, p, resolveUnknown);
   // We need to correct frequencies for gaps:
   double s = 0.;
+  int offset = getDenseCountsOffset(*list.getAlphabet());
   for (int i = 0; i < static_cast<int>(list.getAlphabet()->getSize()); i++)
   {
-    double f = p[i];
+    double f = p[static_cast<size_t>(i - offset)];
     if (f > 0)
       s += f * log(f);
   }
@@ -667,15 +882,18 @@ double SymbolListTools::mutualInformation(
     throw DimensionException("SymbolListTools::mutualInformation: lists must have the same size!", list1.size(), list2.size());
   vector<double> p1(list1.getAlphabet()->getSize());
   vector<double> p2(list2.getAlphabet()->getSize());
-  map<int, map<int, double>> p12;
-  getCounts(list1, list2, p12, resolveUnknown);
+  vector<double> p12;
+  getDenseCounts(list1, list2, p12, resolveUnknown);
+  size_t offset1 = static_cast<size_t>(-getDenseCountsOffset(*list1.getAlphabet()));
+  size_t offset2 = static_cast<size_t>(-getDenseCountsOffset(*list2.getAlphabet()));
+  size_t size2 = getDenseCountsSize(*list2.getAlphabet());
   double mi = 0, tot = 0, pxy;
   // We need to correct frequencies for gaps:
   for (size_t i = 0; i < list1.getAlphabet()->getSize(); i++)
   {
     for (size_t j = 0; j < list2.getAlphabet()->getSize(); j++)
     {
-      pxy = p12[static_cast<int>(i)][static_cast<int>(j)];
+      pxy = p12[(i + offset1) * size2 + j + offset2];
       tot += pxy;
       p1[i] += pxy;
       p2[j] += pxy;
@@ -693,7 +911,7 @@ double SymbolListTools::mutualInformation(
   {
     for (size_t j = 0; j < list2.getAlphabet()->getSize(); j++)
     {
-      pxy = p12[static_cast<int>(i)][static_cast<int>(j)] / tot;
+      pxy = p12[(i + offset1) * size2 + j + offset2] / tot;
       if (pxy > 0)
         mi += pxy * log(pxy / (p1[i] * p2[j]));
     }
@@ -715,15 +933,18 @@ double SymbolListTools::jointEntropy(
     throw Exception("SymbolListTools::jointEntropy: Incorrect specified list, size must be > 0");
   if (list1.size() != list2.size())
     throw DimensionException("SymbolListTools::jointEntropy: lists must have the same size!", list1.size(), list2.size());
-  map<int, map<int, double>> p12;
-  getCounts(list1, list2, p12, resolveUnknown);
+  vector<double> p12;
+  getDenseCounts(list1, list2, p12, resolveUnknown);
+  size_t offset1 = static_cast<size_t>(-getDenseCountsOffset(*list1.getAlphabet()));
+  size_t offset2 = static_cast<size_t>(-getDenseCountsOffset(*list2.getAlphabet()));
+  size_t size2 = getDenseCountsSize(*list2.getAlphabet());
   double tot = 0, pxy, h = 0;
   // We need to correct frequencies for gaps:
   for (size_t i = 0; i < list1.getAlphabet()->getSize(); ++i)
   {
     for (size_t j = 0; j < list2.getAlphabet()->getSize(); ++j)
     {
-      pxy = p12[static_cast<int>(i)][static_cast<int>(j)];
+      pxy = p12[(i + offset1) * size2 + j + offset2];
       tot += pxy;
     }
   }
@@ -731,7 +952,7 @@ double SymbolListTools::jointEntropy(
   {
     for (size_t j = 0; j < list2.getAlphabet()->getSize(); ++j)
     {
-      pxy = p12[static_cast<int>(i)][static_cast<int>(j)] / tot;
+      pxy = p12[(i + offset1) * size2 + j + offset2] / tot;
       if (pxy > 0)
         h += pxy * log(pxy);
     }
@@ -747,9 +968,11 @@ double SymbolListTools::variabilityFactorial(
   // Empty list checking
   if (list.size() == 0)
     throw Exception("SymbolListTools::variabilityFactorial: Incorrect specified list, size must be > 0");
-  map<int, size_t> p;
-  getCounts(list, p);
-  vector<size_t> c = MapTools::getValues(p);
+  vector<size_t> p;
+  getDenseCounts(list, p);
+  // Only observed states are considered:
+  vector<size_t> c;
+  copy_if(p.begin(), p.end(), back_inserter(c), [](size_t n) { return n > 0; });
   size_t s = VectorTools::sum(c);
   long double l = static_cast<long double>(NumTools::fact(s)) / static_cast<long double>(VectorTools::sum(VectorTools::fact(c)));
   return static_cast<double>(std::log(l));
@@ -762,10 +985,9 @@ double SymbolListTools::heterozygosity(const CruxSymbolListInterface& list)
   // Empty list checking
   if (list.size() == 0)
     throw Exception("SymbolListTools::heterozygosity: Incorrect specified list, size must be > 0");
-  map<int, double> p;
-  getFrequencies(list, p);
-  vector<double> c = MapTools::getValues(p);
-  double n = VectorTools::norm<double, double>(MapTools::getValues(p));
+  vector<double> p;
+  getDenseFrequencies(list, p);
+  double n = VectorTools::norm<double, double>(p);
   return 1. - n * n;
 }
 
@@ -779,15 +1001,9 @@ size_t SymbolListTools::getNumberOfDistinctCharacters(const IntSymbolListInterfa
   // For all list's characters
   if (SymbolListTools::isConstant(list))
     return 1;
-  map<int, size_t> counts;
-  SymbolListTools::getCounts(list, counts);
-  size_t s = 0;
-  for (map<int, size_t>::iterator it = counts.begin(); it != counts.end(); it++)
-  {
-    if (it->second != 0)
-      s++;
-  }
-  return s;
+  vector<size_t> counts;
+  SymbolListTools::getDenseCounts(list, counts);
+  return static_cast<size_t>(count_if(counts.begin(), counts.end(), [](size_t n) { return n != 0; }));
 }
 
 /******************************************************************************/
@@ -800,16 +1016,9 @@ size_t SymbolListTools::getMajorAlleleFrequency(const IntSymbolListInterface& li
   // For all list's characters
   if (SymbolListTools::isConstant(list))
     return list.size();
-  map<int, size_t> counts;
-  getCounts(list, counts);
-  size_t s = 0;
-  for (map<int, size_t>::iterator it = counts.begin(); it != counts.end(); it++)
-  {
-    if (it->second != 0)
-      if (it->second > s)
-        s = it->second;
-  }
-  return s;
+  vector<size_t> counts;
+  getDenseCounts(list, counts);
+  return *max_element(counts.begin(), counts.end());
 }
 
 /******************************************************************************/
@@ -823,18 +1032,18 @@ int SymbolListTools::getMajorAllele(const CruxSymbolListInterface& list)
   if (dynamic_cast<const IntSymbolListInterface*>(&list) && SymbolListTools::isConstant(list))
     return (dynamic_cast<const IntSymbolListInterface&>(list))[0];
 
-  map<int, double> counts;
-  SymbolListTools::getCounts(list, counts);
+  vector<double> counts;
+  SymbolListTools::getDenseCounts(list, counts);
+  int offset = getDenseCountsOffset(*list.getAlphabet());
   double s = 0;
   int ma = -100;
-  for (auto it : counts)
+  for (size_t k = 0; k < counts.size(); ++k)
   {
-    if (it.second != 0)
-      if (it.second > s)
-      {
-        s = it.second;
-        ma = it.first;
-      }
+    if (counts[k] > s)
+    {
+      s = counts[k];
+      ma = static_cast<int>(k) + offset;
+    }
   }
   return ma;
 }
@@ -849,14 +1058,13 @@ size_t SymbolListTools::getMinorAlleleFrequency(const IntSymbolListInterface& li
   // For all list's characters
   if (SymbolListTools::isConstant(list))
     return list.size();
-  map<int, size_t> counts;
-  SymbolListTools::getCounts(list, counts);
+  vector<size_t> counts;
+  SymbolListTools::getDenseCounts(list, counts);
   size_t s = list.size();
-  for (auto it : counts)
+  for (size_t n : counts)
   {
-    if (it.second != 0)
-      if (it.second < s)
-        s = it.second;
+    if (n != 0 && n < s)
+      s = n;
   }
   return s;
 }
@@ -871,18 +1079,18 @@ int SymbolListTools::getMinorAllele(const CruxSymbolListInterface& list)
   // For all list's characters
   if (dynamic_cast<const IntSymbolListInterface*>(&list) && SymbolListTools::isConstant(list))
     return (dynamic_cast<const IntSymbolListInterface&>(list))[0];
-  map<int, double> counts;
-  SymbolListTools::getCounts(list, counts);
+  vector<double> counts;
+  SymbolListTools::getDenseCounts(list, counts);
+  int offset = getDenseCountsOffset(*list.getAlphabet());
   double s = (double)list.size();
   int ma = -100;
-  for (auto it : counts)
+  for (size_t k = 0; k < counts.size(); ++k)
   {
-    if (it.second != 0)
-      if (it.second < s)
-      {
-        s = it.second;
-        ma = it.first;
-      }
+    if (counts[k] != 0 && counts[k] < s)
+    {
+      s = counts[k];
+      ma = static_cast<int>(k) + offset;
+    }
   }
   return ma;
 }
@@ -897,14 +1105,9 @@ bool SymbolListTools::hasSingleton(const IntSymbolListInterface& list)
   // For all list's characters
   if (SymbolListTools::isConstant(list))
     return false;
-  map<int, size_t> counts;
-  getCounts(list, counts);
-  for (map<int, size_t>::iterator it = counts.begin(); it != counts.end(); it++)
-  {
-    if (it->second == 1)
-      return true;
-  }
-  return false;
+  vector<size_t> counts;
+  getDenseCounts(list, counts);
+  return find(counts.begin(), counts.end(), 1) != counts.end();
 }
 
 /******************************************************************************/
@@ -917,14 +1120,9 @@ bool SymbolListTools::isParsimonyInformativeSite(const IntSymbolListInterface& l
   // For all list's characters
   if (SymbolListTools::isConstant(list, false, false))
     return false;
-  map<int, size_t> counts;
-  SymbolListTools::getCounts(list, counts);
-  size_t npars = 0;
-  for (map<int, size_t>::iterator it = counts.begin(); it != counts.end(); it++)
-  {
-    if (it->second > 1)
-      npars++;
-  }
+  vector<size_t> counts;
+  SymbolListTools::getDenseCounts(list, counts);
+  size_t npars = static_cast<size_t>(count_if(counts.begin(), counts.end(), [](size_t n) { return n > 1; }));
   if (npars > 1)
     return true;
   return false;
@@ -953,3 +1151,42 @@ bool SymbolListTools::isDoubleton(const IntSymbolListInterface& list)
 }
 
 /******************************************************************************/
+
+/******************************************************************************/
+
+namespace
+{
+uint64_t mixHash(uint64_t h, uint64_t value)
+{
+  h = (h ^ value) * 0xFF51AFD7ED558CCDULL;
+  return h ^ (h >> 32);
+}
+}
+
+size_t SymbolListTools::getContentHash(const IntSymbolListInterface& list)
+{
+  const vector<int>& content = list.getContent();
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ content.size();
+  for (int state : content)
+  {
+    h = mixHash(h, static_cast<uint32_t>(state));
+  }
+  return static_cast<size_t>(h);
+}
+
+size_t SymbolListTools::getContentHash(const ProbabilisticSymbolListInterface& list)
+{
+  const vector<vector<double>>& content = list.getContent();
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ content.size();
+  for (const auto& values : content)
+  {
+    h = mixHash(h, values.size());
+    for (double value : values)
+    {
+      uint64_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      h = mixHash(h, bits);
+    }
+  }
+  return static_cast<size_t>(h);
+}
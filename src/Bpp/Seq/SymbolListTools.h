@@ -13,6 +13,7 @@
 
 // From the STL:
 #include <map>
+#include <vector>
 
 namespace bpp
 {
@@ -580,6 +581,134 @@ public:
       std::map<int, std::map<int, double>>& frequencies,
       bool resolveUnknowns = false);
 
+  /**
+   * @name Dense counts.
+   *
+   * These functions store counts in vectors, where the count of state \f$s\f$
+   * is at index \f$s - o\f$, \f$o\f$ being the smallest state of the alphabet
+   * (-1 for the gap in most alphabets, see getDenseCountsOffset). As alphabets
+   * are small, this is much faster than counting in maps, in particular when
+   * counts are computed for every site of an alignment.
+   *
+   * Unlike their map counterparts, output vectors contain all the states of the
+   * alphabet, with a count of zero if they are not observed.
+   *
+   * @{
+   */
+
+  /**
+   * @return The smallest state of an alphabet, which is the offset of dense counts.
+   * @param alphabet The alphabet.
+   */
+  static int getDenseCountsOffset(const Alphabet& alphabet);
+
+  /**
+   * @return The size of the vectors of dense counts, that is, the number of
+   * integers between the smallest and the largest states of an alphabet.
+   * @param alphabet The alphabet.
+   */
+  static size_t getDenseCountsSize(const Alphabet& alphabet);
+
+  /**
+   * @brief Count all states in the list.
+   *
+   * @param list The list.
+   * @param counts The output vector to store the counts (existing counts will be incremented).
+   */
+  template<class count_type>
+  static void getDenseCounts(
+      const IntSymbolListInterface& list,
+      std::vector<count_type>& counts)
+  {
+    const Alphabet& alphabet = *list.getAlphabet();
+    size_t size = getDenseCountsSize(alphabet);
+    if (counts.size() < size)
+      counts.resize(size);
+    const std::vector<int>& content = list.getContent();
+    countStates_(content.data(), content.size(), getDenseCountsOffset(alphabet), size, counts.data());
+  }
+
+  /**
+   * @brief Sum all states in the list.
+   *
+   * @param list The list.
+   * @param counts The output vector to store the sums (existing counts will be summed).
+   */
+  static void getDenseCounts(
+      const ProbabilisticSymbolListInterface& list,
+      std::vector<double>& counts);
+
+  /**
+   * @brief Count all states in the list normalizing unknown characters.
+   *
+   * For instance, in DNA, N will be counted as A=1/4,T=1/4,C=1/4,G=1/4.
+   *
+   * @param list The list.
+   * @param counts The output vector to store the counts (existing counts will be incremented).
+   */
+  static void getDenseCountsResolveUnknowns(
+      const IntSymbolListInterface& list,
+      std::vector<double>& counts);
+
+  /**
+   * @brief Count all states in the list normalizing unknown characters.
+   *
+   * For instance, (1,1,1,1) will be counted as (1/4,1/4,1/4,1/4).
+   *
+   * @param list The list.
+   * @param counts The output vector to store the counts (existing counts will be incremented).
+   */
+  static void getDenseCountsResolveUnknowns(
+      const ProbabilisticSymbolListInterface& list,
+      std::vector<double>& counts);
+
+  /**
+   * @brief Count all states in the list, optionally resolving unknown characters.
+   *
+   * @param list The list.
+   * @param counts The output vector to store the counts (existing counts will be incremented).
+   * @param resolveUnknowns Tell is unknown characters must be resolved.
+   */
+  static void getDenseCounts(
+      const CruxSymbolListInterface& list,
+      std::vector<double>& counts,
+      bool resolveUnknowns = false);
+
+  /**
+   * @brief Count all pairs of states for two lists of the same size, optionally resolving unknown characters.
+   *
+   * The two lists do not need to share the same alphabet. The counts are stored
+   * as a matrix by rows, with one row per state of the first alphabet and one
+   * column per state of the second alphabet, that is, the count of the pair
+   * \f$(s_1, s_2)\f$ is at index \f$(s_1 - o_1) \times n_2 + s_2 - o_2\f$,
+   * where \f$n_2\f$ is the dense counts size of the second alphabet.
+   *
+   * @param list1 The first list.
+   * @param list2 The second list.
+   * @param counts The output vector to store the counts (existing counts will be incremented).
+   * @param resolveUnknowns Tell is unknown characters must be resolved.
+   * @throw DimensionException If the lists do not have the same size.
+   */
+  static void getDenseCounts(
+      const CruxSymbolListInterface& list1,
+      const CruxSymbolListInterface& list2,
+      std::vector<double>& counts,
+      bool resolveUnknowns = false);
+
+  /**
+   * @brief Get all states frequencies in the list.
+   *
+   * @param list The list.
+   * @param frequencies The output vector with the frequencies of all states. Existing frequencies will be erased if any. Frequencies are all 0 for an empty list.
+   * @param resolveUnknowns Tell is unknown characters must be resolved.
+   */
+  static void getDenseFrequencies(
+      const CruxSymbolListInterface& list,
+      std::vector<double>& frequencies,
+      bool resolveUnknowns = false);
+
+  /** @} */
+
   /**
    * @brief Get the GC content of a symbol list.
    *
@@ -692,6 +821,18 @@ public:
     throw Exception("SymbolListTools::getNumberOfPositionsWithoutGap : unsupported CruxSymbolListInterface implementation.");
   }
 
+  /**
+   * @brief Hash the content of a list, for hash tables of lists.
+   *
+   * Lists with identical contents get the same hash. Alphabets are not taken into account.
+   *
+   * @param list The input list of characters.
+   * @return The hash of the content of the list.
+   */
+  static size_t getContentHash(const IntSymbolListInterface& list);
+
+  static size_t getContentHash(const ProbabilisticSymbolListInterface& list);
+
   /**
    * @brief Change all gap elements to unknown characters (or
    * columns of 1).
@@ -922,6 +1063,52 @@ public:
    * @return True if the site has exactly 2 distinct characters
    */
   static bool isDoubleton(const IntSymbolListInterface& list);
+
+private:
+  /**
+   * @brief Increment the dense counts of an array of states.
+   *
+   * Long arrays are counted in several interleaved histograms, so that
+   * successive identical states do not wait for each other's increment.
+   */
+  template<class count_type>
+  static void countStates_(
+      const int* states,
+      size_t nbStates,
+      int offset,
+      size_t size,
+      count_type* counts)
+  {
+    if (nbStates < 4 * size)
+    {
+      for (size_t i = 0; i < nbStates; ++i)
+      {
+        counts[states[i] - offset]++;
+      }
+      return;
+    }
+    std::vector<size_t> histograms(4 * size);
+    size_t* h0 = histograms.data();
+    size_t* h1 = h0 + size;
+    size_t* h2 = h1 + size;
+    size_t* h3 = h2 + size;
+    size_t i = 0;
+    for ( ; i + 4 <= nbStates; i += 4)
+    {
+      h0[states[i] - offset]++;
+      h1[states[i + 1] - offset]++;
+      h2[states[i + 2] - offset]++;
+      h3[states[i + 3] - offset]++;
+    }
+    for ( ; i < nbStates; ++i)
+    {
+      h0[states[i] - offset]++;
+    }
+    for (size_t k = 0; k < size; ++k)
+    {
+      counts[k] += static_cast<count_type>(h0[k] + h1[k] + h2[k] + h3[k]);
+    }
+  }
 };
 } // end of namespace bpp.
 #endif // BPP_SEQ_SYMBOLLISTTOOLS_H
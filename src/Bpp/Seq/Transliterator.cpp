@@ -12,7 +12,7 @@ using namespace bpp;
 
 unique_ptr<Sequence> AbstractTransliterator::translate(const SequenceInterface& sequence) const
 {
-  if (sequence.alphabet().getAlphabetType() != sourceAlphabet().getAlphabetType())
+  if (!sequence.alphabet().isCompatibleWith(sourceAlphabet()))
     throw AlphabetMismatchException("AbstractTransliterator::translate", getSourceAlphabet(), getTargetAlphabet());
   auto alphaPtr = getTargetAlphabet();
   auto tSeq = make_unique<Sequence>(sequence.getName(), "", sequence.getComments(), alphaPtr);
@@ -30,7 +30,7 @@ unique_ptr<Sequence> AbstractTransliterator::translate(const SequenceInterface&
 
 unique_ptr<Sequence> AbstractReverseTransliterator::reverse(const SequenceInterface& sequence) const
 {
-  if (sequence.alphabet().getAlphabetType() != targetAlphabet().getAlphabetType())
+  if (!sequence.alphabet().isCompatibleWith(targetAlphabet()))
     throw AlphabetMismatchException("AbstractReverseTransliterator::reverse", getSourceAlphabet(), getTargetAlphabet());
   auto alphaPtr = getSourceAlphabet();
   auto rSeq = make_unique<Sequence>(sequence.getName(), "", sequence.getComments(), alphaPtr);
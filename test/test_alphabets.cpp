@@ -8,12 +8,83 @@
 #include <Bpp/Seq/Alphabet/DefaultAlphabet.h>
 #include <Bpp/Seq/Alphabet/CodonAlphabet.h>
 #include <Bpp/Seq/Alphabet/AllelicAlphabet.h>
+#include <Bpp/Seq/Alphabet/WordAlphabet.h>
+#include <Bpp/Seq/Alphabet/RNY.h>
+#include <Bpp/Seq/Alphabet/IntegerAlphabet.h>
 #include <Bpp/Seq/Alphabet/AlphabetTools.h>
 #include <iostream>
+#include <map>
 
 using namespace bpp;
 using namespace std;
 
+// Check that conversions match the registered states.
+bool testConversions(const AbstractAlphabet& alphabet)
+{
+  map<int, string> firstLetters;
+  for (size_t i = 0; i < alphabet.getNumberOfStates(); ++i)
+  {
+    const AlphabetState& st = alphabet.getStateAt(i);
+    if (alphabet.charToInt(st.getLetter()) != st.getNum() || alphabet.encodeState(st.getLetter()) != st.getNum())
+    {
+      cerr << alphabet.getAlphabetType() << ": wrong code for " << st.getLetter() << endl;
+      return false;
+    }
+    if (alphabet.getStateIndex(st.getLetter()) != i)
+      return false;
+    firstLetters.insert(make_pair(st.getNum(), st.getLetter()));
+  }
+  for (const auto& it : firstLetters)
+  {
+    if (alphabet.intToChar(it.first) != it.second || alphabet.decodeState(it.first) != it.second)
+    {
+      cerr << alphabet.getAlphabetType() << ": wrong letter for " << it.first << endl;
+      return false;
+    }
+  }
+  if (alphabet.isIntInAlphabet(firstLetters.rbegin()->first + 1))
+    return false;
+  if (alphabet.isCharInAlphabet("#"))
+    return false;
+  return true;
+}
+
+// Check bulk conversions against state by state ones.
+bool testBulkConversions(const Alphabet& alphabet, const string& text)
+{
+  size_t size = alphabet.getStateCodingSize();
+  vector<int> codes(text.size() / size);
+  alphabet.encode(text.data(), text.size(), codes.data());
+  for (size_t i = 0; i < codes.size(); ++i)
+  {
+    if (codes[i] != alphabet.charToInt(text.substr(i * size, size)))
+    {
+      cerr << alphabet.getAlphabetType() << ": wrong bulk code at " << i << endl;
+      return false;
+    }
+  }
+  string decoded(codes.size() * size, ' ');
+  alphabet.decode(codes.data(), codes.size(), &decoded[0]);
+  for (size_t i = 0; i < codes.size(); ++i)
+  {
+    if (decoded.substr(i * size, size) != alphabet.intToChar(codes[i]))
+    {
+      cerr << alphabet.getAlphabetType() << ": wrong bulk letter at " << i << endl;
+      return false;
+    }
+  }
+  // Errors must be reported, including within vectorized blocks:
+  string bad = text;
+  bad[bad.size() / 2] = '#';
+  try
+  {
+    alphabet.encode(bad.data(), bad.size(), codes.data());
+    return false;
+  }
+  catch (BadCharException& e) {}
+  return true;
+}
+
 int main()
 {
   // This is a very simple test that instantiate all alphabet classes.
@@ -38,6 +109,61 @@ int main()
   if (!AlphabetTools::isCodonAlphabet(*cdn))
     return 1;
 
+  // Testing conversions:
+  auto word = std::make_shared<WordAlphabet>(dna, 4);
+  auto rny = std::make_shared<RNY>(dna);
+  auto integer = std::make_shared<IntegerAlphabet>(20);
+  for (const AbstractAlphabet* alphabet : vector<const AbstractAlphabet*>{ dna.get(), pro.get(), def.get(), cdn.get(), allelic.get(), word.get(), integer.get() })
+  {
+    if (!testConversions(*alphabet))
+      return 1;
+  }
+  string dnaText, wordText, proText, cdnText;
+  for (size_t i = 0; i < 500; ++i)
+  {
+    dnaText += "ACGTacgt-N"[(i * 7) % 10];
+    wordText += "ACGT-N"[(i * 7) % 6];
+    proText += "ACDEFGHIKLMNPQRSTVWYacdwy-X"[(i * 11) % 27];
+    cdnText += (i % 50 == 0 ? "NNN" : (i % 30 == 0 ? "---" : string(1, "ACGU"[i % 4]) + "UG"));
+  }
+  if (!testBulkConversions(*dna, dnaText) || !testBulkConversions(*dna, dnaText.substr(0, 7)))
+    return 1;
+  if (!testBulkConversions(*rna, "AUGC") || !testBulkConversions(*pro, proText) || !testBulkConversions(*cdn, cdnText))
+    return 1;
+  if (!testBulkConversions(*word, wordText.substr(0, 400)) || !testBulkConversions(*rny, "RCA---TGY"))
+    return 1;
+  if (dna->encodeState("a") != 0 || cdn->charToInt("ANU") != 64 || cdn->charToInt("A-U") != -1 || word->encodeState("ACNT") != 256)
+    return 1;
+  if (word->isCharInAlphabet("ACG#") || word->isCharInAlphabet("ACG"))
+    return 1;
+  for (size_t i = 0; i < rny->getNumberOfStates(); ++i)
+  {
+    if (rny->charToInt(rny->getStateAt(i).getLetter()) != rny->getStateAt(i).getNum())
+      return 1;
+  }
+  if (rny->intToChar(350) != "---" || rny->intToChar(12) != rny->getState(12).getLetter())
+    return 1;
+  try
+  {
+    cdn->charToInt("AC");
+    return 1;
+  }
+  catch (BadCharException& e) {}
+
+  // Alphabet identities:
+  auto dna2 = std::make_shared<DNA>();
+  auto cdn2 = std::make_shared<CodonAlphabet>(std::make_shared<RNA>());
+  auto cdnDna = std::make_shared<CodonAlphabet>(dna);
+  if (!dna->isCompatibleWith(*dna2) || dna->getAlphabetId() != dna2->getAlphabetId() || dna->isCompatibleWith(*rna))
+    return 1;
+  if (!cdn->isCompatibleWith(*cdn2) || cdn->isCompatibleWith(*cdnDna))
+    return 1;
+  if (!allelic->isCompatibleWith(AllelicAlphabet(dna, 4)) || allelic->isCompatibleWith(AllelicAlphabet(dna, 3)))
+    return 1;
+  std::unique_ptr<Alphabet> dnaCopy(dna2->clone());
+  if (dnaCopy->getAlphabetId() != dna->getAlphabetId() || dnaCopy->getAlphabetId() == 0)
+    return 1;
+
   for (size_t i = 0; i < allelic->getNumberOfStates(); i++)
   {
     cerr << i << " -> " << allelic->getStateAt(i).getNum() << " -> " << allelic->getStateAt(i).getLetter() << endl;
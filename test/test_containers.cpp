@@ -2,11 +2,23 @@
 //
 // SPDX-License-Identifier: CECILL-2.1
 
+#include <Bpp/Seq/Alphabet/AlphabetTools.h>
 #include <Bpp/Seq/Alphabet/RNA.h>
 #include <Bpp/Seq/Container/VectorSiteContainer.h>
+#include <Bpp/Seq/Container/CompressedSitePatterns.h>
 #include <Bpp/Seq/Container/CompressedVectorSiteContainer.h>
+#include <Bpp/Seq/Container/ContiguousSiteContainer.h>
+#include <Bpp/Seq/Container/OutOfCoreSiteContainer.h>
 #include <Bpp/Seq/Container/SiteContainerTools.h>
+#include <Bpp/Seq/Container/VectorSequenceContainer.h>
+#include <Bpp/Seq/FMIndex.h>
+#include <Bpp/Seq/SiteTools.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <set>
+#include <type_traits>
 
 using namespace bpp;
 using namespace std;
@@ -62,5 +74,471 @@ int main()
   cout << cvs.sequence("seq1").toString() << endl;
   cout << cvs.sequence("seq2").toString() << endl;
 
+  cout << endl;
+  cout << "Contiguous storage" << endl;
+  ContiguousSiteContainer csc(*sites);
+  for (size_t i = 0; i < sites->getNumberOfSites(); ++i)
+  {
+    if (csc.site(i).toString() != sites->site(i).toString() || csc.site(i).getCoordinate() != sites->site(i).getCoordinate())
+      throw Exception("Bad site view in contiguous container");
+  }
+  csc.setLayout(ContiguousSiteContainer::Layout::ROW_MAJOR);
+  cout << csc.sequence("seq1").toString() << endl;
+  cout << csc.sequence("seq2").toString() << endl;
+  if (csc.sequence("seq1").toString() != sites->sequence("seq1").toString() || csc.sequence(1).getName() != "seq2")
+    throw Exception("Bad sequence view in contiguous container");
+  csc.deleteSites(2, 3);
+  Vint coordinates = sites->getSiteCoordinates();
+  coordinates.erase(coordinates.begin() + 2, coordinates.begin() + 5);
+  auto converted = csc.toSiteContainer();
+  cout << converted->sequence("seq2").toString() << endl;
+  if (converted->sequence("seq2").toString() != csc.sequence("seq2").toString() || converted->getSiteCoordinates() != coordinates)
+    throw Exception("Bad conversion of contiguous container");
+
+  cout << endl;
+  cout << "Site coordinates" << endl;
+  auto copy = make_unique<VectorSiteContainer>(*sites);
+  copy->reindexSites();
+  auto newSite = make_unique<Site>(copy->site(0));
+  try
+  {
+    copy->addSite(newSite, true);
+    throw Exception("Duplicated site coordinate not detected");
+  }
+  catch (SiteException& ex)
+  {
+    cout << "Duplicated site coordinate detected." << endl;
+  }
+  copy->setSite(0, newSite, true);
+  copy->deleteSite(1);
+  newSite = make_unique<Site>(copy->site(0));
+  newSite->setCoordinate(2);
+  copy->addSite(newSite, true);
+  newSite = make_unique<Site>(copy->site(0));
+  newSite->setCoordinate(2);
+  try
+  {
+    copy->addSite(newSite, 3, true);
+    throw Exception("Duplicated site coordinate not detected");
+  }
+  catch (SiteException& ex)
+  {
+    cout << "Duplicated site coordinate detected." << endl;
+  }
+  if (copy->getNumberOfSites() != sites->getNumberOfSites() || copy->site(copy->getNumberOfSites() - 1).getCoordinate() != 2)
+    throw Exception("Bad site coordinates after edition");
+
+  cout << endl;
+  cout << "Similarity matrix" << endl;
+  shared_ptr<const Alphabet> dna = AlphabetTools::DNA_ALPHABET;
+  VectorSiteContainer large(dna);
+  string chars = "ACGT-N";
+  for (size_t i = 0; i < 70; ++i)
+  {
+    string str;
+    for (size_t j = 0; j < 150; ++j)
+    {
+      // Make a few gap-only sites:
+      str += j % 50 == 7 ? '-' : chars[(i * 7 + j * j + (i % 5) * j) % (i % 3 == 0 ? 6 : 4)];
+    }
+    auto seq = make_unique<Sequence>("seq" + TextTools::toString(i), str, dna);
+    large.addSequence(seq->getName(), seq);
+  }
+  for (auto& option : { SiteContainerTools::SIMILARITY_ALL, SiteContainerTools::SIMILARITY_NOFULLGAP, SiteContainerTools::SIMILARITY_NODOUBLEGAP, SiteContainerTools::SIMILARITY_NOGAP })
+  {
+    for (bool unresolvedAsGap : { true, false })
+    {
+      auto mat = SiteContainerTools::computeSimilarityMatrix(large, false, option, unresolvedAsGap, 3);
+      const SiteContainerInterface& constLarge = large;
+      auto noFullGap = unresolvedAsGap ? SiteContainerTools::removeGapOrUnresolvedOnlySites(constLarge) : SiteContainerTools::removeGapOnlySites(constLarge);
+      for (size_t i = 0; i < large.getNumberOfSequences(); ++i)
+      {
+        for (size_t j = 0; j < large.getNumberOfSequences(); ++j)
+        {
+          double expected = i == j ? 1. : (option == SiteContainerTools::SIMILARITY_NOFULLGAP ?
+              SiteContainerTools::computeSimilarity(noFullGap->sequence(i), noFullGap->sequence(j), false, SiteContainerTools::SIMILARITY_ALL, unresolvedAsGap) :
+              SiteContainerTools::computeSimilarity(large.sequence(i), large.sequence(j), false, option, unresolvedAsGap));
+          if ((*mat)(i, j) != expected)
+            throw Exception("Bad similarity matrix with option '" + option + "'.");
+        }
+      }
+    }
+  }
+
+  cout << endl;
+  cout << "Out-of-core container" << endl;
+  {
+    // Small blocks, so that sites are spread over several chunk files:
+    OutOfCoreSiteContainer ooc(large, "", 7, 2);
+    if (ooc.getNumberOfSites() != large.getNumberOfSites() || ooc.getNumberOfSequences() != large.getNumberOfSequences() || ooc.getNumberOfBlocks() != 22)
+      throw Exception("Bad out-of-core container size.");
+    for (size_t i = 0; i < large.getNumberOfSites(); ++i)
+    {
+      if (ooc.site(i).toString() != large.site(i).toString())
+        throw Exception("Bad out-of-core site.");
+    }
+    for (size_t i = 0; i < large.getNumberOfSites(); ++i)
+    {
+      size_t pos = (i * 37) % large.getNumberOfSites();
+      if (ooc.site(pos).toString() != large.site(pos).toString() || ooc.getNumberOfLoadedBlocks() > 2)
+        throw Exception("Bad out-of-core site with random access.");
+    }
+    for (size_t i = 0; i < large.getNumberOfSequences(); ++i)
+    {
+      if (ooc.sequence(i).toString() != large.sequence(i).toString() || ooc.sequence(i).getName() != large.sequence(i).getName())
+        throw Exception("Bad out-of-core sequence.");
+    }
+    if (ooc.getNumberOfCachedObjects() != large.getNumberOfSites() + large.getNumberOfSequences())
+      throw Exception("Bad number of cached out-of-core objects.");
+    ooc.clearCache();
+    const Sequence& firstSequence = ooc.sequence(0);
+    if (ooc.sequence(1).toString() != large.sequence(1).toString() || firstSequence.toString() != large.sequence(0).toString())
+      throw Exception("Bad out-of-core sequence reference.");
+    const SiteContainerInterface& constLarge = large;
+    const SiteContainerInterface& constOoc = ooc;
+    auto filtered = SiteContainerTools::removeGapOnlySites(constOoc);
+    auto expectedFiltered = SiteContainerTools::removeGapOnlySites(constLarge);
+    if (filtered->getNumberOfSites() != expectedFiltered->getNumberOfSites())
+      throw Exception("Bad out-of-core gap filtering.");
+    for (size_t i = 0; i < filtered->getNumberOfSites(); ++i)
+    {
+      if (filtered->site(i).toString() != expectedFiltered->site(i).toString() || filtered->site(i).getCoordinate() != expectedFiltered->site(i).getCoordinate())
+        throw Exception("Bad out-of-core gap filtering.");
+    }
+    SiteSelection selection = { 3, 148, 10, 11, 149, 0, 10 };
+    auto selected = SiteContainerTools::getSelectedSites(constOoc, selection);
+    if (selected->getNumberOfSites() != selection.size() || selected->getSequenceNames() != large.getSequenceNames())
+      throw Exception("Bad out-of-core site selection.");
+    for (size_t i = 0; i < selection.size(); ++i)
+    {
+      if (selected->site(i).toString() != large.site(selection[i]).toString())
+        throw Exception("Bad out-of-core site selection.");
+    }
+    auto bootstrap = SiteContainerTools::bootstrapSites(constOoc);
+    if (bootstrap->getNumberOfSites() != large.getNumberOfSites())
+      throw Exception("Bad out-of-core bootstrap.");
+    auto sampledIndex = make_shared<vector<size_t>>();
+    auto sampled = SiteContainerTools::sampleSites(constOoc, 50, sampledIndex);
+    if (sampled->getNumberOfSites() != 50 || sampledIndex->size() != 50 || ooc.getNumberOfLoadedBlocks() > 2)
+      throw Exception("Bad out-of-core sampling.");
+    for (size_t i = 0; i < 50; ++i)
+    {
+      if (sampled->site(i).toString() != large.site((*sampledIndex)[i]).toString())
+        throw Exception("Bad out-of-core sampling.");
+    }
+    size_t nbSites = 0;
+    OutOfCoreSiteContainer::BlockIterator blocks(ooc);
+    while (blocks.hasMoreBlocks())
+    {
+      auto block = blocks.nextBlock();
+      for (size_t i = 0; i < block->getNumberOfSites(); ++i, ++nbSites)
+      {
+        if (block->site(i).toString() != large.site(nbSites).toString())
+          throw Exception("Bad out-of-core block.");
+      }
+    }
+    if (nbSites != large.getNumberOfSites())
+      throw Exception("Bad number of sites in out-of-core blocks.");
+    OutOfCoreSiteContainer oocCopy(ooc);
+    if (oocCopy.site(140).toString() != large.site(140).toString())
+      throw Exception("Bad out-of-core copy.");
+    try
+    {
+      ooc.deleteSite(0);
+      throw Exception("Out-of-core container should not delete sites.");
+    }
+    catch (NotImplementedException& ex)
+    {
+      cout << "Sites can not be deleted from an out-of-core container." << endl;
+    }
+  }
+
+  cout << endl;
+  cout << "Dense counts" << endl;
+  int offset = SiteTools::getDenseCountsOffset(*dna);
+  Vint majority;
+  for (size_t i = 0; i < large.getNumberOfSites(); ++i)
+  {
+    const Site& site = large.site(i);
+    for (bool resolveUnknowns : { false, true })
+    {
+      map<int, double> counts;
+      SiteTools::getCounts(site, counts, resolveUnknowns);
+      if (!resolveUnknowns)
+      {
+        int best = -1;
+        for (auto& it : counts)
+        {
+          if (it.first != -1 && (best == -1 || it.second > counts[best]))
+            best = it.first;
+        }
+        majority.push_back(best);
+      }
+      vector<double> dense;
+      SiteTools::getDenseCounts(site, dense, resolveUnknowns);
+      for (size_t k = 0; k < dense.size(); ++k)
+      {
+        auto it = counts.find(static_cast<int>(k) + offset);
+        if (abs(dense[k] - (it == counts.end() ? 0. : it->second)) > 1e-9)
+          throw Exception("Bad dense counts.");
+      }
+    }
+    const Site& next = large.site((i + 1) % large.getNumberOfSites());
+    map<int, map<int, double>> pairCounts;
+    SiteTools::getCounts(site, next, pairCounts, true);
+    vector<double> densePairCounts;
+    SiteTools::getDenseCounts(site, next, densePairCounts, true);
+    size_t size = SiteTools::getDenseCountsSize(*dna);
+    for (auto& it1 : pairCounts)
+    {
+      for (auto& it2 : it1.second)
+      {
+        if (abs(densePairCounts[static_cast<size_t>(it1.first - offset) * size + static_cast<size_t>(it2.first - offset)] - it2.second) > 1e-9)
+          throw Exception("Bad dense pair counts.");
+      }
+    }
+  }
+  auto consensus = SiteContainerTools::getConsensus(large, "consensus");
+  cout << consensus->toString() << endl;
+  if (consensus->getContent() != majority)
+    throw Exception("Bad consensus sequence.");
+  auto sample = SiteContainerTools::sampleSequence(large, "sample");
+  for (size_t i = 0; i < large.getNumberOfSites(); ++i)
+  {
+    // Gap-only sites give gaps, other sites one of their states:
+    const vector<int>& states = large.site(i).getContent();
+    int state = sample->getValue(i);
+    if (SiteTools::isGapOnly(large.site(i)) ? state != -1 : (state == -1 || find(states.begin(), states.end(), state) == states.end()))
+      throw Exception("Bad sampled sequence.");
+  }
+  vector<double> emptyFrequencies;
+  SiteTools::getDenseFrequencies(Sequence("empty", "", dna), emptyFrequencies);
+  if (emptyFrequencies.size() != SiteTools::getDenseCountsSize(*dna) || count(emptyFrequencies.begin(), emptyFrequencies.end(), 0.) != static_cast<ptrdiff_t>(emptyFrequencies.size()))
+    throw Exception("Bad frequencies of an empty sequence.");
+
+  cout << endl;
+  cout << "Compressed edition" << endl;
+  CompressedVectorSiteContainer compressed(large);
+  VectorSiteContainer reference(large);
+  auto checkCompressed = [&]()
+  {
+    set<string> unique;
+    for (size_t i = 0; i < reference.getNumberOfSites(); ++i)
+    {
+      unique.insert(reference.site(i).toString());
+      if (compressed.site(i).toString() != reference.site(i).toString())
+        throw Exception("Bad site in compressed container.");
+    }
+    if (compressed.getNumberOfSites() != reference.getNumberOfSites() || compressed.getNumberOfUniqueSites() != unique.size())
+      throw Exception("Bad compression after edition.");
+  };
+  checkCompressed();
+  cout << compressed.getNumberOfUniqueSites() << " unique sites." << endl;
+  for (size_t i = 0; i < 40; ++i)
+  {
+    size_t pos = (i * 37) % reference.getNumberOfSites();
+    auto newSite = make_unique<Site>(reference.site((i * 11) % reference.getNumberOfSites()));
+    if (i % 3 == 0)
+    {
+      // Make a new pattern:
+      newSite->setElement(i % newSite->size(), "A");
+      newSite->setElement((i + 1) % newSite->size(), "T");
+    }
+    auto newSite2 = make_unique<Site>(*newSite);
+    compressed.setSite(pos, newSite);
+    reference.setSite(pos, newSite2, false);
+  }
+  checkCompressed();
+  auto removed = compressed.removeSite(7);
+  if (removed->toString() != reference.site(7).toString())
+    throw Exception("Bad removed site in compressed container.");
+  reference.deleteSite(7);
+  compressed.deleteSites(20, 30);
+  reference.deleteSites(20, 30);
+  checkCompressed();
+  CompressedVectorSiteContainer compressedCopy(compressed);
+  newSite = make_unique<Site>(reference.site(0));
+  compressedCopy.addSite(newSite, 3, false);
+  newSite = make_unique<Site>(reference.site(0));
+  reference.addSite(newSite, 3, false);
+  compressed = compressedCopy;
+  checkCompressed();
+
+  cout << endl;
+  cout << "Site patterns" << endl;
+  auto checkPatterns = [](const CompressedSitePatterns& patterns, const auto& container)
+  {
+    set<string> unique;
+    for (size_t i = 0; i < container.getNumberOfSites(); ++i)
+    {
+      unique.insert(container.site(i).toString());
+    }
+    size_t nbSequences = container.getNumberOfSequences();
+    size_t nbStates = patterns.getNumberOfStates();
+    if (patterns.getNumberOfPatterns() != unique.size() || patterns.getNumberOfSites() != container.getNumberOfSites()
+        || patterns.getSequenceNames() != container.getSequenceNames())
+      throw Exception("Bad number of site patterns.");
+    const auto& offsets = patterns.getSiteOffsets();
+    double totalWeight = 0;
+    for (size_t p = 0; p < patterns.getNumberOfPatterns(); ++p)
+    {
+      totalWeight += patterns.getWeights()[p];
+      if (patterns.getWeights()[p] != static_cast<double>(offsets[p + 1] - offsets[p]))
+        throw Exception("Bad pattern weight.");
+      for (size_t k = offsets[p]; k < offsets[p + 1]; ++k)
+      {
+        size_t i = patterns.getSites()[k];
+        if (patterns.getIndices()[i] != p || (k > offsets[p] && patterns.getSites()[k - 1] >= i))
+          throw Exception("Bad list of sites for a pattern.");
+      }
+      // Patterns are numbered by first occurrence:
+      if (p > 0 && patterns.getSites()[offsets[p]] <= patterns.getSites()[offsets[p - 1]])
+        throw Exception("Bad order of patterns.");
+    }
+    if (totalWeight != static_cast<double>(container.getNumberOfSites()))
+      throw Exception("Bad total weight of patterns.");
+    for (size_t i = 0; i < container.getNumberOfSites(); ++i)
+    {
+      size_t p = patterns.getIndices()[i];
+      const auto& content = container.site(i).getContent();
+      for (size_t j = 0; j < nbSequences; ++j)
+      {
+        if constexpr (is_same<decltype(content), const vector<int>&>::value)
+        {
+          if (patterns.getPatternStates(p)[j] != content[j])
+            throw Exception("Bad content of site pattern.");
+        }
+        else
+        {
+          if (!equal(content[j].begin(), content[j].end(), patterns.getPatternProbabilities(p) + j * nbStates))
+            throw Exception("Bad content of probabilistic site pattern.");
+        }
+      }
+    }
+  };
+  for (unsigned int nbThreads : { 1u, 3u, 0u })
+  {
+    checkPatterns(CompressedSitePatterns(reference, nbThreads), reference);
+    checkPatterns(CompressedSitePatterns(compressed, nbThreads), reference);
+  }
+  // Sites built on demand by an out-of-core container remain valid during the compression:
+  OutOfCoreSiteContainer oocReference(reference, "", 3, 1);
+  checkPatterns(CompressedSitePatterns(oocReference, 2), reference);
+  CompressedSitePatterns patterns(reference);
+  cout << patterns.getNumberOfPatterns() << " patterns for " << patterns.getNumberOfSites() << " sites." << endl;
+
+  ProbabilisticVectorSiteContainer probSites(dna);
+  for (size_t s = 0; s < 3; ++s)
+  {
+    vector< vector<double> > values;
+    for (size_t j = 0; j < 60; ++j)
+    {
+      vector<double> v(4, j % 7 == 0 ? 0.25 : 0.);
+      if (j % 7 != 0)
+        v[(j + s) % 4] = 1.;
+      values.push_back(v);
+    }
+    auto probSeq = make_unique<ProbabilisticSequence>("seq" + TextTools::toString(s), values, dna);
+    probSites.addSequence(probSeq->getName(), probSeq);
+  }
+  CompressedSitePatterns probPatterns(probSites, 2);
+  checkPatterns(probPatterns, probSites);
+  if (!probPatterns.isProbabilistic() || probPatterns.getNumberOfPatterns() != 5 || probPatterns.getNumberOfStates() != 4)
+    throw Exception("Bad probabilistic site patterns.");
+
+  cout << endl;
+  cout << "FM-index" << endl;
+  // Random and repetitive sequences, with gaps and ambiguities, and an empty one:
+  VectorSequenceContainer genomes(dna);
+  unsigned int random = 7;
+  for (size_t s = 0; s < 5; ++s)
+  {
+    string str;
+    for (size_t i = 0; i < 300 + 250 * s; ++i)
+    {
+      random = random * 1103515245 + 12345;
+      unsigned int r = (random >> 16) % 100;
+      if (s == 2)
+        str += "ACACAG"[i % (i < 200 ? 2 : 6)];
+      else
+        str += r < 2 ? (r == 0 ? 'N' : '-') : "ACGT"[r % 4];
+    }
+    auto genome = make_unique<Sequence>("genome" + TextTools::toString(s), s == 3 ? "" : str, dna);
+    genomes.addSequence(genome);
+  }
+  auto checkIndex = [&genomes](const FMIndex& index)
+  {
+    if (index.getNumberOfSequences() != genomes.getNumberOfSequences() || index.getSequenceName(4) != "genome4" || index.getSequenceLength(3) != 0)
+      throw Exception("Bad indexed sequences.");
+    for (size_t q = 0; q < 300; ++q)
+    {
+      // Substrings of the sequences, and random patterns:
+      size_t s = q % 5;
+      const vector<int>& content = genomes.sequence(s).getContent();
+      vector<int> pattern;
+      size_t length = 1 + (q * 7) % 12;
+      if (q % 3 != 0 && content.size() > length)
+      {
+        size_t begin = (q * 131) % (content.size() - length);
+        pattern.assign(content.begin() + static_cast<ptrdiff_t>(begin), content.begin() + static_cast<ptrdiff_t>(begin + length));
+      }
+      else
+      {
+        for (size_t i = 0; i < length; ++i)
+        {
+          pattern.push_back(static_cast<int>((q * 13 + i * i) % 4));
+        }
+      }
+      vector<FMIndex::Occurrence> expected;
+      for (size_t t = 0; t < genomes.getNumberOfSequences(); ++t)
+      {
+        const vector<int>& text = genomes.sequence(t).getContent();
+        for (size_t i = 0; i + pattern.size() <= text.size(); ++i)
+        {
+          if (equal(pattern.begin(), pattern.end(), text.begin() + static_cast<ptrdiff_t>(i)))
+            expected.push_back(FMIndex::Occurrence{ t, i });
+        }
+      }
+      FMIndex::Range range = index.getFullRange();
+      for (size_t i = pattern.size(); i > 0; --i)
+      {
+        range = index.extend(range, pattern[i - 1]);
+      }
+      vector<FMIndex::Occurrence> occurrences;
+      index.locate(index.find(pattern), occurrences);
+      if (index.count(pattern) != expected.size() || range.size() != expected.size() || occurrences.size() != expected.size())
+        throw Exception("Bad number of occurrences in FM-index.");
+      for (size_t i = 0; i < expected.size(); ++i)
+      {
+        if (occurrences[i].sequence != expected[i].sequence || occurrences[i].position != expected[i].position)
+          throw Exception("Bad occurrence in FM-index.");
+      }
+    }
+  };
+  for (size_t sampling : { 1, 7, 32 })
+  {
+    FMIndex index(genomes, sampling);
+    checkIndex(index);
+  }
+  FMIndex index(genomes, 5);
+  Sequence seed("seed", "ACACAC", dna);
+  cout << index.count(seed) << " occurrences of " << seed.toString() << "." << endl;
+  index.write("test_fmindex.idx");
+  for (bool memoryMapped : { true, false })
+  {
+    FMIndex reloaded("test_fmindex.idx", dna, memoryMapped);
+    checkIndex(reloaded);
+    if (reloaded.getSuffixArraySampling() != 5)
+      throw Exception("Bad reloaded FM-index.");
+  }
+  try
+  {
+    FMIndex reloaded("test_fmindex.idx", alpha);
+    throw Exception("FM-index reloaded with another alphabet.");
+  }
+  catch (AlphabetException& e)
+  {}
+  remove("test_fmindex.idx");
+
   return sites->getNumberOfSites() == 24 ? 0 : 1;
 }
@@ -3,11 +3,23 @@
 // SPDX-License-Identifier: CECILL-2.1
 
 #include <Bpp/Seq/Alphabet/AlphabetTools.h>
+#include <Bpp/Seq/Container/SequenceContainerTools.h>
+#include <Bpp/Seq/Io/BgzfStream.h>
+#include <Bpp/Seq/Io/BppOSequenceStreamReaderFormat.h>
 #include <Bpp/Seq/Io/Fasta.h>
+#include <Bpp/Seq/Io/Fastq.h>
+#include <Bpp/Seq/Io/IndexedFastaSequenceContainer.h>
 #include <Bpp/Seq/Io/Mase.h>
 #include <Bpp/Seq/Io/Clustal.h>
 #include <Bpp/Seq/Io/Phylip.h>
+#include <Bpp/Seq/Io/PipelinedSequenceIterator.h>
+#include <Bpp/Seq/Io/SequenceWriterTools.h>
+#include <Bpp/Seq/Io/StreamSequenceIterator.h>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <sstream>
 
 using namespace bpp;
 using namespace std;
@@ -51,6 +63,366 @@ int main()
       && sites1->getNumberOfSites()     == sites4->getNumberOfSites()
       && sites1->getNumberOfSites()     == sites5->getNumberOfSites();
 
+  // Memory-mapped reading must give the same result:
+  Fasta fastaMmap;
+  fastaMmap.memoryMapped(true);
+  auto sites6 = fastaMmap.readAlignment("example.fasta", alpha);
+  cout << "Fasta (memory-mapped): " << sites6->getNumberOfSequences() << "\t" << sites6->getNumberOfSites() << endl;
+  test = test && sites6->getNumberOfSequences() == sites1->getNumberOfSequences()
+      && sites6->getNumberOfSites() == sites1->getNumberOfSites();
+  for (size_t i = 0; test && i < sites1->getNumberOfSequences(); ++i)
+  {
+    test = sites6->sequence(i).getName() == sites1->sequence(i).getName()
+        && sites6->sequence(i).getContent() == sites1->sequence(i).getContent();
+  }
+
+  // Streaming over a memory-mapped file:
+  StreamSequenceIterator ssi(make_shared<Fasta>(), make_shared<MemoryMappedInputStream>("example.fasta"), alpha);
+  size_t nbStreamed = 0;
+  while (ssi.hasMoreSequences())
+  {
+    auto seq = ssi.nextSequence();
+    test = test && seq->getContent() == sites1->sequence(nbStreamed).getContent();
+    nbStreamed++;
+  }
+  cout << "Fasta (streamed):      " << nbStreamed << endl;
+  test = test && nbStreamed == sites1->getNumberOfSequences();
+  MemoryMappedInputStream mappedInput("example.fasta");
+  auto mappedSequences = Fasta().readSequences(mappedInput, alpha);
+  test = test && mappedSequences->getNumberOfSequences() == sites1->getNumberOfSequences() && mappedInput.eof();
+
+  // Indexed access:
+  string bases = "ACGT";
+  string chr1, chr2 = string(60, 'G'), chr3 = "ACGTACG";
+  for (size_t i = 0; i < 250; ++i)
+  {
+    chr1 += bases[(i * 7 + i / 13) % 4];
+  }
+  string fastaText = ">chr1 description\n";
+  for (size_t i = 0; i < chr1.size(); i += 60)
+  {
+    fastaText += chr1.substr(i, 60) + "\n";
+  }
+  fastaText += ">chr2\n" + chr2 + "\n>chr3\n" + chr3;
+  ofstream("test_index.fasta") << fastaText;
+  Fasta::FileIndex fai;
+  fai.build("test_index.fasta", true);
+  fai.write("test_index.fasta.fai");
+  ifstream faiFile("test_index.fasta.fai");
+  string faiText((istreambuf_iterator<char>(faiFile)), istreambuf_iterator<char>());
+  cout << faiText;
+  test = test && faiText == "chr1\t250\t18\t60\t61\nchr2\t60\t279\t60\t61\nchr3\t7\t346\t7\t8\n";
+  Fasta::FileIndex fai2;
+  fai2.read("test_index.fasta.fai");
+  shared_ptr<const Alphabet> dna = AlphabetTools::DNA_ALPHABET;
+  Sequence region(dna);
+  ifstream indexed("test_index.fasta", ios::binary);
+  for (size_t begin = 0; begin < chr1.size(); begin += 17)
+  {
+    for (size_t length : { 1, 59, 60, 61, 130 })
+    {
+      string name = "chr1:" + TextTools::toString(begin + 1) + "-" + TextTools::toString(begin + length);
+      fai2.getRegion(indexed, name, region);
+      test = test && region.getName() == name && region.toString() == chr1.substr(begin, length);
+    }
+  }
+  fai2.getRegion(indexed, "chr3:2-5", region);
+  test = test && region.toString() == "CGTA" && fai2.getSubsequence(indexed, "chr2", 10, 100) == chr2.substr(10);
+  fai2.getRegion("chr1:1,001", region, "test_index.fasta");
+  test = test && region.size() == 0;
+  fai2.getSequence("chr1", region, "test_index.fasta");
+  test = test && region.getName() == "chr1" && region.toString() == chr1;
+  fai.getSequence("chr2", region, "test_index.fasta");
+  test = test && region.getName() == "chr2" && region.toString() == chr2 && fai.getSequencePosition("chr2") == streampos(273);
+  try
+  {
+    fai2.getRegion(indexed, "chr1:0-10", region);
+    test = false;
+  }
+  catch (Exception& e) {}
+
+  // BGZF-compressed files, spanning several blocks:
+  string chr4;
+  for (size_t i = 0; i < 200000; ++i)
+  {
+    chr4 += bases[(i * i + i / 7) % 4];
+  }
+  string bgzfText = fastaText + "\n>chr4\n";
+  for (size_t i = 0; i < chr4.size(); i += 70)
+  {
+    bgzfText += chr4.substr(i, 70) + "\n";
+  }
+  ofstream("test_bgzf.fasta") << bgzfText;
+  {
+    BgzfOutputStream bgzf("test_bgzf.fasta.gz");
+    bgzf << bgzfText;
+    test = test && bgzf.buffer().getVirtualOffset() >> 16 > 0;
+  }
+  test = test && BgzfInputStreamBuffer::isBgzfFile("test_bgzf.fasta.gz") && !BgzfInputStreamBuffer::isBgzfFile("test_bgzf.fasta");
+  auto plainSequences = fasta.readSequences("test_bgzf.fasta", dna);
+  auto bgzfSequences = fasta.readSequences("test_bgzf.fasta.gz", dna);
+  test = test && bgzfSequences->getNumberOfSequences() == 4
+      && bgzfSequences->sequence(3).toString() == chr4
+      && bgzfSequences->sequence(0).toString() == plainSequences->sequence(0).toString();
+  fasta.writeSequences("test_bgzf_out.fasta.gz", *bgzfSequences);
+  auto rewritten = fasta.readSequences("test_bgzf_out.fasta.gz", dna);
+  test = test && rewritten->getNumberOfSequences() == 4 && rewritten->sequence(3).toString() == chr4;
+  cout << "Fasta (BGZF):          " << bgzfSequences->getNumberOfSequences() << endl;
+
+  Fasta::FileIndex plainFai, bgzfFai;
+  plainFai.build("test_bgzf.fasta", true);
+  bgzfFai.build("test_bgzf.fasta.gz", true);
+  test = test && bgzfFai.getNumberOfSequences() == 4
+      && bgzfFai.getEntry("chr4").offset == plainFai.getEntry("chr4").offset;
+  for (size_t begin = 0; begin < chr4.size(); begin += 9973)
+  {
+    string name = "chr4:" + TextTools::toString(begin + 1) + "-" + TextTools::toString(begin + 5000);
+    bgzfFai.getRegion(name, region, "test_bgzf.fasta.gz");
+    test = test && region.toString() == chr4.substr(begin, 5000);
+  }
+  bgzfFai.getSequence("chr2", region, "test_bgzf.fasta.gz");
+  test = test && region.toString() == chr2;
+
+  // Sequences read on demand, with a small cache:
+  IndexedFastaSequenceContainer lazySequences("test_bgzf.fasta.gz", dna, 2);
+  test = test && lazySequences.getNumberOfSequences() == 4 && lazySequences.getSequenceNames()[3] == "chr4"
+      && lazySequences.getSequenceLength(3) == chr4.size() && lazySequences.getNumberOfCachedSequences() == 0;
+  test = test && lazySequences.sequence("chr4").toString() == chr4 && lazySequences.sequence(0).toString() == chr1
+      && lazySequences.sequence(1).toString() == chr2 && lazySequences.getNumberOfCachedSequences() == 2
+      && lazySequences.sequence(3).toString() == chr4 && lazySequences.sequence(2).toString() == chr3;
+  test = test && !SequenceContainerTools::sequencesHaveTheSameLength(lazySequences);
+  VectorSequenceContainer lazySelection(dna);
+  SequenceContainerTools::getSelectedSequences(lazySequences, vector<string>({ "chr3", "chr1" }), lazySelection);
+  test = test && lazySelection.getNumberOfSequences() == 2 && lazySelection.sequence("chr1").toString() == chr1;
+  IndexedFastaSequenceContainer lazyFromFai("test_index.fasta", dna);
+  test = test && lazyFromFai.sequence("chr1").toString() == chr1 && lazyFromFai.sequence("chr3").toString() == chr3;
+  // Sequences discarded from the cache remain valid while they are shared:
+  IndexedFastaSequenceContainer lazySingle("test_bgzf.fasta.gz", dna, 1);
+  shared_ptr<const Sequence> pinned = lazySingle.getSharedSequence("chr1");
+  test = test && lazySingle.sequence(3).toString() == chr4 && lazySingle.sequence(2).toString() == chr3
+      && lazySingle.getNumberOfCachedSequences() == 1 && pinned->toString() == chr1 && pinned->getName() == "chr1";
+  pinned.reset();
+
+  // Writing sequences which are freed by later accesses:
+  string expectedText = ">chr1\n";
+  for (size_t i = 0; i < chr1.size(); i += 60)
+  {
+    expectedText += chr1.substr(i, 60) + "\n";
+  }
+  expectedText += ">chr2\n" + chr2 + "\n\n>chr3\n" + chr3 + "\n>chr4\n";
+  for (size_t i = 0; i < chr4.size(); i += 60)
+  {
+    expectedText += chr4.substr(i, 60) + "\n";
+  }
+  for (unsigned int nbThreads : { 1u, 4u })
+  {
+    Fasta lazyWriter(60);
+    lazyWriter.numberOfThreads(nbThreads);
+    ostringstream lazyOutput;
+    lazyWriter.writeSequences(lazyOutput, lazySingle);
+    test = test && lazyOutput.str() == expectedText;
+  }
+  try
+  {
+    lazySequences.deleteSequence(0);
+    test = false;
+  }
+  catch (Exception& e) {}
+
+  // Virtual offsets and block index:
+  BgzfInputStream bgzfInput("test_bgzf.fasta.gz");
+  string part1(100000, ' '), part2(1000, ' '), part3(1000, ' ');
+  bgzfInput.read(&part1[0], 100000);
+  uint64_t voffset = bgzfInput.buffer().getVirtualOffset();
+  bgzfInput.read(&part2[0], 1000);
+  bgzfInput.buffer().seekVirtualOffset(voffset);
+  bgzfInput.read(&part3[0], 1000);
+  test = test && part1 == bgzfText.substr(0, 100000) && part2 == bgzfText.substr(100000, 1000) && part3 == part2
+      && bgzfInput.tellg() == streampos(101000);
+  bgzfInput.buffer().writeIndex("test_bgzf.fasta.gz.gzi");
+  BgzfInputStream bgzfIndexed("test_bgzf.fasta.gz");
+  bgzfIndexed.buffer().readIndex("test_bgzf.fasta.gz.gzi");
+  bgzfIndexed.seekg(150000);
+  bgzfIndexed.read(&part3[0], 1000);
+  test = test && part3 == bgzfText.substr(150000, 1000);
+  bgzfIndexed.seekg(0, ios::end);
+  test = test && bgzfIndexed.tellg() == streampos(static_cast<streamoff>(bgzfText.size()));
+  remove("test_bgzf.fasta.gz.gzi");
+
+  // FASTQ:
+  auto fastq = make_shared<Fastq>(false, true);
+  StreamSequenceWithQualityIterator fqIt(fastq, make_shared<ifstream>("example.fastq"), dna);
+  vector<unique_ptr<SequenceWithQuality>> reads;
+  while (fqIt.hasMoreSequences())
+  {
+    reads.push_back(fqIt.nextSequence());
+  }
+  cout << "Fastq:                 " << reads.size() << endl;
+  test = test && reads.size() == 3 && reads[0]->getName() == "EAS54_6_R1_2_1_413_324"
+      && reads[0]->toString() == "CCCTTCTTGTCTTCAGCGTTTCTCC"
+      && reads[0]->getQuality(0) == 26 && reads[0]->getQuality(2) == 18
+      && reads[2]->getQualities().size() == 25;
+  ostringstream fqOut;
+  Fastq fastq64(true, true);
+  for (const auto& read : reads)
+  {
+    fastq64.writeSequence(fqOut, *read);
+  }
+  istringstream fqIn(fqOut.str());
+  vector<unique_ptr<SequenceWithQuality>> reads64;
+  test = test && fqOut.str().substr(0, 30) == "@EAS54_6_R1_2_1_413_324\nCCCTTC"
+      && fastq64.nextSequences(fqIn, dna, 2, reads64) == 2
+      && fastq64.nextSequences(fqIn, dna, 2, reads64) == 1
+      && fastq64.nextSequences(fqIn, dna, 2, reads64) == 0;
+  for (size_t i = 0; test && i < reads.size(); ++i)
+  {
+    test = reads64[i]->getName() == reads[i]->getName() && reads64[i]->toString() == reads[i]->toString()
+        && reads64[i]->getQualities() == reads[i]->getQualities();
+  }
+  StreamSequenceIterator fqMapped(
+      BppOSequenceStreamReaderFormat().read("Fastq(strict_names=yes)"),
+      make_shared<MemoryMappedInputStream>("example.fastq"), dna);
+  for (size_t i = 0; i < reads.size(); ++i)
+  {
+    auto read = fqMapped.nextSequence();
+    test = test && read && read->getName() == reads[i]->getName() && read->toString() == reads[i]->toString();
+  }
+  test = test && !fqMapped.hasMoreSequences();
+  try
+  {
+    istringstream truncated("@read\nACGT\n+\n!!\n");
+    SequenceWithQuality read(dna);
+    fastq->nextSequence(truncated, read);
+    test = false;
+  }
+  catch (IOException& e) {}
+  try
+  {
+    istringstream highQuality("@read\nACGT\n+\n!!\xC8!\n");
+    SequenceWithQuality read(dna);
+    fastq->nextSequence(highQuality, read);
+    test = false;
+  }
+  catch (IOException& e) {}
+  {
+    // Comments of a reused sequence are cleared with the whole header as name:
+    istringstream headers("@read1 comment\nACGT\n+\n!!!!\n@read2 comment\nACGT\n+\n!!!!\n");
+    SequenceWithQuality read(dna);
+    fastq->nextSequence(headers, read);
+    test = test && read.getName() == "read1" && read.getComments().size() == 1;
+    Fastq(false, false).nextSequence(headers, read);
+    test = test && read.getName() == "read2 comment" && read.getComments().empty();
+  }
+
+  // Pipelined parsing, with small chunks and records longer than chunks:
+  string manyFasta, manyFastq;
+  vector<string> manyNames, manyContents;
+  for (size_t i = 0; i < 500; ++i)
+  {
+    string content;
+    for (size_t j = 0; j < (i * 37) % 3000 + 1; ++j)
+    {
+      content += bases[(i + j * j) % 4];
+    }
+    manyNames.push_back("seq" + TextTools::toString(i));
+    manyContents.push_back(content);
+    manyFasta += ">" + manyNames.back() + "\n";
+    for (size_t j = 0; j < content.size(); j += 80)
+    {
+      manyFasta += content.substr(j, 80) + "\n";
+    }
+    // Quality lines may start with '@':
+    manyFastq += "@" + manyNames.back() + "\n" + content + "\n+\n" + string(content.size(), i % 2 ? '@' : 'I') + "\n";
+  }
+  PipelinedSequenceIterator fastaPipeline(make_shared<Fasta>(), make_shared<istringstream>(manyFasta), dna, 3, 2, 1000);
+  size_t nbPipelined = 0;
+  while (fastaPipeline.hasMoreSequences())
+  {
+    auto seq = fastaPipeline.nextSequence();
+    test = test && seq->getName() == manyNames[nbPipelined] && seq->toString() == manyContents[nbPipelined];
+    nbPipelined++;
+  }
+  PipelinedSequenceWithQualityIterator fastqPipeline(make_shared<Fastq>(), make_shared<istringstream>(manyFastq), dna, 2, 0, 4096);
+  for (size_t i = 0; i < manyNames.size(); ++i)
+  {
+    auto read = fastqPipeline.nextSequence();
+    test = test && read && read->getName() == manyNames[i] && read->toString() == manyContents[i]
+        && read->getQuality(0) == (i % 2 ? 31 : 40);
+  }
+  test = test && !fastqPipeline.hasMoreSequences();
+  // Records are scanned incrementally, even when lines are cut between reads:
+  PipelinedSequenceWithQualityIterator smallChunksPipeline(make_shared<Fastq>(), make_shared<istringstream>(manyFastq.substr(0, manyFastq.find("@seq30\n"))), dna, 1, 0, 7);
+  size_t nbSmallChunks = 0;
+  while (smallChunksPipeline.hasMoreSequences())
+  {
+    auto read = smallChunksPipeline.nextSequence();
+    test = test && read->getName() == manyNames[nbSmallChunks] && read->toString() == manyContents[nbSmallChunks];
+    nbSmallChunks++;
+  }
+  test = test && nbSmallChunks == 30;
+  Fasta parallelFasta;
+  parallelFasta.numberOfThreads(4);
+  istringstream manyFastaInput(manyFasta);
+  auto manySequences = parallelFasta.readSequences(manyFastaInput, dna);
+  test = test && manySequences->getNumberOfSequences() == manyNames.size()
+      && manySequences->sequence(manyNames.size() - 1).toString() == manyContents.back();
+  cout << "Pipelined:             " << nbPipelined << endl;
+  test = test && nbPipelined == manyNames.size();
+
+  // Buffered writers, with records formatted in parallel:
+  Fasta fasta80(80);
+  ostringstream serialOutput, parallelOutput;
+  fasta80.writeSequences(serialOutput, *manySequences);
+  fasta80.numberOfThreads(4);
+  fasta80.writeSequences(parallelOutput, *manySequences);
+  string expectedFasta;
+  for (size_t i = 0; i < manyNames.size(); ++i)
+  {
+    expectedFasta += ">" + manyNames[i] + "\n";
+    size_t j = 0;
+    for ( ; j + 80 <= manyContents[i].size(); j += 80)
+    {
+      expectedFasta += manyContents[i].substr(j, 80) + "\n";
+    }
+    expectedFasta += manyContents[i].substr(j) + "\n";
+  }
+  test = test && serialOutput.str() == expectedFasta && parallelOutput.str() == expectedFasta;
+  // Errors of the formatters are reported to the caller:
+  ostringstream failedOutput;
+  bool formatError = false;
+  try
+  {
+    SequenceWriterTools::writeRecords(failedOutput, 1000, [](size_t i, string& buffer) {
+      if (i == 500)
+        throw Exception("Bad record");
+      buffer += "x";
+    }, 4);
+  }
+  catch (Exception&)
+  {
+    formatError = true;
+  }
+  test = test && formatError && failedOutput.str().size() <= 500;
+  ostringstream maseOutput, clustalOutput, phylipOutput, phylip3Output;
+  mase.writeSequences(maseOutput, *sites1);
+  clustal.writeAlignment(clustalOutput, *sites1);
+  phylip.writeAlignment(phylipOutput, *sites1);
+  phylip3.writeAlignment(phylip3Output, *sites1);
+  istringstream maseInput(maseOutput.str()), clustalInput(clustalOutput.str()), phylipInput(phylipOutput.str()), phylip3Input(phylip3Output.str());
+  auto maseSites = mase.readAlignment(maseInput, alpha);
+  auto clustalSites = clustal.readAlignment(clustalInput, alpha);
+  auto phylipSites = phylip.readAlignment(phylipInput, alpha);
+  auto phylip3Sites = phylip3.readAlignment(phylip3Input, alpha);
+  for (size_t i = 0; i < sites1->getNumberOfSequences(); ++i)
+  {
+    string content = sites1->sequence(i).toString();
+    test = test && maseSites->sequence(i).toString() == content
+        && clustalSites->sequence(i).toString() == content
+        && phylipSites->sequence(i).toString() == content
+        && phylip3Sites->sequence(i).toString() == content;
+  }
+  cout << "Buffered writers:      " << (test ? "ok" : "failed") << endl;
+
   cout << (test ? "Succeeded." : "Failed.") << endl;
   return test ? 0 : 1;
 }
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include <Bpp/Seq/Alphabet/AlphabetTools.h>
+#include <Bpp/Seq/PackedSequence.h>
+#include <Bpp/Seq/SequenceTools.h>
+#include <iostream>
+
+using namespace bpp;
+using namespace std;
+
+bool testPacking(const string& str, shared_ptr<const Alphabet> alpha, unsigned int bits)
+{
+  Sequence seq("test", str, alpha);
+  PackedSequence packed("test", str, alpha, bits);
+  cout << "Packing on " << packed.getBitsPerState() << " bits: ";
+  if (packed.size() != seq.size() || packed.toString() != seq.toString() || packed.unpack() != seq.getContent())
+  {
+    cout << "wrong content" << endl;
+    return false;
+  }
+  for (size_t i = 0; i < seq.size(); ++i)
+  {
+    if (packed[i] != seq[i])
+    {
+      cout << "wrong state at position " << i << endl;
+      return false;
+    }
+  }
+  if (!equal(packed.begin(), packed.end(), seq.getContent().begin()))
+  {
+    cout << "wrong iteration" << endl;
+    return false;
+  }
+
+  // Edition:
+  seq.deleteElements(3, 7);
+  packed.deleteElements(3, 7);
+  seq.addElement(5, alpha->getGapCharacterCode());
+  packed.addElement(5, alpha->getGapCharacterCode());
+  seq.setElement(1, alpha->getUnknownCharacterCode());
+  packed.setElement(1, alpha->getUnknownCharacterCode());
+  seq.setElement(20, 0);
+  packed.setElement(20, 0);
+  seq.setToSizeL(seq.size() + 5);
+  packed.setToSizeL(packed.size() + 5);
+  seq.setToSizeR(seq.size() + 3);
+  packed.setToSizeR(packed.size() + 3);
+  seq.setToSizeR(seq.size() - 2);
+  packed.setToSizeR(packed.size() - 2);
+  if (packed.toString() != seq.toString())
+  {
+    cout << "wrong edition: " << packed.toString() << " vs " << seq.toString() << endl;
+    return false;
+  }
+
+  // Conversion:
+  auto unpacked = packed.toSequence();
+  PackedSequence repacked(*unpacked, bits);
+  if (unpacked->getContent() != seq.getContent() || repacked.unpack() != seq.getContent())
+  {
+    cout << "wrong conversion" << endl;
+    return false;
+  }
+  cout << "OK" << endl;
+  return true;
+}
+
+int main()
+{
+  string dna = "ATTTCG---TCGTT-AAAGCWCATGCATNNNNNNNNNNNCGATCNNNNacgtRYKMSWBDHV";
+  string prot = "MAKV-LLWGHQ*XXXCDERFTYPSNIKLMAWV-RKL";
+
+  if (!testPacking(dna, AlphabetTools::DNA_ALPHABET, 0)) return 1;
+  if (!testPacking(dna, AlphabetTools::DNA_ALPHABET, 2)) return 1;
+  if (!testPacking(dna, AlphabetTools::DNA_ALPHABET, 8)) return 1;
+  if (!testPacking(prot, AlphabetTools::PROTEIN_ALPHABET, 0)) return 1;
+
+  PackedSequence packed("test", dna, AlphabetTools::DNA_ALPHABET, 2);
+  cout << "Exception runs: " << packed.getNumberOfExceptionRuns() << endl;
+  if (packed.getNumberOfExceptionRuns() != 15)
+    return 1;
+
+  // Wrong alphabet for the packing:
+  try
+  {
+    PackedSequence badPacking(AlphabetTools::PROTEIN_ALPHABET, 4);
+    return 1;
+  }
+  catch (AlphabetException& ex)
+  {
+    cout << "Protein sequences can not be stored on 4 bits." << endl;
+  }
+
+  // Wrong states:
+  try
+  {
+    packed.setElement(0, 42);
+    return 1;
+  }
+  catch (BadIntException& ex)
+  {
+    cout << "Invalid state detected." << endl;
+  }
+
+  // Whole genome like sequence:
+  string big;
+  for (size_t i = 0; i < 100000; ++i)
+  {
+    big += (i / 1000) % 10 == 0 ? "N" : "ACGT";
+  }
+  PackedSequence bigPacked("big", big, AlphabetTools::DNA_ALPHABET, 2);
+  cout << "Storage of " << bigPacked.size() << " states: " << bigPacked.getStorageSize() << " bytes." << endl;
+  if (bigPacked.toString() != big || bigPacked.getNumberOfExceptionRuns() != 10)
+    return 1;
+
+  return 0;
+}
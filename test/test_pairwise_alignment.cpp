@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: The Bio++ Development Group
+//
+// SPDX-License-Identifier: CECILL-2.1
+
+#include <Bpp/Seq/Alphabet/AlphabetTools.h>
+#include <Bpp/Seq/Alphabet/DNA.h>
+#include <Bpp/Seq/AlphabetIndex/SimpleScore.h>
+#include <Bpp/Seq/Container/PairwiseAligner.h>
+#include <Bpp/Seq/Container/SiteContainerTools.h>
+#include <Bpp/Seq/Container/VectorSequenceContainer.h>
+#include <Bpp/Seq/SequenceTools.h>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace bpp;
+using namespace std;
+
+// Score of the optimal alignment, computed with full matrices:
+double referenceScore(const Sequence& seq1, const Sequence& seq2, const AlphabetIndex2& score, double opening, double extending, PairwiseAligner::Mode mode = PairwiseAligner::Mode::GLOBAL)
+{
+  size_t m = seq1.size();
+  size_t n = seq2.size();
+  double minusInf = -1e100;
+  vector< vector<double> > h(m + 1, vector<double>(n + 1, minusInf)), e = h, f = h;
+  double best = mode == PairwiseAligner::Mode::LOCAL ? 0 : minusInf;
+  for (size_t i = 0; i <= m; ++i)
+  {
+    for (size_t j = 0; j <= n; ++j)
+    {
+      if (j > 0)
+        e[i][j] = max(e[i][j - 1] + extending, h[i][j - 1] + opening + extending);
+      if (i > 0)
+        f[i][j] = max(f[i - 1][j] + extending, h[i - 1][j] + opening + extending);
+      if (i > 0 && j > 0)
+        h[i][j] = h[i - 1][j - 1] + score.getIndex(seq1[i - 1], seq2[j - 1]);
+      if (i > 0 || j > 0)
+        h[i][j] = max(h[i][j], max(e[i][j], f[i][j]));
+      if ((i == 0 && j == 0) || mode == PairwiseAligner::Mode::LOCAL || (mode == PairwiseAligner::Mode::GLOCAL && i == 0))
+        h[i][j] = max(h[i][j], 0.);
+      if (mode == PairwiseAligner::Mode::LOCAL || (mode == PairwiseAligner::Mode::GLOCAL && i == m))
+        best = max(best, h[i][j]);
+    }
+  }
+  return mode == PairwiseAligner::Mode::GLOBAL ? h[m][n] : best;
+}
+
+// Score of an alignment:
+double alignmentScore(const Sequence& seq1, const Sequence& seq2, const AlphabetIndex2& score, double opening, double extending)
+{
+  double s = 0;
+  bool gap1 = false, gap2 = false;
+  for (size_t i = 0; i < seq1.size(); ++i)
+  {
+    if (seq1[i] == -1)
+    {
+      s += (gap1 ? 0 : opening) + extending;
+      gap1 = true;
+      gap2 = false;
+    }
+    else if (seq2[i] == -1)
+    {
+      s += (gap2 ? 0 : opening) + extending;
+      gap2 = true;
+      gap1 = false;
+    }
+    else
+    {
+      s += score.getIndex(seq1[i], seq2[i]);
+      gap1 = gap2 = false;
+    }
+  }
+  return s;
+}
+
+int main()
+{
+  shared_ptr<const Alphabet> alpha = AlphabetTools::DNA_ALPHABET;
+  // Scores take the ownership of their alphabet:
+  SimpleScore integerScore(new DNA(), 2, -1);
+  SimpleScore realScore(new DNA(), 1.5, -0.75);
+  string chars = "ACGT";
+  mt19937 generator(42);
+
+  for (size_t k = 0; k < 200; ++k)
+  {
+    string str1, str2;
+    size_t m = generator() % 25;
+    size_t n = generator() % 25;
+    for (size_t i = 0; i < m; ++i)
+    {
+      str1 += chars[generator() % 4];
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+      str2 += (i < m && generator() % 2 == 0) ? str1[i] : chars[generator() % 4];
+    }
+    Sequence seq1("seq1", str1, alpha);
+    Sequence seq2("seq2", str2, alpha);
+    const AlphabetIndex2& score = (k % 2 == 0 ? integerScore : realScore);
+    double opening = (k % 3 == 0 ? 0. : -3.);
+    double extending = -1.;
+
+    PairwiseAligner aligner(score, opening, extending);
+    double expected = referenceScore(seq1, seq2, score, opening, extending);
+    auto aln = aligner.align(seq1, seq2);
+    double observed = alignmentScore(aln->sequence(0), aln->sequence(1), score, opening, extending);
+    if (abs(aligner.getAlignmentScore(seq1, seq2) - expected) > 1e-9 || abs(observed - expected) > 1e-9)
+    {
+      cout << "Non optimal alignment of " << str1 << " and " << str2 << ": " << observed << " instead of " << expected << endl;
+      return 1;
+    }
+    auto ungapped = unique_ptr<Sequence>(aln->sequence(0).clone());
+    SequenceTools::removeGaps(*ungapped);
+    if (ungapped->toString() != str1)
+      return 1;
+
+    // A band including the optimal alignment gives the same result:
+    aligner.setBandWidth(30);
+    if (abs(aligner.getAlignmentScore(seq1, seq2) - expected) > 1e-9)
+      return 1;
+
+    // Local modes:
+    for (auto mode : { PairwiseAligner::Mode::LOCAL, PairwiseAligner::Mode::GLOCAL })
+    {
+      aligner.setMode(mode);
+      expected = referenceScore(seq1, seq2, score, opening, extending, mode);
+      auto result = aligner.compute(seq1, seq2);
+      observed = alignmentScore(result.alignment->sequence(0), result.alignment->sequence(1), score, opening, extending);
+      if (abs(result.score - expected) > 1e-9 || abs(observed - expected) > 1e-9)
+      {
+        cout << "Non optimal local alignment of " << str1 << " and " << str2 << ": " << observed << " instead of " << expected << endl;
+        return 1;
+      }
+      ungapped.reset(result.alignment->sequence(1).clone());
+      SequenceTools::removeGaps(*ungapped);
+      if (ungapped->toString() != str2.substr(result.begin2, result.end2 - result.begin2))
+        return 1;
+      if (mode == PairwiseAligner::Mode::GLOCAL && (result.begin1 != 0 || result.end1 != str1.size()))
+        return 1;
+    }
+  }
+
+  // Large sequences, with a band:
+  string str1, str2;
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    str1 += chars[generator() % 4];
+  }
+  str2 = str1.substr(0, 5000) + str1.substr(5010, 10000) + "ACGTACGT" + str1.substr(15010);
+  Sequence seq1("seq1", str1, alpha);
+  Sequence seq2("seq2", str2, alpha);
+  PairwiseAligner aligner(integerScore, -5, -1, 50);
+  auto aln = aligner.align(seq1, seq2);
+  cout << "Banded alignment of " << seq1.size() << " and " << seq2.size() << " positions: " << aln->getNumberOfSites() << " sites, score " << aligner.getAlignmentScore(seq1, seq2) << "." << endl;
+  if (alignmentScore(aln->sequence(0), aln->sequence(1), integerScore, -5, -1) != aligner.getAlignmentScore(seq1, seq2))
+    return 1;
+
+  // A read mapped on a reference, and many references:
+  Sequence read("read", str1.substr(12000, 150), alpha);
+  PairwiseAligner mapper(integerScore, -5, -1, PairwiseAligner::NO_BAND, PairwiseAligner::Mode::GLOCAL);
+  auto hit = mapper.compute(read, seq2, false);
+  cout << "Read mapped at [" << hit.begin2 << ", " << hit.end2 << "[ with score " << hit.score << "." << endl;
+  if (hit.begin2 != 12000 - 10 || hit.end2 != 12150 - 10 || hit.score != 300 || hit.alignment)
+    return 1;
+  VectorSequenceContainer targets(alpha);
+  for (size_t k = 0; k < 20; ++k)
+  {
+    auto target = make_unique<Sequence>("target" + TextTools::toString(k), str1.substr(k * 1000, 1000), alpha);
+    targets.addSequence(target->getName(), target);
+  }
+  auto hits = mapper.computeAll(read, targets, true, 3);
+  for (size_t k = 0; k < 20; ++k)
+  {
+    auto expectedHit = mapper.compute(read, targets.sequence(k));
+    if (hits[k].score != expectedHit.score || hits[k].begin2 != expectedHit.begin2 || hits[k].end2 != expectedHit.end2
+        || hits[k].alignment->sequence(1).toString() != expectedHit.alignment->sequence(1).toString())
+      return 1;
+  }
+  if (hits[12].score != 300)
+    return 1;
+
+  // Previous interface:
+  auto nw = SiteContainerTools::alignNW(Sequence("seq1", "ACGTTGCA", alpha), Sequence("seq2", "ACGGCA", alpha), integerScore, -2);
+  cout << nw->sequence(0).toString() << endl << nw->sequence(1).toString() << endl;
+  if (nw->getNumberOfSites() != 8 || alignmentScore(nw->sequence(0), nw->sequence(1), integerScore, 0, -2) != 8)
+    return 1;
+  auto sw = SiteContainerTools::alignSW(Sequence("seq1", "TTTTACGTACGTTTTT", alpha), Sequence("seq2", "GGACGTTCGTGG", alpha), integerScore, -2, -1);
+  cout << sw->sequence(0).toString() << endl << sw->sequence(1).toString() << endl;
+  if (sw->sequence(0).toString() != "ACGTACGT" || sw->sequence(1).toString() != "ACGTTCGT")
+    return 1;
+
+  return 0;
+}
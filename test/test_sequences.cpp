@@ -4,8 +4,17 @@
 
 #include <Bpp/Seq/Alphabet/DNA.h>
 #include <Bpp/Seq/Alphabet/AlphabetTools.h>
+#include <Bpp/Seq/Container/VectorSequenceContainer.h>
+#include <Bpp/Seq/GeneticCode/StandardGeneticCode.h>
+#include <Bpp/Seq/GeneticCode/VertebrateMitochondrialGeneticCode.h>
+#include <Bpp/Seq/Io/Fasta.h>
+#include <Bpp/Seq/Io/StreamSequenceIterator.h>
+#include <Bpp/Seq/MotifSearch.h>
+#include <Bpp/Seq/OrfFinder.h>
 #include <Bpp/Seq/SequenceTools.h>
+#include <Bpp/Seq/SequenceWithQuality.h>
 #include <iostream>
+#include <sstream>
 
 using namespace bpp;
 using namespace std;
@@ -23,6 +32,358 @@ int main()
   Sequence motif7("motif", "AAGCA", alpha);
   size_t pos;
 
+  cout << "--- Bulk edition ---" << endl;
+
+  // Long enough sequences to use vectorized blocks, with ambiguities and gaps:
+  string chars = "ACGTACGTACGT-NRY";
+  string complementChars = "TGCATGCATGCA-NYR";
+  for (size_t length : { 0, 1, 7, 64, 101 })
+  {
+    string str, rev, revComp, noGap;
+    for (size_t i = 0; i < length; ++i)
+    {
+      size_t k = (i * i + 3 * i) % (i < 40 ? 12 : chars.size());
+      str += chars[k];
+      rev = chars[k] + rev;
+      revComp = complementChars[k] + revComp;
+      if (chars[k] != '-')
+        noGap += chars[k];
+    }
+    Sequence seq("seq", str, alpha);
+    SequenceTools::invertComplement(seq);
+    if (seq.toString() != revComp)
+      throw Exception("Bad reverse complement.");
+    SequenceTools::complement(seq);
+    if (seq.toString() != rev)
+      throw Exception("Bad complement.");
+    SequenceTools::invert(seq);
+    if (seq.toString() != str)
+      throw Exception("Bad inversion.");
+    SequenceTools::removeGaps(seq);
+    if (seq.toString() != noGap || SequenceTools::getSequenceWithoutGaps(Sequence("seq", str, alpha))->toString() != noGap)
+      throw Exception("Bad gap removal.");
+
+    // Qualities follow the removal of gaps:
+    vector<int> qualities(length), noGapQualities;
+    for (size_t i = 0; i < length; ++i)
+    {
+      qualities[i] = static_cast<int>(i);
+      if (str[i] != '-')
+        noGapQualities.push_back(static_cast<int>(i));
+    }
+    SequenceWithQuality seqWithQuality("seq", str, qualities, alpha);
+    SequenceTools::removeGaps(seqWithQuality);
+    if (seqWithQuality.toString() != noGap || seqWithQuality.getQualities() != noGapQualities)
+      throw Exception("Bad gap removal with qualities.");
+  }
+
+  // Deletions of scattered elements do not describe a range:
+  Sequence scattered("scattered", "ACGTACGT", alpha);
+  IntSymbolListDeletionEvent scatteredDeletion(&scattered, { true, false, true, true, false, false, true, true });
+  vector<int> filtered = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  scatteredDeletion.filter(filtered);
+  if (!scatteredDeletion.isScattered() || filtered != vector<int>({ 0, 2, 3, 6, 7 }))
+    throw Exception("Bad filtering of scattered deletion.");
+  try
+  {
+    scatteredDeletion.getPosition();
+    throw Exception("Missing exception for the position of a deletion by mask.");
+  }
+  catch (Exception& e)
+  {
+    if (string(e.what()).find("scattered") == string::npos)
+      throw;
+  }
+
+  shared_ptr<const Alphabet> codonAlpha = AlphabetTools::DNA_CODON_ALPHABET;
+  StandardGeneticCode gCode(AlphabetTools::DNA_ALPHABET);
+  Sequence codons("codons", "CCCATGTAA---GGGTGAAAA", codonAlpha);
+  if (SequenceTools::getSequenceWithoutStops(codons, gCode)->toString() != "CCCATG---GGGAAA")
+    throw Exception("Bad stop removal.");
+  unique_ptr<Sequence> stopsAsGaps(codons.clone());
+  SequenceTools::replaceStopsWithGaps(*stopsAsGaps, gCode);
+  if (stopsAsGaps->toString() != "CCCATG------GGG---AAA")
+    throw Exception("Bad stop replacement.");
+  for (bool includeInit : { true, false })
+  {
+    for (bool includeStop : { true, false })
+    {
+      Sequence cds(codons);
+      SequenceTools::getCDS(cds, gCode, true, true, includeInit, includeStop);
+      string expected = string(includeInit ? "ATG" : "") + (includeStop ? "TAA" : "");
+      if (cds.toString() != expected)
+        throw Exception("Bad CDS extraction.");
+    }
+  }
+
+  cout << "--- Translation ---" << endl;
+
+  if (gCode.translate("ATG") != "M" || gCode.translate(codonAlpha->getUnknownCharacterCode()) != 23 || gCode.getSynonymous("L").size() != 6)
+    throw Exception("Bad translation.");
+  if (!gCode.areSynonymous("CTA", "TTG") || gCode.areSynonymous("CTA", "ATG"))
+    throw Exception("Bad synonymous codons.");
+  vector<int> cat = { 1, 0, 3 };
+  if (!(gCode.getCodonType(codonAlpha->charToInt("TAA")) & GeneticCode::STOP)
+      || !(gCode.getCodonType(cat.data() + 2, true) & GeneticCode::START)
+      || gCode.getCodonType(cat.data(), false) != 0)
+    throw Exception("Bad codon types.");
+  try
+  {
+    gCode.translate("TGA");
+    throw Exception("Stop codon not detected.");
+  }
+  catch (StopCodonException& ex)
+  {}
+  VertebrateMitochondrialGeneticCode mitoCode(AlphabetTools::DNA_ALPHABET);
+  if (mitoCode.translate("TGA") != "W" || !mitoCode.isStop("AGA") || mitoCode.getSynonymous("W").size() != 2)
+    throw Exception("Bad mitochondrial translation.");
+
+  // Six-frame translation, compared to the translation of codons:
+  string nucleotides;
+  for (size_t i = 0; i < 200; ++i)
+  {
+    nucleotides += i == 50 ? 'N' : chars[(i * i * i + 7 * i) % 11];
+  }
+  nucleotides += "---A";
+  Sequence nucSeq("nuc", nucleotides, alpha);
+  Sequence revComp(nucSeq);
+  SequenceTools::invertComplement(revComp);
+  auto frames = gCode.translateSixFrames(nucSeq);
+  for (size_t f = 0; f < 6; ++f)
+  {
+    const Sequence& strand = f < 3 ? nucSeq : revComp;
+    size_t start = f % 3;
+    const Sequence& protein = *frames[f];
+    if (protein.size() != (strand.size() - start) / 3)
+      throw Exception("Bad frame length.");
+    for (size_t k = 0; k < protein.size(); ++k)
+    {
+      int n1 = strand[start + 3 * k], n2 = strand[start + 3 * k + 1], n3 = strand[start + 3 * k + 2];
+      int expected = 23;
+      if (n1 == -1 && n2 == -1 && n3 == -1)
+        expected = -1;
+      else if (n1 >= 0 && n2 >= 0 && n3 >= 0)
+      {
+        int codon = gCode.codonAlphabet().getCodon(n1, n2, n3);
+        expected = gCode.isStop(codon) ? -2 : gCode.translate(codon);
+      }
+      if (protein[k] != expected)
+        throw Exception("Bad six-frame translation.");
+    }
+  }
+  cout << frames[0]->toString() << endl;
+
+  cout << "--- ORF finding ---" << endl;
+
+  auto sharedCode = make_shared<StandardGeneticCode>(AlphabetTools::DNA_ALPHABET);
+  OrfFinder finder(sharedCode);
+  finder.minLength(6);
+  finder.translate(true);
+  // A forward ORF at [2, 14[, and a reverse one at [16, 25[:
+  Sequence orfSeq("orfs", "CCATGAAATTTTAAGGTCAGGGCATA", alpha);
+  vector<OrfFinder::Orf> orfs;
+  finder.findOrfs(orfSeq, orfs);
+  shared_ptr<const Alphabet> protAlpha = AlphabetTools::PROTEIN_ALPHABET;
+  bool forwardFound = false, reverseFound = false;
+  for (const auto& orf : orfs)
+  {
+    string protein = Sequence("", orf.protein, protAlpha).toString();
+    if (!orf.reverse && orf.begin == 2 && orf.end == 14 && orf.hasStart && orf.hasStop && protein == "MKF")
+      forwardFound = true;
+    if (orf.reverse && orf.begin == 16 && orf.end == 25 && orf.frame == 1 && protein == "MP")
+      reverseFound = true;
+  }
+  if (!forwardFound || !reverseFound)
+    throw Exception("ORFs not found.");
+  // Without start codons, the fragment before the first stop codon, CCA TGA, is a partial ORF:
+  finder.requireStart(false);
+  finder.minLength(3);
+  for (bool partialOrfs : { false, true })
+  {
+    finder.partialOrfs(partialOrfs);
+    vector<OrfFinder::Orf> stopToStop;
+    finder.findOrfs(orfSeq, stopToStop);
+    bool firstFragmentFound = false;
+    for (const auto& orf : stopToStop)
+    {
+      if (!orf.reverse && orf.begin == 0 && orf.end == 6 && orf.hasStop)
+        firstFragmentFound = true;
+      if (!partialOrfs && !orf.hasStop)
+        throw Exception("Partial ORF reported.");
+    }
+    if (firstFragmentFound != partialOrfs)
+      throw Exception("Bad report of the ORF before the first stop codon.");
+  }
+
+  // Chunks scanned in parallel give the same ORFs:
+  string genome;
+  unsigned int random = 12345;
+  for (size_t i = 0; i < 450000; ++i)
+  {
+    random = random * 1103515245 + 12345;
+    genome += "ACGT"[(random >> 16) % 4];
+  }
+  Sequence genomeSeq("genome", genome, alpha);
+  for (bool requireStart : { true, false })
+  {
+    finder.requireStart(requireStart);
+    finder.partialOrfs(!requireStart);
+    finder.alternativeStarts(!requireStart);
+    finder.minLength(90);
+    vector<OrfFinder::Orf> serial, parallel;
+    finder.setNumberOfThreads(1);
+    finder.findOrfs(genomeSeq, serial);
+    finder.setNumberOfThreads(4);
+    finder.findOrfs(genomeSeq, parallel);
+    if (serial.size() == 0 || serial.size() != parallel.size())
+      throw Exception("Bad number of ORFs with several threads.");
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+      const auto& orf = serial[i];
+      if (orf.begin != parallel[i].begin || orf.end != parallel[i].end || orf.reverse != parallel[i].reverse || orf.protein != parallel[i].protein)
+        throw Exception("Bad ORF with several threads.");
+      // Only the last codon is a stop codon:
+      vector<int> codons(orf.length() / 3);
+      gCode.translateNucleotides(genomeSeq.getContent().data() + orf.begin, orf.length(), codons.data(), orf.reverse);
+      if (orf.length() < 90 || orf.length() % 3 != 0 || count(codons.begin(), codons.end(), -2) != (orf.hasStop ? 1 : 0) || (orf.hasStop && codons.back() != -2))
+        throw Exception("Bad ORF.");
+      if (requireStart && !(orf.hasStart && orf.protein[0] == 12))
+        throw Exception("ORF without start codon.");
+    }
+    cout << serial.size() << " ORFs found." << endl;
+  }
+
+  // Sequences read from a stream:
+  finder.requireStart(true);
+  finder.partialOrfs(false);
+  finder.minLength(6);
+  auto fastaInput = make_shared<istringstream>(">first\nCCATGAAATTTTAAGG\n>second\nTCAGGGCATA\n");
+  StreamSequenceIterator fastaSequences(make_shared<Fasta>(), fastaInput, alpha);
+  vector<OrfFinder::Orf> streamOrfs;
+  finder.findOrfs(fastaSequences, streamOrfs);
+  if (streamOrfs.size() != 2 || streamOrfs[0].sequenceName != "first" || streamOrfs[1].sequenceName != "second" || !streamOrfs[1].reverse)
+    throw Exception("Bad ORFs from a stream.");
+
+  cout << "--- Motif search ---" << endl;
+
+  // Matches are checked against a naive search, on a sequence with ambiguities and N runs:
+  string target;
+  for (size_t i = 0; i < 5000; ++i)
+  {
+    random = random * 1103515245 + 12345;
+    unsigned int r = (random >> 16) % 200;
+    target += r < 2 ? (r == 0 ? 'R' : 'W') : "ACGT"[r % 4];
+  }
+  target.replace(1000, 30, string(30, 'N'));
+  target.replace(3000, 3, "--A");
+  Sequence targetSeq("target", target, alpha);
+  VectorSequenceContainer motifs(alpha);
+  for (size_t m = 0; m < 200; ++m)
+  {
+    // Motifs are taken from the target, with some ambiguity codes:
+    random = random * 1103515245 + 12345;
+    size_t begin = (random >> 16) % 4900;
+    string motif = target.substr(begin, 6 + m % 10);
+    if (m % 7 == 0)
+      motif[m % motif.size()] = "NRYSWKM"[(m / 7) % 7];
+    if (m % 50 == 1)
+      motif.replace(1, 6, "NNNNNN");
+    auto motifSeq = make_unique<Sequence>("m" + TextTools::toString(m), motif, alpha);
+    motifs.addSequence(motifSeq);
+  }
+  auto naiveSearch = [&](const MotifSearch& search, vector<MotifSearch::Match>& matches) {
+    for (size_t m = 0; m < motifs.getNumberOfSequences(); ++m)
+    {
+      vector<int> motif = motifs.sequence(m).getContent();
+      for (bool reverse : { false, true })
+      {
+        if (reverse && !search.searchesBothStrands())
+          continue;
+        if (reverse)
+        {
+          Sequence complement(motifs.sequence(m));
+          SequenceTools::invertComplement(complement);
+          motif = complement.getContent();
+        }
+        for (size_t i = 0; i + motif.size() <= targetSeq.size(); ++i)
+        {
+          bool found = true;
+          for (size_t j = 0; found && j < motif.size(); ++j)
+          {
+            int x = targetSeq[i + j], y = motif[j];
+            if (search.isStrict())
+              found = x == y;
+            else if (!search.matchUnresolved() && (x < 0 || x > 3))
+              found = false;
+            else
+            {
+              vector<int> aliases1 = alpha->getAlias(x), aliases2 = alpha->getAlias(y);
+              found = find_first_of(aliases1.begin(), aliases1.end(), aliases2.begin(), aliases2.end()) != aliases1.end();
+            }
+          }
+          if (found)
+            matches.push_back(MotifSearch::Match{ m, i, i + motif.size(), reverse });
+        }
+      }
+    }
+    sort(matches.begin(), matches.end(), [](const MotifSearch::Match& match1, const MotifSearch::Match& match2) {
+      if (match1.end != match2.end)
+        return match1.end < match2.end;
+      if (match1.begin != match2.begin)
+        return match1.begin < match2.begin;
+      return match1.motif < match2.motif || (match1.motif == match2.motif && match1.reverse < match2.reverse);
+    });
+  };
+  for (bool strict : { true, false })
+  {
+    for (bool bothStrands : { false, true })
+    {
+      for (bool matchUnresolved : { true, false })
+      {
+        MotifSearch search(motifs, strict, bothStrands);
+        search.matchUnresolved(matchUnresolved);
+        vector<MotifSearch::Match> matches, expected;
+        search.findAll(targetSeq, matches);
+        naiveSearch(search, expected);
+        if (matches.size() != expected.size())
+          throw Exception("Bad number of motif matches.");
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+          if (matches[i].motif != expected[i].motif || matches[i].begin != expected[i].begin || matches[i].end != expected[i].end || matches[i].reverse != expected[i].reverse)
+            throw Exception("Bad motif match.");
+        }
+        cout << matches.size() << " matches found." << endl;
+      }
+    }
+  }
+
+  // A small set of motifs, on both strands:
+  Sequence palindrome("palindrome", "ARYT", alpha);
+  MotifSearch palindromeSearch(palindrome, false, true);
+  Sequence palindromes("palindromes", "CCAGCTGGAATTCC", alpha);
+  MotifSearch::MatchIterator it(palindromeSearch, palindromes);
+  vector<size_t> starts;
+  while (it.hasMoreMatches())
+  {
+    MotifSearch::Match match = it.nextMatch();
+    starts.push_back(match.begin);
+  }
+  if (starts != vector<size_t>({ 2, 2, 8, 8 }))
+    throw Exception("Bad matches on both strands.");
+
+  // Unresolved states of the sequences only match if requested, except with findFirstOf:
+  Sequence nRun("nRun", "CCTNNNNNAGG", alpha);
+  Sequence ctnag("ctnag", "CTNAG", alpha);
+  MotifSearch nRunSearch(ctnag);
+  vector<MotifSearch::Match> nRunMatches;
+  nRunSearch.findAll(nRun, nRunMatches);
+  if (nRunSearch.matchUnresolved() || !nRunMatches.empty())
+    throw Exception("Unresolved states matched by default.");
+  nRunSearch.matchUnresolved(true);
+  nRunSearch.findAll(nRun, nRunMatches);
+  if (nRunMatches.empty() || nRunMatches[0].begin != 1 || SequenceTools::findFirstOf(nRun, ctnag, false) != 1)
+    throw Exception("Unresolved states not matched.");
+
   cout << "--- Strict match ---" << endl;
 
   pos = SequenceTools::findFirstOf(seq1, motif1);